@@ -87,4 +87,7 @@
 
 #define SO_BPF_EXTENSIONS	48
 
+#define SO_ATTACH_BPF		50
+#define SO_DETACH_BPF		SO_DETACH_FILTER
+
 #endif /* _UAPI_ASM_SOCKET_H */
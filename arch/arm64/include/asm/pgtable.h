@@ -346,6 +346,14 @@ extern pgprot_t phys_mem_access_prot(struct file *file, unsigned long pfn,
 #define pmd_sect(pmd)		((pmd_val(pmd) & PMD_TYPE_MASK) == \
 				 PMD_TYPE_SECT)
 
+/*
+ * APTable[1] write-protects everything mapped below a table descriptor,
+ * whatever the permissions of the ptes themselves (used by lazy fork).
+ */
+#define pmd_table_wrprotected(pmd)	(!!(pmd_val(pmd) & PMD_TABLE_RDONLY))
+#define pmd_table_wrprotect(pmd)	__pmd(pmd_val(pmd) | PMD_TABLE_RDONLY)
+#define pmd_table_mkwrite(pmd)		__pmd(pmd_val(pmd) & ~PMD_TABLE_RDONLY)
+
 #ifdef CONFIG_ARM64_64K_PAGES
 #define pud_sect(pud)		(0)
 #define pud_table(pud)		(1)
@@ -19,6 +19,9 @@
 #include <asm/spinlock_types.h>
 #include <asm/processor.h>
 
+#ifdef CONFIG_QUEUED_SPINLOCKS
+#include <asm-generic/qspinlock.h>
+#else
 /*
  * Spinlock implementation.
  *
@@ -111,6 +114,7 @@ static inline int arch_spin_is_contended(arch_spinlock_t *lock)
 	return (lockval.next - lockval.owner) > 1;
 }
 #define arch_spin_is_contended	arch_spin_is_contended
+#endif /* CONFIG_QUEUED_SPINLOCKS */
 
 /*
  * Write lock implementation.
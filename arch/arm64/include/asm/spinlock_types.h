@@ -20,6 +20,9 @@
 # error "please don't include this file directly"
 #endif
 
+#ifdef CONFIG_QUEUED_SPINLOCKS
+#include <asm-generic/qspinlock_types.h>
+#else
 #define TICKET_SHIFT	16
 
 typedef struct {
@@ -33,6 +36,7 @@ typedef struct {
 } __aligned(4) arch_spinlock_t;
 
 #define __ARCH_SPIN_LOCK_UNLOCKED	{ 0 , 0 }
+#endif
 
 typedef struct {
 	volatile unsigned int lock;
@@ -80,5 +80,8 @@
 
 #define SO_BPF_EXTENSIONS	48
 
+#define SO_ATTACH_BPF		50
+#define SO_DETACH_BPF		SO_DETACH_FILTER
+
 #endif /* _ASM_SOCKET_H */
 
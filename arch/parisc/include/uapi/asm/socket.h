@@ -79,4 +79,7 @@
 
 #define SO_BPF_EXTENSIONS	0x4029
 
+#define SO_ATTACH_BPF		0x402B
+#define SO_DETACH_BPF		SO_DETACH_FILTER
+
 #endif /* _UAPI_ASM_SOCKET_H */
@@ -0,0 +1,619 @@
+/*
+ * Adiantum length-preserving encryption mode
+ *
+ * Copyright 2018 Google LLC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+/*
+ * Adiantum is a tweakable, length-preserving encryption mode designed for fast
+ * and secure disk encryption, especially on CPUs without dedicated crypto
+ * instructions.  Adiantum encrypts each sector using the XChaCha12 stream
+ * cipher, two passes of an epsilon-almost-delta-universal (e-dU) hash
+ * function, and an invocation of the AES-256 block cipher on a single
+ * 16-byte block.  See the paper for details:
+ *
+ *	Adiantum: length-preserving encryption for entry-level processors
+ *      (https://eprint.iacr.org/2018/720.pdf)
+ *
+ * For flexibility, this implementation also allows other ciphers:
+ *
+ *	- Stream cipher: XChaCha12 or XChaCha20
+ *	- Block cipher: any with a 128-bit block size and 256-bit key
+ *
+ * This implementation doesn't currently allow other e-dU hash functions, i.e.
+ * HPolyC is not supported.  This is because Adiantum is ~20% faster than
+ * HPolyC but still provably as secure, and also the e-dU hash function of
+ * HBSH is formally defined to take two inputs (tweak, message) which makes it
+ * difficult to wrap with the crypto_shash API.  Rather, some details need to
+ * be handled here.  Nevertheless, if needed in the future, support for other
+ * e-dU hash functions could be added here.
+ */
+
+#include <crypto/algapi.h>
+#include <crypto/b128ops.h>
+#include <crypto/chacha.h>
+#include <crypto/internal/hash.h>
+#include <crypto/nhpoly1305.h>
+#include <crypto/scatterwalk.h>
+#include <linux/err.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/scatterlist.h>
+#include <linux/slab.h>
+
+#include "internal.h"
+
+/*
+ * Size of right-hand part of input data, in bytes; also the size of the block
+ * cipher's block size and the hash function's output.
+ */
+#define BLOCKCIPHER_BLOCK_SIZE		16
+
+/* Size of the block cipher key (K_E) in bytes */
+#define BLOCKCIPHER_KEY_SIZE		32
+
+/* Size of the hash key (K_H) in bytes */
+#define HASH_KEY_SIZE		(POLY1305_BLOCK_SIZE + NHPOLY1305_KEY_SIZE)
+
+/*
+ * The specification allows variable-length tweaks, but Linux's crypto API
+ * currently only allows algorithms to support a single length.  The "natural"
+ * tweak length for Adiantum is 16, since that fits into one Poly1305 block for
+ * the best performance.  But longer tweaks are useful for fscrypt, to avoid
+ * needing to derive per-file keys.  So instead we use two blocks, or 32 bytes.
+ */
+#define TWEAK_SIZE		32
+
+struct adiantum_instance_ctx {
+	struct crypto_spawn streamcipher_spawn;
+	struct crypto_spawn blockcipher_spawn;
+	struct crypto_shash_spawn hash_spawn;
+};
+
+struct adiantum_tfm_ctx {
+	struct crypto_blkcipher *streamcipher;
+	struct crypto_cipher *blockcipher;
+	struct crypto_shash *hash;
+	struct poly1305_key header_hash_key;
+};
+
+/*
+ * The right-hand part of the data, followed by the rest of the XChaCha IV
+ * while the stream cipher runs.  The first 16 bytes are P_R, P_M, C_M or C_R
+ * depending on the step; see adiantum_crypt().
+ */
+union adiantum_rbuf {
+	u8 bytes[XCHACHA_IV_SIZE];
+	__le32 words[XCHACHA_IV_SIZE / sizeof(__le32)];
+	le128 bignum;	/* interpret as element of Z/(2^{128}Z) */
+};
+
+/*
+ * Given the XChaCha stream key K_S, derive the block cipher key K_E and the
+ * hash key K_H as follows:
+ *
+ *     K_E || K_H || ... = XChaCha(key=K_S, nonce=1||0^191)
+ *
+ * Note that this denotes using bits from the XChaCha keystream, which here we
+ * get indirectly by encrypting a buffer containing all 0's.
+ */
+static int adiantum_setkey(struct crypto_tfm *parent, const u8 *key,
+			   unsigned int keylen)
+{
+	struct adiantum_tfm_ctx *tctx = crypto_tfm_ctx(parent);
+	struct {
+		u8 iv[XCHACHA_IV_SIZE];
+		u8 derived_keys[BLOCKCIPHER_KEY_SIZE + HASH_KEY_SIZE];
+		struct scatterlist sg;
+	} *data;
+	struct blkcipher_desc desc;
+	u8 *keyp;
+	int err;
+
+	/* Set the stream cipher key (K_S) */
+	crypto_blkcipher_clear_flags(tctx->streamcipher, CRYPTO_TFM_REQ_MASK);
+	crypto_blkcipher_set_flags(tctx->streamcipher,
+				   crypto_tfm_get_flags(parent) &
+				   CRYPTO_TFM_REQ_MASK);
+	err = crypto_blkcipher_setkey(tctx->streamcipher, key, keylen);
+	crypto_tfm_set_flags(parent,
+			     crypto_blkcipher_get_flags(tctx->streamcipher) &
+			     CRYPTO_TFM_RES_MASK);
+	if (err)
+		return err;
+
+	/* Derive the subkeys */
+	data = kzalloc(sizeof(*data), GFP_KERNEL);
+	if (!data)
+		return -ENOMEM;
+	data->iv[0] = 1;
+	sg_init_one(&data->sg, data->derived_keys, sizeof(data->derived_keys));
+	desc.tfm = tctx->streamcipher;
+	desc.info = data->iv;
+	desc.flags = CRYPTO_TFM_REQ_MAY_SLEEP;
+	err = crypto_blkcipher_encrypt_iv(&desc, &data->sg, &data->sg,
+					  sizeof(data->derived_keys));
+	if (err)
+		goto out;
+	keyp = data->derived_keys;
+
+	/* Set the block cipher key (K_E) */
+	crypto_cipher_clear_flags(tctx->blockcipher, CRYPTO_TFM_REQ_MASK);
+	crypto_cipher_set_flags(tctx->blockcipher,
+				crypto_tfm_get_flags(parent) &
+				CRYPTO_TFM_REQ_MASK);
+	err = crypto_cipher_setkey(tctx->blockcipher, keyp,
+				   BLOCKCIPHER_KEY_SIZE);
+	crypto_tfm_set_flags(parent,
+			     crypto_cipher_get_flags(tctx->blockcipher) &
+			     CRYPTO_TFM_RES_MASK);
+	if (err)
+		goto out;
+	keyp += BLOCKCIPHER_KEY_SIZE;
+
+	/* Set the hash key (K_H) */
+	poly1305_core_setkey(&tctx->header_hash_key, keyp);
+	keyp += POLY1305_BLOCK_SIZE;
+
+	crypto_shash_clear_flags(tctx->hash, CRYPTO_TFM_REQ_MASK);
+	crypto_shash_set_flags(tctx->hash, crypto_tfm_get_flags(parent) &
+					   CRYPTO_TFM_REQ_MASK);
+	err = crypto_shash_setkey(tctx->hash, keyp, NHPOLY1305_KEY_SIZE);
+	crypto_tfm_set_flags(parent, crypto_shash_get_flags(tctx->hash) &
+				     CRYPTO_TFM_RES_MASK);
+	keyp += NHPOLY1305_KEY_SIZE;
+	WARN_ON(keyp != &data->derived_keys[ARRAY_SIZE(data->derived_keys)]);
+out:
+	kzfree(data);
+	return err;
+}
+
+/* Addition in Z/(2^{128}Z) */
+static inline void le128_add(le128 *r, const le128 *v1, const le128 *v2)
+{
+	u64 x = le64_to_cpu(v1->b);
+	u64 y = le64_to_cpu(v2->b);
+
+	r->b = cpu_to_le64(x + y);
+	r->a = cpu_to_le64(le64_to_cpu(v1->a) + le64_to_cpu(v2->a) +
+			   (x + y < x));
+}
+
+/* Subtraction in Z/(2^{128}Z) */
+static inline void le128_sub(le128 *r, const le128 *v1, const le128 *v2)
+{
+	u64 x = le64_to_cpu(v1->b);
+	u64 y = le64_to_cpu(v2->b);
+
+	r->b = cpu_to_le64(x - y);
+	r->a = cpu_to_le64(le64_to_cpu(v1->a) - le64_to_cpu(v2->a) -
+			   (x - y > x));
+}
+
+/*
+ * Apply the Poly1305 e-dU hash function to (bulk length, tweak) and save the
+ * result to @header_hash.  This is the calculation
+ *
+ *	H_T <- Poly1305_{K_T}(bin_{128}(|L|) || T)
+ *
+ * from the procedure in section 6.4 of the Adiantum paper.  The resulting
+ * value is reused in both the first and second hash steps.  Specifically,
+ * it's added to the result of an independently keyed e-dU hash function
+ * (for equal length inputs only) taken over the left-hand part (the "bulk")
+ * of the message, to give the overall Adiantum hash of the
+ * (tweak, left-hand part) pair.
+ */
+static void adiantum_hash_header(const struct adiantum_tfm_ctx *tctx,
+				 unsigned int bulk_len, const u8 *tweak,
+				 le128 *header_hash)
+{
+	struct {
+		__le64 message_bits;
+		__le64 padding;
+	} header = {
+		.message_bits = cpu_to_le64((u64)bulk_len * 8)
+	};
+	struct poly1305_state state;
+
+	poly1305_core_init(&state);
+
+	BUILD_BUG_ON(sizeof(header) % POLY1305_BLOCK_SIZE != 0);
+	poly1305_core_blocks(&state, &tctx->header_hash_key,
+			     &header, sizeof(header) / POLY1305_BLOCK_SIZE);
+
+	BUILD_BUG_ON(TWEAK_SIZE % POLY1305_BLOCK_SIZE != 0);
+	poly1305_core_blocks(&state, &tctx->header_hash_key, tweak,
+			     TWEAK_SIZE / POLY1305_BLOCK_SIZE);
+
+	poly1305_core_emit(&state, header_hash);
+}
+
+/* Hash the left-hand part (the "bulk") of the message using NHPoly1305 */
+static void adiantum_hash_message(const struct adiantum_tfm_ctx *tctx,
+				  u32 flags, struct scatterlist *sgl,
+				  unsigned int bulk_len, le128 *digest)
+{
+	SHASH_DESC_ON_STACK(hash_desc, tctx->hash);
+	struct sg_mapping_iter miter;
+	unsigned int i, n;
+	int err;
+
+	hash_desc->tfm = tctx->hash;
+	hash_desc->flags = flags & CRYPTO_TFM_REQ_MAY_SLEEP;
+
+	err = crypto_shash_init(hash_desc);
+	BUG_ON(err);
+
+	sg_miter_start(&miter, sgl, sg_nents(sgl),
+		       SG_MITER_FROM_SG | SG_MITER_ATOMIC);
+	for (i = 0; i < bulk_len; i += n) {
+		sg_miter_next(&miter);
+		n = min_t(unsigned int, miter.length, bulk_len - i);
+		err = crypto_shash_update(hash_desc, miter.addr, n);
+		BUG_ON(err);
+	}
+	sg_miter_stop(&miter);
+
+	err = crypto_shash_final(hash_desc, (u8 *)digest);
+	BUG_ON(err);
+}
+
+static int adiantum_crypt(struct blkcipher_desc *desc,
+			  struct scatterlist *dst, struct scatterlist *src,
+			  unsigned int nbytes, bool enc)
+{
+	const struct adiantum_tfm_ctx *tctx = crypto_blkcipher_ctx(desc->tfm);
+	const unsigned int bulk_len = nbytes - BLOCKCIPHER_BLOCK_SIZE;
+	struct blkcipher_desc stream_desc;
+	union adiantum_rbuf rbuf;
+	le128 header_hash;
+	le128 digest;
+	unsigned int stream_len;
+	int err;
+
+	if (nbytes < BLOCKCIPHER_BLOCK_SIZE)
+		return -EINVAL;
+
+	/*
+	 * First hash step
+	 *	enc: P_M = P_R + H_{K_H}(T, P_L)
+	 *	dec: C_M = C_R + H_{K_H}(T, C_L)
+	 */
+	adiantum_hash_header(tctx, bulk_len, desc->info, &header_hash);
+	adiantum_hash_message(tctx, desc->flags, src, bulk_len, &digest);
+	le128_add(&digest, &digest, &header_hash);
+	scatterwalk_map_and_copy(&rbuf.bignum, src, bulk_len,
+				 BLOCKCIPHER_BLOCK_SIZE, 0);
+	le128_add(&rbuf.bignum, &rbuf.bignum, &digest);
+
+	/* If encrypting, encrypt P_M with the block cipher to get C_M */
+	if (enc)
+		crypto_cipher_encrypt_one(tctx->blockcipher, rbuf.bytes,
+					  rbuf.bytes);
+
+	/* Initialize the rest of the XChaCha IV (first part is C_M) */
+	BUILD_BUG_ON(BLOCKCIPHER_BLOCK_SIZE != 16);
+	BUILD_BUG_ON(XCHACHA_IV_SIZE != 32);	/* nonce || stream position */
+	rbuf.words[4] = cpu_to_le32(1);
+	rbuf.words[5] = 0;
+	rbuf.words[6] = 0;
+	rbuf.words[7] = 0;
+
+	/*
+	 * XChaCha needs to be done on all the data except the last 16 bytes;
+	 * for disk encryption that usually means 4080 or 496 bytes.  But ChaCha
+	 * implementations tend to be most efficient when passed a whole number
+	 * of 64-byte ChaCha blocks, or sometimes even a multiple of 256 bytes.
+	 * And here it doesn't matter whether the last 16 bytes are written to,
+	 * as the second hash step will overwrite them.  Thus, round the XChaCha
+	 * length up to the next 64-byte boundary if possible.
+	 */
+	stream_len = bulk_len;
+	if (round_up(stream_len, CHACHA_BLOCK_SIZE) <= nbytes)
+		stream_len = round_up(stream_len, CHACHA_BLOCK_SIZE);
+
+	stream_desc.tfm = tctx->streamcipher;
+	stream_desc.info = rbuf.bytes;
+	stream_desc.flags = desc->flags & CRYPTO_TFM_REQ_MAY_SLEEP;
+	err = crypto_blkcipher_encrypt_iv(&stream_desc, dst, src, stream_len);
+	if (err)
+		return err;
+
+	/* If decrypting, decrypt C_M with the block cipher to get P_M */
+	if (!enc)
+		crypto_cipher_decrypt_one(tctx->blockcipher, rbuf.bytes,
+					  rbuf.bytes);
+
+	/*
+	 * Second hash step
+	 *	enc: C_R = C_M - H_{K_H}(T, C_L)
+	 *	dec: P_R = P_M - H_{K_H}(T, P_L)
+	 */
+	adiantum_hash_message(tctx, desc->flags, dst, bulk_len, &digest);
+	le128_add(&digest, &digest, &header_hash);
+	le128_sub(&rbuf.bignum, &rbuf.bignum, &digest);
+	scatterwalk_map_and_copy(&rbuf.bignum, dst, bulk_len,
+				 BLOCKCIPHER_BLOCK_SIZE, 1);
+	return 0;
+}
+
+static int adiantum_encrypt(struct blkcipher_desc *desc,
+			    struct scatterlist *dst, struct scatterlist *src,
+			    unsigned int nbytes)
+{
+	return adiantum_crypt(desc, dst, src, nbytes, true);
+}
+
+static int adiantum_decrypt(struct blkcipher_desc *desc,
+			    struct scatterlist *dst, struct scatterlist *src,
+			    unsigned int nbytes)
+{
+	return adiantum_crypt(desc, dst, src, nbytes, false);
+}
+
+static int adiantum_init_tfm(struct crypto_tfm *tfm)
+{
+	struct crypto_instance *inst = (void *)tfm->__crt_alg;
+	struct adiantum_instance_ctx *ictx = crypto_instance_ctx(inst);
+	struct adiantum_tfm_ctx *tctx = crypto_tfm_ctx(tfm);
+	struct crypto_blkcipher *streamcipher;
+	struct crypto_cipher *blockcipher;
+	struct crypto_shash *hash;
+	int err;
+
+	streamcipher = crypto_spawn_blkcipher(&ictx->streamcipher_spawn);
+	if (IS_ERR(streamcipher))
+		return PTR_ERR(streamcipher);
+
+	blockcipher = crypto_spawn_cipher(&ictx->blockcipher_spawn);
+	if (IS_ERR(blockcipher)) {
+		err = PTR_ERR(blockcipher);
+		goto err_free_streamcipher;
+	}
+
+	hash = crypto_spawn_shash(&ictx->hash_spawn);
+	if (IS_ERR(hash)) {
+		err = PTR_ERR(hash);
+		goto err_free_blockcipher;
+	}
+
+	tctx->streamcipher = streamcipher;
+	tctx->blockcipher = blockcipher;
+	tctx->hash = hash;
+	return 0;
+
+err_free_blockcipher:
+	crypto_free_cipher(blockcipher);
+err_free_streamcipher:
+	crypto_free_blkcipher(streamcipher);
+	return err;
+}
+
+static void adiantum_exit_tfm(struct crypto_tfm *tfm)
+{
+	struct adiantum_tfm_ctx *tctx = crypto_tfm_ctx(tfm);
+
+	crypto_free_blkcipher(tctx->streamcipher);
+	crypto_free_cipher(tctx->blockcipher);
+	crypto_free_shash(tctx->hash);
+}
+
+/*
+ * Check for a supported set of inner algorithms.
+ * See the comment at the beginning of this file.
+ */
+static bool adiantum_supported_algorithms(struct crypto_alg *streamcipher_alg,
+					  struct crypto_alg *blockcipher_alg,
+					  struct shash_alg *hash_alg)
+{
+	if (strcmp(streamcipher_alg->cra_name, "xchacha12") != 0 &&
+	    strcmp(streamcipher_alg->cra_name, "xchacha20") != 0)
+		return false;
+
+	if (blockcipher_alg->cra_cipher.cia_min_keysize > BLOCKCIPHER_KEY_SIZE ||
+	    blockcipher_alg->cra_cipher.cia_max_keysize < BLOCKCIPHER_KEY_SIZE)
+		return false;
+	if (blockcipher_alg->cra_blocksize != BLOCKCIPHER_BLOCK_SIZE)
+		return false;
+
+	if (strcmp(hash_alg->base.cra_name, "nhpoly1305") != 0)
+		return false;
+
+	return true;
+}
+
+static struct crypto_instance *adiantum_alloc(struct rtattr **tb)
+{
+	const char *streamcipher_name;
+	const char *blockcipher_name;
+	const char *nhpoly1305_name;
+	struct crypto_instance *inst;
+	struct adiantum_instance_ctx *ictx;
+	struct crypto_alg *streamcipher_alg;
+	struct crypto_alg *blockcipher_alg;
+	struct crypto_alg *hash_base;
+	struct shash_alg *hash_alg;
+	int err;
+
+	err = crypto_check_attr_type(tb, CRYPTO_ALG_TYPE_BLKCIPHER);
+	if (err)
+		return ERR_PTR(err);
+
+	streamcipher_name = crypto_attr_alg_name(tb[1]);
+	if (IS_ERR(streamcipher_name))
+		return ERR_CAST(streamcipher_name);
+
+	blockcipher_name = crypto_attr_alg_name(tb[2]);
+	if (IS_ERR(blockcipher_name))
+		return ERR_CAST(blockcipher_name);
+
+	nhpoly1305_name = crypto_attr_alg_name(tb[3]);
+	if (nhpoly1305_name == ERR_PTR(-ENOENT))
+		nhpoly1305_name = "nhpoly1305";
+	if (IS_ERR(nhpoly1305_name))
+		return ERR_CAST(nhpoly1305_name);
+
+	/* Stream cipher, e.g. "xchacha12" */
+	streamcipher_alg = crypto_alg_mod_lookup(streamcipher_name,
+						 CRYPTO_ALG_TYPE_BLKCIPHER,
+						 CRYPTO_ALG_TYPE_MASK);
+	if (IS_ERR(streamcipher_alg))
+		return ERR_CAST(streamcipher_alg);
+
+	/* Block cipher, e.g. "aes" */
+	blockcipher_alg = crypto_alg_mod_lookup(blockcipher_name,
+						CRYPTO_ALG_TYPE_CIPHER,
+						CRYPTO_ALG_TYPE_MASK);
+	if (IS_ERR(blockcipher_alg)) {
+		err = PTR_ERR(blockcipher_alg);
+		goto out_put_streamcipher;
+	}
+
+	/* NHPoly1305 e-dU hash function */
+	hash_base = crypto_alg_mod_lookup(nhpoly1305_name,
+					  CRYPTO_ALG_TYPE_SHASH,
+					  CRYPTO_ALG_TYPE_MASK);
+	if (IS_ERR(hash_base)) {
+		err = PTR_ERR(hash_base);
+		goto out_put_blockcipher;
+	}
+	hash_alg = __crypto_shash_alg(hash_base);
+
+	/* Check the set of algorithms */
+	err = -EINVAL;
+	if (!adiantum_supported_algorithms(streamcipher_alg, blockcipher_alg,
+					   hash_alg)) {
+		pr_warn("Unsupported Adiantum instantiation: (%s,%s,%s)\n",
+			streamcipher_alg->cra_name, blockcipher_alg->cra_name,
+			hash_alg->base.cra_name);
+		goto out_put_hash;
+	}
+
+	inst = kzalloc(sizeof(*inst) + sizeof(*ictx), GFP_KERNEL);
+	err = -ENOMEM;
+	if (!inst)
+		goto out_put_hash;
+	ictx = crypto_instance_ctx(inst);
+
+	err = crypto_init_spawn(&ictx->streamcipher_spawn, streamcipher_alg,
+				inst, CRYPTO_ALG_TYPE_MASK);
+	if (err)
+		goto err_free_inst;
+
+	err = crypto_init_spawn(&ictx->blockcipher_spawn, blockcipher_alg,
+				inst, CRYPTO_ALG_TYPE_MASK);
+	if (err)
+		goto err_drop_streamcipher;
+
+	err = crypto_init_shash_spawn(&ictx->hash_spawn, hash_alg, inst);
+	if (err)
+		goto err_drop_blockcipher;
+
+	/* Instance fields */
+
+	err = -ENAMETOOLONG;
+	if (snprintf(inst->alg.cra_name, CRYPTO_MAX_ALG_NAME,
+		     "adiantum(%s,%s)", streamcipher_alg->cra_name,
+		     blockcipher_alg->cra_name) >= CRYPTO_MAX_ALG_NAME)
+		goto err_drop_hash;
+	if (snprintf(inst->alg.cra_driver_name, CRYPTO_MAX_ALG_NAME,
+		     "adiantum(%s,%s,%s)",
+		     streamcipher_alg->cra_driver_name,
+		     blockcipher_alg->cra_driver_name,
+		     hash_alg->base.cra_driver_name) >= CRYPTO_MAX_ALG_NAME)
+		goto err_drop_hash;
+
+	inst->alg.cra_flags = CRYPTO_ALG_TYPE_BLKCIPHER;
+	inst->alg.cra_blocksize = BLOCKCIPHER_BLOCK_SIZE;
+	inst->alg.cra_ctxsize = sizeof(struct adiantum_tfm_ctx);
+	inst->alg.cra_alignmask = streamcipher_alg->cra_alignmask |
+				  hash_alg->base.cra_alignmask;
+	/*
+	 * The block cipher is only invoked once per message, so for long
+	 * messages (e.g. sectors for disk encryption) its performance doesn't
+	 * matter as much as that of the stream cipher and hash function.  Thus,
+	 * weigh the block cipher's ->cra_priority less.
+	 */
+	inst->alg.cra_priority = (4 * streamcipher_alg->cra_priority +
+				  2 * hash_alg->base.cra_priority +
+				  blockcipher_alg->cra_priority) / 7;
+	inst->alg.cra_type = &crypto_blkcipher_type;
+
+	inst->alg.cra_blkcipher.min_keysize =
+		streamcipher_alg->cra_blkcipher.min_keysize;
+	inst->alg.cra_blkcipher.max_keysize =
+		streamcipher_alg->cra_blkcipher.max_keysize;
+	inst->alg.cra_blkcipher.ivsize = TWEAK_SIZE;
+
+	inst->alg.cra_init = adiantum_init_tfm;
+	inst->alg.cra_exit = adiantum_exit_tfm;
+
+	inst->alg.cra_blkcipher.setkey = adiantum_setkey;
+	inst->alg.cra_blkcipher.encrypt = adiantum_encrypt;
+	inst->alg.cra_blkcipher.decrypt = adiantum_decrypt;
+
+out:
+	crypto_mod_put(hash_base);
+	crypto_mod_put(blockcipher_alg);
+	crypto_mod_put(streamcipher_alg);
+	return inst;
+
+err_drop_hash:
+	crypto_drop_shash(&ictx->hash_spawn);
+err_drop_blockcipher:
+	crypto_drop_spawn(&ictx->blockcipher_spawn);
+err_drop_streamcipher:
+	crypto_drop_spawn(&ictx->streamcipher_spawn);
+err_free_inst:
+	kfree(inst);
+	inst = ERR_PTR(err);
+	goto out;
+
+out_put_hash:
+	crypto_mod_put(hash_base);
+out_put_blockcipher:
+	crypto_mod_put(blockcipher_alg);
+out_put_streamcipher:
+	crypto_mod_put(streamcipher_alg);
+	return ERR_PTR(err);
+}
+
+static void adiantum_free(struct crypto_instance *inst)
+{
+	struct adiantum_instance_ctx *ictx = crypto_instance_ctx(inst);
+
+	crypto_drop_spawn(&ictx->streamcipher_spawn);
+	crypto_drop_spawn(&ictx->blockcipher_spawn);
+	crypto_drop_shash(&ictx->hash_spawn);
+	kfree(inst);
+}
+
+/* adiantum(streamcipher_name, blockcipher_name [, nhpoly1305_name]) */
+static struct crypto_template adiantum_tmpl = {
+	.name = "adiantum",
+	.alloc = adiantum_alloc,
+	.free = adiantum_free,
+	.module = THIS_MODULE,
+};
+
+static int __init adiantum_module_init(void)
+{
+	return crypto_register_template(&adiantum_tmpl);
+}
+
+static void __exit adiantum_module_exit(void)
+{
+	crypto_unregister_template(&adiantum_tmpl);
+}
+
+module_init(adiantum_module_init);
+module_exit(adiantum_module_exit);
+
+MODULE_DESCRIPTION("Adiantum length-preserving encryption mode");
+MODULE_LICENSE("GPL v2");
+MODULE_AUTHOR("Eric Biggers <ebiggers@google.com>");
+MODULE_ALIAS_CRYPTO("adiantum");
@@ -0,0 +1,844 @@
+/*
+ * Crypto API throughput benchmark
+ *
+ * Unlike tcrypt, which runs a fixed list of speed tests selected by mode
+ * number, this module stays loaded and takes a benchmark specification
+ * through debugfs.  Requests are issued through the asynchronous
+ * ablkcipher, aead and ahash interfaces, optionally from several threads
+ * and with several requests in flight per thread, so that both synchronous
+ * (generic, NEON, CE) and offloaded drivers can be compared under the same
+ * load.  Results are returned as a single JSON object.
+ *
+ * Example:
+ *
+ *   # echo "type=skcipher alg=xts(aes) driver=xts-aes-ce keylen=64 \
+ *           sizes=512,4096 depth=8 threads=4 secs=1" \
+ *           > /sys/kernel/debug/crypto_bench/run
+ *   # cat /sys/kernel/debug/crypto_bench/run
+ *
+ * Recognised keys:
+ *   type      skcipher, aead or hash (default skcipher)
+ *   alg       algorithm name, e.g. "cbc(aes)" or "sha256"
+ *   driver    driver name to benchmark instead of the highest priority one
+ *   keylen    key size in bytes; required for ciphers, optional for hashes
+ *   sizes     comma separated request sizes in bytes
+ *   depth     requests kept in flight by each thread (default 1)
+ *   threads   number of submitting threads, one per CPU (default 1)
+ *   secs      seconds to run each request size for (default 1)
+ *   op        encrypt or decrypt (default encrypt)
+ *   assoclen  AEAD associated data length (default 0)
+ *   authsize  AEAD tag length (default: the algorithm's maximum)
+ *
+ * "cycles_per_byte" is measured with get_cycles(), as tcrypt's cycle mode
+ * is, and is summed over all submitting threads.  On architectures where
+ * get_cycles() reads a fixed frequency counter it is in counter ticks.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ */
+
+#include <crypto/hash.h>
+#include <linux/cpumask.h>
+#include <linux/crypto.h>
+#include <linux/debugfs.h>
+#include <linux/err.h>
+#include <linux/jiffies.h>
+#include <linux/kernel.h>
+#include <linux/ktime.h>
+#include <linux/kthread.h>
+#include <linux/list.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/random.h>
+#include <linux/scatterlist.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/timex.h>
+#include <linux/uaccess.h>
+
+#define BENCH_MAX_SIZES		16
+#define BENCH_MAX_SIZE		(64 * 1024)
+#define BENCH_MAX_DEPTH		64
+#define BENCH_MAX_SECS		60
+#define BENCH_MAX_KEYLEN	1088
+#define BENCH_MAX_IVLEN		32
+#define BENCH_MAX_AUTHSIZE	32
+#define BENCH_MAX_ASSOCLEN	512
+#define BENCH_MAX_DIGESTSIZE	64
+#define BENCH_RESULT_SIZE	8192
+
+enum bench_type {
+	BENCH_SKCIPHER,
+	BENCH_AEAD,
+	BENCH_HASH,
+};
+
+static const char * const bench_type_names[] = {
+	[BENCH_SKCIPHER]	= "skcipher",
+	[BENCH_AEAD]		= "aead",
+	[BENCH_HASH]		= "hash",
+};
+
+static const unsigned int bench_default_sizes[] = {
+	16, 64, 256, 512, 1024, 4096,
+};
+
+struct bench_spec {
+	enum bench_type type;
+	char alg[CRYPTO_MAX_ALG_NAME];
+	char driver[CRYPTO_MAX_ALG_NAME];
+	unsigned int keylen;
+	unsigned int sizes[BENCH_MAX_SIZES];
+	unsigned int nsizes;
+	unsigned int depth;
+	unsigned int threads;
+	unsigned int secs;
+	bool decrypt;
+	unsigned int assoclen;
+	int authsize;
+};
+
+struct bench_run;
+struct bench_thread;
+
+struct bench_slot {
+	struct bench_thread *thread;
+	struct list_head list;
+	int err;
+	union {
+		struct ablkcipher_request *skcipher;
+		struct aead_request *aead;
+		struct ahash_request *hash;
+	} req;
+	u8 *src;
+	u8 *dst;
+	struct scatterlist sg_src;
+	struct scatterlist sg_dst;
+	u8 iv[BENCH_MAX_IVLEN];
+	u8 digest[BENCH_MAX_DIGESTSIZE];
+};
+
+struct bench_thread {
+	struct bench_run *run;
+	struct bench_slot *slots;
+	unsigned int nslots;
+	spinlock_t lock;
+	struct list_head done;
+	struct completion comp;
+	u64 ops;
+	u64 bytes;
+	u64 cycles;
+	int err;
+};
+
+struct bench_run {
+	const struct bench_spec *spec;
+	union {
+		struct crypto_ablkcipher *skcipher;
+		struct crypto_aead *aead;
+		struct crypto_ahash *hash;
+	} tfm;
+	const char *driver;
+	unsigned int ivsize;
+	unsigned int authsize;
+	unsigned int size;
+	unsigned long deadline;
+	u8 iv[BENCH_MAX_IVLEN];
+	u8 *assoc;
+	struct scatterlist sg_assoc;
+	atomic_t remaining;
+	struct completion all_done;
+};
+
+static struct dentry *bench_dir;
+static DEFINE_MUTEX(bench_mutex);
+static char *bench_result;
+static size_t bench_result_len;
+
+static void bench_slot_done(struct bench_slot *slot, int err)
+{
+	struct bench_thread *t = slot->thread;
+	unsigned long flags;
+
+	slot->err = err;
+	spin_lock_irqsave(&t->lock, flags);
+	list_add_tail(&slot->list, &t->done);
+	spin_unlock_irqrestore(&t->lock, flags);
+	complete(&t->comp);
+}
+
+static void bench_req_done(struct crypto_async_request *req, int err)
+{
+	if (err == -EINPROGRESS)
+		return;
+
+	bench_slot_done(req->data, err);
+}
+
+/*
+ * Start one request.  Whether the driver completes it synchronously, queues
+ * it or fails it, the slot always ends up on its thread's done list.
+ */
+static void bench_submit(struct bench_slot *slot)
+{
+	struct bench_run *run = slot->thread->run;
+	const struct bench_spec *spec = run->spec;
+	int ret;
+
+	memcpy(slot->iv, run->iv, run->ivsize);
+
+	switch (spec->type) {
+	case BENCH_SKCIPHER:
+		if (spec->decrypt)
+			ret = crypto_ablkcipher_decrypt(slot->req.skcipher);
+		else
+			ret = crypto_ablkcipher_encrypt(slot->req.skcipher);
+		break;
+	case BENCH_AEAD:
+		if (spec->decrypt)
+			ret = crypto_aead_decrypt(slot->req.aead);
+		else
+			ret = crypto_aead_encrypt(slot->req.aead);
+		break;
+	default:
+		ret = crypto_ahash_digest(slot->req.hash);
+		break;
+	}
+
+	if (ret == -EINPROGRESS || ret == -EBUSY)
+		return;
+	bench_slot_done(slot, ret);
+}
+
+static int bench_thread_fn(void *data)
+{
+	struct bench_thread *t = data;
+	struct bench_run *run = t->run;
+	unsigned int inflight = 0;
+	cycles_t start;
+	unsigned int i;
+
+	start = get_cycles();
+	for (i = 0; i < run->spec->depth; i++) {
+		bench_submit(&t->slots[i]);
+		inflight++;
+	}
+
+	while (inflight) {
+		struct bench_slot *slot;
+
+		wait_for_completion(&t->comp);
+		spin_lock_irq(&t->lock);
+		slot = list_first_entry(&t->done, struct bench_slot, list);
+		list_del(&slot->list);
+		spin_unlock_irq(&t->lock);
+		inflight--;
+
+		if (slot->err) {
+			if (!t->err)
+				t->err = slot->err;
+			continue;
+		}
+		t->ops++;
+		t->bytes += run->size;
+
+		if (!t->err && time_before(jiffies, run->deadline)) {
+			bench_submit(slot);
+			inflight++;
+		}
+	}
+	t->cycles = get_cycles() - start;
+
+	if (atomic_dec_and_test(&run->remaining))
+		complete(&run->all_done);
+	return 0;
+}
+
+static void bench_free_slot(struct bench_run *run, struct bench_slot *slot)
+{
+	switch (run->spec->type) {
+	case BENCH_SKCIPHER:
+		ablkcipher_request_free(slot->req.skcipher);
+		break;
+	case BENCH_AEAD:
+		aead_request_free(slot->req.aead);
+		break;
+	default:
+		ahash_request_free(slot->req.hash);
+		break;
+	}
+	kfree(slot->src);
+	kfree(slot->dst);
+}
+
+static int bench_init_slot(struct bench_run *run, struct bench_thread *t,
+			   struct bench_slot *slot, const u8 *src)
+{
+	const struct bench_spec *spec = run->spec;
+	unsigned int len = run->size + run->authsize;
+	unsigned int cryptlen;
+
+	slot->thread = t;
+	slot->src = kmemdup(src, len, GFP_KERNEL);
+	slot->dst = kmalloc(len, GFP_KERNEL);
+	if (!slot->src || !slot->dst)
+		goto nomem;
+	sg_init_one(&slot->sg_src, slot->src, len);
+	sg_init_one(&slot->sg_dst, slot->dst, len);
+
+	switch (spec->type) {
+	case BENCH_SKCIPHER:
+		slot->req.skcipher = ablkcipher_request_alloc(run->tfm.skcipher,
+							      GFP_KERNEL);
+		if (!slot->req.skcipher)
+			goto nomem;
+		ablkcipher_request_set_callback(slot->req.skcipher,
+						CRYPTO_TFM_REQ_MAY_BACKLOG,
+						bench_req_done, slot);
+		ablkcipher_request_set_crypt(slot->req.skcipher,
+					     &slot->sg_src, &slot->sg_dst,
+					     run->size, slot->iv);
+		break;
+	case BENCH_AEAD:
+		slot->req.aead = aead_request_alloc(run->tfm.aead, GFP_KERNEL);
+		if (!slot->req.aead)
+			goto nomem;
+		cryptlen = run->size;
+		if (spec->decrypt)
+			cryptlen += run->authsize;
+		aead_request_set_callback(slot->req.aead,
+					  CRYPTO_TFM_REQ_MAY_BACKLOG,
+					  bench_req_done, slot);
+		aead_request_set_assoc(slot->req.aead, &run->sg_assoc,
+				       spec->assoclen);
+		aead_request_set_crypt(slot->req.aead, &slot->sg_src,
+				       &slot->sg_dst, cryptlen, slot->iv);
+		break;
+	default:
+		slot->req.hash = ahash_request_alloc(run->tfm.hash, GFP_KERNEL);
+		if (!slot->req.hash)
+			goto nomem;
+		ahash_request_set_callback(slot->req.hash,
+					   CRYPTO_TFM_REQ_MAY_BACKLOG,
+					   bench_req_done, slot);
+		ahash_request_set_crypt(slot->req.hash, &slot->sg_src,
+					slot->digest, run->size);
+		break;
+	}
+	return 0;
+
+nomem:
+	kfree(slot->src);
+	kfree(slot->dst);
+	return -ENOMEM;
+}
+
+/*
+ * AEAD decryption only succeeds on a valid ciphertext, so produce one with
+ * a single encryption that every slot then starts from.
+ */
+static int bench_prepare_aead_input(struct bench_run *run, u8 *buf)
+{
+	unsigned int len = run->size + run->authsize;
+	struct scatterlist sg_src, sg_dst;
+	struct aead_request *req;
+	DECLARE_CRYPTO_WAIT(wait);
+	u8 *out;
+	u8 iv[BENCH_MAX_IVLEN];
+	int err;
+
+	out = kmalloc(len, GFP_KERNEL);
+	req = aead_request_alloc(run->tfm.aead, GFP_KERNEL);
+	if (!out || !req) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	memcpy(iv, run->iv, run->ivsize);
+	sg_init_one(&sg_src, buf, len);
+	sg_init_one(&sg_dst, out, len);
+	aead_request_set_callback(req, CRYPTO_TFM_REQ_MAY_BACKLOG |
+				  CRYPTO_TFM_REQ_MAY_SLEEP,
+				  crypto_req_done, &wait);
+	aead_request_set_assoc(req, &run->sg_assoc, run->spec->assoclen);
+	aead_request_set_crypt(req, &sg_src, &sg_dst, run->size, iv);
+	err = crypto_wait_req(crypto_aead_encrypt(req), &wait);
+	if (!err)
+		memcpy(buf, out, len);
+out:
+	aead_request_free(req);
+	kfree(out);
+	return err;
+}
+
+static int bench_one_size(struct bench_run *run, unsigned int size,
+			  u64 *ops, u64 *bytes, u64 *ns, u64 *cycles)
+{
+	const struct bench_spec *spec = run->spec;
+	struct task_struct **tasks;
+	struct bench_thread *threads;
+	unsigned int i, cpu;
+	u8 *src;
+	u64 start;
+	int err;
+
+	run->size = size;
+	src = kmalloc(size + run->authsize, GFP_KERNEL);
+	threads = kcalloc(spec->threads, sizeof(*threads), GFP_KERNEL);
+	tasks = kcalloc(spec->threads, sizeof(*tasks), GFP_KERNEL);
+	if (!src || !threads || !tasks) {
+		err = -ENOMEM;
+		goto out;
+	}
+	get_random_bytes(src, size + run->authsize);
+
+	if (spec->type == BENCH_AEAD && spec->decrypt) {
+		err = bench_prepare_aead_input(run, src);
+		if (err)
+			goto out;
+	}
+
+	for (i = 0; i < spec->threads; i++) {
+		struct bench_thread *t = &threads[i];
+
+		t->run = run;
+		spin_lock_init(&t->lock);
+		INIT_LIST_HEAD(&t->done);
+		init_completion(&t->comp);
+		t->slots = kcalloc(spec->depth, sizeof(*t->slots), GFP_KERNEL);
+		if (!t->slots) {
+			err = -ENOMEM;
+			goto out_slots;
+		}
+		for (; t->nslots < spec->depth; t->nslots++) {
+			err = bench_init_slot(run, t, &t->slots[t->nslots], src);
+			if (err)
+				goto out_slots;
+		}
+	}
+
+	atomic_set(&run->remaining, spec->threads);
+	init_completion(&run->all_done);
+
+	cpu = cpumask_first(cpu_online_mask);
+	for (i = 0; i < spec->threads; i++) {
+		tasks[i] = kthread_create(bench_thread_fn, &threads[i],
+					  "crypto_bench/%u", i);
+		if (IS_ERR(tasks[i])) {
+			err = PTR_ERR(tasks[i]);
+			while (i--)
+				kthread_stop(tasks[i]);
+			goto out_slots;
+		}
+		kthread_bind(tasks[i], cpu);
+		cpu = cpumask_next(cpu, cpu_online_mask);
+		if (cpu >= nr_cpu_ids)
+			cpu = cpumask_first(cpu_online_mask);
+	}
+
+	run->deadline = jiffies + spec->secs * HZ;
+	start = ktime_get_ns();
+	for (i = 0; i < spec->threads; i++)
+		wake_up_process(tasks[i]);
+	wait_for_completion(&run->all_done);
+	*ns = ktime_get_ns() - start;
+
+	err = 0;
+	*ops = *bytes = *cycles = 0;
+	for (i = 0; i < spec->threads; i++) {
+		if (threads[i].err && !err)
+			err = threads[i].err;
+		*ops += threads[i].ops;
+		*bytes += threads[i].bytes;
+		*cycles += threads[i].cycles;
+	}
+
+out_slots:
+	for (i = 0; i < spec->threads; i++) {
+		struct bench_thread *t = &threads[i];
+
+		while (t->nslots--)
+			bench_free_slot(run, &t->slots[t->nslots]);
+		kfree(t->slots);
+	}
+out:
+	kfree(tasks);
+	kfree(threads);
+	kfree(src);
+	return err;
+}
+
+static int bench_alloc_tfm(struct bench_run *run)
+{
+	const struct bench_spec *spec = run->spec;
+	const char *name = spec->driver[0] ? spec->driver : spec->alg;
+	u8 *key = NULL;
+	int err;
+
+	if (spec->keylen) {
+		key = kmalloc(spec->keylen, GFP_KERNEL);
+		if (!key)
+			return -ENOMEM;
+		get_random_bytes(key, spec->keylen);
+	}
+
+	switch (spec->type) {
+	case BENCH_SKCIPHER:
+		run->tfm.skcipher = crypto_alloc_ablkcipher(name, 0, 0);
+		if (IS_ERR(run->tfm.skcipher)) {
+			err = PTR_ERR(run->tfm.skcipher);
+			break;
+		}
+		run->driver = crypto_tfm_alg_driver_name(
+				crypto_ablkcipher_tfm(run->tfm.skcipher));
+		run->ivsize = crypto_ablkcipher_ivsize(run->tfm.skcipher);
+		err = crypto_ablkcipher_setkey(run->tfm.skcipher, key,
+					       spec->keylen);
+		break;
+	case BENCH_AEAD:
+		run->tfm.aead = crypto_alloc_aead(name, 0, 0);
+		if (IS_ERR(run->tfm.aead)) {
+			err = PTR_ERR(run->tfm.aead);
+			break;
+		}
+		run->driver = crypto_tfm_alg_driver_name(
+				crypto_aead_tfm(run->tfm.aead));
+		run->ivsize = crypto_aead_ivsize(run->tfm.aead);
+		/* a freshly allocated tfm uses the maximum tag size */
+		run->authsize = spec->authsize >= 0 ? spec->authsize :
+				crypto_aead_authsize(run->tfm.aead);
+		if (run->authsize > BENCH_MAX_AUTHSIZE) {
+			err = -EINVAL;
+			break;
+		}
+		err = crypto_aead_setkey(run->tfm.aead, key, spec->keylen);
+		if (!err)
+			err = crypto_aead_setauthsize(run->tfm.aead,
+						      run->authsize);
+		break;
+	default:
+		run->tfm.hash = crypto_alloc_ahash(name, 0, 0);
+		if (IS_ERR(run->tfm.hash)) {
+			err = PTR_ERR(run->tfm.hash);
+			break;
+		}
+		run->driver = crypto_tfm_alg_driver_name(
+				crypto_ahash_tfm(run->tfm.hash));
+		if (crypto_ahash_digestsize(run->tfm.hash) >
+		    BENCH_MAX_DIGESTSIZE) {
+			err = -EINVAL;
+			break;
+		}
+		err = 0;
+		if (spec->keylen)
+			err = crypto_ahash_setkey(run->tfm.hash, key,
+						  spec->keylen);
+		break;
+	}
+	kfree(key);
+
+	if (!err && run->ivsize > BENCH_MAX_IVLEN)
+		err = -EINVAL;
+	if (!err)
+		get_random_bytes(run->iv, run->ivsize);
+	return err;
+}
+
+static void bench_free_tfm(struct bench_run *run)
+{
+	switch (run->spec->type) {
+	case BENCH_SKCIPHER:
+		if (!IS_ERR_OR_NULL(run->tfm.skcipher))
+			crypto_free_ablkcipher(run->tfm.skcipher);
+		break;
+	case BENCH_AEAD:
+		if (!IS_ERR_OR_NULL(run->tfm.aead))
+			crypto_free_aead(run->tfm.aead);
+		break;
+	default:
+		if (!IS_ERR_OR_NULL(run->tfm.hash))
+			crypto_free_ahash(run->tfm.hash);
+		break;
+	}
+}
+
+/* Run the benchmark described by @spec and format it into bench_result. */
+static int bench_execute(const struct bench_spec *spec)
+{
+	struct bench_run run = { .spec = spec };
+	size_t len = 0;
+	unsigned int i;
+	int err;
+
+	err = bench_alloc_tfm(&run);
+	if (err)
+		goto out;
+
+	run.assoc = kzalloc(max(spec->assoclen, 1U), GFP_KERNEL);
+	if (!run.assoc) {
+		err = -ENOMEM;
+		goto out;
+	}
+	sg_init_one(&run.sg_assoc, run.assoc, spec->assoclen);
+
+	len += scnprintf(bench_result + len, BENCH_RESULT_SIZE - len,
+			 "{\"type\":\"%s\",\"alg\":\"%s\",\"driver\":\"%s\","
+			 "\"op\":\"%s\",\"keylen\":%u,\"ivsize\":%u,",
+			 bench_type_names[spec->type], spec->alg, run.driver,
+			 spec->type == BENCH_HASH ? "digest" :
+			 spec->decrypt ? "decrypt" : "encrypt",
+			 spec->keylen, run.ivsize);
+	if (spec->type == BENCH_AEAD)
+		len += scnprintf(bench_result + len, BENCH_RESULT_SIZE - len,
+				 "\"assoclen\":%u,\"authsize\":%u,",
+				 spec->assoclen, run.authsize);
+	len += scnprintf(bench_result + len, BENCH_RESULT_SIZE - len,
+			 "\"depth\":%u,\"threads\":%u,\"secs\":%u,"
+			 "\"results\":[",
+			 spec->depth, spec->threads, spec->secs);
+
+	for (i = 0; i < spec->nsizes; i++) {
+		u64 ops, bytes, ns, cycles, mbps, cpb;
+
+		err = bench_one_size(&run, spec->sizes[i],
+				     &ops, &bytes, &ns, &cycles);
+		if (err)
+			goto out;
+
+		mbps = ns ? div64_u64(bytes * 1000, ns) : 0;
+		cpb = bytes ? div64_u64(cycles * 100, bytes) : 0;
+		len += scnprintf(bench_result + len, BENCH_RESULT_SIZE - len,
+				 "%s{\"size\":%u,\"ops\":%llu,\"bytes\":%llu,"
+				 "\"ns\":%llu,\"ops_per_sec\":%llu,"
+				 "\"mb_per_sec\":%llu,"
+				 "\"cycles_per_byte\":%llu.%02llu}",
+				 i ? "," : "", spec->sizes[i], ops, bytes, ns,
+				 ns ? div64_u64(ops * NSEC_PER_SEC, ns) : 0,
+				 mbps, cpb / 100, cpb % 100);
+	}
+	len += scnprintf(bench_result + len, BENCH_RESULT_SIZE - len, "]}\n");
+
+out:
+	bench_result_len = err ? 0 : len;
+	kfree(run.assoc);
+	bench_free_tfm(&run);
+	return err;
+}
+
+static int bench_parse_name(char *dst, const char *val)
+{
+	const char *p;
+
+	if (strlen(val) >= CRYPTO_MAX_ALG_NAME)
+		return -ENAMETOOLONG;
+	/* names are echoed into the JSON output unescaped */
+	for (p = val; *p; p++)
+		if (*p == '"' || *p == '\\' || *p < ' ')
+			return -EINVAL;
+	strcpy(dst, val);
+	return 0;
+}
+
+static int bench_parse_type(struct bench_spec *spec, const char *val)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(bench_type_names); i++) {
+		if (!strcmp(val, bench_type_names[i])) {
+			spec->type = i;
+			return 0;
+		}
+	}
+	return -EINVAL;
+}
+
+static int bench_parse_sizes(struct bench_spec *spec, char *val)
+{
+	char *tok;
+	int err;
+
+	spec->nsizes = 0;
+	while ((tok = strsep(&val, ",")) != NULL) {
+		unsigned int size;
+
+		if (!*tok)
+			continue;
+		if (spec->nsizes >= BENCH_MAX_SIZES)
+			return -E2BIG;
+		err = kstrtouint(tok, 0, &size);
+		if (err)
+			return err;
+		if (!size || size > BENCH_MAX_SIZE)
+			return -EINVAL;
+		spec->sizes[spec->nsizes++] = size;
+	}
+	return spec->nsizes ? 0 : -EINVAL;
+}
+
+static int bench_parse(struct bench_spec *spec, char *buf)
+{
+	char *tok;
+	int err = 0;
+
+	memset(spec, 0, sizeof(*spec));
+	spec->type = BENCH_SKCIPHER;
+	spec->depth = 1;
+	spec->threads = 1;
+	spec->secs = 1;
+	spec->authsize = -1;
+	memcpy(spec->sizes, bench_default_sizes, sizeof(bench_default_sizes));
+	spec->nsizes = ARRAY_SIZE(bench_default_sizes);
+
+	while (!err && (tok = strsep(&buf, " \t\n")) != NULL) {
+		char *val;
+
+		if (!*tok)
+			continue;
+		val = strchr(tok, '=');
+		if (!val)
+			return -EINVAL;
+		*val++ = '\0';
+
+		if (!strcmp(tok, "type")) {
+			err = bench_parse_type(spec, val);
+		} else if (!strcmp(tok, "alg")) {
+			err = bench_parse_name(spec->alg, val);
+		} else if (!strcmp(tok, "driver")) {
+			err = bench_parse_name(spec->driver, val);
+		} else if (!strcmp(tok, "keylen")) {
+			err = kstrtouint(val, 0, &spec->keylen);
+		} else if (!strcmp(tok, "sizes")) {
+			err = bench_parse_sizes(spec, val);
+		} else if (!strcmp(tok, "depth")) {
+			err = kstrtouint(val, 0, &spec->depth);
+		} else if (!strcmp(tok, "threads")) {
+			err = kstrtouint(val, 0, &spec->threads);
+		} else if (!strcmp(tok, "secs")) {
+			err = kstrtouint(val, 0, &spec->secs);
+		} else if (!strcmp(tok, "op")) {
+			if (!strcmp(val, "encrypt"))
+				spec->decrypt = false;
+			else if (!strcmp(val, "decrypt"))
+				spec->decrypt = true;
+			else
+				err = -EINVAL;
+		} else if (!strcmp(tok, "assoclen")) {
+			err = kstrtouint(val, 0, &spec->assoclen);
+		} else if (!strcmp(tok, "authsize")) {
+			err = kstrtoint(val, 0, &spec->authsize);
+		} else {
+			err = -EINVAL;
+		}
+	}
+	if (err)
+		return err;
+
+	if (!spec->alg[0] && !spec->driver[0])
+		return -EINVAL;
+	if (!spec->alg[0])
+		strcpy(spec->alg, spec->driver);
+	if (spec->type != BENCH_HASH && !spec->keylen)
+		return -EINVAL;
+	if (spec->keylen > BENCH_MAX_KEYLEN ||
+	    spec->assoclen > BENCH_MAX_ASSOCLEN)
+		return -EINVAL;
+	if (!spec->depth || spec->depth > BENCH_MAX_DEPTH)
+		return -EINVAL;
+	if (!spec->threads || spec->threads > num_online_cpus())
+		return -EINVAL;
+	if (!spec->secs || spec->secs > BENCH_MAX_SECS)
+		return -EINVAL;
+	return 0;
+}
+
+static ssize_t bench_run_write(struct file *file, const char __user *ubuf,
+			       size_t count, loff_t *ppos)
+{
+	struct bench_spec *spec;
+	char *buf;
+	int err;
+
+	if (count >= PAGE_SIZE)
+		return -E2BIG;
+
+	buf = kmalloc(count + 1, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+	if (copy_from_user(buf, ubuf, count)) {
+		kfree(buf);
+		return -EFAULT;
+	}
+	buf[count] = '\0';
+
+	spec = kmalloc(sizeof(*spec), GFP_KERNEL);
+	if (!spec) {
+		err = -ENOMEM;
+		goto out;
+	}
+
+	err = bench_parse(spec, buf);
+	if (err)
+		goto out;
+
+	err = mutex_lock_interruptible(&bench_mutex);
+	if (err)
+		goto out;
+	err = bench_execute(spec);
+	mutex_unlock(&bench_mutex);
+out:
+	kfree(spec);
+	kfree(buf);
+	return err ? err : count;
+}
+
+static ssize_t bench_run_read(struct file *file, char __user *ubuf,
+			      size_t count, loff_t *ppos)
+{
+	ssize_t ret;
+
+	mutex_lock(&bench_mutex);
+	ret = simple_read_from_buffer(ubuf, count, ppos, bench_result,
+				      bench_result_len);
+	mutex_unlock(&bench_mutex);
+	return ret;
+}
+
+static const struct file_operations bench_run_fops = {
+	.owner		= THIS_MODULE,
+	.open		= simple_open,
+	.read		= bench_run_read,
+	.write		= bench_run_write,
+	.llseek		= default_llseek,
+};
+
+static int __init crypto_bench_init(void)
+{
+	bench_result = kzalloc(BENCH_RESULT_SIZE, GFP_KERNEL);
+	if (!bench_result)
+		return -ENOMEM;
+
+	bench_dir = debugfs_create_dir("crypto_bench", NULL);
+	if (IS_ERR_OR_NULL(bench_dir) ||
+	    !debugfs_create_file("run", S_IRUSR | S_IWUSR, bench_dir, NULL,
+				 &bench_run_fops)) {
+		debugfs_remove_recursive(bench_dir);
+		kfree(bench_result);
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+static void __exit crypto_bench_exit(void)
+{
+	debugfs_remove_recursive(bench_dir);
+	kfree(bench_result);
+}
+
+module_init(crypto_bench_init);
+module_exit(crypto_bench_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Crypto API throughput benchmark");
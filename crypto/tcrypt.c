@@ -69,7 +69,8 @@ static char *check[] = {
 	"cast6", "arc4", "michael_mic", "deflate", "crc32c", "tea", "xtea",
 	"khazad", "wp512", "wp384", "wp256", "tnepres", "xeta",  "fcrypt",
 	"camellia", "seed", "salsa20", "rmd128", "rmd160", "rmd256", "rmd320",
-	"lzo", "cts", "zlib", NULL
+	"lzo", "cts", "zlib", "chacha20", "xchacha20", "xchacha12",
+	"poly1305", "nhpoly1305", NULL
 };
 
 static int test_cipher_jiffies(struct blkcipher_desc *desc, int enc,
@@ -1454,6 +1455,34 @@ static int do_test(int m)
 		ret += tcrypt_test("crct10dif");
 		break;
 
+	case 48:
+		ret += tcrypt_test("chacha20");
+		break;
+
+	case 49:
+		ret += tcrypt_test("xchacha20");
+		break;
+
+	case 50:
+		ret += tcrypt_test("xchacha12");
+		break;
+
+	case 51:
+		ret += tcrypt_test("poly1305");
+		break;
+
+	case 52:
+		ret += tcrypt_test("nhpoly1305");
+		break;
+
+	case 53:
+		ret += tcrypt_test("adiantum(xchacha12,aes)");
+		break;
+
+	case 54:
+		ret += tcrypt_test("adiantum(xchacha20,aes)");
+		break;
+
 	case 100:
 		ret += tcrypt_test("hmac(md5)");
 		break;
@@ -1751,6 +1780,26 @@ static int do_test(int m)
 				NULL, 0, 16, 8, aead_speed_template_20);
 		break;
 
+	case 212:
+		test_cipher_speed("chacha20", ENCRYPT, sec, NULL, 0,
+				  speed_template_32);
+		test_cipher_speed("xchacha20", ENCRYPT, sec, NULL, 0,
+				  speed_template_32);
+		test_cipher_speed("xchacha12", ENCRYPT, sec, NULL, 0,
+				  speed_template_32);
+		break;
+
+	case 213:
+		test_cipher_speed("adiantum(xchacha12,aes)", ENCRYPT, sec,
+				  NULL, 0, speed_template_32);
+		test_cipher_speed("adiantum(xchacha12,aes)", DECRYPT, sec,
+				  NULL, 0, speed_template_32);
+		test_cipher_speed("adiantum(xchacha20,aes)", ENCRYPT, sec,
+				  NULL, 0, speed_template_32);
+		test_cipher_speed("adiantum(xchacha20,aes)", DECRYPT, sec,
+				  NULL, 0, speed_template_32);
+		break;
+
 	case 300:
 		/* fall through */
 
@@ -1834,6 +1883,14 @@ static int do_test(int m)
 		test_hash_speed("crct10dif", sec, generic_hash_speed_template);
 		if (mode > 300 && mode < 400) break;
 
+	case 321:
+		test_hash_speed("poly1305", sec, poly1305_speed_template);
+		if (mode > 300 && mode < 400) break;
+
+	case 322:
+		test_hash_speed("nhpoly1305", sec, nhpoly1305_speed_template);
+		if (mode > 300 && mode < 400) break;
+
 	case 399:
 		break;
 
@@ -52,6 +52,7 @@ static struct cipher_speed_template des3_speed_template[] = {
  */
 static u8 speed_template_8[] = {8, 0};
 static u8 speed_template_24[] = {24, 0};
+static u8 speed_template_32[] = {32, 0};
 static u8 speed_template_8_16[] = {8, 16, 0};
 static u8 speed_template_8_32[] = {8, 32, 0};
 static u8 speed_template_16_32[] = {16, 32, 0};
@@ -126,4 +127,37 @@ static struct hash_speed hash_speed_template_16[] = {
 	{  .blen = 0,	.plen = 0,	.klen = 0, }
 };
 
+/* The 32-byte one-time key is included at the start of each buffer */
+static struct hash_speed poly1305_speed_template[] = {
+	{ .blen = 96,	.plen = 16, },
+	{ .blen = 96,	.plen = 32, },
+	{ .blen = 96,	.plen = 96, },
+	{ .blen = 288,	.plen = 16, },
+	{ .blen = 288,	.plen = 32, },
+	{ .blen = 288,	.plen = 288, },
+	{ .blen = 1056,	.plen = 32, },
+	{ .blen = 1056,	.plen = 1056, },
+	{ .blen = 2080,	.plen = 32, },
+	{ .blen = 2080,	.plen = 2080, },
+	{ .blen = 4128,	.plen = 4128, },
+	{ .blen = 8224,	.plen = 8224, },
+
+	/* End marker */
+	{  .blen = 0,	.plen = 0, }
+};
+
+static struct hash_speed nhpoly1305_speed_template[] = {
+	{ .blen = 16,	.plen = 16,	.klen = 1088, },
+	{ .blen = 64,	.plen = 64,	.klen = 1088, },
+	{ .blen = 256,	.plen = 256,	.klen = 1088, },
+	{ .blen = 1024,	.plen = 16,	.klen = 1088, },
+	{ .blen = 1024,	.plen = 1024,	.klen = 1088, },
+	{ .blen = 4096,	.plen = 256,	.klen = 1088, },
+	{ .blen = 4096,	.plen = 4096,	.klen = 1088, },
+	{ .blen = 8192,	.plen = 8192,	.klen = 1088, },
+
+	/* End marker */
+	{  .blen = 0,	.plen = 0,	.klen = 0, }
+};
+
 #endif	/* _CRYPTO_TCRYPT_H */
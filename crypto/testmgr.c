@@ -1905,6 +1905,36 @@ static const struct alg_test_desc alg_test_descs[] = {
 		.alg = "__ghash-pclmulqdqni",
 		.test = alg_test_null,
 		.fips_allowed = 1,
+	}, {
+		.alg = "adiantum(xchacha12,aes)",
+		.test = alg_test_skcipher,
+		.suite = {
+			.cipher = {
+				.enc = {
+					.vecs = adiantum_xchacha12_aes_enc_tv_template,
+					.count = ADIANTUM_XCHACHA12_AES_ENC_TEST_VECTORS
+				},
+				.dec = {
+					.vecs = adiantum_xchacha12_aes_dec_tv_template,
+					.count = ADIANTUM_XCHACHA12_AES_DEC_TEST_VECTORS
+				}
+			}
+		}
+	}, {
+		.alg = "adiantum(xchacha20,aes)",
+		.test = alg_test_skcipher,
+		.suite = {
+			.cipher = {
+				.enc = {
+					.vecs = adiantum_xchacha20_aes_enc_tv_template,
+					.count = ADIANTUM_XCHACHA20_AES_ENC_TEST_VECTORS
+				},
+				.dec = {
+					.vecs = adiantum_xchacha20_aes_dec_tv_template,
+					.count = ADIANTUM_XCHACHA20_AES_DEC_TEST_VECTORS
+				}
+			}
+		}
 	}, {
 		.alg = "ansi_cprng",
 		.test = alg_test_cprng,
@@ -2301,6 +2331,21 @@ static const struct alg_test_desc alg_test_descs[] = {
 				}
 			}
 		}
+	}, {
+		.alg = "chacha20",
+		.test = alg_test_skcipher,
+		.suite = {
+			.cipher = {
+				.enc = {
+					.vecs = chacha20_enc_tv_template,
+					.count = CHACHA20_ENC_TEST_VECTORS
+				},
+				.dec = {
+					.vecs = chacha20_enc_tv_template,
+					.count = CHACHA20_ENC_TEST_VECTORS
+				}
+			}
+		}
 	}, {
 		.alg = "cmac(aes)",
 		.test = alg_test_hash,
@@ -3249,6 +3294,15 @@ static const struct alg_test_desc alg_test_descs[] = {
 				.count = MICHAEL_MIC_TEST_VECTORS
 			}
 		}
+	}, {
+		.alg = "nhpoly1305",
+		.test = alg_test_hash,
+		.suite = {
+			.hash = {
+				.vecs = nhpoly1305_tv_template,
+				.count = NHPOLY1305_TEST_VECTORS
+			}
+		}
 	}, {
 		.alg = "ofb(aes)",
 		.test = alg_test_skcipher,
@@ -3280,6 +3334,15 @@ static const struct alg_test_desc alg_test_descs[] = {
 				}
 			}
 		}
+	}, {
+		.alg = "poly1305",
+		.test = alg_test_hash,
+		.suite = {
+			.hash = {
+				.vecs = poly1305_tv_template,
+				.count = POLY1305_TEST_VECTORS
+			}
+		}
 	}, {
 		.alg = "rfc3686(ctr(aes))",
 		.test = alg_test_skcipher,
@@ -3511,6 +3574,36 @@ static const struct alg_test_desc alg_test_descs[] = {
 				.count = XCBC_AES_TEST_VECTORS
 			}
 		}
+	}, {
+		.alg = "xchacha12",
+		.test = alg_test_skcipher,
+		.suite = {
+			.cipher = {
+				.enc = {
+					.vecs = xchacha12_enc_tv_template,
+					.count = XCHACHA12_ENC_TEST_VECTORS
+				},
+				.dec = {
+					.vecs = xchacha12_enc_tv_template,
+					.count = XCHACHA12_ENC_TEST_VECTORS
+				}
+			}
+		}
+	}, {
+		.alg = "xchacha20",
+		.test = alg_test_skcipher,
+		.suite = {
+			.cipher = {
+				.enc = {
+					.vecs = xchacha20_enc_tv_template,
+					.count = XCHACHA20_ENC_TEST_VECTORS
+				},
+				.dec = {
+					.vecs = xchacha20_enc_tv_template,
+					.count = XCHACHA20_ENC_TEST_VECTORS
+				}
+			}
+		}
 	}, {
 		.alg = "xts(aes)",
 		.test = alg_test_skcipher,
@@ -3603,6 +3696,22 @@ static const struct alg_test_desc alg_test_descs[] = {
 				}
 			}
 		}
+	}, {
+		.alg = "zstd",
+		.test = alg_test_comp,
+		.fips_allowed = 1,
+		.suite = {
+			.comp = {
+				.comp = {
+					.vecs = zstd_comp_tv_template,
+					.count = ZSTD_COMP_TEST_VECTORS
+				},
+				.decomp = {
+					.vecs = zstd_decomp_tv_template,
+					.count = ZSTD_DECOMP_TEST_VECTORS
+				}
+			}
+		}
 	}
 };
 
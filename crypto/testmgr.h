@@ -32,7 +32,7 @@
 #define MAX_DIGEST_SIZE		64
 #define MAX_TAP			8
 
-#define MAX_KEYLEN		160
+#define MAX_KEYLEN		1088
 #define MAX_IVLEN		32
 
 struct hash_testvec {
@@ -43,7 +43,7 @@ struct hash_testvec {
 	unsigned char tap[MAX_TAP];
 	unsigned short psize;
 	unsigned char np;
-	unsigned char ksize;
+	unsigned short ksize;
 };
 
 struct cipher_testvec {
@@ -28370,6 +28370,1641 @@ static struct cipher_testvec salsa20_stream_enc_tv_template[] = {
 	},
 };
 
+/*
+ * ChaCha20 test vectors.  The first is from RFC7539 Appendix A.2.
+ */
+#define CHACHA20_ENC_TEST_VECTORS 2
+
+static struct cipher_testvec chacha20_enc_tv_template[] = {
+	{
+		.key	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.klen	= 32,
+		.iv	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.input	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.ilen	= 64,
+		.result	= "\x76\xb8\xe0\xad\xa0\xf1\x3d\x90"
+		  "\x40\x5d\x6a\xe5\x53\x86\xbd\x28"
+		  "\xbd\xd2\x19\xb8\xa0\x8d\xed\x1a"
+		  "\xa8\x36\xef\xcc\x8b\x77\x0d\xc7"
+		  "\xda\x41\x59\x7c\x51\x57\x48\x8d"
+		  "\x77\x24\xe0\x3f\xb8\xd8\x4a\x37"
+		  "\x6a\x43\xb8\xf4\x15\x18\xa1\x1c"
+		  "\xc3\x87\xb6\x69\xb2\xee\x65\x86",
+		.rlen	= 64,
+	}, {
+		.key	= "\x68\x47\x38\x54\xf1\xef\x86\x45"
+		  "\xbf\xb2\xb2\xb6\xe1\x35\x66\x86"
+		  "\x8b\xd1\xc7\x8c\xde\x25\x69\x5e"
+		  "\x93\x43\x0f\x6f\xfe\x4b\x73\x02",
+		.klen	= 32,
+		.iv	= "\x01\x00\x00\x00\x2f\xf4\x8c\xdc"
+		  "\x3d\x3f\xe4\x17\xea\x95\x25\xb4",
+		.input	= "\x17\xa0\xb0\x87\x93\xbb\x8c\x36"
+		  "\xf1\x80\xe3\x89\xf2\xa8\x4a\x74"
+		  "\x4b\xff\x77\x8e\x48\x51\xb6\x68"
+		  "\xc9\xf1\x09\x21\x2c\xca\x43\xb7"
+		  "\xc6\x16\x66\x30\x2a\x14\xe2\x55"
+		  "\xcd\xb6\x5c\x24\x1f\x62\x5f\xcc"
+		  "\x1d\x4f\xa3\xdb\x5b\xe0\x48\x81"
+		  "\xd6\x1b\x13\x06\x71\xdd\xcd\xff"
+		  "\x6f\x0e\x14\xac\xe4\x4e\xea\xeb"
+		  "\x16\xa2\x0c\x90\xa2\x2b\x6e\xee"
+		  "\x8c\x61\xbd\x69\x59\x9a\xc0\x7d"
+		  "\xe2\x2a\x4d\xea\x27\x42\xc9\x4d"
+		  "\xd1\x72\x9b\xe6\xea\x40\x09\x76"
+		  "\xd9\xcc\x44\xe4\xd6\xb2\x5f\xb6"
+		  "\x9f\x64\x9a\x86\x52\xc5\x44\x46"
+		  "\xf4\x31\xb0\x58\x91\xbd\x83\x30"
+		  "\xf5\x74\x2e\x87\x26\xb6\x3a\xe6"
+		  "\xd2\x76\xde\xf7\x0f\x9e\x1d\x3f"
+		  "\x0b\xd1\x29\x5f\xb9\x69\x4b\x25"
+		  "\x5d\x2b\xb6\xba\xec\xb2\x7a\x21"
+		  "\xe8\x6b\x64\x1e\x90\x80\x64\x33"
+		  "\x44\xa9\x01\x25\x1b\x67\x23\xe5"
+		  "\x58\x28\xc7\xd8\x9a\xbd\x46\x2f"
+		  "\x44\xf5\x43\x2c\x20\x88\x18\xd0"
+		  "\xd9\x43\x6d\x26\x00\xf2\x3b\x53"
+		  "\xdb\xdf\x80\x0c\xa1\xf7\x86\x4f"
+		  "\x70\x08\x98\xd6\x1a\x0c\xb6\x14"
+		  "\x2e\x22\xd6\x7c\x3e\xdc\xa4\x2b"
+		  "\x3e\xe4\x56\xbf\x44\xd7\x88\x89"
+		  "\xfb\xa4\xb8\xfb\xd3\xa1\xd9\x6e"
+		  "\x0a\xe5\x13\xc2\x7e\x3d\xae\x37"
+		  "\x96\x06\x07\x1b\x4c\x36\xca\x4e"
+		  "\x61\x5a\xa8\xbb\x7a\x90\x76\xc3"
+		  "\x91\xb3\x1a\x74\x3c\xc8\xad\xe9"
+		  "\xd9\xe0\x09\x24\x76\xbc\xe0\xdf"
+		  "\x96\x83\x4e\x67\x4c\x9a\xba\xdb"
+		  "\x9a\x9e\x70\x17\x5a\xc9\x76\x77"
+		  "\x1a\x47\x8d\x18\xeb\x8f\x7e\xa1"
+		  "\x56\x6f\xef\xeb\xb9\xf0\x9a\x57"
+		  "\xc3\x71\x0a\xfc\xd5\x72\x5c\xb3"
+		  "\x80\x04\xe1\x3f\xda\xeb\x35\x8a"
+		  "\x3a\xb7\x62\x6f\x24\xa1\xc3\xae"
+		  "\x8e\x90\x55\xd5\x3d\xcb\x8b\xd4"
+		  "\xf4\x26\x04\xff\xf4\xa1\xa3\x83"
+		  "\x59\xcc\x73\xf4\x29\xd3\x02\xb9"
+		  "\x83\x23\x49\x29\xb5\xb8\x71\x6b"
+		  "\x94\x8b\xcd\x20\x7a\x33\xf1",
+		.ilen	= 375,
+		.result	= "\x69\x40\x07\x9b\x5a\x95\xa9\xd1"
+		  "\x84\x0a\x7c\xd7\xb9\x58\xc6\x31"
+		  "\xf1\x4e\x99\x04\x0e\xf9\x05\xfe"
+		  "\x36\x30\x1b\xa2\x50\x41\x01\x3b"
+		  "\xd9\x0c\x2f\xe9\xef\xc3\x72\x40"
+		  "\xd3\xe8\x35\x96\xa1\x9d\x93\x9b"
+		  "\x67\x15\xd7\x58\xb2\x76\xfe\x6a"
+		  "\x01\xd7\x2b\x61\x74\x71\x44\x9e"
+		  "\xfe\xc3\x61\x1b\x07\x60\xa1\xba"
+		  "\x8e\x61\x58\xb0\x27\x58\x94\xd9"
+		  "\x1d\x1f\x1e\x4d\x12\x9a\xd9\xc1"
+		  "\xb9\x85\x06\x70\x73\x89\x4b\xfa"
+		  "\xdb\x91\x49\x49\x33\xf5\x3c\x8e"
+		  "\xdf\xfd\xcf\x3c\x72\xd6\xcb\x1d"
+		  "\x04\x3b\x91\x72\x79\xc0\xe8\xfc"
+		  "\x13\x77\xc7\xf3\xfd\x5f\x9c\x9c"
+		  "\xbb\x30\x1c\xd1\xd6\x8c\xe1\x47"
+		  "\xbc\xc5\x8e\x17\xae\xf1\xe3\x65"
+		  "\xf5\x0f\x30\x85\xa2\x42\x9d\x67"
+		  "\x06\xe6\x63\x5a\x6d\x43\x27\x07"
+		  "\x8f\x7b\xad\x42\x1f\xb0\x35\x00"
+		  "\x9a\xa4\xb0\xa1\x3f\x07\xad\x3c"
+		  "\x51\x56\x3d\x27\xbc\x27\x6e\xef"
+		  "\xbd\x12\x94\x4a\x6b\x8f\x29\x8d"
+		  "\x33\x42\xe0\x9e\xdf\x0c\x5a\xd5"
+		  "\x92\xde\x99\x3e\x04\xa3\x05\x12"
+		  "\xbf\x98\x3f\x55\x11\x77\x45\xf8"
+		  "\xbf\x4c\x75\x03\x7b\x52\xf3\xa9"
+		  "\x99\x3d\x04\x99\x1e\xf1\xae\x3f"
+		  "\x1d\x08\xee\xbf\x51\x82\x83\xd0"
+		  "\xbf\x50\x86\x06\xec\x02\x97\x47"
+		  "\x94\x42\xb7\x7b\x36\x27\x97\x2b"
+		  "\x19\xe1\xdb\x32\xc9\xe0\x65\x95"
+		  "\x79\x42\xfa\xcc\x17\x1c\x52\xe1"
+		  "\xde\x16\x7d\x0a\x57\x68\x59\xbc"
+		  "\x96\x37\x00\x67\x37\xaa\x97\xe6"
+		  "\x68\x98\x16\x98\x9e\x4c\x34\xba"
+		  "\xba\x8e\x11\xa4\x22\x9b\x57\xa2"
+		  "\x11\x25\xc1\x35\x03\x07\x72\x17"
+		  "\x8c\xc0\xe4\x7b\xc1\xa7\x8f\xf4"
+		  "\xee\xa3\xa9\x31\xbd\x5f\x15\x06"
+		  "\x7d\x01\xfb\xf1\x57\x1d\x94\x8b"
+		  "\xbe\x19\xab\x6a\xc2\x5c\xf3\xc4"
+		  "\x45\x2b\x74\xfa\x8d\x5e\x2e\x46"
+		  "\xfd\xad\x42\x29\x9d\x8b\x83\xc5"
+		  "\x0b\x7b\x98\x3b\xa2\xb5\x5a\x7a"
+		  "\x80\x98\xf6\xda\x80\x31\xb5",
+		.rlen	= 375,
+		.also_non_np = 1,
+		.np	= 4,
+		.tap	= { 128, 2, 97, 148 },
+	}
+};
+
+/*
+ * XChaCha20 test vectors
+ */
+#define XCHACHA20_ENC_TEST_VECTORS 2
+
+static struct cipher_testvec xchacha20_enc_tv_template[] = {
+	{
+		.key	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.klen	= 32,
+		.iv	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.input	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.ilen	= 64,
+		.result	= "\xbc\xd0\x2a\x18\xbf\x3f\x01\xd1"
+		  "\x92\x92\xde\x30\xa7\xa8\xfd\xac"
+		  "\xa4\xb6\x5e\x50\xa6\x00\x2c\xc7"
+		  "\x2c\xd6\xd2\xf7\xc9\x1a\xc3\xd5"
+		  "\x72\x8f\x83\xe0\xaa\xd2\xbf\xcf"
+		  "\x9a\xbd\x2d\x2d\xb5\x8f\xae\xdd"
+		  "\x65\x01\x5d\xd8\x3f\xc0\x9b\x13"
+		  "\x1e\x27\x10\x43\x01\x9e\x8e\x0f",
+		.rlen	= 64,
+	}, {
+		.key	= "\x72\x73\x5f\xf2\xc0\x49\x1d\x74"
+		  "\xe1\x30\x26\x50\x07\x2a\xe8\x94"
+		  "\xbd\xdf\x03\x72\x52\x21\x31\x10"
+		  "\x20\x22\x80\x33\x4f\xa0\x8f\x62",
+		.klen	= 32,
+		.iv	= "\xe7\x66\xc5\x23\x40\x65\xdd\x41"
+		  "\x53\x2a\x2f\x99\xeb\x50\x28\xe9"
+		  "\xe3\xbf\x0b\x15\xe3\x3c\x2d\x82"
+		  "\xec\xf2\x4f\x3a\x13\x9a\x23\x45",
+		.input	= "\x48\xab\x0a\xe8\x87\x9f\x8c\xb1"
+		  "\x53\xed\x1c\xb3\x11\xb2\xbc\x35"
+		  "\xed\xf8\xfc\x68\x47\xd0\x6a\x52"
+		  "\x09\xd1\xed\x46\xc7\x26\xc4\xa4"
+		  "\xc9\xc2\x48\xf8\xb9\xc8\xe0\xaa"
+		  "\x37\xaa\x0e\x76\x44\x42\xa9\x6e"
+		  "\xc9\x44\xdd\x69\xc5\x20\xb9\xc5"
+		  "\x56\xc9\xbb\xa9\x44\xf9\x82\x5a"
+		  "\x99\xe7\x71\x2e\xb2\x34\x4b\xd6"
+		  "\x27\x2d\x03\x6a\x67\xa3\x7f\x66"
+		  "\xb5\xf7\xae\x88\xa5\x21\x86\x4f"
+		  "\xc6\x6f\x2f\x46\x44\xf2\xfc\x54"
+		  "\x08\x14\xe8\xe7\x26\x28\x63\xd8"
+		  "\x08\x15\x98\xae\xe9\x16\x27\xa1"
+		  "\xd1\x29\x5e\x9d\x33\x8f\xd4\xd7"
+		  "\x25\xc1\x7c\x7e\xd2\xf7\xfc\x13"
+		  "\xdf\xf7\x30\xcb\x5a\x5e\x62\xde"
+		  "\x63\xa0\x98\xc5\x95\x40\x05\x30"
+		  "\x9d\xf7\x11\x26\x89\x73\x52\xed"
+		  "\x57\x10\x75\x91\x00\x93\x67\x51"
+		  "\xaa\xd3\x2e\xa9\xe6\xbf\x5e\x5d"
+		  "\x45\xd1\x5d\x30\xab\x19\xd1\x0a"
+		  "\xd4\x77\x1b\xce\x87\xe5\xa7\xad"
+		  "\xbf\xdf\xa6\x50\x06\xf7\xad\xb5"
+		  "\x24\xab\xcb\x96\x3a\x0f\xa7\x2e"
+		  "\xef\x8c\x1b\x39\xbf\x2d\x94\x2b"
+		  "\xb1\xfd\x70\xe6\xfa\x36\xd5\x06"
+		  "\x2b\xb6\x39\x16\x47\x54\xee\x6c"
+		  "\x97\x63\xfd\xaf\x8b\x84\xea\xfb"
+		  "\xc3\x3c\x6e\x5b\x8e\xc6\x0e\xd1"
+		  "\x95\x5b\x1d\x2f\x70\xa6\x73\xf6"
+		  "\x48\xc6\x97\x30\xf1\x34\x60\xe0"
+		  "\x00\x04\x3d\xf6\x37\xfd\xc8\x5a"
+		  "\x4f\xb8\x7b\xe2\xf5\x1c\xe8\x9e"
+		  "\x11\xbc\xff\x4e\x52\x7d\xc7\x88"
+		  "\xc1\x7c\x71\xdc\xb1\x70\x90\xb4"
+		  "\x3b\x9f\xc2\x2d\x23\x05\x76\x8d"
+		  "\x4c\x09\xeb\x8d\x9d\x36\x37\x96",
+		.ilen	= 304,
+		.result	= "\x10\x41\x1e\xd9\xf4\xa8\xe2\x6e"
+		  "\xc6\x98\x59\xe6\x7d\x8e\x5c\x43"
+		  "\xe0\x15\xc1\xd0\x56\x95\xb3\xe4"
+		  "\xaf\x14\xb4\x53\x8c\x65\xf1\x90"
+		  "\xa5\xb2\x61\x91\x35\xda\xd4\xdf"
+		  "\x61\x57\xed\xbe\x21\xc9\xa9\xba"
+		  "\x14\x0c\x5d\xba\x93\x9d\xba\x46"
+		  "\x69\xec\xc7\x31\x72\x27\xa9\x2a"
+		  "\x0a\xa2\xe1\xa6\x92\xb1\x60\x85"
+		  "\x82\x48\x95\xe6\x2c\x75\x31\x7a"
+		  "\xb1\xea\x41\x93\xd4\x94\xa1\x96"
+		  "\xec\x5e\x0f\x0b\x3c\xa4\x34\x2f"
+		  "\x16\xe3\x25\x1a\x7d\xf3\xa4\xa7"
+		  "\xd1\x99\xb1\x63\x48\xe0\x3b\xc3"
+		  "\x42\xf3\x8a\x06\xc8\x9e\xe7\x8a"
+		  "\xda\xe1\x0c\x68\x0e\x71\xb2\x36"
+		  "\x16\x7e\x71\x73\x06\x65\xda\x00"
+		  "\xd9\x65\x04\xd4\xad\x3b\xb2\x6e"
+		  "\xe0\x04\x41\x5e\xfd\xb9\x7f\x66"
+		  "\x58\x71\x65\xa6\xd9\x25\xb0\x21"
+		  "\xf0\x40\xf7\x77\x02\x51\x72\xd6"
+		  "\x3a\x12\x97\x0b\x26\xd4\xef\xf9"
+		  "\xc5\x15\xf4\x63\xf1\x84\x3a\xdf"
+		  "\x16\xa9\x8a\x1f\x8f\x02\xf2\x5f"
+		  "\xf1\xa0\xd0\xeb\x3e\x33\x38\xc9"
+		  "\x4f\x2a\xc3\x16\x33\xfe\xc1\x45"
+		  "\xce\x4a\xc3\x95\x03\x37\x33\x54"
+		  "\xaf\xe3\x5b\x89\x13\xda\x97\x3d"
+		  "\xbe\x8f\xf0\x59\xca\xe9\x23\x72"
+		  "\x15\xe2\x24\x59\xc0\x01\xe9\xe6"
+		  "\xde\x27\x0f\x9e\xd9\x06\xf3\x61"
+		  "\x4e\x0c\x80\x8e\xb8\xf4\x9e\x6f"
+		  "\xc4\x89\x5f\x47\xea\xe5\xc8\x70"
+		  "\x7b\x01\xd1\x4e\x71\xb5\x66\x81"
+		  "\xa1\x8d\x2f\xa4\x0f\x71\x5b\x4d"
+		  "\xc4\xd1\x98\x7f\xeb\xcc\xf8\x83"
+		  "\x6f\x49\x1d\x68\x9d\x2c\x2e\xce"
+		  "\x78\xf9\xeb\x9b\x09\x50\xe6\x85",
+		.rlen	= 304,
+		.also_non_np = 1,
+		.np	= 3,
+		.tap	= { 64, 17, 223 },
+	}
+};
+
+/*
+ * XChaCha12 test vectors
+ */
+#define XCHACHA12_ENC_TEST_VECTORS 2
+
+static struct cipher_testvec xchacha12_enc_tv_template[] = {
+	{
+		.key	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.klen	= 32,
+		.iv	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.input	= "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00"
+		  "\x00\x00\x00\x00\x00\x00\x00\x00",
+		.ilen	= 64,
+		.result	= "\x10\xe0\xa5\x31\xa2\xf9\x16\xa3"
+		  "\x64\xea\xdb\xbf\x8e\x72\x6d\x4c"
+		  "\xb0\x1d\x18\xeb\x4a\xca\xda\x60"
+		  "\x79\x22\x02\x07\x2a\x7b\x4b\x7a"
+		  "\x13\x58\x46\xa9\xd4\x45\x2c\x5c"
+		  "\xe8\xdc\x06\xd7\x79\x07\xf1\xa1"
+		  "\x8e\xeb\xb9\x78\xfb\x8e\xe0\x0b"
+		  "\x9f\x39\x73\xfb\x7a\xf1\xb1\x13",
+		.rlen	= 64,
+	}, {
+		.key	= "\xa1\x2d\xfe\x88\x44\xf5\x45\x07"
+		  "\x5f\xbd\xa7\x4c\x81\x19\x8b\xbd"
+		  "\xbb\xcc\x7a\x7c\xf6\xa0\x7f\xa3"
+		  "\xfb\x93\x9f\x4a\x8e\xbb\x9a\x31",
+		.klen	= 32,
+		.iv	= "\xde\xe5\x2e\x93\xb0\x81\x30\x6d"
+		  "\x3f\x2d\x5e\xd4\x1f\xc5\x43\x6c"
+		  "\xf4\xe3\x79\xb0\x1d\x37\xb6\x06"
+		  "\x50\x09\xcc\x94\x9b\xd3\x78\xc4",
+		.input	= "\x69\x56\xf1\xf7\x48\xdd\x9d\xb5"
+		  "\x4a\x43\x7f\x7c\x3b\xa8\xc4\x04"
+		  "\x83\xbd\x08\x9d\x3a\x97\xd1\xdc"
+		  "\x6d\xbd\xc9\xdf\x57\x5b\x72\xc8"
+		  "\x71\xad\x28\x10\xb5\x81\xde\xfc"
+		  "\xc0\x00\xe6\x99\x8b\xe9\x47\x23"
+		  "\xb1\xe5\x97\x22\xeb\x28\x5b\x83"
+		  "\xe9\x6d\x00\x73\xb8\x93\xf9\xf9"
+		  "\x45\xbd\x97\xef\x90\x59\xfb\x27"
+		  "\xb8\x54\x99\xbb\x76\x88\xf6\x9e"
+		  "\xd1\x83\x2e\x92\xed\xed\xb9\x7a"
+		  "\x38\x83\x4a\xf1\xdc\x31\x9d\x75"
+		  "\x26\xea\x18\xb1\x4d\xe4\x96\x0d"
+		  "\x34\x18\x4c\xce\xaf\xfe\xfa\x04"
+		  "\x13\x4f\xa6\xfb\x7c\xf8\xfe\xce"
+		  "\xaa\xc1\xdd\xa0\xff\xc3\xb5\x5c"
+		  "\xf8\xe7\x27\x5a\x2d\x53\xca\xef"
+		  "\xa9\x04\x16\x6f\xa2\xc1\x2f\x63"
+		  "\x5b\x15\xca\x7a\xa8\x35\x86\x52"
+		  "\xce\x9c\x72\x1e\x4c\x79\xfb\xc8"
+		  "\xb5\xa4\x8c\x43\x75\x44\xd6\x0f"
+		  "\xfe\x72\x1d\x43\x47\x67\x60\x4a"
+		  "\x8c\x9c\x14\x66\x3b\x1d\x61\xff"
+		  "\xf5\xa7\x80\x69\x53\x07\x80\x94"
+		  "\x69\x76\xa6\xa4\x84\x0b\x9e\x42"
+		  "\xcc\xeb\x7b\xbf\x7f\x1c\x20\x59"
+		  "\x03\xdd\x3a\xb7\xc5\x0f\xf4\x0a"
+		  "\x6f\x7d\xc1\xd8\x58\xf3\xca\x28"
+		  "\x05\x6f\xe5\xd0\xf7\x7e\x31\xfb"
+		  "\xa2\xbb\x60\x59\xc7\x8f\x28\x9c"
+		  "\xff\x5a\x83\x5a\x32\x46\x83\x16"
+		  "\x1e\x5f\xc4\x3a\x96\x52\x0a\xf2"
+		  "\x2f\x5a\x79\x0c\xee\x20\x7f\x25"
+		  "\x17\x2a\x36\x64\x39\x3a\xa9\x01"
+		  "\xdf\xe7\xd1\x0c\xd6\x23\xc1\x06"
+		  "\x0a\x7a\x10\x8e\xab\x0b\x4a\x8f"
+		  "\x80\x56\x50\x2c\xc6\xa8\x29\x67"
+		  "\x72\xfb\xb1\xa6\x40\x81\x46\xd8",
+		.ilen	= 304,
+		.result	= "\xde\x15\x1b\x15\x66\x2f\xb5\xd2"
+		  "\xba\xea\x70\xd4\xa0\xd9\x16\x2b"
+		  "\xef\xe5\x20\x69\x48\x17\x54\xcb"
+		  "\x4c\xbd\xb7\x1b\x6c\xd9\x1f\xe9"
+		  "\x2a\x4c\xb1\xc2\x2b\xa0\x47\x80"
+		  "\xae\x7c\xd3\xa2\x52\xbc\x57\x86"
+		  "\xe0\xef\x9f\x17\xa0\x6a\xbc\xf3"
+		  "\x41\x5f\x8c\x42\x3e\xe0\x13\xc5"
+		  "\x51\xe9\xae\x0c\xf1\x3d\x62\x25"
+		  "\xeb\xc8\xb9\x23\x96\x3c\xc2\x0b"
+		  "\xe7\x9f\x4b\x3d\xbd\x8d\xec\x86"
+		  "\xb1\xf7\x50\xc0\x25\xb6\x3d\xca"
+		  "\xe2\xe9\x53\x03\xd1\xc1\x8f\x45"
+		  "\x90\xc2\x14\x1c\xc3\x9a\x8d\x1f"
+		  "\xb7\x18\x29\xd7\x7e\x6f\xd6\xf5"
+		  "\x59\xc3\x15\x9d\xf6\xbc\xd8\x46"
+		  "\x53\x84\x68\xf7\x64\x1c\xeb\x14"
+		  "\x7e\xd2\x23\x8d\x21\x9f\x8f\xe0"
+		  "\xb0\x82\x29\xb3\xb1\x2e\x5d\x65"
+		  "\x84\x6a\x00\x91\x09\x4f\xfa\x9d"
+		  "\x0d\xd2\xe9\x40\x67\x2b\xb8\x77"
+		  "\x9f\x8b\xa7\x27\x46\x94\x49\xdf"
+		  "\xc3\x35\x50\x2c\xa2\xfb\x1d\xe3"
+		  "\xd4\x58\xcd\xc3\x01\x27\x27\x25"
+		  "\xe8\x4c\xc3\x9c\x48\x21\xad\xfe"
+		  "\xcd\xe3\x95\xb7\xa5\x05\xde\x10"
+		  "\x1b\xe1\x64\x6b\xb4\x1c\xb2\xb0"
+		  "\xb4\x40\x1a\xfe\x6e\x46\x12\x9a"
+		  "\x40\xb4\x9c\x25\x73\x41\x15\x93"
+		  "\xb7\x65\x9f\x5d\x55\x96\xc8\x24"
+		  "\x8f\x8e\x3f\xe3\xa0\x05\x52\xf7"
+		  "\xf5\x8a\xd5\x90\xe8\x6c\xac\xdc"
+		  "\x96\x78\x61\xfc\xb0\xb7\xdb\x38"
+		  "\x01\xe1\xce\x91\xe2\xc1\x54\xab"
+		  "\xaf\x26\xd0\x90\x13\x36\x52\x60"
+		  "\x4d\x34\x90\x58\xf0\xd4\x08\x87"
+		  "\x15\x08\x31\x69\x47\x21\x97\xea"
+		  "\x69\x80\x53\xb4\xf0\xc3\x41\x90",
+		.rlen	= 304,
+		.also_non_np = 1,
+		.np	= 3,
+		.tap	= { 64, 17, 223 },
+	}
+};
+
+/*
+ * Poly1305 test vectors.  The one-time key is passed in the first 32 bytes
+ * of the data.  The first is from RFC7539 section 2.5.2.
+ */
+#define POLY1305_TEST_VECTORS 2
+
+static struct hash_testvec poly1305_tv_template[] = {
+	{
+		.plaintext= "\x85\xd6\xbe\x78\x57\x55\x6d\x33"
+		  "\x7f\x44\x52\xfe\x42\xd5\x06\xa8"
+		  "\x01\x03\x80\x8a\xfb\x0d\xb2\xfd"
+		  "\x4a\xbf\xf6\xaf\x41\x49\xf5\x1b"
+		  "\x43\x72\x79\x70\x74\x6f\x67\x72"
+		  "\x61\x70\x68\x69\x63\x20\x46\x6f"
+		  "\x72\x75\x6d\x20\x52\x65\x73\x65"
+		  "\x61\x72\x63\x68\x20\x47\x72\x6f"
+		  "\x75\x70",
+		.psize	= 66,
+		.digest	= "\xa8\x06\x1d\xc1\x30\x51\x36\xc6"
+		  "\xc2\x2b\x8b\xaf\x0c\x01\x27\xa9",
+	}, {
+		.plaintext= "\x23\x65\x9d\x9b\xe0\x58\xd5\x5d"
+		  "\x93\xe5\xad\x91\xee\xef\xf6\xb4"
+		  "\x7e\xd5\xa1\x38\x80\x80\xa7\xf6"
+		  "\x2f\x34\x9e\x55\x36\xaa\xdc\x29"
+		  "\x73\x32\x78\xa1\x13\x24\x85\x13"
+		  "\x54\xa7\x51\x78\xe6\x79\x84\x8c"
+		  "\xe1\x1e\x1e\x44\xff\xa5\x4a\x17"
+		  "\x91\x57\x71\xce\xa4\xa2\x43\xc1"
+		  "\x7d\x35\xc4\xae\x65\xae\xe9\x65"
+		  "\x31\x9e\x3d\x3c\xab\x29\xf9\x10"
+		  "\x1a\x3b\x5b\x82\x83\xe6\x7c\x41"
+		  "\x1c\xaa\x76\xf5\x5c\x94\x27\x9d"
+		  "\x05\x3f\x85\xa0\x18\xf8\x73\x22"
+		  "\x1a\x3b\xe9\xbe\xe1\x86\x3a\x95"
+		  "\xf9\x2f\x0a\xc1\x69\xb5\xa2\x10"
+		  "\x56\xf9\x04\x98\xe2\xf6\x80\xd7"
+		  "\x56\xdd\x6c\x7b",
+		.psize	= 132,
+		.digest	= "\x1c\x86\xb6\xaa\xe9\x30\x4b\x0c"
+		  "\x84\xf2\xbd\x4f\xa1\xf9\xb5\xb5",
+		.np	= 4,
+		.tap	= { 7, 25, 1, 67 },
+	}
+};
+
+/*
+ * NHPoly1305 test vectors
+ */
+#define NHPOLY1305_TEST_VECTORS 2
+
+static struct hash_testvec nhpoly1305_tv_template[] = {
+	{
+		.key	= "\xa8\x47\x29\xa5\x04\x72\xdc\x50"
+		  "\x60\xa7\x4b\xf4\x86\x4a\x77\xf8"
+		  "\x6f\xca\xcf\xfb\x68\xfb\x9c\xaa"
+		  "\x30\x78\x4f\x41\xa0\x67\x56\xc7"
+		  "\xaf\xb1\xcf\x98\x21\x8f\x9b\x34"
+		  "\x3b\x70\xcb\x0f\x4c\x70\x37\x9c"
+		  "\xdc\x09\x44\xe7\x69\x6b\x3b\x63"
+		  "\x75\x17\xcf\xbb\x8d\x8f\x51\x20"
+		  "\x83\xb9\x4e\x4d\xdb\xb0\x19\xef"
+		  "\x4c\xc9\xa0\x89\xc4\x76\x94\x58"
+		  "\x41\x1b\x6d\x7e\xb9\x47\xf5\xcb"
+		  "\x64\x13\xac\xf2\xa5\xa1\x51\x69"
+		  "\x24\x12\x52\xb4\x52\x4a\x70\xa7"
+		  "\x0d\x61\x95\xa0\x04\xdb\x2f\xc7"
+		  "\x59\x5c\x14\x71\xd8\xa6\x91\x46"
+		  "\x2f\xfa\x18\x97\x35\xae\xa6\xed"
+		  "\x2c\xd9\xaa\xe5\x68\xa3\x1f\x74"
+		  "\x39\xcb\xf3\x13\x4a\xd6\xb7\xe5"
+		  "\x77\xfe\x8f\x6d\xb3\x71\x8d\x16"
+		  "\xa2\xa9\x34\xa3\x13\x06\x4c\xbf"
+		  "\x91\xf8\x73\x06\xfa\xb8\xd4\xb8"
+		  "\xd9\x01\x50\x06\x1f\x37\x95\x7c"
+		  "\xcd\x88\x4b\x0e\x75\x82\xba\xe1"
+		  "\xa0\xdf\xb5\x6f\xd1\xda\x8b\x15"
+		  "\x6c\x31\x63\x89\xc1\xe8\x5a\x8b"
+		  "\x0c\x38\x0d\x38\xb3\xee\x97\x4b"
+		  "\x30\xab\x9c\xce\xb6\x86\x16\x16"
+		  "\x79\xb6\xb7\x4f\x64\x74\xfc\x4f"
+		  "\x2a\x5e\x61\xf7\xb9\x1b\x75\x9b"
+		  "\xc3\xe1\xe1\xc7\x5a\xdd\xed\x6a"
+		  "\x35\x94\xf1\xa0\x64\x0e\xdb\xbe"
+		  "\xe9\x8a\xb9\x91\x2e\x42\x43\x03"
+		  "\x1e\xf4\xc6\x1a\x25\x9b\x7a\x18"
+		  "\x25\xfe\xa1\xb2\x23\xba\xfe\x3a"
+		  "\xf5\xde\xb2\x45\x4e\x55\x4d\x85"
+		  "\x19\x4a\xbe\xab\x61\x94\x4b\x54"
+		  "\x90\x30\xb0\x61\x4e\x84\x3e\x3b"
+		  "\x9d\x54\xea\xf2\xf4\x4d\x4f\x53"
+		  "\x9e\x29\x37\xb4\xd0\x99\xf2\xda"
+		  "\xbc\x30\x42\xfe\x71\x7e\x64\x44"
+		  "\x17\x63\xfb\x04\x2c\x95\x5b\xd4"
+		  "\x71\xc2\x59\x19\xba\xcf\x77\xf6"
+		  "\xb7\x3c\x50\x79\x50\x6e\x73\xd5"
+		  "\x6c\xa6\x1a\xae\xff\x96\xfc\xd7"
+		  "\x11\xda\xfa\xcf\x31\x8d\x80\x26"
+		  "\xf7\x2c\x9d\x39\x3e\x40\x37\xe3"
+		  "\xdb\xa6\x43\x3e\x68\x29\xf7\xe3"
+		  "\x1d\x38\xe6\xec\xf5\xd2\x65\x92"
+		  "\xde\x3d\x23\x28\x29\xf6\xf8\x94"
+		  "\x88\xaf\xe3\xff\x51\x3e\x1f\xd6"
+		  "\xb9\xfc\xcc\x77\xa2\xc0\x6a\xe6"
+		  "\x91\xb7\xdb\x54\xe4\xf9\x4d\xa7"
+		  "\x00\x5b\x06\x61\x0d\x38\x07\x97"
+		  "\x34\xfc\x95\x04\x4c\x86\x59\xc2"
+		  "\x17\xbe\xc5\x49\xcd\xf3\xa9\xca"
+		  "\x48\xee\x23\x72\xe5\x8e\x65\xfa"
+		  "\xa4\x6b\xdf\x46\x24\xa8\x05\x91"
+		  "\x3c\xfa\x42\xd8\x12\xb7\x14\x0e"
+		  "\xd7\x45\xc3\x2c\xd6\xe6\x03\x52"
+		  "\x2f\x1d\xa8\x59\x81\x30\x79\xe5"
+		  "\x79\x67\xd1\x37\xf5\xc6\x4e\xf5"
+		  "\x00\x33\x9c\x7d\x97\x7f\x1e\x6e"
+		  "\x8b\x48\x55\x63\x63\x13\x86\x25"
+		  "\x99\xe0\x9c\x81\x85\x95\x1d\x2f"
+		  "\xb5\xb8\xeb\xce\x51\x11\x40\x9d"
+		  "\x8e\xab\xa6\x55\xbf\xcd\x33\x67"
+		  "\x5e\xc8\xbf\xcf\x69\x25\x16\x67"
+		  "\x48\x5a\x9e\x84\x12\x35\x07\x63"
+		  "\x14\xf9\x62\xba\x7c\xba\x59\x83"
+		  "\x61\xc5\x2b\x5c\x50\x75\x00\x23"
+		  "\x7e\xef\x4c\x24\x9d\x36\xe0\xc6"
+		  "\x14\xdf\xbe\xab\x8e\x82\x1c\x68"
+		  "\x4d\x43\xf5\x6f\x14\x70\x54\x42"
+		  "\x3d\x22\x60\x7f\x4d\x0d\xb0\x7a"
+		  "\x50\x92\xb1\x8f\xec\xe9\xba\x0b"
+		  "\xe0\x20\x9a\x74\x9e\x97\x9f\x5a"
+		  "\xee\x33\xfc\x4e\xda\x95\x15\xda"
+		  "\xac\xd6\xe7\xad\xa9\x2a\x0a\xe0"
+		  "\x95\xab\xd0\x78\xa1\x91\x55\x0c"
+		  "\x7e\xbe\x72\x56\xd3\xbc\xeb\x0d"
+		  "\xaf\x61\x54\xbf\x89\x19\x51\x5a"
+		  "\x41\x1d\x4d\xa0\x97\x75\x63\xeb"
+		  "\xaf\xc8\x8b\x5e\xef\x34\x0d\x1e"
+		  "\x82\xc8\xd0\x13\x75\xe0\x2c\x78"
+		  "\xcf\xa6\xed\xcc\x52\x91\x76\x58"
+		  "\xdb\x37\xc5\xbc\xd4\x92\x04\x7c"
+		  "\x56\x85\x73\xee\xa4\xf4\x8f\x83"
+		  "\x6a\xb0\x49\xb2\x55\xb8\x61\x8e"
+		  "\xff\x75\xfc\xd1\xda\xc1\x52\x2c"
+		  "\x03\xd9\xf2\xb5\x9e\x39\xdd\x99"
+		  "\x37\x5a\x31\xfb\x50\x63\x2c\x84"
+		  "\x33\xa6\xad\x2b\xaa\x09\x04\x2b"
+		  "\x8f\x20\xc4\x99\xfd\x14\xf2\xb9"
+		  "\x6e\x79\x98\x84\x6c\x28\x54\x14"
+		  "\xc5\x23\x5d\x31\x6c\xdc\x52\xf4"
+		  "\x17\xeb\x39\xb7\x5a\x7c\xc2\xc5"
+		  "\x9f\x76\x39\x52\x6c\xd4\xb6\xc0"
+		  "\x17\x29\xa2\x92\x99\x52\xa3\x81"
+		  "\xdd\xc4\x41\x1d\x9f\xcc\xa9\x7e"
+		  "\x16\xe1\xe5\xfd\x45\xe0\x2a\x35"
+		  "\x56\x7b\x92\xa1\x7f\xc7\x82\x97"
+		  "\xde\xd7\x1f\x48\xdd\x9c\x10\xd5"
+		  "\x91\x06\xa7\x17\x64\x0d\x7e\x23"
+		  "\x86\x03\xdc\xec\x99\x11\x67\x21"
+		  "\xdd\x0b\xb9\x98\xfe\x98\xfd\xb1"
+		  "\x48\x68\x65\x2e\x25\x5b\x2c\xa2"
+		  "\x79\x4f\x09\x23\x76\x08\x3b\xf8"
+		  "\x11\x67\xbb\x06\x90\xf5\x3c\x85"
+		  "\x2e\x97\xe8\x17\x6e\x1b\x5b\xf1"
+		  "\x85\x86\x21\xad\x49\x42\x68\xc6"
+		  "\xd3\x7f\x4a\x4a\xb6\x68\xf0\xe8"
+		  "\xa4\x0f\x65\x7d\x12\x42\x22\x9e"
+		  "\xb4\xdb\x1b\x65\xfe\xbc\x94\xa1"
+		  "\x40\xfc\x85\xfc\xa6\x5d\x11\x60"
+		  "\x56\x93\x31\xef\x81\xa3\x65\x45"
+		  "\x63\x7e\x68\xda\xca\xd8\x8e\x76"
+		  "\xca\xcb\xf3\x2e\x76\x19\xbc\x63"
+		  "\x94\x89\xf7\x05\xc6\x06\x45\xbd"
+		  "\x50\x08\xb4\xe0\x85\x09\x55\xb4"
+		  "\xcc\xa3\x13\x9e\x76\xde\x95\x8e"
+		  "\xa6\x4f\xc2\x7c\xdc\x2d\x80\x73"
+		  "\xb8\x6f\xbe\x67\x71\x36\x46\x39"
+		  "\xda\xa4\x63\x82\x2f\xcc\x5b\xe6"
+		  "\x7d\x94\x9b\x22\x88\x0d\xf5\xe0"
+		  "\x9f\x1e\x33\x9d\xa8\x8a\x11\xe2"
+		  "\xc3\xb7\x4f\x79\x66\x8b\xcb\xf6"
+		  "\xb4\x6e\x1c\xdf\x5b\xc4\x5f\x3b"
+		  "\x97\xf5\x8d\xc9\xa5\x5e\xd3\xf4"
+		  "\xa3\x3b\x24\x29\x98\x2e\x9b\x42"
+		  "\xbe\x9a\xc3\xe1\x22\x93\xdd\x76"
+		  "\x7d\xa3\xba\x89\x30\x53\xf7\xd3"
+		  "\x6e\x82\xf9\x7c\x37\x20\xf3\xb4"
+		  "\xf1\x4b\xbe\xb0\x67\xce\x7d\x49"
+		  "\x74\x8e\x65\x29\xf8\x6d\x4c\xec"
+		  "\x76\xb5\xfe\x58\x96\xcd\x02\x4b"
+		  "\x04\x87\xd8\x0f\xd3\x87\x89\xa1",
+		.ksize	= 1088,
+		.plaintext= "\x10\x9a\xcc\xae\xc8\x87\x51\x8b"
+		  "\xf2\xe4\xc9\xa6\x0d\xcc\x29\xd0",
+		.psize	= 16,
+		.digest	= "\xbd\x39\xb9\x4e\xca\x17\x3c\x5f"
+		  "\xda\x71\xfa\x67\xf3\x04\xed\x0e",
+	}, {
+		.key	= "\x71\x1f\x16\x8d\xe4\x6d\xa1\x60"
+		  "\xb5\x6e\x04\xfb\x0a\x1e\x89\x9a"
+		  "\x9c\x24\xea\x24\xc8\x91\x15\xa0"
+		  "\x6f\x31\x55\xc7\x8b\x6b\xc6\xa0"
+		  "\x9c\xe2\x7c\x7a\xcb\x1c\x03\x8b"
+		  "\x10\x4c\x2a\x9b\x32\x0f\xce\x72"
+		  "\xd4\xc5\x98\xa9\xb9\x0b\x16\x12"
+		  "\x13\x37\xb5\x4d\x34\xe9\x31\x27"
+		  "\xb1\x26\x68\x22\x1b\x5f\x46\x66"
+		  "\x0c\x3a\xcd\xfe\xf5\xe9\x2c\xf0"
+		  "\xc4\x3b\xd4\x69\xb2\xc6\x95\xd4"
+		  "\x22\xc1\xbf\x56\xde\xa5\xcb\x19"
+		  "\xb0\x92\xcc\x67\x48\x10\x0b\x19"
+		  "\x43\xe9\x6f\xe3\xb6\xf3\x97\x25"
+		  "\xda\x11\xfa\xd6\xb3\x3e\x54\xe3"
+		  "\xdd\xd5\xd2\x64\x9b\x6c\xcf\x0e"
+		  "\x4d\x29\x03\xdf\x1b\xe1\xde\x60"
+		  "\x3e\x41\x6d\x81\xa3\x27\xca\x0a"
+		  "\x40\x2c\x13\x9d\x0b\x78\x7c\x19"
+		  "\x8b\x51\xf4\x79\x2d\x5f\xc5\x8c"
+		  "\xfb\x62\x84\x30\x76\x08\xb4\x33"
+		  "\x43\x34\x5a\xf4\xd5\xff\xe6\x7a"
+		  "\xd7\xdc\x23\x56\x14\x89\x01\xd8"
+		  "\x2f\x97\xb2\x36\x8e\x49\x69\x62"
+		  "\x44\x34\x23\x1d\x8a\xea\x95\x38"
+		  "\xa9\xc1\xb2\x75\xba\xa1\x50\xd4"
+		  "\x1d\x41\x56\xa0\x14\x1d\x40\x13"
+		  "\xe5\x0a\xa0\x37\xe1\x87\x6b\x84"
+		  "\xfa\x42\x70\x84\xf9\x75\x2d\x64"
+		  "\x36\x4d\x74\xa1\x30\x00\x31\x34"
+		  "\xd3\x93\x93\xbc\x11\x09\x57\x91"
+		  "\x7b\x3f\x02\x7a\xe5\x51\x3e\x60"
+		  "\x8f\x8b\x94\x82\xac\xb4\x74\x94"
+		  "\xba\xff\xaa\x38\x21\x55\x41\x7d"
+		  "\xcf\xba\xec\xa8\xce\xdc\xb8\x5e"
+		  "\xb5\xac\xaa\x50\x7d\xf4\xda\x8b"
+		  "\xa6\xa5\x1a\xb2\xdd\x3f\x91\xe1"
+		  "\x41\xb2\x7d\xb8\xde\xdf\x62\xec"
+		  "\xe8\xd1\x79\xf1\x5b\x6f\x4a\xad"
+		  "\xfa\x45\xff\x84\x9b\x9d\x2a\x46"
+		  "\x89\xaa\x3c\x0c\x25\xe0\x2d\x9b"
+		  "\xc5\xf5\xae\x16\x37\x84\x92\x0c"
+		  "\x5c\xf8\x01\x96\x41\x69\x94\xe1"
+		  "\x56\x95\x55\x82\x8d\xca\x6d\xa8"
+		  "\x42\x3d\x86\x72\x94\x48\xaf\x8a"
+		  "\x21\x76\xd6\x61\xba\x66\x17\xe3"
+		  "\xb8\x48\x89\xa6\x47\x48\x6a\xac"
+		  "\xb4\x15\xc8\x2d\x74\x5d\xa7\x1f"
+		  "\x3f\x21\x3c\x16\xc3\xfc\x93\xfc"
+		  "\x24\x05\xe0\xec\x3e\xf8\xe5\x2e"
+		  "\x7b\xcc\x1a\xf4\x8c\xf3\xdb\x68"
+		  "\x18\x03\x8b\x03\x9e\x8c\x06\xad"
+		  "\xc1\x2a\x79\xd2\x79\x88\x46\xf1"
+		  "\x48\x13\xfa\x22\xd5\x90\xde\x99"
+		  "\xb8\x86\x17\x7f\xd1\x9f\xa2\xc2"
+		  "\xe2\x7a\x61\xaf\xb3\x71\x5d\x9f"
+		  "\xe4\xbc\x8f\xc5\x2a\x67\xd1\x47"
+		  "\xfa\x17\xff\x16\xc9\x91\x20\x17"
+		  "\xa1\x6d\x2e\x62\xd1\x72\xd4\xf6"
+		  "\x9c\x95\x00\xdd\xe6\xe3\x89\x4d"
+		  "\x49\xdf\x52\x73\xfc\x6e\xca\x55"
+		  "\x74\x39\x15\x26\xd0\x5e\x66\x10"
+		  "\xa2\xb5\xd5\x10\xe7\x8d\xce\x3f"
+		  "\x25\xeb\x48\x74\x7b\x97\xcc\xa0"
+		  "\x50\x65\x39\x4e\xa4\x4c\x38\x9a"
+		  "\xf1\x15\x9e\xd0\xea\x3e\xb3\x55"
+		  "\xa2\x97\xdb\x38\xa1\x3a\xdc\x04"
+		  "\xc5\x05\x94\x29\xd7\xdb\x55\x6e"
+		  "\x35\x6e\x28\xad\xa5\xfa\x78\x32"
+		  "\xaa\x02\xd7\x49\x2c\x5e\xb3\x6a"
+		  "\xc1\xaf\xea\xd3\x2c\x08\x17\x58"
+		  "\xf8\x6a\xb2\x8b\xc3\x6f\xea\x05"
+		  "\xbf\xfd\xb1\xb7\x29\x8e\x15\xbb"
+		  "\x76\x93\x47\xd8\xe0\xfa\x5a\x6f"
+		  "\x1b\x0e\x90\x7c\x15\x26\x27\x9c"
+		  "\x03\x51\x76\x6f\x8a\xcc\x93\xe3"
+		  "\x77\x0f\x89\x33\x0c\x7d\x89\xca"
+		  "\xe6\x69\xc6\x57\x5c\x7d\xd9\x93"
+		  "\x42\x86\x6f\x10\x0f\x62\xe0\x18"
+		  "\xec\xf2\xd9\x07\xbc\xa6\xc3\x61"
+		  "\xe1\x11\x07\x8e\x59\xe8\x41\xe2"
+		  "\x40\x39\xd7\xb4\xf8\xd6\x52\xcb"
+		  "\x03\x04\x2a\xf6\x44\xa8\xaf\xbf"
+		  "\x5e\x55\xb4\x05\x83\xdd\x55\xa5"
+		  "\xf6\xcc\x29\xbb\x02\xed\x24\x92"
+		  "\x89\x21\x62\xfd\xba\x5f\xff\xcf"
+		  "\xb5\x8e\x82\x8f\x06\xb6\xea\x79"
+		  "\x38\x14\xca\x4b\x12\x3f\xc5\x4e"
+		  "\x50\x26\x9a\x00\xa7\x75\xf2\xb8"
+		  "\xbb\x31\x2e\xcf\x28\x81\x1a\x5a"
+		  "\x6f\x0c\x21\xa5\x0c\xaf\xba\x6a"
+		  "\xc3\xde\x85\x7a\xe1\xe2\x7f\x56"
+		  "\xd1\x87\x2d\x40\x7c\xcb\xe4\x12"
+		  "\x39\xee\x61\xac\xfc\x8b\xbf\x18"
+		  "\xae\x6d\x1d\x7a\x0a\x61\x9a\x27"
+		  "\x61\x4f\xa0\x6e\x1a\x1c\x5a\x57"
+		  "\xbf\x1f\xe4\xad\x82\xd3\xb0\x78"
+		  "\x1b\x11\x2b\x49\x17\xed\x00\x22"
+		  "\x5e\xf3\x5a\x59\x25\xdb\xc8\x77"
+		  "\x8f\x69\x08\xee\xfe\xcd\x68\x64"
+		  "\x10\x02\x9f\x41\x22\x29\x24\x71"
+		  "\x9c\x2d\x3f\x33\xcc\xe5\x55\x1a"
+		  "\x96\x51\x73\x30\x96\xea\xb6\xe6"
+		  "\x72\x32\xef\xea\x33\x4b\xe3\xe7"
+		  "\xb6\x85\x2d\xe4\x0b\xca\x0a\x01"
+		  "\x0a\x4d\x54\x97\xa1\x0c\xfe\x59"
+		  "\xfa\x95\x2a\xce\x2f\x01\x1e\x23"
+		  "\xa3\x4f\xdf\x13\xc9\x52\x3f\xbd"
+		  "\x5f\xcf\x6f\xc7\x40\x9b\x8d\x2c"
+		  "\xdb\xc6\x02\x40\x1e\xfc\x5e\x4c"
+		  "\x09\xa9\x30\x88\x4f\x89\x5e\x8c"
+		  "\x7f\x9b\x14\x4c\xf1\xad\x15\x13"
+		  "\x44\xbf\xec\x3c\x28\x88\xb7\x8c"
+		  "\x15\x3c\x63\x0a\x9f\x54\x6a\x6f"
+		  "\x8d\x55\x76\x0d\x3a\xf8\x98\x2d"
+		  "\x51\x81\xfb\xa9\x78\xae\xc0\xfa"
+		  "\x0c\x60\x29\xce\xf5\xe9\x34\x36"
+		  "\x92\x90\x2e\x89\x33\xd6\xf5\xfa"
+		  "\x67\xcf\x9e\xd1\xab\x60\x48\x91"
+		  "\x7d\x50\xae\xf0\xa4\xd1\x5d\x03"
+		  "\x03\x1d\xaf\xce\x22\xca\x13\xe6"
+		  "\x10\x9d\x22\xde\xb0\xa6\x39\x00"
+		  "\xea\x6b\x58\x92\xa0\xcb\x99\xb5"
+		  "\x88\xe4\xd2\xd6\x4c\x9e\x59\x79"
+		  "\x3e\x31\x71\x5d\xa4\xf8\x91\xc2"
+		  "\xb0\x91\x3e\xac\x7e\x46\xc4\x52"
+		  "\xc2\x35\x49\x21\x38\x05\x5a\x56"
+		  "\xfb\x30\xeb\xa7\x46\xb9\xb9\xca"
+		  "\x4b\xbd\x93\x4e\x5a\x56\xb1\xa2"
+		  "\x05\x04\x44\xbb\x8a\xb0\xd7\x63"
+		  "\x6c\x96\xb7\xcc\xc8\xc3\x9d\x86"
+		  "\x98\x95\xf5\x5d\x79\xd4\xb8\xd0"
+		  "\x19\x8b\xf5\xb5\xc2\xed\x54\xef"
+		  "\xed\x46\x09\xf4\x0f\x0c\x54\xcd"
+		  "\x32\x08\xaa\xf5\xb3\x5d\xdb\x07"
+		  "\x10\x8a\x63\x62\xa2\x29\x1f\xf3",
+		.ksize	= 1088,
+		.plaintext= "\xef\x9f\x86\x53\x47\x4a\x93\x3a"
+		  "\x7b\xd0\xa9\xaf\x05\xe7\xfc\x13"
+		  "\x6c\x25\x29\x49\xe2\x52\x3f\xc5"
+		  "\xae\x60\x96\x7b\x39\xfc\x18\x13"
+		  "\x17\x8d\x67\xfc\x3b\x9d\xc0\x6b"
+		  "\x0a\x81\xa9\x95\xa7\x9c\xdb\xb4"
+		  "\xb1\x0b\xd5\x10\x33\xbd\xa9\x75"
+		  "\xce\x75\x1d\xb8\x8b\xf6\x9e\xe2"
+		  "\x1e\x05\xe0\xb2\x5e\x63\x35\xd6"
+		  "\x2b\xec\x62\xfa\xde\xca\xa8\xf1"
+		  "\x28\xd6\x66\xca\x65\x55\x1b\x93"
+		  "\xba\x12\x0f\x32\xaf\x70\x0b\x4f"
+		  "\xed\x21\x15\xb8\x29\xb1\x07\xe3"
+		  "\x6f\xdc\x0d\x1f\x1e\x85\x15\xc7"
+		  "\x02\xcf\x33\xf7\xe5\x4b\x98\xa2"
+		  "\x94\x69\x77\xed\x30\x91\x68\xff"
+		  "\x31\xd9\xd2\x91\x48\x32\xce\xbc"
+		  "\x92\xf9\x1d\x86\xed\x65\xec\xe1"
+		  "\xb2\x68\xeb\xa0\x33\xd3\x4f\xe8"
+		  "\x10\xac\xf1\xbd\x87\x97\x91\xa9"
+		  "\xcd\x46\x50\x4c\xd0\xe0\x82\xd5"
+		  "\x5f\xd5\xb4\x0a\x96\xc7\x8e\xf3"
+		  "\x26\x4c\x02\xf9\x8f\x26\x3c\x8c"
+		  "\x9e\x5b\xc7\x79\x72\x7a\x56\xba"
+		  "\xbf\x97\x5c\x5f\xe5\xcc\x1f\x4c"
+		  "\xa3\x06\xb1\xfb\x20\xeb\xe7\x7d"
+		  "\x18\x23\x01\xc2\x9f\xec\xaa\x25"
+		  "\x04\x45\x37\x5e\x11\xc9\x44\xc5"
+		  "\x07\xa8\xa5\x0c\x60\x42\xdd\x55"
+		  "\x77\x7f\x6c\x30\xac\xa9\x67\x2a"
+		  "\x97\x3f\x1f\x06\xe9\x93\x79\xa8"
+		  "\x67\x42\x3b\x53\xbe\xd0\x55\x44"
+		  "\x1f\x24\x2f\x5f\xc4\xc6\xed\xf9"
+		  "\x77\xb1\xc4\x05\x87\x0c\x4b\x61"
+		  "\xb8\xde\x4f\xb4\xcc\x5e\xcd\xb7"
+		  "\xf0\xbd\x7a\xc2\x32\xbc\xbc\x8d"
+		  "\xab\x0c\xa3\x46\xfd\xbc\x58\x9e"
+		  "\x47\x55\x40\x08\x35\xef\xb8\xaa"
+		  "\xe4\x01\xa1\x82\xf4\xab\x3e\xcc"
+		  "\x0e\x0f\xf2\xad\x23\xd8\xf5\xe4"
+		  "\x52\xd4\x6a\x24\xdb\x42\x46\x44"
+		  "\xf8\x52\x5b\x1b\x47\xfb\xb0\x0e"
+		  "\xbf\xcb\x9c\x7b\x7d\xc5\x8f\xc2"
+		  "\x0b\x7d\xd6\x3e\x74\x8e\x2b\x3e"
+		  "\x45\x7f\xf9\x0d\xbf\xac\xbe\x26"
+		  "\xb1\x08\xe4\x28\xdd\xe0\xbd\x11"
+		  "\xb4\x9e\xe2\x2d\xa9\xc0\x63\xaa"
+		  "\x6e\x93\xac\x9c\x61\x2c\xa7\x6f"
+		  "\xc6\x3c\x31\xb7\xb6\xfc\xac\x76"
+		  "\x47\x68\xb3\x84\x82\x78\xb4\xd6"
+		  "\x9a\x3f\xa1\x32\xdc\xb9\xa3\xf0"
+		  "\x95\x6d\x2d\x80\x9c\x42\x6d\x2c"
+		  "\x8b\x4b\x8a\x3b\xa9\xbc\x4c\x98"
+		  "\x2a\xec\x31\xb7\x6f\x6f\xc1\x74"
+		  "\x5d\xcf\x7f\x78\xdd\x21\x8b\xc0"
+		  "\x5e\xf2\xfd\x4e\x76\xde\xe6\xee"
+		  "\x3e\x49\x72\x60\x40\x69\xa7\x8d"
+		  "\x57\x71\x0c\xcf\x31\xbb\x86\xd3"
+		  "\x79\x99\xca\x21\x91\xf4\x51\x74"
+		  "\x10\x20\x1c\x6a\x1a\x2e\xb6\xc5"
+		  "\x80\xd6\x0d\xc8\x58\x1d\x72\xc9"
+		  "\xb4\xb7\xe4\x10\x28\x84\x71\x21"
+		  "\x10\x5a\xfb\x53\xc5\x3d\xe3\x11"
+		  "\x18\x52\x14\x21\x24\xc9\x5e\xab"
+		  "\xe8\x95\x9b\x4d\x59\xab\x72\xd5"
+		  "\xf4\xf3\x28\x31\x40\xd7\xa6\x77"
+		  "\xaf\x22\xd1\x1b\x8c\x18\xd4\x17"
+		  "\x37\xb9\x3a\x2b\xbf\x0e\x0a\x58"
+		  "\x84\x69\x3a\x22\x6e\x10\xfe\x66"
+		  "\xd5\x3b\x63\x1a\xc2\xba\xd2\xf1"
+		  "\x1d\x6f\x45\x6b\x01\xb2\x86\x60"
+		  "\x69\xf2\xd2\xd1\x32\xc7\xa9\xa4"
+		  "\xd2\xe4\xc1\x1c\xa4\xe7\xae\x95"
+		  "\x8d\x7d\xe1\x97\x26\xde\xb9\x96"
+		  "\x06\x1f\x25\x77\xee\xb7\x07\xc6"
+		  "\x9f\x21\xd6\x1a\x2c\xfe\x3e\x88"
+		  "\x19\x48\xb9\xd4\x66\xfd\x35\xed"
+		  "\x23\x8f\xf0\x23\xdb\x1e\x39\xb7"
+		  "\xe2\x44\x7f\x35\x3e\x04\xfe\x73"
+		  "\x07\x81\xa9\xc8\x2e\x39\x3a\x7b"
+		  "\x1a\xa1\x07\x87\x9a\x0c\x40\x26"
+		  "\x0e\xfc\x36\x36\x5e\xa6\x5a\x8c"
+		  "\x5b\x72\x45\x21\xfa\x1f\xd6\x2b"
+		  "\xda\xb5\x2e\xa3\x14\x02\x0d\xa9"
+		  "\xc8\x43\x45\xde\x09\x05\xe8\x3e"
+		  "\xc4\xf0\x1a\x78\x6f\x1e\x30\x41"
+		  "\xb3\x21\xd6\x75\x32\x6e\x6d\xe3"
+		  "\xee\x9c\x17\x15\x2f\xc1\x55\x9b"
+		  "\xa0\x34\x87\xd0\xf8\x5f\xc4\xb1"
+		  "\xa2\x0b\xc0\x6d\x67\x1a\x27\x75"
+		  "\x64\xce\xa5\x40\x1b\x0f\x1f\x47"
+		  "\x3e\x63\x26\x2d\x1a\x65\x78\xf5"
+		  "\x9e\xfd\x95\xa2\x1d\x86\x08\x58"
+		  "\x63\xee\xd8\x75\x10\x3e\x24\x67"
+		  "\x4e\x4f\xf5\xb4\xd5\x57\xe1\xb1"
+		  "\xda\xd4\xe2\x16\x27\x7f\x71\x91"
+		  "\x47\xf9\x1b\x37\xca\xfd\x54\x20"
+		  "\xd3\x5e\x09\x33\x91\xb8\x7c\x07"
+		  "\x30\x28\xf0\xd7\xfc\x61\x86\x98"
+		  "\x65\xa2\x78\xc4\xbd\xc4\xa2\x6f"
+		  "\xb4\x15\xdd\x03\x11\xf9\x06\x02"
+		  "\x81\x4e\xa9\x97\xb4\xdd\xc7\xef"
+		  "\x3d\x2a\xd7\x91\x15\xe3\xac\x8b"
+		  "\xb3\xec\xb2\x91\xd6\x10\x51\x5a"
+		  "\x34\xb5\xff\x0d\x61\xed\xae\x3a"
+		  "\x79\x84\x88\x46\xd5\x69\x2a\x99"
+		  "\x50\x11\x19\x83\xc1\x90\x5f\x60"
+		  "\xdd\x2a\xe7\x97\xef\xa5\xe1\x52"
+		  "\xc2\x57\x8e\x6d\xe5\xae\xfb\xc6"
+		  "\x1b\x98\x46\xa3\x01\xe8\x2a\xb9"
+		  "\xca\xaf\x28\x85\x84\x6c\xf7\x28"
+		  "\xb0\x74\x47\xd3\x0f\xd7\x65\xfe"
+		  "\xdd\xd9\xd4\xe3\x87\x27\x29\xae"
+		  "\x69\x7a\xec\xd1\x57\xf1\x75\x6c"
+		  "\x5e\xce\x0e\x71\x07\xb0\xf1\x1d"
+		  "\x43\x9d\xcc\x1b\xa3\x04\x04\xab"
+		  "\xab\x8c\xe3\xf8\x29\x02\x5c\xda"
+		  "\x98\x7d\xb8\x2d\xa4\x22\x65\x22"
+		  "\x9e\xc9\x8a\x32\xdb\x16\x3a\x50"
+		  "\x5f\x9a\x33\xf1\xe2\x3d\xfa\x79"
+		  "\xdd\xeb\xab\x57\xd5\x87\x34\x79"
+		  "\x59\x56\xac\xab\xeb\x4f\xac\x4b"
+		  "\x6f\x41\x72\xa5\x1c\x86\x16\x5f"
+		  "\x62\x2c\x15\x34\xf3\x1a\xce\x05"
+		  "\x27\xf8\xb5\xd0\x60\xa3\xda\x37"
+		  "\x20\xeb\x65\xc4\x91\x7e\x54\x18"
+		  "\x0d\x1d\x2d\xa3\x91\xfe\x22\x7d"
+		  "\xc6\x7a\x0a\x71\x60\xc0\x1c\x06"
+		  "\x5c\x4b\x9f\xa0\x88\x5c\xe0\xf3"
+		  "\xe4\x62\x01\x55\x2e\x22\x40\x9e"
+		  "\x81\x77\xf1\xec\x73\x4b\x7f\xc3"
+		  "\xc9\x43\x53\xea\x5c\xaf\x68\x88"
+		  "\x24\xeb\x45\x1e\x55\x91\x5b\x5a"
+		  "\xd9\xe0\xe3\x73\xda\xe9\x46\x76",
+		.psize	= 1072,
+		.digest	= "\x7e\xa7\xbb\x1f\xe3\x6c\x4c\x26"
+		  "\xac\x30\x26\x4c\xdf\xcd\xc0\x70",
+		.np	= 6,
+		.tap	= { 17, 255, 255, 255, 255, 35 },
+	}
+};
+
+/*
+ * Adiantum test vectors, XChaCha12 variant
+ */
+#define ADIANTUM_XCHACHA12_AES_ENC_TEST_VECTORS 3
+
+static struct cipher_testvec adiantum_xchacha12_aes_enc_tv_template[] = {
+	{
+		.key	= "\x25\x36\xf3\x39\x4a\x38\x7c\x3f"
+		  "\x3c\x9a\x34\x93\xde\x1c\xf8\xb7"
+		  "\x7b\x80\xa5\xfc\xc9\xfc\x09\x53"
+		  "\xa4\x54\x8b\x6f\x84\x36\xd9\x7a",
+		.klen	= 32,
+		.iv	= "\xa9\x81\x09\x55\xa6\x47\x96\x4d"
+		  "\xfa\x05\xe7\x92\xd8\x5c\x4c\xa1"
+		  "\xb4\x54\xd8\xd5\x3c\x81\x3f\x00"
+		  "\x4b\x44\x99\x14\x5e\x69\x51\x81",
+		.input	= "\x2d\x77\x35\xf9\x8b\x9d\xdd\xdc"
+		  "\xfc\x1c\x49\xd5\xef\x95\x18\xd1",
+		.ilen	= 16,
+		.result	= "\xee\x07\xc8\xe4\xab\x2e\x65\x0a"
+		  "\xec\x2d\xa7\x5d\x6f\x3d\x82\x1a",
+		.rlen	= 16,
+	}, {
+		.key	= "\xe8\x73\xbe\x5d\xf1\xd9\x40\xef"
+		  "\x78\xe9\x06\xad\x77\x2a\xbf\x07"
+		  "\x1d\x00\xd7\x78\xb9\x56\xd6\xe3"
+		  "\x52\x62\xb7\x41\xfc\x76\x3a\x04",
+		.klen	= 32,
+		.iv	= "\xd9\x91\xfa\x62\x70\x05\x27\x9b"
+		  "\xa6\x29\xf5\x7e\x3f\x1a\xd2\x9f"
+		  "\x7c\xc7\xb9\x62\xce\xaa\xb4\x0c"
+		  "\x96\x4a\xb1\x30\xf4\x43\x34\xc8",
+		.input	= "\x6a\xac\x3d\xda\x50\x84\xe7\x13"
+		  "\x10\xbf\x69\x6c\xe3\x4f\x21\x54"
+		  "\xc2\xd3\x6f\xc0\x4c\x44\x71\x89"
+		  "\x35\x4f\xc0\xa9\x67\xfa\x5f\xc2"
+		  "\xe9\x53\xe3\x0d\xb8\x23\x40\xb7"
+		  "\xb6\xdc\xa1\xc4\xc4\x32\x32\xef",
+		.ilen	= 48,
+		.result	= "\x3f\x7a\x91\x92\x0c\xf9\x8d\x46"
+		  "\x99\x05\xbb\xfa\x1b\x36\xe6\xcc"
+		  "\x18\x94\xff\x53\x23\xac\x40\xd9"
+		  "\xbb\x2e\xdf\xb2\x7b\x11\x52\x81"
+		  "\xd2\xe1\x49\xf6\x4b\x26\x9a\x18"
+		  "\x20\xb8\x66\x03\x23\x1f\x02\x95",
+		.rlen	= 48,
+	}, {
+		.key	= "\x3f\xff\x51\xd8\x5d\xe7\x6b\x5e"
+		  "\x27\x3f\x38\x09\x85\x09\x38\xd4"
+		  "\xdf\xd2\xad\x8e\x30\xf8\x42\xa3"
+		  "\x4c\xe4\x4e\xfc\x95\xe7\x44\x6b",
+		.klen	= 32,
+		.iv	= "\x36\x4d\x1e\x9f\xff\x3b\x75\x11"
+		  "\xdd\xea\xa4\xe2\x5b\x5f\x5c\xf9"
+		  "\xaf\xa3\x01\x20\x5f\x3c\xcf\xa5"
+		  "\x6a\xe2\x4e\x6b\xe5\xe0\xfb\xa9",
+		.input	= "\xd4\x63\x36\x25\x6d\xbf\xaf\x7c"
+		  "\xab\xeb\xfe\x1f\x93\x22\x06\x31"
+		  "\x90\x8f\xca\xe0\x00\x0f\x39\x87"
+		  "\xd9\x07\xed\xf6\xc3\x94\xd2\xd2"
+		  "\x1c\x97\x31\x45\x0f\xa3\x7b\x99"
+		  "\x16\x88\xe6\x6d\x3a\xb5\xd6\xe1"
+		  "\x0a\x88\x89\x13\x7a\x25\x8d\x18"
+		  "\xdb\xb6\x9f\xb9\xeb\xdc\x94\x34"
+		  "\x42\xb3\x83\x26\x8b\xa7\x1f\xb0"
+		  "\xef\x96\x53\xc9\x74\x0d\xa5\x30"
+		  "\xf9\xa7\xba\x1e\x91\xa4\x26\xe3"
+		  "\x67\xde\xe0\x27\x57\x40\x40\x42"
+		  "\xa2\xfe\xad\x18\x18\xe5\x9b\x6e"
+		  "\x52\xe9\x32\x10\x34\x73\x55\x6f"
+		  "\x88\x35\xfd\xa1\x18\x23\x9d\x77"
+		  "\x14\xcd\x4f\xdb\xf9\xdb\x2b\xfe"
+		  "\x8e\xe1\x78\x50\x9e\x4b\x6f\xcf"
+		  "\x75\x32\x03\x53\x63\x39\x00\x8f"
+		  "\x9d\x19\x29\x05\x78\xf8\x63\x2b"
+		  "\xdd\x9f\x55\xfc\xa3\x01\xc9\x23"
+		  "\x4d\x3b\x20\x40\x49\x73\x9c\xf0"
+		  "\x43\xb7\x50\xea\x82\xea\xc0\x62"
+		  "\xe1\xc7\x1a\xe9\xe2\x5b\xea\xf0"
+		  "\xe7\x12\x7d\xe5\xa3\x66\xec\x0c"
+		  "\x5f\x10\xff\x23\x9f\xcd\x86\xc3"
+		  "\xbf\xd2\xd4\xb4\xf6\x08\x2e\xdb"
+		  "\xad\xec\xee\x21\xd3\x50\x7c\x9a"
+		  "\x87\x04\x10\xa0\x87\xd7\x4e\x31"
+		  "\xbf\xf8\x66\xc7\x8b\xb1\x65\x52"
+		  "\xea\x89\xf2\x2b\x1c\x9f\x2a\x24"
+		  "\xce\x1e\x51\x53\x15\xbb\x5a\x73"
+		  "\x7b\x79\xa1\xe7\x60\x4b\xab\x02"
+		  "\x56\xee\x8c\x66\x12\xd0\x98\x71"
+		  "\xaf\x69\xdc\xf9\x30\x14\x6d\xec"
+		  "\x2b\xd3\xa6\x4a\xc0\x4d\x43\xb6"
+		  "\x56\x67\xcd\x0a\x87\x44\x6c\xef"
+		  "\x5a\xc0\x71\xc8\x24\xce\x64\xe7"
+		  "\xcd\xc5\x52\x72\x80\x0c\x70\x98"
+		  "\x43\xfd\xd6\xef\x07\x7a\xab\xc1"
+		  "\xb0\x19\x53\xa9\xe6\xb0\xb8\x8b"
+		  "\x58\xd4\x78\xaf\x2a\x90\x14\x40"
+		  "\x65\xd9\x25\x89\xe8\x6c\x5a\xcc"
+		  "\xe3\xec\xd6\x85\x4a\x45\x01\x12"
+		  "\x1b\x45\x3e\x7e\x6c\x7b\xe2\x91"
+		  "\x30\x57\x25\xa5\x96\x08\x90\xf8"
+		  "\x2c\x63\xf5\xa1\xe5\xfd\x21\xad"
+		  "\xad\x3d\x17\x2c\xd0\x59\xd4\x70"
+		  "\x9a\x5c\x8b\xb0\x6e\x1a\xda\xef"
+		  "\x01\xa2\xe6\xca\x88\x85\x6d\x32"
+		  "\x95\x14\xc9\xd8\x23\x1e\x87\x9d"
+		  "\xfa\x7b\x83\x68\xb2\x18\x5c\x4b"
+		  "\x82\xef\xfa\x77\x95\x92\x8c\x52"
+		  "\x35\x6f\x15\x04\x79\xef\x73\x16"
+		  "\xfc\x71\x27\xf0\xfb\x50\x98\x43"
+		  "\xa8\x08\x53\x59\xf1\x44\xd4\x99"
+		  "\x75\x90\x11\xd1\xf4\xb9\xbf\x2a"
+		  "\xe8\xee\x6b\xc6\xe1\xbf\x76\x20"
+		  "\x62\x91\xb5\xb8\x90\x11\x6a\xd8"
+		  "\xcd\x84\x19\x7d\xa3\x60\x35\x18"
+		  "\x04\x5a\xd6\x98\xa1\xdc\xb3\x95"
+		  "\x1d\xcd\x4a\x58\x86\xb9\x1f\x8d"
+		  "\x9c\x3e\xbb\x61\xa2\x54\x3a\x72"
+		  "\x26\x77\x71\x4a\x36\x4c\xe3\x4c"
+		  "\xbd\x17\xc5\xaa\x1b\xc7\xde\xbd",
+		.ilen	= 512,
+		.result	= "\x58\x1f\x32\x4f\x49\xba\x5b\x03"
+		  "\x8a\x3b\x98\x66\xf4\x09\x78\x2a"
+		  "\x77\x1a\x10\x7c\xb9\xc2\x6c\x46"
+		  "\x27\xb9\x18\x72\x7f\x52\xd3\x26"
+		  "\x74\x33\x38\x24\xc1\x6b\x89\x5c"
+		  "\x6d\x49\x9a\xbf\x4b\xde\xf0\xc6"
+		  "\x04\x18\x2f\xe2\x9e\xf7\x30\x36"
+		  "\xfa\xe3\x14\xde\x81\x3b\x1a\x2c"
+		  "\x68\x29\xde\xf6\xdf\x3e\x4c\x49"
+		  "\x39\x87\x82\x31\x70\x8c\x90\x35"
+		  "\x62\xb7\x36\x2e\xcb\xe9\xd2\x6e"
+		  "\x39\xae\xf4\x13\xa9\xe9\x4c\xbd"
+		  "\x98\x6e\x56\xe7\xe3\x70\x94\x80"
+		  "\x1d\x9a\xdb\x03\x72\x4f\x53\xce"
+		  "\x7f\x92\xba\x28\xc8\x9f\x2c\x42"
+		  "\x16\x8b\x59\xf5\x09\x80\xd5\x1d"
+		  "\x8c\x9b\xd2\x41\x3f\xf6\xb2\x57"
+		  "\xa5\xd0\xd0\x97\x63\x8c\xc6\xa6"
+		  "\x6c\xca\x62\x57\x93\x2f\x09\xbe"
+		  "\xd0\x62\xbf\xf5\xac\x66\xe4\xed"
+		  "\x95\xc1\xec\x80\x85\x64\x72\x66"
+		  "\xd0\x1e\xaf\xe0\xec\x26\x84\xbc"
+		  "\x93\x31\x37\x1e\xdb\x81\x37\x52"
+		  "\xad\x8e\xeb\xe7\x13\x83\xe7\x3f"
+		  "\x45\x5b\x3d\x02\x00\xfc\xe1\x8f"
+		  "\xf7\x46\xd3\xd5\x03\x67\xd1\x87"
+		  "\x37\x02\xa1\x04\x61\xbf\x41\xc9"
+		  "\x85\x8d\x79\x81\xe8\xb3\x58\x6d"
+		  "\xd1\x63\x23\xb8\x44\x57\x76\x33"
+		  "\x96\xbc\x39\x6e\x9e\x6c\xcf\x15"
+		  "\x30\x77\x97\xbf\xfe\x8f\x2a\x04"
+		  "\x06\x8e\x98\x2f\x0b\x19\x10\x5f"
+		  "\x45\x6e\x38\x86\x4b\x27\xc8\x75"
+		  "\xc3\xfa\xdf\xeb\xc2\x13\xd4\x18"
+		  "\xb2\x68\x10\x10\xfd\x21\x84\x49"
+		  "\x82\x79\x22\x09\xb2\x22\x87\xd7"
+		  "\xc2\x35\xf8\x1b\x20\x4d\x01\xe1"
+		  "\xb1\x3a\xa0\xee\x5f\xad\x01\x0c"
+		  "\x85\x72\xf6\xe6\xbc\x51\xf7\xe5"
+		  "\xe1\xcb\xbb\xe6\x68\x90\x02\x36"
+		  "\x65\x30\x83\xd4\x54\x6c\x5e\xeb"
+		  "\xa6\x3f\x2d\x52\xe0\x0f\x92\x5a"
+		  "\x64\xc3\x5a\x33\x28\x2c\xbb\xf5"
+		  "\xf4\xf9\xc8\x2a\xb5\xcd\xd6\x4a"
+		  "\xc5\xaf\xa0\x6c\x5f\x04\x5e\x8a"
+		  "\xa9\xd0\x26\xfc\x2f\x68\x35\x05"
+		  "\xdb\xf9\x12\x67\xe8\x4d\xcb\x74"
+		  "\xaa\x5f\x7b\x7e\xe9\x42\x2e\x3b"
+		  "\xd9\x5a\x05\x23\xde\xd5\x38\xe5"
+		  "\x1d\x69\x73\x1b\x63\xbf\xe7\xcd"
+		  "\x0d\xb3\x05\xf8\x24\xbd\x41\x37"
+		  "\xf6\x3f\x93\x88\xbf\x0a\x9d\x17"
+		  "\xe5\xb4\xeb\xec\x60\x38\xc9\xc6"
+		  "\x12\xcb\xcf\x69\x49\x1e\x8a\x2b"
+		  "\xa3\xa6\xbf\x27\xa6\xea\x84\xf8"
+		  "\xf5\x81\xe3\x5f\xb7\xa4\xe8\x04"
+		  "\x6c\x1e\xf4\x8e\xe4\x52\xa3\x22"
+		  "\x12\xcd\x29\xe8\x2b\x9a\xae\xc2"
+		  "\xce\xb9\x41\xc6\xa9\xd9\xf6\x0e"
+		  "\x34\x13\x9c\x9b\x05\x14\x5e\x87"
+		  "\x6c\x44\x20\xed\xfd\x09\xc6\x81"
+		  "\x18\x5a\xf2\xc7\x81\xf4\xc3\x67"
+		  "\x1f\xab\x21\x62\x30\x6a\x7b\x4e"
+		  "\x08\x25\x3f\xbe\x49\xdd\x0a\x35",
+		.rlen	= 512,
+		.also_non_np = 1,
+		.np	= 3,
+		.tap	= { 32, 200, 280 },
+	}
+};
+
+#define ADIANTUM_XCHACHA12_AES_DEC_TEST_VECTORS 3
+
+static struct cipher_testvec adiantum_xchacha12_aes_dec_tv_template[] = {
+	{
+		.key	= "\x25\x36\xf3\x39\x4a\x38\x7c\x3f"
+		  "\x3c\x9a\x34\x93\xde\x1c\xf8\xb7"
+		  "\x7b\x80\xa5\xfc\xc9\xfc\x09\x53"
+		  "\xa4\x54\x8b\x6f\x84\x36\xd9\x7a",
+		.klen	= 32,
+		.iv	= "\xa9\x81\x09\x55\xa6\x47\x96\x4d"
+		  "\xfa\x05\xe7\x92\xd8\x5c\x4c\xa1"
+		  "\xb4\x54\xd8\xd5\x3c\x81\x3f\x00"
+		  "\x4b\x44\x99\x14\x5e\x69\x51\x81",
+		.input	= "\xee\x07\xc8\xe4\xab\x2e\x65\x0a"
+		  "\xec\x2d\xa7\x5d\x6f\x3d\x82\x1a",
+		.ilen	= 16,
+		.result	= "\x2d\x77\x35\xf9\x8b\x9d\xdd\xdc"
+		  "\xfc\x1c\x49\xd5\xef\x95\x18\xd1",
+		.rlen	= 16,
+	}, {
+		.key	= "\xe8\x73\xbe\x5d\xf1\xd9\x40\xef"
+		  "\x78\xe9\x06\xad\x77\x2a\xbf\x07"
+		  "\x1d\x00\xd7\x78\xb9\x56\xd6\xe3"
+		  "\x52\x62\xb7\x41\xfc\x76\x3a\x04",
+		.klen	= 32,
+		.iv	= "\xd9\x91\xfa\x62\x70\x05\x27\x9b"
+		  "\xa6\x29\xf5\x7e\x3f\x1a\xd2\x9f"
+		  "\x7c\xc7\xb9\x62\xce\xaa\xb4\x0c"
+		  "\x96\x4a\xb1\x30\xf4\x43\x34\xc8",
+		.input	= "\x3f\x7a\x91\x92\x0c\xf9\x8d\x46"
+		  "\x99\x05\xbb\xfa\x1b\x36\xe6\xcc"
+		  "\x18\x94\xff\x53\x23\xac\x40\xd9"
+		  "\xbb\x2e\xdf\xb2\x7b\x11\x52\x81"
+		  "\xd2\xe1\x49\xf6\x4b\x26\x9a\x18"
+		  "\x20\xb8\x66\x03\x23\x1f\x02\x95",
+		.ilen	= 48,
+		.result	= "\x6a\xac\x3d\xda\x50\x84\xe7\x13"
+		  "\x10\xbf\x69\x6c\xe3\x4f\x21\x54"
+		  "\xc2\xd3\x6f\xc0\x4c\x44\x71\x89"
+		  "\x35\x4f\xc0\xa9\x67\xfa\x5f\xc2"
+		  "\xe9\x53\xe3\x0d\xb8\x23\x40\xb7"
+		  "\xb6\xdc\xa1\xc4\xc4\x32\x32\xef",
+		.rlen	= 48,
+	}, {
+		.key	= "\x3f\xff\x51\xd8\x5d\xe7\x6b\x5e"
+		  "\x27\x3f\x38\x09\x85\x09\x38\xd4"
+		  "\xdf\xd2\xad\x8e\x30\xf8\x42\xa3"
+		  "\x4c\xe4\x4e\xfc\x95\xe7\x44\x6b",
+		.klen	= 32,
+		.iv	= "\x36\x4d\x1e\x9f\xff\x3b\x75\x11"
+		  "\xdd\xea\xa4\xe2\x5b\x5f\x5c\xf9"
+		  "\xaf\xa3\x01\x20\x5f\x3c\xcf\xa5"
+		  "\x6a\xe2\x4e\x6b\xe5\xe0\xfb\xa9",
+		.input	= "\x58\x1f\x32\x4f\x49\xba\x5b\x03"
+		  "\x8a\x3b\x98\x66\xf4\x09\x78\x2a"
+		  "\x77\x1a\x10\x7c\xb9\xc2\x6c\x46"
+		  "\x27\xb9\x18\x72\x7f\x52\xd3\x26"
+		  "\x74\x33\x38\x24\xc1\x6b\x89\x5c"
+		  "\x6d\x49\x9a\xbf\x4b\xde\xf0\xc6"
+		  "\x04\x18\x2f\xe2\x9e\xf7\x30\x36"
+		  "\xfa\xe3\x14\xde\x81\x3b\x1a\x2c"
+		  "\x68\x29\xde\xf6\xdf\x3e\x4c\x49"
+		  "\x39\x87\x82\x31\x70\x8c\x90\x35"
+		  "\x62\xb7\x36\x2e\xcb\xe9\xd2\x6e"
+		  "\x39\xae\xf4\x13\xa9\xe9\x4c\xbd"
+		  "\x98\x6e\x56\xe7\xe3\x70\x94\x80"
+		  "\x1d\x9a\xdb\x03\x72\x4f\x53\xce"
+		  "\x7f\x92\xba\x28\xc8\x9f\x2c\x42"
+		  "\x16\x8b\x59\xf5\x09\x80\xd5\x1d"
+		  "\x8c\x9b\xd2\x41\x3f\xf6\xb2\x57"
+		  "\xa5\xd0\xd0\x97\x63\x8c\xc6\xa6"
+		  "\x6c\xca\x62\x57\x93\x2f\x09\xbe"
+		  "\xd0\x62\xbf\xf5\xac\x66\xe4\xed"
+		  "\x95\xc1\xec\x80\x85\x64\x72\x66"
+		  "\xd0\x1e\xaf\xe0\xec\x26\x84\xbc"
+		  "\x93\x31\x37\x1e\xdb\x81\x37\x52"
+		  "\xad\x8e\xeb\xe7\x13\x83\xe7\x3f"
+		  "\x45\x5b\x3d\x02\x00\xfc\xe1\x8f"
+		  "\xf7\x46\xd3\xd5\x03\x67\xd1\x87"
+		  "\x37\x02\xa1\x04\x61\xbf\x41\xc9"
+		  "\x85\x8d\x79\x81\xe8\xb3\x58\x6d"
+		  "\xd1\x63\x23\xb8\x44\x57\x76\x33"
+		  "\x96\xbc\x39\x6e\x9e\x6c\xcf\x15"
+		  "\x30\x77\x97\xbf\xfe\x8f\x2a\x04"
+		  "\x06\x8e\x98\x2f\x0b\x19\x10\x5f"
+		  "\x45\x6e\x38\x86\x4b\x27\xc8\x75"
+		  "\xc3\xfa\xdf\xeb\xc2\x13\xd4\x18"
+		  "\xb2\x68\x10\x10\xfd\x21\x84\x49"
+		  "\x82\x79\x22\x09\xb2\x22\x87\xd7"
+		  "\xc2\x35\xf8\x1b\x20\x4d\x01\xe1"
+		  "\xb1\x3a\xa0\xee\x5f\xad\x01\x0c"
+		  "\x85\x72\xf6\xe6\xbc\x51\xf7\xe5"
+		  "\xe1\xcb\xbb\xe6\x68\x90\x02\x36"
+		  "\x65\x30\x83\xd4\x54\x6c\x5e\xeb"
+		  "\xa6\x3f\x2d\x52\xe0\x0f\x92\x5a"
+		  "\x64\xc3\x5a\x33\x28\x2c\xbb\xf5"
+		  "\xf4\xf9\xc8\x2a\xb5\xcd\xd6\x4a"
+		  "\xc5\xaf\xa0\x6c\x5f\x04\x5e\x8a"
+		  "\xa9\xd0\x26\xfc\x2f\x68\x35\x05"
+		  "\xdb\xf9\x12\x67\xe8\x4d\xcb\x74"
+		  "\xaa\x5f\x7b\x7e\xe9\x42\x2e\x3b"
+		  "\xd9\x5a\x05\x23\xde\xd5\x38\xe5"
+		  "\x1d\x69\x73\x1b\x63\xbf\xe7\xcd"
+		  "\x0d\xb3\x05\xf8\x24\xbd\x41\x37"
+		  "\xf6\x3f\x93\x88\xbf\x0a\x9d\x17"
+		  "\xe5\xb4\xeb\xec\x60\x38\xc9\xc6"
+		  "\x12\xcb\xcf\x69\x49\x1e\x8a\x2b"
+		  "\xa3\xa6\xbf\x27\xa6\xea\x84\xf8"
+		  "\xf5\x81\xe3\x5f\xb7\xa4\xe8\x04"
+		  "\x6c\x1e\xf4\x8e\xe4\x52\xa3\x22"
+		  "\x12\xcd\x29\xe8\x2b\x9a\xae\xc2"
+		  "\xce\xb9\x41\xc6\xa9\xd9\xf6\x0e"
+		  "\x34\x13\x9c\x9b\x05\x14\x5e\x87"
+		  "\x6c\x44\x20\xed\xfd\x09\xc6\x81"
+		  "\x18\x5a\xf2\xc7\x81\xf4\xc3\x67"
+		  "\x1f\xab\x21\x62\x30\x6a\x7b\x4e"
+		  "\x08\x25\x3f\xbe\x49\xdd\x0a\x35",
+		.ilen	= 512,
+		.result	= "\xd4\x63\x36\x25\x6d\xbf\xaf\x7c"
+		  "\xab\xeb\xfe\x1f\x93\x22\x06\x31"
+		  "\x90\x8f\xca\xe0\x00\x0f\x39\x87"
+		  "\xd9\x07\xed\xf6\xc3\x94\xd2\xd2"
+		  "\x1c\x97\x31\x45\x0f\xa3\x7b\x99"
+		  "\x16\x88\xe6\x6d\x3a\xb5\xd6\xe1"
+		  "\x0a\x88\x89\x13\x7a\x25\x8d\x18"
+		  "\xdb\xb6\x9f\xb9\xeb\xdc\x94\x34"
+		  "\x42\xb3\x83\x26\x8b\xa7\x1f\xb0"
+		  "\xef\x96\x53\xc9\x74\x0d\xa5\x30"
+		  "\xf9\xa7\xba\x1e\x91\xa4\x26\xe3"
+		  "\x67\xde\xe0\x27\x57\x40\x40\x42"
+		  "\xa2\xfe\xad\x18\x18\xe5\x9b\x6e"
+		  "\x52\xe9\x32\x10\x34\x73\x55\x6f"
+		  "\x88\x35\xfd\xa1\x18\x23\x9d\x77"
+		  "\x14\xcd\x4f\xdb\xf9\xdb\x2b\xfe"
+		  "\x8e\xe1\x78\x50\x9e\x4b\x6f\xcf"
+		  "\x75\x32\x03\x53\x63\x39\x00\x8f"
+		  "\x9d\x19\x29\x05\x78\xf8\x63\x2b"
+		  "\xdd\x9f\x55\xfc\xa3\x01\xc9\x23"
+		  "\x4d\x3b\x20\x40\x49\x73\x9c\xf0"
+		  "\x43\xb7\x50\xea\x82\xea\xc0\x62"
+		  "\xe1\xc7\x1a\xe9\xe2\x5b\xea\xf0"
+		  "\xe7\x12\x7d\xe5\xa3\x66\xec\x0c"
+		  "\x5f\x10\xff\x23\x9f\xcd\x86\xc3"
+		  "\xbf\xd2\xd4\xb4\xf6\x08\x2e\xdb"
+		  "\xad\xec\xee\x21\xd3\x50\x7c\x9a"
+		  "\x87\x04\x10\xa0\x87\xd7\x4e\x31"
+		  "\xbf\xf8\x66\xc7\x8b\xb1\x65\x52"
+		  "\xea\x89\xf2\x2b\x1c\x9f\x2a\x24"
+		  "\xce\x1e\x51\x53\x15\xbb\x5a\x73"
+		  "\x7b\x79\xa1\xe7\x60\x4b\xab\x02"
+		  "\x56\xee\x8c\x66\x12\xd0\x98\x71"
+		  "\xaf\x69\xdc\xf9\x30\x14\x6d\xec"
+		  "\x2b\xd3\xa6\x4a\xc0\x4d\x43\xb6"
+		  "\x56\x67\xcd\x0a\x87\x44\x6c\xef"
+		  "\x5a\xc0\x71\xc8\x24\xce\x64\xe7"
+		  "\xcd\xc5\x52\x72\x80\x0c\x70\x98"
+		  "\x43\xfd\xd6\xef\x07\x7a\xab\xc1"
+		  "\xb0\x19\x53\xa9\xe6\xb0\xb8\x8b"
+		  "\x58\xd4\x78\xaf\x2a\x90\x14\x40"
+		  "\x65\xd9\x25\x89\xe8\x6c\x5a\xcc"
+		  "\xe3\xec\xd6\x85\x4a\x45\x01\x12"
+		  "\x1b\x45\x3e\x7e\x6c\x7b\xe2\x91"
+		  "\x30\x57\x25\xa5\x96\x08\x90\xf8"
+		  "\x2c\x63\xf5\xa1\xe5\xfd\x21\xad"
+		  "\xad\x3d\x17\x2c\xd0\x59\xd4\x70"
+		  "\x9a\x5c\x8b\xb0\x6e\x1a\xda\xef"
+		  "\x01\xa2\xe6\xca\x88\x85\x6d\x32"
+		  "\x95\x14\xc9\xd8\x23\x1e\x87\x9d"
+		  "\xfa\x7b\x83\x68\xb2\x18\x5c\x4b"
+		  "\x82\xef\xfa\x77\x95\x92\x8c\x52"
+		  "\x35\x6f\x15\x04\x79\xef\x73\x16"
+		  "\xfc\x71\x27\xf0\xfb\x50\x98\x43"
+		  "\xa8\x08\x53\x59\xf1\x44\xd4\x99"
+		  "\x75\x90\x11\xd1\xf4\xb9\xbf\x2a"
+		  "\xe8\xee\x6b\xc6\xe1\xbf\x76\x20"
+		  "\x62\x91\xb5\xb8\x90\x11\x6a\xd8"
+		  "\xcd\x84\x19\x7d\xa3\x60\x35\x18"
+		  "\x04\x5a\xd6\x98\xa1\xdc\xb3\x95"
+		  "\x1d\xcd\x4a\x58\x86\xb9\x1f\x8d"
+		  "\x9c\x3e\xbb\x61\xa2\x54\x3a\x72"
+		  "\x26\x77\x71\x4a\x36\x4c\xe3\x4c"
+		  "\xbd\x17\xc5\xaa\x1b\xc7\xde\xbd",
+		.rlen	= 512,
+		.also_non_np = 1,
+		.np	= 3,
+		.tap	= { 32, 200, 280 },
+	}
+};
+
+/*
+ * Adiantum test vectors, XChaCha20 variant
+ */
+#define ADIANTUM_XCHACHA20_AES_ENC_TEST_VECTORS 3
+
+static struct cipher_testvec adiantum_xchacha20_aes_enc_tv_template[] = {
+	{
+		.key	= "\xbe\x57\x70\xd8\xa9\x5d\x0d\x67"
+		  "\x3d\xac\xe9\x4a\xce\x8d\x78\x42"
+		  "\x92\xc4\x26\x6f\x26\x23\xf7\x55"
+		  "\xc2\x30\xa1\xb1\xd4\xff\xe9\x54",
+		.klen	= 32,
+		.iv	= "\xae\xad\x02\x66\xe8\x41\x61\x9d"
+		  "\xae\x51\x34\x06\x98\x35\x71\x43"
+		  "\x27\x39\x7d\x69\x01\x6e\x67\xa9"
+		  "\xaf\x84\x23\xa1\xbe\x08\xd7\xbc",
+		.input	= "\x84\x1d\xde\x3e\x18\x0a\x6e\x25"
+		  "\xe5\x6d\x91\xb4\xa6\x56\x39\x09",
+		.ilen	= 16,
+		.result	= "\xc3\x67\x7b\xc0\xbd\x0c\xc4\x92"
+		  "\x9d\x0b\xa8\xc5\x54\x72\xe3\x23",
+		.rlen	= 16,
+	}, {
+		.key	= "\x91\x86\x9f\xea\xe1\x94\xed\xcf"
+		  "\x19\x56\x91\xa0\x86\x66\x77\x8b"
+		  "\xca\x81\x96\xd9\xeb\x55\x64\xf5"
+		  "\xcd\xe3\x2d\x6e\xbf\x38\xf8\x30",
+		.klen	= 32,
+		.iv	= "\x0e\x7e\x8c\x55\x68\x81\xa8\xc3"
+		  "\x2c\x6d\xd4\xa8\x34\x2d\xcd\x72"
+		  "\x57\x2c\x06\xef\x74\x2e\xd6\x56"
+		  "\xeb\x01\xe0\x6e\x95\x16\x18\xed",
+		.input	= "\xc3\xb7\xdc\xae\x2f\x34\x4f\x7f"
+		  "\xe6\xb0\x0d\x51\xb1\x64\xf5\x01"
+		  "\x82\xc8\xf7\x5e\xc3\xcd\x9a\xe2"
+		  "\xd3\x6e\x84\x1a\x3a\xa0\xd9\xec"
+		  "\xd6\x9f\x4e\xdc\x8b\xa1\x18\x85"
+		  "\xa1\x8a\xc8\xf1\x5f\x3c\xb7\xb2",
+		.ilen	= 48,
+		.result	= "\x32\xa5\x51\x17\xb2\xa0\x9b\x52"
+		  "\x90\x01\x5d\x67\x7c\x13\xf2\x21"
+		  "\x5c\x40\xde\xfe\x05\x3f\x35\xa3"
+		  "\x7b\xdc\x6f\x8f\x94\x1d\x26\x36"
+		  "\xd9\xaa\xa8\x87\xb5\xc2\x28\xb0"
+		  "\xb1\x98\xc5\xaf\x97\x65\x4f\x5d",
+		.rlen	= 48,
+	}, {
+		.key	= "\xc7\x4b\x1a\xc8\x5a\x71\xc8\x7f"
+		  "\x3e\x31\x3f\xd3\xde\x81\x2f\x08"
+		  "\x78\x4f\x60\x57\x2c\x92\x3a\xf5"
+		  "\x1f\xf6\x61\xcc\x56\x05\xa9\x32",
+		.klen	= 32,
+		.iv	= "\xa8\x37\xbe\xdd\xd0\x61\xac\xf6"
+		  "\x77\x46\x7e\xb7\x72\x08\x86\x75"
+		  "\xce\x13\xcd\xcf\x78\x32\x33\x70"
+		  "\x40\x77\x72\x40\x5f\xc3\x14\x04",
+		.input	= "\xf6\x7a\xa1\x1e\xc4\x8b\x25\xfd"
+		  "\x82\x7d\x62\xea\x56\x67\x8b\x26"
+		  "\xa6\x3b\x56\xc0\x2e\x18\xc9\xb0"
+		  "\x41\x2f\xff\xbb\xb0\xb7\xf1\xb0"
+		  "\x63\x9f\x7e\xa9\x00\x8b\xa6\x17"
+		  "\x62\x34\xf4\xb9\xef\x01\xd8\xf9"
+		  "\x26\x43\xaa\xaa\x36\x77\x9f\xc8"
+		  "\x30\x67\xcf\xd8\x3d\x60\xc3\x7a"
+		  "\x6e\x4c\x19\xfa\xc3\x17\x7f\x18"
+		  "\x77\xab\xbf\xce\xa1\x0a\x2f\x7e"
+		  "\x96\x54\x9a\x92\x33\x96\x46\x28"
+		  "\x4e\xf7\x9e\x61\x42\x7a\xfd\x99"
+		  "\xd4\xeb\x08\x49\x32\xc7\x35\xc6"
+		  "\xb1\x64\x7d\x4b\xae\x42\x85\xe4"
+		  "\x62\x90\xcf\x1b\x22\x69\x96\x9a"
+		  "\x9d\x80\x10\x1c\xbe\x16\x2e\x3e"
+		  "\x11\x61\xd0\x89\xb3\xca\x49\x25"
+		  "\xaf\xe2\x14\xca\x3e\x0f\x01\x91"
+		  "\x5e\xce\xc7\x9e\x11\xce\x9a\x33"
+		  "\x98\x3c\x73\x8c\x7e\xb0\x85\xde"
+		  "\x4c\x77\x2a\x96\xb9\x53\x8e\xc1"
+		  "\x96\x0b\x60\xec\x39\xdb\x17\x15"
+		  "\x4d\x04\x69\x1c\xba\x24\xa5\x43"
+		  "\xcb\x98\x8e\x36\xd8\xf8\xc4\x7c"
+		  "\xc5\x03\x2e\x32\x6f\xf3\x0b\xc3"
+		  "\x83\x22\x12\x81\x23\xed\x1a\x73"
+		  "\xca\xe4\x56\x27\x54\xb7\x6a\x18"
+		  "\x19\x9e\x7a\x14\x4c\x41\x0e\x5d"
+		  "\x6e\xfa\x73\xb9\xeb\x95\xce\x7f"
+		  "\xda\x67\xdb\x3f\xa0\xaf\x66\xfe"
+		  "\x89\x72\x89\x1e\x8e\x46\xb3\x02"
+		  "\x01\x2f\x43\x91\x99\x7b\x99\xc0"
+		  "\xda\x38\xee\xdd\x11\x75\x10\xb7"
+		  "\xc2\x80\xe1\x3f\xb4\xdb\x66\x5e"
+		  "\xb4\xde\xce\xe6\x4b\x95\xd7\x25"
+		  "\x3b\xd2\x72\xc0\xb4\xef\x2c\xa6"
+		  "\x4b\xe5\x9b\x4a\xdf\x94\xa7\x29"
+		  "\xd2\x8e\xf5\x54\x41\x66\xb8\x52"
+		  "\x03\x4a\xe8\x27\x88\x8e\x63\x21"
+		  "\x94\xda\x0c\x3d\x12\x20\x4d\x93"
+		  "\x62\x33\x7c\x94\x69\x4c\xe6\x61"
+		  "\x80\x5f\xe7\xc5\x98\xf5\xf7\x04"
+		  "\x81\x02\xb2\xf3\xff\x9a\xe8\x51"
+		  "\xca\xa0\x9c\x4f\xb5\xd8\x7b\x58"
+		  "\x1a\x36\xe9\xcd\xd8\x00\x2a\x05"
+		  "\x80\x87\x09\x66\x93\xc5\xc2\xbf"
+		  "\x27\x9a\x0b\x40\xb1\x37\x39\x91"
+		  "\xcf\x99\x64\xd6\xf8\xb7\x03\xba"
+		  "\xf3\xeb\xef\x4e\xed\xaa\x50\x5f"
+		  "\x03\x3c\x86\xcd\x5d\xd2\xe5\xe4"
+		  "\x38\x3c\x87\x78\x59\x7a\x75\x06"
+		  "\x15\x1f\xc6\xe7\x2f\x2a\x2e\x62"
+		  "\xa0\x3c\x13\x65\xa8\x06\xea\x1f"
+		  "\x5e\xab\xa4\xd5\x3f\x61\xf6\x05"
+		  "\x9a\x4e\x58\x50\x25\xba\x7c\x8a"
+		  "\x0e\x13\x7f\x5f\xc2\xef\x82\xe3"
+		  "\x77\x86\x14\x96\x67\xd9\x3c\x15"
+		  "\x7a\xac\x8d\x09\x37\x43\x57\x15"
+		  "\x4f\x0b\x41\x41\xa8\x7f\xfd\xb2"
+		  "\xea\x04\xc9\xf7\x2f\x75\x58\x71"
+		  "\x5c\x64\x0b\x39\x5c\xca\x3c\x9a"
+		  "\x6a\x5d\xf8\x3b\x14\x71\x9e\xed"
+		  "\x27\x90\x75\x4c\xcc\x5f\x9f\x8e"
+		  "\x87\x67\x0f\x4c\xed\x9c\x07\xf4",
+		.ilen	= 512,
+		.result	= "\x4f\x47\x86\xa1\xd6\x57\x1a\x4c"
+		  "\x14\xeb\xfc\xea\xed\x96\x28\x72"
+		  "\x54\x1d\xa8\xf5\xae\x88\x69\x60"
+		  "\x57\xc4\x53\x6c\xb3\xa2\x05\x77"
+		  "\x7f\x8e\x92\x8d\xd6\x7a\x90\x73"
+		  "\x09\x9e\xca\xb8\x2a\x5b\xed\x86"
+		  "\xbb\x63\x81\x33\x9c\xaa\xe6\x59"
+		  "\x05\x83\xd6\x45\xa9\xdd\xc1\xb0"
+		  "\x94\x11\xf0\xb5\xa4\xa4\xc2\x68"
+		  "\x0e\xbc\x35\x81\x84\xfc\xba\x34"
+		  "\x50\x62\xc7\x9f\xd1\xb0\x55\x27"
+		  "\x86\x90\xe5\xb4\x96\x56\xf0\x29"
+		  "\xc5\xe5\x01\x0e\xc7\xad\xc7\x26"
+		  "\x12\xf2\x0a\xbb\x24\x71\x73\x42"
+		  "\xb1\x95\xd6\xea\x42\x7d\xbf\xd7"
+		  "\xc6\x52\x64\x9a\xc3\x25\x2b\x57"
+		  "\xeb\xed\xfb\x8b\xc3\x8b\xbc\x63"
+		  "\x29\x7c\x34\xb0\x97\xfb\x12\xe9"
+		  "\x4f\xed\x20\xcb\x28\x1a\x8d\x6b"
+		  "\x6e\x40\xd0\x03\xf3\xd7\x3d\x57"
+		  "\xff\x7e\x4f\xc8\x5d\xd1\xeb\x30"
+		  "\x29\x21\x2e\xdf\x40\x29\xa5\x53"
+		  "\x48\x41\xfe\x1c\x57\x2e\xf9\xaf"
+		  "\x69\xe6\x1a\xbb\x89\x34\x15\x8a"
+		  "\x02\x21\x7d\x86\x3a\xc3\x96\x82"
+		  "\xd6\x36\x28\xdc\x22\xa0\xe7\x38"
+		  "\xbe\x35\xdb\xb4\x72\x6d\x45\x71"
+		  "\xa8\x2e\xb1\xc0\x16\xb7\x16\x52"
+		  "\x64\x92\x74\x0e\x9a\xd5\x06\xa8"
+		  "\xb9\x02\xb6\x77\x5d\xcc\xd7\x7d"
+		  "\x45\x9e\x72\x92\xeb\x60\x76\x1e"
+		  "\x15\x8e\xb5\x97\x70\x35\x55\x19"
+		  "\xc4\xf6\xd1\xd0\x84\xa1\xcf\x19"
+		  "\x9d\x3f\x20\xa6\x58\xc9\x5e\x27"
+		  "\xea\xaa\xda\xc3\x2b\x1d\xcc\x60"
+		  "\x7c\x19\x2a\x20\xed\x2e\x82\xe1"
+		  "\x28\x0a\xd7\xe5\x38\x03\x64\xdb"
+		  "\x92\x50\x21\xa8\xae\xdf\x75\x88"
+		  "\xd9\x4d\x94\x54\xff\x77\xe0\xeb"
+		  "\xfc\x12\x13\x1d\xad\xa2\x99\x3b"
+		  "\x06\x2a\x3e\x09\x62\xd4\xd3\xa5"
+		  "\x06\xa6\xe4\x45\x8a\x25\xbc\x60"
+		  "\xd1\x9e\x6e\xea\x99\x78\x3d\xac"
+		  "\xb5\x6b\x6a\x3c\x02\x4f\x68\x59"
+		  "\x42\xed\x61\x6c\x64\x02\x12\x6a"
+		  "\xc1\xc0\xff\xc2\x2c\xf0\x53\x3e"
+		  "\xc5\x14\xf6\x17\xa8\x69\x5b\xd3"
+		  "\xd7\xf6\x10\x1d\xc4\x56\x5f\x2f"
+		  "\x2d\x83\xea\x25\xe0\x33\xca\x2d"
+		  "\x42\x69\x15\xd7\xff\x49\xb5\x35"
+		  "\xab\x96\x7a\xb6\x21\x65\x67\x46"
+		  "\x18\x25\x58\x6f\x5c\xe0\x7d\x7d"
+		  "\xf1\xcc\xde\x8e\xbd\xa3\x9d\x68"
+		  "\xe7\xcb\x2d\x2b\xae\x3f\x06\x19"
+		  "\x21\xa3\x2b\xba\x00\xe2\x2e\xc1"
+		  "\x43\x69\xfe\xbe\x35\x8d\x14\x02"
+		  "\xea\x64\x30\xc4\x4f\xbf\xc9\x83"
+		  "\x31\x43\x5d\x71\xec\x97\x41\x8e"
+		  "\x6b\x77\x89\x16\xc5\x10\x41\x56"
+		  "\x0c\xbd\x38\x57\x46\x62\xe2\x59"
+		  "\xd7\x69\x48\x20\xd8\x01\xaf\xad"
+		  "\xda\xcf\xdb\xb3\xf9\x2c\xfe\xa4"
+		  "\x5a\xff\x19\x70\xfd\x68\xa7\x41"
+		  "\xac\xd2\x70\x59\xc9\x68\x32\x86",
+		.rlen	= 512,
+		.also_non_np = 1,
+		.np	= 3,
+		.tap	= { 32, 200, 280 },
+	}
+};
+
+#define ADIANTUM_XCHACHA20_AES_DEC_TEST_VECTORS 3
+
+static struct cipher_testvec adiantum_xchacha20_aes_dec_tv_template[] = {
+	{
+		.key	= "\xbe\x57\x70\xd8\xa9\x5d\x0d\x67"
+		  "\x3d\xac\xe9\x4a\xce\x8d\x78\x42"
+		  "\x92\xc4\x26\x6f\x26\x23\xf7\x55"
+		  "\xc2\x30\xa1\xb1\xd4\xff\xe9\x54",
+		.klen	= 32,
+		.iv	= "\xae\xad\x02\x66\xe8\x41\x61\x9d"
+		  "\xae\x51\x34\x06\x98\x35\x71\x43"
+		  "\x27\x39\x7d\x69\x01\x6e\x67\xa9"
+		  "\xaf\x84\x23\xa1\xbe\x08\xd7\xbc",
+		.input	= "\xc3\x67\x7b\xc0\xbd\x0c\xc4\x92"
+		  "\x9d\x0b\xa8\xc5\x54\x72\xe3\x23",
+		.ilen	= 16,
+		.result	= "\x84\x1d\xde\x3e\x18\x0a\x6e\x25"
+		  "\xe5\x6d\x91\xb4\xa6\x56\x39\x09",
+		.rlen	= 16,
+	}, {
+		.key	= "\x91\x86\x9f\xea\xe1\x94\xed\xcf"
+		  "\x19\x56\x91\xa0\x86\x66\x77\x8b"
+		  "\xca\x81\x96\xd9\xeb\x55\x64\xf5"
+		  "\xcd\xe3\x2d\x6e\xbf\x38\xf8\x30",
+		.klen	= 32,
+		.iv	= "\x0e\x7e\x8c\x55\x68\x81\xa8\xc3"
+		  "\x2c\x6d\xd4\xa8\x34\x2d\xcd\x72"
+		  "\x57\x2c\x06\xef\x74\x2e\xd6\x56"
+		  "\xeb\x01\xe0\x6e\x95\x16\x18\xed",
+		.input	= "\x32\xa5\x51\x17\xb2\xa0\x9b\x52"
+		  "\x90\x01\x5d\x67\x7c\x13\xf2\x21"
+		  "\x5c\x40\xde\xfe\x05\x3f\x35\xa3"
+		  "\x7b\xdc\x6f\x8f\x94\x1d\x26\x36"
+		  "\xd9\xaa\xa8\x87\xb5\xc2\x28\xb0"
+		  "\xb1\x98\xc5\xaf\x97\x65\x4f\x5d",
+		.ilen	= 48,
+		.result	= "\xc3\xb7\xdc\xae\x2f\x34\x4f\x7f"
+		  "\xe6\xb0\x0d\x51\xb1\x64\xf5\x01"
+		  "\x82\xc8\xf7\x5e\xc3\xcd\x9a\xe2"
+		  "\xd3\x6e\x84\x1a\x3a\xa0\xd9\xec"
+		  "\xd6\x9f\x4e\xdc\x8b\xa1\x18\x85"
+		  "\xa1\x8a\xc8\xf1\x5f\x3c\xb7\xb2",
+		.rlen	= 48,
+	}, {
+		.key	= "\xc7\x4b\x1a\xc8\x5a\x71\xc8\x7f"
+		  "\x3e\x31\x3f\xd3\xde\x81\x2f\x08"
+		  "\x78\x4f\x60\x57\x2c\x92\x3a\xf5"
+		  "\x1f\xf6\x61\xcc\x56\x05\xa9\x32",
+		.klen	= 32,
+		.iv	= "\xa8\x37\xbe\xdd\xd0\x61\xac\xf6"
+		  "\x77\x46\x7e\xb7\x72\x08\x86\x75"
+		  "\xce\x13\xcd\xcf\x78\x32\x33\x70"
+		  "\x40\x77\x72\x40\x5f\xc3\x14\x04",
+		.input	= "\x4f\x47\x86\xa1\xd6\x57\x1a\x4c"
+		  "\x14\xeb\xfc\xea\xed\x96\x28\x72"
+		  "\x54\x1d\xa8\xf5\xae\x88\x69\x60"
+		  "\x57\xc4\x53\x6c\xb3\xa2\x05\x77"
+		  "\x7f\x8e\x92\x8d\xd6\x7a\x90\x73"
+		  "\x09\x9e\xca\xb8\x2a\x5b\xed\x86"
+		  "\xbb\x63\x81\x33\x9c\xaa\xe6\x59"
+		  "\x05\x83\xd6\x45\xa9\xdd\xc1\xb0"
+		  "\x94\x11\xf0\xb5\xa4\xa4\xc2\x68"
+		  "\x0e\xbc\x35\x81\x84\xfc\xba\x34"
+		  "\x50\x62\xc7\x9f\xd1\xb0\x55\x27"
+		  "\x86\x90\xe5\xb4\x96\x56\xf0\x29"
+		  "\xc5\xe5\x01\x0e\xc7\xad\xc7\x26"
+		  "\x12\xf2\x0a\xbb\x24\x71\x73\x42"
+		  "\xb1\x95\xd6\xea\x42\x7d\xbf\xd7"
+		  "\xc6\x52\x64\x9a\xc3\x25\x2b\x57"
+		  "\xeb\xed\xfb\x8b\xc3\x8b\xbc\x63"
+		  "\x29\x7c\x34\xb0\x97\xfb\x12\xe9"
+		  "\x4f\xed\x20\xcb\x28\x1a\x8d\x6b"
+		  "\x6e\x40\xd0\x03\xf3\xd7\x3d\x57"
+		  "\xff\x7e\x4f\xc8\x5d\xd1\xeb\x30"
+		  "\x29\x21\x2e\xdf\x40\x29\xa5\x53"
+		  "\x48\x41\xfe\x1c\x57\x2e\xf9\xaf"
+		  "\x69\xe6\x1a\xbb\x89\x34\x15\x8a"
+		  "\x02\x21\x7d\x86\x3a\xc3\x96\x82"
+		  "\xd6\x36\x28\xdc\x22\xa0\xe7\x38"
+		  "\xbe\x35\xdb\xb4\x72\x6d\x45\x71"
+		  "\xa8\x2e\xb1\xc0\x16\xb7\x16\x52"
+		  "\x64\x92\x74\x0e\x9a\xd5\x06\xa8"
+		  "\xb9\x02\xb6\x77\x5d\xcc\xd7\x7d"
+		  "\x45\x9e\x72\x92\xeb\x60\x76\x1e"
+		  "\x15\x8e\xb5\x97\x70\x35\x55\x19"
+		  "\xc4\xf6\xd1\xd0\x84\xa1\xcf\x19"
+		  "\x9d\x3f\x20\xa6\x58\xc9\x5e\x27"
+		  "\xea\xaa\xda\xc3\x2b\x1d\xcc\x60"
+		  "\x7c\x19\x2a\x20\xed\x2e\x82\xe1"
+		  "\x28\x0a\xd7\xe5\x38\x03\x64\xdb"
+		  "\x92\x50\x21\xa8\xae\xdf\x75\x88"
+		  "\xd9\x4d\x94\x54\xff\x77\xe0\xeb"
+		  "\xfc\x12\x13\x1d\xad\xa2\x99\x3b"
+		  "\x06\x2a\x3e\x09\x62\xd4\xd3\xa5"
+		  "\x06\xa6\xe4\x45\x8a\x25\xbc\x60"
+		  "\xd1\x9e\x6e\xea\x99\x78\x3d\xac"
+		  "\xb5\x6b\x6a\x3c\x02\x4f\x68\x59"
+		  "\x42\xed\x61\x6c\x64\x02\x12\x6a"
+		  "\xc1\xc0\xff\xc2\x2c\xf0\x53\x3e"
+		  "\xc5\x14\xf6\x17\xa8\x69\x5b\xd3"
+		  "\xd7\xf6\x10\x1d\xc4\x56\x5f\x2f"
+		  "\x2d\x83\xea\x25\xe0\x33\xca\x2d"
+		  "\x42\x69\x15\xd7\xff\x49\xb5\x35"
+		  "\xab\x96\x7a\xb6\x21\x65\x67\x46"
+		  "\x18\x25\x58\x6f\x5c\xe0\x7d\x7d"
+		  "\xf1\xcc\xde\x8e\xbd\xa3\x9d\x68"
+		  "\xe7\xcb\x2d\x2b\xae\x3f\x06\x19"
+		  "\x21\xa3\x2b\xba\x00\xe2\x2e\xc1"
+		  "\x43\x69\xfe\xbe\x35\x8d\x14\x02"
+		  "\xea\x64\x30\xc4\x4f\xbf\xc9\x83"
+		  "\x31\x43\x5d\x71\xec\x97\x41\x8e"
+		  "\x6b\x77\x89\x16\xc5\x10\x41\x56"
+		  "\x0c\xbd\x38\x57\x46\x62\xe2\x59"
+		  "\xd7\x69\x48\x20\xd8\x01\xaf\xad"
+		  "\xda\xcf\xdb\xb3\xf9\x2c\xfe\xa4"
+		  "\x5a\xff\x19\x70\xfd\x68\xa7\x41"
+		  "\xac\xd2\x70\x59\xc9\x68\x32\x86",
+		.ilen	= 512,
+		.result	= "\xf6\x7a\xa1\x1e\xc4\x8b\x25\xfd"
+		  "\x82\x7d\x62\xea\x56\x67\x8b\x26"
+		  "\xa6\x3b\x56\xc0\x2e\x18\xc9\xb0"
+		  "\x41\x2f\xff\xbb\xb0\xb7\xf1\xb0"
+		  "\x63\x9f\x7e\xa9\x00\x8b\xa6\x17"
+		  "\x62\x34\xf4\xb9\xef\x01\xd8\xf9"
+		  "\x26\x43\xaa\xaa\x36\x77\x9f\xc8"
+		  "\x30\x67\xcf\xd8\x3d\x60\xc3\x7a"
+		  "\x6e\x4c\x19\xfa\xc3\x17\x7f\x18"
+		  "\x77\xab\xbf\xce\xa1\x0a\x2f\x7e"
+		  "\x96\x54\x9a\x92\x33\x96\x46\x28"
+		  "\x4e\xf7\x9e\x61\x42\x7a\xfd\x99"
+		  "\xd4\xeb\x08\x49\x32\xc7\x35\xc6"
+		  "\xb1\x64\x7d\x4b\xae\x42\x85\xe4"
+		  "\x62\x90\xcf\x1b\x22\x69\x96\x9a"
+		  "\x9d\x80\x10\x1c\xbe\x16\x2e\x3e"
+		  "\x11\x61\xd0\x89\xb3\xca\x49\x25"
+		  "\xaf\xe2\x14\xca\x3e\x0f\x01\x91"
+		  "\x5e\xce\xc7\x9e\x11\xce\x9a\x33"
+		  "\x98\x3c\x73\x8c\x7e\xb0\x85\xde"
+		  "\x4c\x77\x2a\x96\xb9\x53\x8e\xc1"
+		  "\x96\x0b\x60\xec\x39\xdb\x17\x15"
+		  "\x4d\x04\x69\x1c\xba\x24\xa5\x43"
+		  "\xcb\x98\x8e\x36\xd8\xf8\xc4\x7c"
+		  "\xc5\x03\x2e\x32\x6f\xf3\x0b\xc3"
+		  "\x83\x22\x12\x81\x23\xed\x1a\x73"
+		  "\xca\xe4\x56\x27\x54\xb7\x6a\x18"
+		  "\x19\x9e\x7a\x14\x4c\x41\x0e\x5d"
+		  "\x6e\xfa\x73\xb9\xeb\x95\xce\x7f"
+		  "\xda\x67\xdb\x3f\xa0\xaf\x66\xfe"
+		  "\x89\x72\x89\x1e\x8e\x46\xb3\x02"
+		  "\x01\x2f\x43\x91\x99\x7b\x99\xc0"
+		  "\xda\x38\xee\xdd\x11\x75\x10\xb7"
+		  "\xc2\x80\xe1\x3f\xb4\xdb\x66\x5e"
+		  "\xb4\xde\xce\xe6\x4b\x95\xd7\x25"
+		  "\x3b\xd2\x72\xc0\xb4\xef\x2c\xa6"
+		  "\x4b\xe5\x9b\x4a\xdf\x94\xa7\x29"
+		  "\xd2\x8e\xf5\x54\x41\x66\xb8\x52"
+		  "\x03\x4a\xe8\x27\x88\x8e\x63\x21"
+		  "\x94\xda\x0c\x3d\x12\x20\x4d\x93"
+		  "\x62\x33\x7c\x94\x69\x4c\xe6\x61"
+		  "\x80\x5f\xe7\xc5\x98\xf5\xf7\x04"
+		  "\x81\x02\xb2\xf3\xff\x9a\xe8\x51"
+		  "\xca\xa0\x9c\x4f\xb5\xd8\x7b\x58"
+		  "\x1a\x36\xe9\xcd\xd8\x00\x2a\x05"
+		  "\x80\x87\x09\x66\x93\xc5\xc2\xbf"
+		  "\x27\x9a\x0b\x40\xb1\x37\x39\x91"
+		  "\xcf\x99\x64\xd6\xf8\xb7\x03\xba"
+		  "\xf3\xeb\xef\x4e\xed\xaa\x50\x5f"
+		  "\x03\x3c\x86\xcd\x5d\xd2\xe5\xe4"
+		  "\x38\x3c\x87\x78\x59\x7a\x75\x06"
+		  "\x15\x1f\xc6\xe7\x2f\x2a\x2e\x62"
+		  "\xa0\x3c\x13\x65\xa8\x06\xea\x1f"
+		  "\x5e\xab\xa4\xd5\x3f\x61\xf6\x05"
+		  "\x9a\x4e\x58\x50\x25\xba\x7c\x8a"
+		  "\x0e\x13\x7f\x5f\xc2\xef\x82\xe3"
+		  "\x77\x86\x14\x96\x67\xd9\x3c\x15"
+		  "\x7a\xac\x8d\x09\x37\x43\x57\x15"
+		  "\x4f\x0b\x41\x41\xa8\x7f\xfd\xb2"
+		  "\xea\x04\xc9\xf7\x2f\x75\x58\x71"
+		  "\x5c\x64\x0b\x39\x5c\xca\x3c\x9a"
+		  "\x6a\x5d\xf8\x3b\x14\x71\x9e\xed"
+		  "\x27\x90\x75\x4c\xcc\x5f\x9f\x8e"
+		  "\x87\x67\x0f\x4c\xed\x9c\x07\xf4",
+		.rlen	= 512,
+		.also_non_np = 1,
+		.np	= 3,
+		.tap	= { 32, 200, 280 },
+	}
+};
+
 /*
  * CTS (Cipher Text Stealing) mode tests
  */
@@ -29593,4 +31228,78 @@ static const struct comp_testvec lz4hc_decomp_tv_template[] = {
 	},
 };
 
+/*
+ * Zstd test vectors, compressed at the default level 3.
+ */
+#define ZSTD_COMP_TEST_VECTORS 2
+#define ZSTD_DECOMP_TEST_VECTORS 2
+
+static struct comp_testvec zstd_comp_tv_template[] = {
+	{
+		.inlen	= 68,
+		.outlen	= 39,
+		.input	= "The algorithm is zstd. "
+			  "The algorithm is zstd. "
+			  "The algorithm is zstd.",
+		.output	= "\x28\xb5\x2f\xfd\x20\x44\xf5\x00\x00\xb8\x54\x68\x65"
+			  "\x20\x61\x6c\x67\x6f\x72\x69\x74\x68\x6d\x20\x69\x73"
+			  "\x20\x7a\x73\x74\x64\x2e\x20\x01\x00\x55\x73\x36\x01",
+	}, {
+		.inlen	= 232,
+		.outlen	= 165,
+		.input	= "zstd, short for Zstandard, is a fast lossless "
+			  "compression algorithm, targeting real-time "
+			  "compression scenarios at zlib-level and better "
+			  "compression ratios. It's backed by a very fast "
+			  "entropy stage, provided by Huff0 and FSE library.",
+		.output	= "\x28\xb5\x2f\xfd\x20\xe8\xe5\x04\x00\xd2\x0b\x22\x1c"
+			  "\x70\x49\xd3\x06\x01\x1d\x65\xd9\x2e\x19\x1c\xf2\x66"
+			  "\x97\x58\x4b\x10\xf0\xc8\x01\x1e\xf1\x73\x57\x00\x55"
+			  "\xfc\x02\x85\x45\x4b\xcf\xa1\x05\x0c\x06\x02\x0c\x23"
+			  "\x81\x00\x9d\x92\x9a\xd8\xd8\x51\x7b\x2f\x49\xea\x26"
+			  "\x5b\xd4\x14\x97\x97\x63\x64\x08\x45\x1d\x1f\x60\x0b"
+			  "\x5c\x78\xde\x96\xaa\xed\xda\x31\x4a\x65\x34\xc5\x90"
+			  "\x38\x87\x07\x6f\xf9\x79\x5a\xc9\x8a\x1b\x72\x4b\x60"
+			  "\x99\xfa\x48\xb7\x76\x68\xad\x0d\x62\xd8\xd3\x3c\xb0"
+			  "\x9c\xf2\x7e\xd3\x04\xc9\xc2\xbf\xe1\x9f\xe8\x7d\x19"
+			  "\x2e\xff\x6c\x90\x16\x4a\xb5\x3f\xb0\xa6\xe1\xd5\x34"
+			  "\xdc\x06\xed\x0f\x01\x05\x00\x5e\x10\xba\xd2\xc1\xaa"
+			  "\x98\xc1\x49\xaa\xe3\x31\x77\x28\x33",
+	},
+};
+
+static struct comp_testvec zstd_decomp_tv_template[] = {
+	{
+		.inlen	= 39,
+		.outlen	= 68,
+		.input	= "\x28\xb5\x2f\xfd\x20\x44\xf5\x00\x00\xb8\x54\x68\x65"
+			  "\x20\x61\x6c\x67\x6f\x72\x69\x74\x68\x6d\x20\x69\x73"
+			  "\x20\x7a\x73\x74\x64\x2e\x20\x01\x00\x55\x73\x36\x01",
+		.output	= "The algorithm is zstd. "
+			  "The algorithm is zstd. "
+			  "The algorithm is zstd.",
+	}, {
+		.inlen	= 165,
+		.outlen	= 232,
+		.input	= "\x28\xb5\x2f\xfd\x20\xe8\xe5\x04\x00\xd2\x0b\x22\x1c"
+			  "\x70\x49\xd3\x06\x01\x1d\x65\xd9\x2e\x19\x1c\xf2\x66"
+			  "\x97\x58\x4b\x10\xf0\xc8\x01\x1e\xf1\x73\x57\x00\x55"
+			  "\xfc\x02\x85\x45\x4b\xcf\xa1\x05\x0c\x06\x02\x0c\x23"
+			  "\x81\x00\x9d\x92\x9a\xd8\xd8\x51\x7b\x2f\x49\xea\x26"
+			  "\x5b\xd4\x14\x97\x97\x63\x64\x08\x45\x1d\x1f\x60\x0b"
+			  "\x5c\x78\xde\x96\xaa\xed\xda\x31\x4a\x65\x34\xc5\x90"
+			  "\x38\x87\x07\x6f\xf9\x79\x5a\xc9\x8a\x1b\x72\x4b\x60"
+			  "\x99\xfa\x48\xb7\x76\x68\xad\x0d\x62\xd8\xd3\x3c\xb0"
+			  "\x9c\xf2\x7e\xd3\x04\xc9\xc2\xbf\xe1\x9f\xe8\x7d\x19"
+			  "\x2e\xff\x6c\x90\x16\x4a\xb5\x3f\xb0\xa6\xe1\xd5\x34"
+			  "\xdc\x06\xed\x0f\x01\x05\x00\x5e\x10\xba\xd2\xc1\xaa"
+			  "\x98\xc1\x49\xaa\xe3\x31\x77\x28\x33",
+		.output	= "zstd, short for Zstandard, is a fast lossless "
+			  "compression algorithm, targeting real-time "
+			  "compression scenarios at zlib-level and better "
+			  "compression ratios. It's backed by a very fast "
+			  "entropy stage, provided by Huff0 and FSE library.",
+	},
+};
+
 #endif	/* _CRYPTO_TESTMGR_H */
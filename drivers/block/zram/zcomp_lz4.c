@@ -8,6 +8,7 @@
  */
 
 #include <linux/kernel.h>
+#include <linux/module.h>
 #include <linux/slab.h>
 #include <linux/lz4.h>
 #include <linux/vmalloc.h>
@@ -15,6 +16,14 @@
 
 #include "zcomp_lz4.h"
 
+/*
+ * Higher values trade compression ratio for compression speed, each
+ * step skipping more of the input when no match is found.
+ */
+static int lz4_acceleration = LZ4_ACCELERATION_DEFAULT;
+module_param(lz4_acceleration, int, 0644);
+MODULE_PARM_DESC(lz4_acceleration, "LZ4 acceleration factor, 1 is the default LZ4 speed/ratio");
+
 static void *zcomp_lz4_create(gfp_t flags)
 {
 	void *ret;
@@ -35,16 +44,27 @@ static void zcomp_lz4_destroy(void *private)
 static int zcomp_lz4_compress(const unsigned char *src, unsigned char *dst,
 		size_t *dst_len, void *private)
 {
-	/* return  : Success if return 0 */
-	return lz4_compress(src, PAGE_SIZE, dst, dst_len, private);
+	int ret;
+
+	/* the stream buffer is two pages, larger than the worst case */
+	ret = LZ4_compress_fast(src, dst, PAGE_SIZE,
+				LZ4_COMPRESSBOUND(PAGE_SIZE),
+				ACCESS_ONCE(lz4_acceleration), private);
+	if (!ret)
+		return -1;
+	*dst_len = ret;
+	return 0;
 }
 
 static int zcomp_lz4_decompress(const unsigned char *src, size_t src_len,
 		unsigned char *dst)
 {
-	size_t dst_len = PAGE_SIZE;
-	/* return  : Success if return 0 */
-	return lz4_decompress_unknownoutputsize(src, src_len, dst, &dst_len);
+	int ret;
+
+	ret = LZ4_decompress_safe(src, dst, src_len, PAGE_SIZE);
+	if (ret != PAGE_SIZE)
+		return -1;
+	return 0;
 }
 
 struct zcomp_backend zcomp_lz4 = {
@@ -0,0 +1,163 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/percpu.h>
+#include <linux/zstd.h>
+
+#include "zcomp_zstd.h"
+
+/*
+ * The level is fixed when a stream is created since the workspace is
+ * sized for it; pages being small, even high levels only need a small
+ * window.
+ */
+static int zstd_level = 1;
+module_param(zstd_level, int, 0444);
+MODULE_PARM_DESC(zstd_level, "Zstd compression level used by new zram streams");
+
+struct zcomp_zstd {
+	zstd_cctx *cctx;
+	zstd_parameters params;
+	void *wksp;
+};
+
+/*
+ * Decompression is called with the table entry bit spinlock held and
+ * without a compression stream, so it uses a per-cpu context instead.
+ * The contexts are allocated along with the first compression stream
+ * and freed with the last one.
+ */
+static DEFINE_MUTEX(zstd_dctx_lock);
+static int zstd_dctx_users;
+static DEFINE_PER_CPU(zstd_dctx *, zstd_dctxs);
+
+static void zstd_free_dctx(void)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		vfree(per_cpu(zstd_dctxs, cpu));
+		per_cpu(zstd_dctxs, cpu) = NULL;
+	}
+}
+
+static int zstd_get_dctx(gfp_t flags)
+{
+	size_t size = zstd_dctx_workspace_bound();
+	int cpu, ret = 0;
+
+	mutex_lock(&zstd_dctx_lock);
+	if (zstd_dctx_users++)
+		goto out;
+
+	for_each_possible_cpu(cpu) {
+		void *wksp = __vmalloc(size, flags | __GFP_HIGHMEM,
+				       PAGE_KERNEL);
+
+		/* the context lives at the start of its workspace */
+		if (!wksp || !zstd_init_dctx(wksp, size)) {
+			vfree(wksp);
+			zstd_free_dctx();
+			zstd_dctx_users--;
+			ret = -ENOMEM;
+			goto out;
+		}
+		per_cpu(zstd_dctxs, cpu) = wksp;
+	}
+out:
+	mutex_unlock(&zstd_dctx_lock);
+	return ret;
+}
+
+static void zstd_put_dctx(void)
+{
+	mutex_lock(&zstd_dctx_lock);
+	if (!--zstd_dctx_users)
+		zstd_free_dctx();
+	mutex_unlock(&zstd_dctx_lock);
+}
+
+static void *zcomp_zstd_create(gfp_t flags)
+{
+	struct zcomp_zstd *zstd;
+	size_t size;
+
+	zstd = kzalloc(sizeof(*zstd), flags);
+	if (!zstd)
+		return NULL;
+
+	zstd->params = zstd_get_params(zstd_level, PAGE_SIZE);
+	size = zstd_cctx_workspace_bound(&zstd->params.cParams);
+	zstd->wksp = __vmalloc(size, flags | __GFP_HIGHMEM, PAGE_KERNEL);
+	if (!zstd->wksp)
+		goto out_free;
+
+	zstd->cctx = zstd_init_cctx(zstd->wksp, size);
+	if (!zstd->cctx)
+		goto out_free;
+
+	if (zstd_get_dctx(flags))
+		goto out_free;
+
+	return zstd;
+
+out_free:
+	vfree(zstd->wksp);
+	kfree(zstd);
+	return NULL;
+}
+
+static void zcomp_zstd_destroy(void *private)
+{
+	struct zcomp_zstd *zstd = private;
+
+	zstd_put_dctx();
+	vfree(zstd->wksp);
+	kfree(zstd);
+}
+
+static int zcomp_zstd_compress(const unsigned char *src, unsigned char *dst,
+		size_t *dst_len, void *private)
+{
+	struct zcomp_zstd *zstd = private;
+	size_t ret;
+
+	/* the stream buffer is two pages, larger than the worst case */
+	ret = zstd_compress_cctx(zstd->cctx, dst, zstd_compress_bound(PAGE_SIZE),
+				 src, PAGE_SIZE, &zstd->params);
+	if (zstd_is_error(ret))
+		return -1;
+	*dst_len = ret;
+	return 0;
+}
+
+static int zcomp_zstd_decompress(const unsigned char *src, size_t src_len,
+		unsigned char *dst)
+{
+	zstd_dctx *dctx = get_cpu_var(zstd_dctxs);
+	size_t ret;
+
+	ret = zstd_decompress_dctx(dctx, dst, PAGE_SIZE, src, src_len);
+	put_cpu_var(zstd_dctxs);
+	if (ret != PAGE_SIZE)
+		return -1;
+	return 0;
+}
+
+struct zcomp_backend zcomp_zstd = {
+	.compress = zcomp_zstd_compress,
+	.decompress = zcomp_zstd_decompress,
+	.create = zcomp_zstd_create,
+	.destroy = zcomp_zstd_destroy,
+	.name = "zstd",
+};
@@ -53,6 +53,7 @@
 
 #include <asm/cacheflush.h>
 #include <linux/atomic.h>
+#include <linux/delayacct.h>
 #include <linux/fdtable.h>
 #include <linux/file.h>
 #include <linux/freezer.h>
@@ -3951,7 +3952,18 @@ retry:
 		if (!binder_has_work(thread, wait_for_proc_work))
 			ret = -EAGAIN;
 	} else {
+		/*
+		 * A thread with a transaction in flight that is not
+		 * available for process work is waiting for a reply.
+		 */
+		bool in_reply_wait = !wait_for_proc_work &&
+				     thread->transaction_stack;
+
+		if (in_reply_wait)
+			delayacct_binder_start();
 		ret = binder_wait_for_work(thread, wait_for_proc_work);
+		if (in_reply_wait)
+			delayacct_binder_end();
 	}
 
 	thread->looper &= ~BINDER_LOOPER_STATE_WAITING;
@@ -140,7 +140,7 @@ int fscrypt_do_page_crypto(const struct inode *inode, fscrypt_direction_t rw,
 {
 	struct {
 		__le64 index;
-		u8 padding[FS_IV_SIZE - sizeof(__le64)];
+		u8 padding[FSCRYPT_MAX_IV_SIZE - sizeof(__le64)];
 	} iv;
 	struct ablkcipher_request *req = NULL;
 	DECLARE_CRYPTO_WAIT(wait);
@@ -151,7 +151,7 @@ int fscrypt_do_page_crypto(const struct inode *inode, fscrypt_direction_t rw,
 
 	BUG_ON(len == 0);
 
-	BUILD_BUG_ON(sizeof(iv) != FS_IV_SIZE);
+	BUILD_BUG_ON(sizeof(iv) != FSCRYPT_MAX_IV_SIZE);
 	BUILD_BUG_ON(AES_BLOCK_SIZE != FS_IV_SIZE);
 	iv.index = cpu_to_le64(lblk_num);
 	memset(iv.padding, 0, sizeof(iv.padding));
@@ -41,7 +41,7 @@ int fname_encrypt(struct inode *inode, const struct qstr *iname,
 	DECLARE_CRYPTO_WAIT(wait);
 	struct crypto_ablkcipher *tfm = inode->i_crypt_info->ci_ctfm;
 	int res = 0;
-	char iv[FS_CRYPTO_BLOCK_SIZE];
+	char iv[FSCRYPT_MAX_IV_SIZE];
 	struct scatterlist sg;
 
 	/*
@@ -54,7 +54,7 @@ int fname_encrypt(struct inode *inode, const struct qstr *iname,
 	memset(out + iname->len, 0, olen - iname->len);
 
 	/* Initialize the IV */
-	memset(iv, 0, FS_CRYPTO_BLOCK_SIZE);
+	memset(iv, 0, FSCRYPT_MAX_IV_SIZE);
 
 	/* Set up the encryption request */
 	req = ablkcipher_request_alloc(tfm, GFP_NOFS);
@@ -95,7 +95,7 @@ static int fname_decrypt(struct inode *inode,
 	struct scatterlist src_sg, dst_sg;
 	struct crypto_ablkcipher *tfm = inode->i_crypt_info->ci_ctfm;
 	int res = 0;
-	char iv[FS_CRYPTO_BLOCK_SIZE];
+	char iv[FSCRYPT_MAX_IV_SIZE];
 
 	/* Allocate request */
 	req = ablkcipher_request_alloc(tfm, GFP_NOFS);
@@ -106,7 +106,7 @@ static int fname_decrypt(struct inode *inode,
 		crypto_req_done, &wait);
 
 	/* Initialize IV */
-	memset(iv, 0, FS_CRYPTO_BLOCK_SIZE);
+	memset(iv, 0, FSCRYPT_MAX_IV_SIZE);
 
 	/* Create decryption request */
 	sg_init_one(&src_sg, iname->name, iname->len);
@@ -17,6 +17,7 @@
 
 /* Encryption parameters */
 #define FS_IV_SIZE			16
+#define FSCRYPT_MAX_IV_SIZE		32
 #define FS_KEY_DERIVATION_NONCE_SIZE	16
 
 /**
@@ -112,6 +113,10 @@ static inline bool fscrypt_valid_enc_modes(u32 contents_mode,
 	    filenames_mode == FS_ENCRYPTION_MODE_SPECK128_256_CTS)
 		return true;
 
+	if (contents_mode == FS_ENCRYPTION_MODE_ADIANTUM &&
+	    filenames_mode == FS_ENCRYPTION_MODE_ADIANTUM)
+		return true;
+
 	return false;
 }
 
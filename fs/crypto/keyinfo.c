@@ -195,6 +195,11 @@ static struct fscrypt_mode {
 		.cipher_str = "cts(cbc(speck128))",
 		.keysize = 32,
 	},
+	[FS_ENCRYPTION_MODE_ADIANTUM] = {
+		.friendly_name = "Adiantum",
+		.cipher_str = "adiantum(xchacha12,aes)",
+		.keysize = 32,
+	},
 };
 
 static struct fscrypt_mode *
@@ -823,6 +823,7 @@ do {									       \
 #endif /* defined(__KERNEL__) || defined(__linux__) */
 
 #include "extents_status.h"
+#include "fast_commit.h"
 
 /*
  * Lock subclasses for i_data_sem in the ext4_inode_info structure.
@@ -981,6 +982,16 @@ struct ext4_inode_info {
 	/* Precomputed uuid+inum+igen checksum for seeding inode checksums */
 	__u32 i_csum_seed;
 
+	/*
+	 * Fast commit tracking: entry on the s_fc_q list, the transaction
+	 * the tracked changes belong to and the logical block range they
+	 * touched.  Protected by s_fc_lock.
+	 */
+	struct list_head i_fc_list;
+	tid_t i_fc_tid;
+	ext4_lblk_t i_fc_lblk_start;
+	ext4_lblk_t i_fc_lblk_len;
+
 #ifdef CONFIG_EXT4_FS_ENCRYPTION
 	/* Encryption params */
 	struct ext4_crypt_info *i_crypt_info;
@@ -1046,6 +1057,8 @@ struct ext4_inode_info {
 						      blocks */
 #define EXT4_MOUNT2_HURD_COMPAT		0x00000004 /* Support HURD-castrated
 						      file systems */
+#define EXT4_MOUNT2_JOURNAL_FAST_COMMIT	0x00000008 /* Satisfy fsync with
+						      fast commits */
 
 #define clear_opt(sb, opt)		EXT4_SB(sb)->s_mount_opt &= \
 						~EXT4_MOUNT_##opt
@@ -1396,6 +1409,17 @@ struct ext4_sb_info {
 	struct ratelimit_state s_err_ratelimit_state;
 	struct ratelimit_state s_warning_ratelimit_state;
 	struct ratelimit_state s_msg_ratelimit_state;
+
+	/* Fast commits, see fast_commit.c */
+	struct list_head s_fc_q;	/* inodes with tracked changes */
+	struct list_head s_fc_dentry_q;	/* tracked namespace changes */
+	unsigned int s_fc_q_len;
+	bool s_fc_ineligible;
+	tid_t s_fc_ineligible_tid;
+	spinlock_t s_fc_lock;		/* protects the above */
+	struct mutex s_fc_mutex;	/* serializes fast commits */
+	void *s_fc_buf;			/* staging buffer for a run */
+	struct ext4_fc_stats s_fc_stats;
 };
 
 static inline struct ext4_sb_info *EXT4_SB(struct super_block *sb)
@@ -2254,6 +2278,8 @@ extern void ext4_mark_bitmap_end(int start_bit, int end_bit, char *bitmap);
 extern int ext4_init_inode_table(struct super_block *sb,
 				 ext4_group_t group, int barrier);
 extern void ext4_end_bitmap_read(struct buffer_head *bh, int uptodate);
+extern int ext4_mark_inode_used(handle_t *handle, struct super_block *sb,
+				unsigned long ino);
 
 /* mballoc.c */
 extern long ext4_mb_stats;
@@ -2275,6 +2301,8 @@ extern int ext4_mb_add_groupinfo(struct super_block *sb,
 		ext4_group_t i, struct ext4_group_desc *desc);
 extern int ext4_group_add_blocks(handle_t *handle, struct super_block *sb,
 				ext4_fsblk_t block, unsigned long count);
+extern int ext4_mb_mark_bb_used(handle_t *handle, struct super_block *sb,
+				ext4_fsblk_t block, unsigned long count);
 extern int ext4_trim_fs(struct super_block *, struct fstrim_range *,
 				unsigned long blkdev_flags);
 
@@ -2312,6 +2340,9 @@ extern int  ext4_sync_inode(handle_t *, struct inode *);
 extern void ext4_dirty_inode(struct inode *, int);
 extern int ext4_change_inode_journal_flag(struct inode *, int);
 extern int ext4_get_inode_loc(struct inode *, struct ext4_iloc *);
+extern int ext4_write_raw_inode(handle_t *handle, struct super_block *sb,
+				unsigned long ino, struct ext4_inode *raw,
+				int keep_blocks);
 extern int ext4_inode_attach_jinode(struct inode *inode);
 extern int ext4_can_truncate(struct inode *inode);
 extern void ext4_truncate(struct inode *);
@@ -2354,6 +2385,10 @@ extern int ext4_dirent_csum_verify(struct inode *inode,
 				   struct ext4_dir_entry *dirent);
 extern int ext4_orphan_add(handle_t *, struct inode *);
 extern int ext4_orphan_del(handle_t *, struct inode *);
+extern int ext4_fc_add_dentry(struct inode *dir, struct inode *inode,
+			      const struct qstr *name);
+extern int ext4_fc_del_dentry(struct inode *dir, unsigned long ino,
+			      const struct qstr *name);
 extern int ext4_htree_fill_tree(struct file *dir_file, __u32 start_hash,
 				__u32 start_minor_hash, __u32 *next_hash);
 extern int ext4_search_dir(struct buffer_head *bh,
@@ -2988,6 +3023,25 @@ extern int ext4_bio_write_page(struct ext4_io_submit *io,
 /* mmp.c */
 extern int ext4_multi_mount_protect(struct super_block *, ext4_fsblk_t);
 
+/* fast_commit.c */
+extern void ext4_fc_init(struct super_block *sb);
+extern void ext4_fc_init_inode(struct inode *inode);
+extern int ext4_fc_start(struct super_block *sb);
+extern void ext4_fc_stop(struct super_block *sb);
+extern void ext4_fc_track_inode(handle_t *handle, struct inode *inode);
+extern void ext4_fc_track_range(handle_t *handle, struct inode *inode,
+				ext4_lblk_t start, ext4_lblk_t end);
+extern void ext4_fc_track_create(handle_t *handle, struct dentry *dentry);
+extern void ext4_fc_track_link(handle_t *handle, struct dentry *dentry);
+extern void ext4_fc_track_unlink(handle_t *handle, struct dentry *dentry);
+extern void ext4_fc_mark_ineligible(struct super_block *sb, int reason,
+				    handle_t *handle);
+extern void ext4_fc_del(struct inode *inode);
+extern void ext4_fc_cleanup(journal_t *journal, tid_t tid);
+extern int ext4_fc_commit(journal_t *journal, struct inode *inode,
+			  tid_t commit_tid);
+extern void ext4_fc_replay(struct super_block *sb);
+
 /*
  * Note that these flags will never ever appear in a buffer_head's state flag.
  * See EXT4_MAP_... to see where this is used.
@@ -4659,6 +4659,7 @@ void ext4_ext_truncate(handle_t *handle, struct inode *inode)
 
 	last_block = (inode->i_size + sb->s_blocksize - 1)
 			>> EXT4_BLOCK_SIZE_BITS(sb);
+	ext4_fc_track_range(handle, inode, last_block, EXT_MAX_BLOCKS - 1);
 retry:
 	err = ext4_es_remove_extent(inode, last_block,
 				    EXT_MAX_BLOCKS - last_block);
@@ -5491,6 +5492,7 @@ int ext4_collapse_range(struct inode *inode, loff_t offset, loff_t len)
 		ret = PTR_ERR(handle);
 		goto out_dio;
 	}
+	ext4_fc_mark_ineligible(sb, EXT4_FC_REASON_EXTENT_SHIFT, handle);
 
 	down_write(&EXT4_I(inode)->i_data_sem);
 	ext4_discard_preallocations(inode);
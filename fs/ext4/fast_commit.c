@@ -0,0 +1,1289 @@
+/*
+ *  fs/ext4/fast_commit.c
+ *
+ * Ext4 fast commits.
+ *
+ * A full jbd2 commit writes every metadata block the running transaction
+ * touched, which makes fsync() of a small append cost a handful of journal
+ * blocks plus two cache flushes.  A fast commit instead logs a compact
+ * description of what the running transaction did to the tracked inodes:
+ * which logical ranges got mapped or unmapped, the raw inode images, and
+ * simple namespace changes.  After journal recovery, the last fast commit
+ * of the transaction that was running at the time of the crash is replayed
+ * on top of the recovered filesystem through ordinary handles.
+ *
+ * Operations whose effects cannot be described this way mark the running
+ * transaction ineligible, and fsync() falls back to a full commit of it.
+ */
+
+#include <linux/fs.h>
+#include <linux/crc32.h>
+#include <linux/proc_fs.h>
+#include <linux/seq_file.h>
+#include <linux/vmalloc.h>
+#include <linux/quotaops.h>
+#include "ext4.h"
+#include "ext4_jbd2.h"
+#include "ext4_extents.h"
+
+static const char *ext4_fc_reason_str[EXT4_FC_REASON_MAX] = {
+	[EXT4_FC_REASON_XATTR]		= "Extended attributes changed",
+	[EXT4_FC_REASON_RENAME]		= "Rename",
+	[EXT4_FC_REASON_DIR_OP]		= "Directory created or removed",
+	[EXT4_FC_REASON_SPECIAL_FILE]	= "Special file or symlink created",
+	[EXT4_FC_REASON_ORPHAN]		= "Inode on orphan list",
+	[EXT4_FC_REASON_INODE_FREE]	= "Inode freed",
+	[EXT4_FC_REASON_ENCRYPTED_DIR]	= "Encrypted directory changed",
+	[EXT4_FC_REASON_EXTENT_SHIFT]	= "Extents shifted",
+	[EXT4_FC_REASON_MIGRATE]	= "Inode migrated",
+	[EXT4_FC_REASON_MOVE_EXT]	= "Extents moved",
+	[EXT4_FC_REASON_RESIZE]		= "Resize",
+	[EXT4_FC_REASON_JOURNAL_FLAG]	= "Data journalling changed",
+	[EXT4_FC_REASON_QUOTA]		= "Quota",
+	[EXT4_FC_REASON_INODE_FORMAT]	= "Unsupported inode format",
+	[EXT4_FC_REASON_EVICT]		= "Tracked inode evicted",
+	[EXT4_FC_REASON_NOMEM]		= "Memory allocation failure",
+	[EXT4_FC_REASON_TOO_BIG]	= "Fast commit area full",
+};
+
+void ext4_fc_init(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+
+	INIT_LIST_HEAD(&sbi->s_fc_q);
+	INIT_LIST_HEAD(&sbi->s_fc_dentry_q);
+	sbi->s_fc_q_len = 0;
+	sbi->s_fc_ineligible = false;
+	spin_lock_init(&sbi->s_fc_lock);
+	mutex_init(&sbi->s_fc_mutex);
+}
+
+void ext4_fc_init_inode(struct inode *inode)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+
+	INIT_LIST_HEAD(&ei->i_fc_list);
+	ei->i_fc_tid = 0;
+	ei->i_fc_lblk_start = 0;
+	ei->i_fc_lblk_len = 0;
+}
+
+/*
+ * Tracking.  Every inode changed under a handle is queued on s_fc_q with
+ * the tid of that handle's transaction, regular files together with the
+ * logical range ext4_map_blocks() and truncate touched.  Entries are
+ * dropped once their transaction has committed.
+ */
+static inline int ext4_fc_tracking(handle_t *handle, struct inode *inode)
+{
+	return test_opt2(inode->i_sb, JOURNAL_FAST_COMMIT) &&
+		ext4_handle_valid(handle);
+}
+
+static void __ext4_fc_mark_ineligible(struct ext4_sb_info *sbi, int reason,
+				      tid_t tid)
+{
+	if (!sbi->s_fc_ineligible || tid_gt(tid, sbi->s_fc_ineligible_tid))
+		sbi->s_fc_ineligible_tid = tid;
+	sbi->s_fc_ineligible = true;
+	sbi->s_fc_stats.fc_ineligible_reasons[reason]++;
+}
+
+void ext4_fc_mark_ineligible(struct super_block *sb, int reason,
+			     handle_t *handle)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	journal_t *journal = sbi->s_journal;
+	tid_t tid;
+
+	if (!test_opt2(sb, JOURNAL_FAST_COMMIT) || !journal)
+		return;
+
+	if (handle && ext4_handle_valid(handle)) {
+		tid = handle->h_transaction->t_tid;
+	} else {
+		read_lock(&journal->j_state_lock);
+		tid = journal->j_running_transaction ?
+			journal->j_running_transaction->t_tid :
+			journal->j_transaction_sequence;
+		read_unlock(&journal->j_state_lock);
+	}
+
+	spin_lock(&sbi->s_fc_lock);
+	__ext4_fc_mark_ineligible(sbi, reason, tid);
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+static void __ext4_fc_track_inode(struct ext4_sb_info *sbi,
+				  struct ext4_inode_info *ei, tid_t tid)
+{
+	if (ei->i_fc_tid != tid) {
+		/* The older transaction carries the older changes */
+		ei->i_fc_tid = tid;
+		ei->i_fc_lblk_len = 0;
+	}
+	if (list_empty(&ei->i_fc_list)) {
+		list_add_tail(&ei->i_fc_list, &sbi->s_fc_q);
+		sbi->s_fc_q_len++;
+	}
+}
+
+void ext4_fc_track_inode(handle_t *handle, struct inode *inode)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	struct ext4_sb_info *sbi = EXT4_SB(inode->i_sb);
+	tid_t tid;
+
+	if (!ext4_fc_tracking(handle, inode))
+		return;
+
+	tid = handle->h_transaction->t_tid;
+	/* Racy, but only misses when we'd have to take the lock anyway */
+	if (ACCESS_ONCE(ei->i_fc_tid) == tid && !list_empty(&ei->i_fc_list))
+		return;
+
+	spin_lock(&sbi->s_fc_lock);
+	__ext4_fc_track_inode(sbi, ei, tid);
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+void ext4_fc_track_range(handle_t *handle, struct inode *inode,
+			 ext4_lblk_t start, ext4_lblk_t end)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	struct ext4_sb_info *sbi = EXT4_SB(inode->i_sb);
+	ext4_lblk_t old_end;
+
+	if (!ext4_fc_tracking(handle, inode) || !S_ISREG(inode->i_mode))
+		return;
+
+	spin_lock(&sbi->s_fc_lock);
+	__ext4_fc_track_inode(sbi, ei, handle->h_transaction->t_tid);
+	if (ei->i_fc_lblk_len) {
+		old_end = ei->i_fc_lblk_start + ei->i_fc_lblk_len - 1;
+		start = min(start, ei->i_fc_lblk_start);
+		end = max(end, old_end);
+	}
+	ei->i_fc_lblk_start = start;
+	ei->i_fc_lblk_len = end - start + 1;
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+static void ext4_fc_track_dentry(handle_t *handle, struct dentry *dentry,
+				 int op)
+{
+	struct inode *dir = dentry->d_parent->d_inode;
+	struct inode *inode = dentry->d_inode;
+	struct ext4_sb_info *sbi = EXT4_SB(dir->i_sb);
+	struct ext4_fc_dentry_update *fcd;
+
+	if (!ext4_fc_tracking(handle, dir))
+		return;
+
+	/* Replay has no key to recreate encrypted names with */
+	if (ext4_encrypted_inode(dir)) {
+		ext4_fc_mark_ineligible(dir->i_sb,
+					EXT4_FC_REASON_ENCRYPTED_DIR, handle);
+		return;
+	}
+
+	fcd = kmalloc(sizeof(*fcd) + dentry->d_name.len, GFP_NOFS);
+	if (!fcd) {
+		ext4_fc_mark_ineligible(dir->i_sb, EXT4_FC_REASON_NOMEM,
+					handle);
+		return;
+	}
+	fcd->fcd_tid = handle->h_transaction->t_tid;
+	fcd->fcd_op = op;
+	fcd->fcd_parent = dir->i_ino;
+	fcd->fcd_ino = inode->i_ino;
+	fcd->fcd_name_len = dentry->d_name.len;
+	memcpy(fcd->fcd_name, dentry->d_name.name, dentry->d_name.len);
+
+	spin_lock(&sbi->s_fc_lock);
+	list_add_tail(&fcd->fcd_list, &sbi->s_fc_dentry_q);
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+void ext4_fc_track_create(handle_t *handle, struct dentry *dentry)
+{
+	ext4_fc_track_dentry(handle, dentry, EXT4_FC_TAG_CREAT);
+}
+
+void ext4_fc_track_link(handle_t *handle, struct dentry *dentry)
+{
+	ext4_fc_track_dentry(handle, dentry, EXT4_FC_TAG_LINK);
+}
+
+void ext4_fc_track_unlink(handle_t *handle, struct dentry *dentry)
+{
+	ext4_fc_track_dentry(handle, dentry, EXT4_FC_TAG_UNLINK);
+}
+
+/*
+ * Called from ext4_clear_inode().  The changes of an inode evicted before
+ * its transaction committed can't be fast committed any more.
+ */
+void ext4_fc_del(struct inode *inode)
+{
+	struct ext4_inode_info *ei = EXT4_I(inode);
+	struct ext4_sb_info *sbi = EXT4_SB(inode->i_sb);
+
+	if (!test_opt2(inode->i_sb, JOURNAL_FAST_COMMIT))
+		return;
+
+	spin_lock(&sbi->s_fc_lock);
+	if (!list_empty(&ei->i_fc_list)) {
+		__ext4_fc_mark_ineligible(sbi, EXT4_FC_REASON_EVICT,
+					  ei->i_fc_tid);
+		list_del_init(&ei->i_fc_list);
+		sbi->s_fc_q_len--;
+	}
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+/* Called from the commit callback once transaction @tid has committed */
+void ext4_fc_cleanup(journal_t *journal, tid_t tid)
+{
+	struct super_block *sb = journal->j_private;
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_inode_info *ei, *ei_n;
+	struct ext4_fc_dentry_update *fcd, *fcd_n;
+
+	if (!test_opt2(sb, JOURNAL_FAST_COMMIT))
+		return;
+
+	spin_lock(&sbi->s_fc_lock);
+	list_for_each_entry_safe(ei, ei_n, &sbi->s_fc_q, i_fc_list) {
+		if (tid_gt(ei->i_fc_tid, tid))
+			continue;
+		list_del_init(&ei->i_fc_list);
+		ei->i_fc_lblk_len = 0;
+		sbi->s_fc_q_len--;
+	}
+	list_for_each_entry_safe(fcd, fcd_n, &sbi->s_fc_dentry_q, fcd_list) {
+		if (tid_gt(fcd->fcd_tid, tid))
+			continue;
+		list_del(&fcd->fcd_list);
+		kfree(fcd);
+	}
+	if (sbi->s_fc_ineligible && tid_geq(tid, sbi->s_fc_ineligible_tid))
+		sbi->s_fc_ineligible = false;
+	spin_unlock(&sbi->s_fc_lock);
+}
+
+/*
+ * Commit.  A run is built in s_fc_buf while updates to the journal are
+ * locked out, so that it describes a consistent state of the running
+ * transaction, and is then written to the fast commit area.
+ */
+struct ext4_fc_run {
+	struct super_block *sb;
+	u8 *buf;
+	unsigned int off;
+	unsigned int size;
+};
+
+/* Append a record header and return where its value goes */
+static void *ext4_fc_reserve(struct ext4_fc_run *run, u16 tag, u16 len)
+{
+	struct ext4_fc_tl *tl;
+
+	if (run->off + sizeof(*tl) + len > run->size)
+		return NULL;
+	tl = (struct ext4_fc_tl *)(run->buf + run->off);
+	tl->fc_tag = cpu_to_le16(tag);
+	tl->fc_len = cpu_to_le16(len);
+	run->off += sizeof(*tl) + len;
+	return tl + 1;
+}
+
+static int ext4_fc_add_inode(struct ext4_fc_run *run, unsigned long ino,
+			     u8 *raw)
+{
+	int isize = EXT4_INODE_SIZE(run->sb);
+	struct ext4_fc_inode *fc;
+
+	fc = ext4_fc_reserve(run, EXT4_FC_TAG_INODE, sizeof(*fc) + isize);
+	if (!fc)
+		return -ENOSPC;
+	fc->fc_ino = cpu_to_le32(ino);
+	memcpy(fc->fc_raw_inode, raw, isize);
+	return 0;
+}
+
+static int ext4_fc_add_dentry_info(struct ext4_fc_run *run,
+				   struct ext4_fc_dentry_update *fcd)
+{
+	struct ext4_fc_dentry_info *fc;
+
+	fc = ext4_fc_reserve(run, fcd->fcd_op,
+			     sizeof(*fc) + fcd->fcd_name_len);
+	if (!fc)
+		return -ENOSPC;
+	fc->fc_parent_ino = cpu_to_le32(fcd->fcd_parent);
+	fc->fc_ino = cpu_to_le32(fcd->fcd_ino);
+	memcpy(fc->fc_dname, fcd->fcd_name, fcd->fcd_name_len);
+	return 0;
+}
+
+/* Length of the hole at @lblk, which ext4_map_blocks() found unmapped */
+static int ext4_fc_hole_len(struct inode *inode, ext4_lblk_t lblk,
+			    ext4_lblk_t *len)
+{
+	struct ext4_ext_path *path;
+	struct ext4_extent *ex;
+	ext4_lblk_t next;
+
+	down_read(&EXT4_I(inode)->i_data_sem);
+	path = ext4_find_extent(inode, lblk, NULL, 0);
+	if (IS_ERR(path)) {
+		up_read(&EXT4_I(inode)->i_data_sem);
+		return PTR_ERR(path);
+	}
+	ex = path[path->p_depth].p_ext;
+	if (ex && le32_to_cpu(ex->ee_block) > lblk)
+		next = le32_to_cpu(ex->ee_block);
+	else
+		next = ext4_ext_next_allocated_block(path);
+	ext4_ext_drop_refs(path);
+	kfree(path);
+	up_read(&EXT4_I(inode)->i_data_sem);
+
+	*len = next > lblk ? next - lblk : 0;
+	return 0;
+}
+
+static int ext4_fc_add_ranges(struct ext4_fc_run *run, struct inode *inode,
+			      ext4_lblk_t start, ext4_lblk_t len)
+{
+	struct ext4_fc_add_range *add;
+	struct ext4_fc_del_range *del;
+	struct ext4_map_blocks map;
+	ext4_lblk_t cur = start, end = start + len, n;
+	int ret;
+
+	while (cur < end) {
+		map.m_lblk = cur;
+		map.m_len = end - cur;
+		ret = ext4_map_blocks(NULL, inode, &map, 0);
+		if (ret < 0)
+			return ret;
+		if (ret > 0) {
+			add = ext4_fc_reserve(run, EXT4_FC_TAG_ADD_RANGE,
+					      sizeof(*add));
+			if (!add)
+				return -ENOSPC;
+			add->fc_ino = cpu_to_le32(inode->i_ino);
+			add->fc_lblk = cpu_to_le32(cur);
+			add->fc_len = cpu_to_le32(ret);
+			add->fc_pblk_lo = cpu_to_le32(map.m_pblk & 0xffffffff);
+			add->fc_pblk_hi = cpu_to_le16(map.m_pblk >> 32);
+			add->fc_flags = cpu_to_le16(
+				map.m_flags & EXT4_MAP_UNWRITTEN ?
+				EXT4_FC_RANGE_UNWRITTEN : 0);
+			cur += ret;
+			continue;
+		}
+
+		ret = ext4_fc_hole_len(inode, cur, &n);
+		if (ret)
+			return ret;
+		if (!n)
+			return -EAGAIN;
+		n = min(n, end - cur);
+		del = ext4_fc_reserve(run, EXT4_FC_TAG_DEL_RANGE, sizeof(*del));
+		if (!del)
+			return -ENOSPC;
+		del->fc_ino = cpu_to_le32(inode->i_ino);
+		del->fc_lblk = cpu_to_le32(cur);
+		del->fc_len = cpu_to_le32(n);
+		cur += n;
+	}
+	return 0;
+}
+
+static int ext4_fc_check_inode(struct inode *inode)
+{
+	if (!list_empty(&EXT4_I(inode)->i_orphan))
+		return -EAGAIN;
+	if (!S_ISREG(inode->i_mode))
+		return 0;
+	if (!ext4_test_inode_flag(inode, EXT4_INODE_EXTENTS) ||
+	    ext4_has_inline_data(inode) || ext4_should_journal_data(inode)) {
+		ext4_fc_mark_ineligible(inode->i_sb,
+					EXT4_FC_REASON_INODE_FORMAT, NULL);
+		return -EAGAIN;
+	}
+	return 0;
+}
+
+/* Must be called with updates locked so the transaction stays put */
+static int ext4_fc_build_run(struct ext4_fc_run *run, tid_t tid,
+			     struct inode **inodes, int count)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(run->sb);
+	int isize = EXT4_INODE_SIZE(run->sb);
+	struct ext4_fc_dentry_update *fcd;
+	struct ext4_fc_head *head;
+	struct ext4_fc_tail *tail;
+	struct ext4_iloc iloc;
+	ext4_lblk_t start, len;
+	u8 *images;
+	int i, ret = 0;
+
+	run->off = 0;
+	head = ext4_fc_reserve(run, EXT4_FC_TAG_HEAD, sizeof(*head));
+	if (!head)
+		return -ENOSPC;
+	head->fc_features = cpu_to_le32(EXT4_FC_SUPPORTED_FEATURES);
+	head->fc_tid = cpu_to_le32(tid);
+
+	images = kmalloc(count * isize, GFP_NOFS);
+	if (!images)
+		return -ENOMEM;
+	for (i = 0; i < count; i++) {
+		ret = ext4_fc_check_inode(inodes[i]);
+		if (ret)
+			goto out;
+		ret = ext4_get_inode_loc(inodes[i], &iloc);
+		if (ret)
+			goto out;
+		memcpy(images + i * isize, ext4_raw_inode(&iloc), isize);
+		brelse(iloc.bh);
+	}
+
+	/*
+	 * Namespace changes first, so that replay finds the inodes and the
+	 * names in place.  A created inode is preceded by its image.
+	 */
+	spin_lock(&sbi->s_fc_lock);
+	if (sbi->s_fc_ineligible && tid_geq(sbi->s_fc_ineligible_tid, tid)) {
+		spin_unlock(&sbi->s_fc_lock);
+		ret = -EAGAIN;
+		goto out;
+	}
+	list_for_each_entry(fcd, &sbi->s_fc_dentry_q, fcd_list) {
+		if (fcd->fcd_tid != tid)
+			continue;
+		if (fcd->fcd_op == EXT4_FC_TAG_CREAT) {
+			for (i = 0; i < count; i++)
+				if (inodes[i]->i_ino == fcd->fcd_ino)
+					break;
+			if (i == count) {
+				ret = -EAGAIN;
+				break;
+			}
+			ret = ext4_fc_add_inode(run, fcd->fcd_ino,
+						images + i * isize);
+			if (ret)
+				break;
+		}
+		ret = ext4_fc_add_dentry_info(run, fcd);
+		if (ret)
+			break;
+	}
+	spin_unlock(&sbi->s_fc_lock);
+	if (ret)
+		goto out;
+
+	for (i = 0; i < count; i++) {
+		spin_lock(&sbi->s_fc_lock);
+		start = EXT4_I(inodes[i])->i_fc_lblk_start;
+		len = EXT4_I(inodes[i])->i_fc_lblk_len;
+		spin_unlock(&sbi->s_fc_lock);
+		if (len) {
+			ret = ext4_fc_add_ranges(run, inodes[i], start, len);
+			if (ret)
+				goto out;
+		}
+		ret = ext4_fc_add_inode(run, inodes[i]->i_ino,
+					images + i * isize);
+		if (ret)
+			goto out;
+	}
+
+	tail = ext4_fc_reserve(run, EXT4_FC_TAG_TAIL, sizeof(*tail));
+	if (!tail) {
+		ret = -ENOSPC;
+		goto out;
+	}
+	head->fc_len = cpu_to_le32(run->off);
+	tail->fc_tid = cpu_to_le32(tid);
+	tail->fc_crc = cpu_to_le32(crc32_be(~0, run->buf,
+					    (u8 *)&tail->fc_crc - run->buf));
+out:
+	kfree(images);
+	return ret;
+}
+
+static void ext4_fc_submit_bh(struct buffer_head *bh, int rw)
+{
+	lock_buffer(bh);
+	clear_buffer_dirty(bh);
+	set_buffer_uptodate(bh);
+	bh->b_end_io = end_buffer_write_sync;
+	get_bh(bh);
+	submit_bh(rw, bh);
+}
+
+/*
+ * Write the run out.  The last block goes out with a flush so that the
+ * file data written back before it, and the rest of the run, are stable
+ * once it is.
+ */
+static int ext4_fc_write_run(journal_t *journal, struct ext4_fc_run *run,
+			     int *nblks)
+{
+	int bsize = journal->j_blocksize;
+	int n = DIV_ROUND_UP(run->off, bsize);
+	struct buffer_head **bhs;
+	int i, got = 0, ret = 0;
+
+	bhs = kcalloc(n, sizeof(*bhs), GFP_NOFS);
+	if (!bhs)
+		return -ENOMEM;
+
+	for (got = 0; got < n; got++) {
+		ret = jbd2_fc_get_buf(journal, &bhs[got]);
+		if (ret)
+			goto out;
+		memcpy(bhs[got]->b_data, run->buf + got * bsize,
+		       min_t(int, bsize, run->off - got * bsize));
+	}
+
+	for (i = 0; i < n - 1; i++)
+		ext4_fc_submit_bh(bhs[i], WRITE_SYNC);
+	for (i = 0; i < n - 1; i++) {
+		wait_on_buffer(bhs[i]);
+		if (unlikely(!buffer_uptodate(bhs[i])))
+			ret = -EIO;
+	}
+	if (ret)
+		goto out;
+
+	if (journal->j_flags & JBD2_BARRIER) {
+		/* The preflush below only covers the journal device */
+		if (journal->j_fs_dev != journal->j_dev)
+			blkdev_issue_flush(journal->j_fs_dev, GFP_NOFS, NULL);
+		ext4_fc_submit_bh(bhs[n - 1], WRITE_FLUSH_FUA);
+	} else {
+		ext4_fc_submit_bh(bhs[n - 1], WRITE_SYNC);
+	}
+	wait_on_buffer(bhs[n - 1]);
+	if (unlikely(!buffer_uptodate(bhs[n - 1])))
+		ret = -EIO;
+	else
+		*nblks = n;
+out:
+	for (i = 0; i < got; i++)
+		brelse(bhs[i]);
+	kfree(bhs);
+	return ret;
+}
+
+/* Take a reference to every inode tracked for @tid */
+static int ext4_fc_grab_inodes(struct ext4_sb_info *sbi, tid_t tid,
+			       struct inode ***inodesp, int *countp)
+{
+	struct ext4_inode_info *ei;
+	struct inode **inodes;
+	unsigned int len;
+	int count = 0;
+
+	spin_lock(&sbi->s_fc_lock);
+	for (;;) {
+		len = sbi->s_fc_q_len;
+		spin_unlock(&sbi->s_fc_lock);
+		inodes = kmalloc_array(len ? len : 1, sizeof(*inodes),
+				       GFP_NOFS);
+		if (!inodes)
+			return -ENOMEM;
+		spin_lock(&sbi->s_fc_lock);
+		if (sbi->s_fc_q_len <= len)
+			break;
+		spin_unlock(&sbi->s_fc_lock);
+		kfree(inodes);
+		spin_lock(&sbi->s_fc_lock);
+	}
+
+	list_for_each_entry(ei, &sbi->s_fc_q, i_fc_list) {
+		if (ei->i_fc_tid != tid)
+			continue;
+		inodes[count] = igrab(&ei->vfs_inode);
+		if (!inodes[count]) {
+			/* Going away, ext4_fc_del() will make tid ineligible */
+			spin_unlock(&sbi->s_fc_lock);
+			while (count--)
+				iput(inodes[count]);
+			kfree(inodes);
+			return -EAGAIN;
+		}
+		count++;
+	}
+	spin_unlock(&sbi->s_fc_lock);
+
+	*inodesp = inodes;
+	*countp = count;
+	return 0;
+}
+
+static int ext4_fc_perform_commit(journal_t *journal, struct super_block *sb,
+				  tid_t tid, int *nblks)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_fc_run run;
+	struct inode **inodes;
+	int i, count, ret;
+
+	/* Journalled quota updates are metadata the run can't describe */
+	if (sb_any_quota_loaded(sb)) {
+		ext4_fc_mark_ineligible(sb, EXT4_FC_REASON_QUOTA, NULL);
+		return -EAGAIN;
+	}
+
+	ret = ext4_fc_grab_inodes(sbi, tid, &inodes, &count);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		ret = filemap_write_and_wait(inodes[i]->i_mapping);
+		if (ret)
+			goto out;
+	}
+
+	run.sb = sb;
+	run.buf = sbi->s_fc_buf;
+	run.size = (journal->j_fc_last - journal->j_fc_first) *
+		journal->j_blocksize;
+
+	jbd2_journal_lock_updates(journal);
+	ret = ext4_fc_build_run(&run, tid, inodes, count);
+	if (!ret && jbd2_fc_begin_commit(journal, tid))
+		ret = -EAGAIN;
+	jbd2_journal_unlock_updates(journal);
+	if (ret)
+		goto out;
+
+	/* Writeback started before the lock may still be converting extents */
+	for (i = 0; i < count; i++) {
+		ret = filemap_fdatawait(inodes[i]->i_mapping);
+		if (ret)
+			goto out;
+	}
+
+	ret = ext4_fc_write_run(journal, &run, nblks);
+out:
+	for (i = 0; i < count; i++)
+		iput(inodes[i]);
+	kfree(inodes);
+	return ret;
+}
+
+/*
+ * ext4_fc_commit() - make the changes of running transaction @commit_tid
+ * durable without committing it.  Returns -EAGAIN if the caller has to
+ * fall back to jbd2_complete_transaction().
+ */
+int ext4_fc_commit(journal_t *journal, struct inode *inode, tid_t commit_tid)
+{
+	struct super_block *sb = inode->i_sb;
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	int running, nblks = 0, ret;
+
+	if (!S_ISREG(inode->i_mode) || ext4_should_journal_data(inode))
+		return -EAGAIN;
+
+	/*
+	 * Only the running transaction can be fast committed; one which is
+	 * already committing, or has committed and may still need a data
+	 * barrier, is left to the regular path.
+	 */
+	read_lock(&journal->j_state_lock);
+	running = journal->j_running_transaction &&
+		journal->j_running_transaction->t_tid == commit_tid;
+	read_unlock(&journal->j_state_lock);
+	if (!running)
+		return -EAGAIN;
+
+	/* Replay relies on the previous transaction being in the log */
+	ret = jbd2_log_wait_commit(journal, commit_tid - 1);
+	if (ret)
+		return ret;
+
+	mutex_lock(&sbi->s_fc_mutex);
+	ret = ext4_fc_perform_commit(journal, sb, commit_tid, &nblks);
+
+	spin_lock(&sbi->s_fc_lock);
+	if (!ret) {
+		sbi->s_fc_stats.fc_commits++;
+		sbi->s_fc_stats.fc_blocks += nblks;
+	} else if (ret == -ENOSPC) {
+		/* Later runs of this transaction won't be any smaller */
+		__ext4_fc_mark_ineligible(sbi, EXT4_FC_REASON_TOO_BIG,
+					  commit_tid);
+		sbi->s_fc_stats.fc_ineligible_commits++;
+	} else if (ret == -EAGAIN) {
+		sbi->s_fc_stats.fc_ineligible_commits++;
+	} else {
+		sbi->s_fc_stats.fc_failed_commits++;
+	}
+	spin_unlock(&sbi->s_fc_lock);
+	mutex_unlock(&sbi->s_fc_mutex);
+
+	return ret ? -EAGAIN : 0;
+}
+
+/*
+ * Replay.  Records are applied through regular handles on top of the
+ * recovered filesystem, and each step is written so that it can be
+ * redone if we crash again before the replayed changes get committed.
+ */
+static struct ext4_fc_tl *ext4_fc_next_tl(u8 *run, int len, int *off)
+{
+	struct ext4_fc_tl *tl;
+
+	if (*off + sizeof(*tl) > len)
+		return NULL;
+	tl = (struct ext4_fc_tl *)(run + *off);
+	if (*off + sizeof(*tl) + le16_to_cpu(tl->fc_len) > len)
+		return NULL;
+	*off += sizeof(*tl) + le16_to_cpu(tl->fc_len);
+	return tl;
+}
+
+static int ext4_fc_run_valid(u8 *run, int len, tid_t tid)
+{
+	struct ext4_fc_tail *tail;
+	struct ext4_fc_tl *tl;
+
+	if (len < 2 * sizeof(*tl) + sizeof(struct ext4_fc_head) +
+	    sizeof(*tail))
+		return 0;
+	tl = (struct ext4_fc_tl *)(run + len - sizeof(*tail) - sizeof(*tl));
+	if (le16_to_cpu(tl->fc_tag) != EXT4_FC_TAG_TAIL ||
+	    le16_to_cpu(tl->fc_len) != sizeof(*tail))
+		return 0;
+	tail = (struct ext4_fc_tail *)(tl + 1);
+	if (le32_to_cpu(tail->fc_tid) != tid)
+		return 0;
+	return le32_to_cpu(tail->fc_crc) ==
+		crc32_be(~0, run, (u8 *)&tail->fc_crc - run);
+}
+
+/* Find the last valid run of @tid in the fast commit area */
+static u8 *ext4_fc_find_run(u8 *area, int size, int bsize, tid_t tid,
+			    int *run_len)
+{
+	struct ext4_fc_head *head;
+	struct ext4_fc_tl *tl;
+	u8 *found = NULL;
+	int off = 0, len;
+
+	while (off + sizeof(*tl) + sizeof(*head) <= size) {
+		tl = (struct ext4_fc_tl *)(area + off);
+		head = (struct ext4_fc_head *)(tl + 1);
+		len = le32_to_cpu(head->fc_len);
+		if (le16_to_cpu(tl->fc_tag) != EXT4_FC_TAG_HEAD ||
+		    le16_to_cpu(tl->fc_len) != sizeof(*head) ||
+		    le32_to_cpu(head->fc_tid) != tid ||
+		    le32_to_cpu(head->fc_features) &
+		    ~EXT4_FC_SUPPORTED_FEATURES ||
+		    len <= 0 || len > size - off ||
+		    !ext4_fc_run_valid(area + off, len, tid)) {
+			off += bsize;
+			continue;
+		}
+		found = area + off;
+		*run_len = len;
+		off += round_up(len, bsize);
+	}
+	return found;
+}
+
+/* Drop the icache copy, replay writes raw inodes behind its back */
+static void ext4_fc_iput(struct inode *inode)
+{
+	if (atomic_read(&inode->i_count) == 1)
+		remove_inode_hash(inode);
+	iput(inode);
+}
+
+static int ext4_fc_mark_range_used(struct super_block *sb, ext4_fsblk_t pblk,
+				   ext4_lblk_t len)
+{
+	handle_t *handle;
+	int ret;
+
+	handle = ext4_journal_start_sb(sb, EXT4_HT_MISC,
+			2 * (len / EXT4_BLOCKS_PER_GROUP(sb) + 2) + 1);
+	if (IS_ERR(handle))
+		return PTR_ERR(handle);
+	ret = ext4_mb_mark_bb_used(handle, sb, pblk, len);
+	ext4_journal_stop(handle);
+	return ret;
+}
+
+static int ext4_fc_replay_inode(struct super_block *sb,
+				struct ext4_fc_inode *fc)
+{
+	int isize = EXT4_INODE_SIZE(sb);
+	unsigned long ino = le32_to_cpu(fc->fc_ino);
+	struct ext4_extent_header *eh;
+	struct ext4_inode *raw;
+	handle_t *handle;
+	int ret, created;
+
+	raw = kmemdup(fc->fc_raw_inode, isize, GFP_NOFS);
+	if (!raw)
+		return -ENOMEM;
+
+	/* inode bitmap, block bitmap, group desc, inode table, superblock */
+	handle = ext4_journal_start_sb(sb, EXT4_HT_INODE, 5);
+	if (IS_ERR(handle)) {
+		ret = PTR_ERR(handle);
+		goto out;
+	}
+	ret = ext4_mark_inode_used(handle, sb, ino);
+	if (ret < 0)
+		goto out_stop;
+	created = ret;
+	if (created) {
+		/* Its blocks come from the ranges that follow */
+		memset(raw->i_block, 0, sizeof(raw->i_block));
+		eh = (struct ext4_extent_header *)raw->i_block;
+		eh->eh_magic = EXT4_EXT_MAGIC;
+		eh->eh_max = cpu_to_le16((sizeof(raw->i_block) -
+					  sizeof(*eh)) /
+					 sizeof(struct ext4_extent));
+		raw->i_blocks_lo = 0;
+		raw->i_blocks_high = 0;
+		raw->i_file_acl_lo = 0;
+		raw->i_file_acl_high = 0;
+	}
+	ret = ext4_write_raw_inode(handle, sb, ino, raw, !created);
+	/* Directories in use, like the root, are already up to date */
+	if (ret == -EBUSY && !S_ISREG(le16_to_cpu(raw->i_mode)))
+		ret = 0;
+out_stop:
+	ext4_journal_stop(handle);
+out:
+	kfree(raw);
+	return ret;
+}
+
+static int ext4_fc_remove_range(struct inode *inode, ext4_lblk_t lblk,
+				ext4_lblk_t len)
+{
+	handle_t *handle;
+	int ret;
+
+	down_write(&EXT4_I(inode)->i_data_sem);
+	ret = ext4_es_remove_extent(inode, lblk, len);
+	if (!ret)
+		ret = ext4_ext_remove_space(inode, lblk, lblk + len - 1);
+	up_write(&EXT4_I(inode)->i_data_sem);
+	if (ret)
+		return ret;
+
+	handle = ext4_journal_start(inode, EXT4_HT_INODE, 1);
+	if (IS_ERR(handle))
+		return PTR_ERR(handle);
+	ret = ext4_mark_inode_dirty(handle, inode);
+	ext4_journal_stop(handle);
+	return ret;
+}
+
+static int ext4_fc_insert_range(struct inode *inode, ext4_lblk_t lblk,
+				ext4_fsblk_t pblk, ext4_lblk_t len,
+				int unwritten)
+{
+	struct ext4_ext_path *path;
+	struct ext4_extent newex;
+	handle_t *handle;
+	int ret;
+
+	handle = ext4_journal_start(inode, EXT4_HT_MAP_BLOCKS,
+				    ext4_chunk_trans_blocks(inode, len));
+	if (IS_ERR(handle))
+		return PTR_ERR(handle);
+
+	down_write(&EXT4_I(inode)->i_data_sem);
+	path = ext4_find_extent(inode, lblk, NULL, 0);
+	if (IS_ERR(path)) {
+		ret = PTR_ERR(path);
+		goto out_sem;
+	}
+	newex.ee_block = cpu_to_le32(lblk);
+	ext4_ext_store_pblock(&newex, pblk);
+	newex.ee_len = cpu_to_le16(len);
+	if (unwritten)
+		ext4_ext_mark_unwritten(&newex);
+	ret = ext4_ext_insert_extent(handle, inode, &path, &newex, 0);
+	ext4_ext_drop_refs(path);
+	kfree(path);
+	if (!ret)
+		ret = ext4_es_remove_extent(inode, lblk, len);
+out_sem:
+	up_write(&EXT4_I(inode)->i_data_sem);
+	if (!ret) {
+		dquot_alloc_block_nofail(inode, len);
+		ret = ext4_mb_mark_bb_used(handle, inode->i_sb, pblk, len);
+	}
+	if (!ret)
+		ret = ext4_mark_inode_dirty(handle, inode);
+	ext4_journal_stop(handle);
+	return ret;
+}
+
+static int ext4_fc_replay_add_range(struct super_block *sb,
+				    struct ext4_fc_add_range *fc)
+{
+	ext4_lblk_t lblk = le32_to_cpu(fc->fc_lblk);
+	ext4_lblk_t end = lblk + le32_to_cpu(fc->fc_len);
+	ext4_fsblk_t pblk = le32_to_cpu(fc->fc_pblk_lo) |
+		((ext4_fsblk_t)le16_to_cpu(fc->fc_pblk_hi) << 32);
+	int unwritten = le16_to_cpu(fc->fc_flags) & EXT4_FC_RANGE_UNWRITTEN;
+	int max = unwritten ? EXT_UNWRITTEN_MAX_LEN : EXT_INIT_MAX_LEN;
+	struct ext4_map_blocks map;
+	struct inode *inode;
+	ext4_lblk_t cur = lblk, n;
+	int ret = 0;
+
+	inode = ext4_iget(sb, le32_to_cpu(fc->fc_ino));
+	if (IS_ERR(inode))
+		return PTR_ERR(inode);
+
+	while (cur < end) {
+		map.m_lblk = cur;
+		map.m_len = min_t(ext4_lblk_t, end - cur, max);
+		ret = ext4_map_blocks(NULL, inode, &map, 0);
+		if (ret < 0)
+			break;
+		if (ret > 0) {
+			n = ret;
+			/* Already there from an earlier attempt */
+			if (map.m_pblk == pblk + (cur - lblk) &&
+			    !!(map.m_flags & EXT4_MAP_UNWRITTEN) == !!unwritten) {
+				cur += n;
+				continue;
+			}
+			ret = ext4_fc_remove_range(inode, cur, n);
+			if (ret)
+				break;
+		} else {
+			ret = ext4_fc_hole_len(inode, cur, &n);
+			if (ret)
+				break;
+			n = min_t(ext4_lblk_t, n, map.m_len);
+			if (!n) {
+				ret = -EIO;
+				break;
+			}
+		}
+		ret = ext4_fc_insert_range(inode, cur, pblk + (cur - lblk), n,
+					   unwritten);
+		if (ret)
+			break;
+		cur += n;
+	}
+	ext4_fc_iput(inode);
+	return ret;
+}
+
+static int ext4_fc_replay_del_range(struct super_block *sb,
+				    struct ext4_fc_del_range *fc)
+{
+	struct inode *inode;
+	int ret;
+
+	inode = ext4_iget(sb, le32_to_cpu(fc->fc_ino));
+	if (IS_ERR(inode))
+		return PTR_ERR(inode);
+	ret = ext4_fc_remove_range(inode, le32_to_cpu(fc->fc_lblk),
+				   le32_to_cpu(fc->fc_len));
+	ext4_fc_iput(inode);
+	return ret;
+}
+
+static int ext4_fc_replay_dentry(struct super_block *sb, int tag,
+				 struct ext4_fc_dentry_info *fc, int len)
+{
+	struct qstr name = QSTR_INIT(fc->fc_dname, len - sizeof(*fc));
+	struct inode *dir, *inode;
+	int ret;
+
+	dir = ext4_iget(sb, le32_to_cpu(fc->fc_parent_ino));
+	if (IS_ERR(dir))
+		return PTR_ERR(dir);
+
+	if (tag == EXT4_FC_TAG_UNLINK) {
+		ret = ext4_fc_del_dentry(dir, le32_to_cpu(fc->fc_ino), &name);
+	} else {
+		inode = ext4_iget(sb, le32_to_cpu(fc->fc_ino));
+		if (IS_ERR(inode)) {
+			ret = PTR_ERR(inode);
+		} else {
+			ret = ext4_fc_add_dentry(dir, inode, &name);
+			ext4_fc_iput(inode);
+		}
+	}
+	ext4_fc_iput(dir);
+	return ret;
+}
+
+/* Check the records of a run and mark the blocks it maps in use */
+static int ext4_fc_replay_scan(struct super_block *sb, u8 *run, int len)
+{
+	int isize = EXT4_INODE_SIZE(sb);
+	struct ext4_fc_add_range *add;
+	struct ext4_fc_tl *tl;
+	int off = 0, vlen, ret;
+
+	while ((tl = ext4_fc_next_tl(run, len, &off)) != NULL) {
+		vlen = le16_to_cpu(tl->fc_len);
+		switch (le16_to_cpu(tl->fc_tag)) {
+		case EXT4_FC_TAG_ADD_RANGE:
+			if (vlen != sizeof(*add))
+				return -EIO;
+			add = (struct ext4_fc_add_range *)(tl + 1);
+			ret = ext4_fc_mark_range_used(sb,
+				le32_to_cpu(add->fc_pblk_lo) |
+				((ext4_fsblk_t)le16_to_cpu(add->fc_pblk_hi) << 32),
+				le32_to_cpu(add->fc_len));
+			if (ret)
+				return ret;
+			break;
+		case EXT4_FC_TAG_DEL_RANGE:
+			if (vlen != sizeof(struct ext4_fc_del_range))
+				return -EIO;
+			break;
+		case EXT4_FC_TAG_CREAT:
+		case EXT4_FC_TAG_LINK:
+		case EXT4_FC_TAG_UNLINK:
+			if (vlen <= sizeof(struct ext4_fc_dentry_info) ||
+			    vlen > sizeof(struct ext4_fc_dentry_info) +
+			    EXT4_NAME_LEN)
+				return -EIO;
+			break;
+		case EXT4_FC_TAG_INODE:
+			if (vlen != sizeof(struct ext4_fc_inode) + isize)
+				return -EIO;
+			break;
+		case EXT4_FC_TAG_HEAD:
+		case EXT4_FC_TAG_PAD:
+		case EXT4_FC_TAG_TAIL:
+			break;
+		default:
+			return -EIO;
+		}
+	}
+	return off == len ? 0 : -EIO;
+}
+
+static int ext4_fc_replay_run(struct super_block *sb, u8 *run, int len)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_fc_add_range *add;
+	struct ext4_fc_tl *tl;
+	int off = 0, ret = 0;
+
+	ret = ext4_fc_replay_scan(sb, run, len);
+	if (ret)
+		return ret;
+
+	while (!ret && (tl = ext4_fc_next_tl(run, len, &off)) != NULL) {
+		switch (le16_to_cpu(tl->fc_tag)) {
+		case EXT4_FC_TAG_INODE:
+			ret = ext4_fc_replay_inode(sb,
+					(struct ext4_fc_inode *)(tl + 1));
+			break;
+		case EXT4_FC_TAG_ADD_RANGE:
+			ret = ext4_fc_replay_add_range(sb,
+					(struct ext4_fc_add_range *)(tl + 1));
+			break;
+		case EXT4_FC_TAG_DEL_RANGE:
+			ret = ext4_fc_replay_del_range(sb,
+					(struct ext4_fc_del_range *)(tl + 1));
+			break;
+		case EXT4_FC_TAG_CREAT:
+		case EXT4_FC_TAG_LINK:
+		case EXT4_FC_TAG_UNLINK:
+			ret = ext4_fc_replay_dentry(sb,
+					le16_to_cpu(tl->fc_tag),
+					(struct ext4_fc_dentry_info *)(tl + 1),
+					le16_to_cpu(tl->fc_len));
+			break;
+		default:
+			continue;
+		}
+		sbi->s_fc_stats.fc_replayed_records++;
+	}
+	if (ret)
+		return ret;
+
+	/*
+	 * Ranges removed above may have freed blocks which another inode of
+	 * the run took over in the meantime; claim them back.
+	 */
+	off = 0;
+	while ((tl = ext4_fc_next_tl(run, len, &off)) != NULL) {
+		if (le16_to_cpu(tl->fc_tag) != EXT4_FC_TAG_ADD_RANGE)
+			continue;
+		add = (struct ext4_fc_add_range *)(tl + 1);
+		ret = ext4_fc_mark_range_used(sb,
+			le32_to_cpu(add->fc_pblk_lo) |
+			((ext4_fsblk_t)le16_to_cpu(add->fc_pblk_hi) << 32),
+			le32_to_cpu(add->fc_len));
+		if (ret)
+			return ret;
+	}
+	return 0;
+}
+
+/*
+ * Called at mount time, after journal recovery and before orphan cleanup.
+ * The replayed changes are committed through the journal before the fast
+ * commit area is handed back to jbd2.
+ */
+void ext4_fc_replay(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	journal_t *journal = sbi->s_journal;
+	int bsize = sb->s_blocksize;
+	int nblocks, size, len = 0, i, ret = 0;
+	unsigned long s_flags = sb->s_flags;
+	struct buffer_head *bh;
+	u8 *area, *run;
+
+	if (!journal || !(journal->j_flags & JBD2_FC_REPLAY))
+		return;
+
+	if (bdev_read_only(sb->s_bdev)) {
+		ext4_msg(sb, KERN_ERR, "write access "
+			"unavailable, skipping fast commit replay");
+		return;
+	}
+
+	nblocks = journal->j_fc_last - journal->j_fc_first;
+	size = nblocks * bsize;
+	area = vmalloc(size);
+	if (!area) {
+		ext4_msg(sb, KERN_ERR, "no memory for fast commit replay");
+		return;
+	}
+	for (i = 0; i < nblocks; i++) {
+		ret = jbd2_fc_read_buf(journal, i, &bh);
+		if (ret)
+			goto out;
+		memcpy(area + i * bsize, bh->b_data, bsize);
+		brelse(bh);
+	}
+
+	run = ext4_fc_find_run(area, size, bsize, journal->j_fc_replay_tid,
+			       &len);
+	if (!run)
+		goto out;
+
+	sb->s_flags &= ~MS_RDONLY;
+	ret = ext4_fc_replay_run(sb, run, len);
+	if (!ret)
+		ret = jbd2_journal_force_commit(journal);
+	sb->s_flags = s_flags;
+	if (!ret) {
+		sbi->s_fc_stats.fc_replays++;
+		ext4_msg(sb, KERN_INFO, "replayed fast commit of "
+			 "transaction %u", journal->j_fc_replay_tid);
+	}
+out:
+	vfree(area);
+	if (ret)
+		ext4_error(sb, "fast commit replay failed: %d", ret);
+	jbd2_fc_replay_done(journal);
+}
+
+static int ext4_fc_info_show(struct seq_file *seq, void *v)
+{
+	struct super_block *sb = seq->private;
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_fc_stats stats;
+	int i;
+
+	spin_lock(&sbi->s_fc_lock);
+	stats = sbi->s_fc_stats;
+	spin_unlock(&sbi->s_fc_lock);
+
+	seq_printf(seq, "fc stats:\n");
+	seq_printf(seq, "  %lu commits\n", stats.fc_commits);
+	seq_printf(seq, "  %lu ineligible\n", stats.fc_ineligible_commits);
+	seq_printf(seq, "  %lu failed\n", stats.fc_failed_commits);
+	seq_printf(seq, "  %lu blocks\n", stats.fc_blocks);
+	seq_printf(seq, "  %lu replays\n", stats.fc_replays);
+	seq_printf(seq, "  %lu replayed records\n",
+		   stats.fc_replayed_records);
+	seq_printf(seq, "Ineligible reasons:\n");
+	for (i = 0; i < EXT4_FC_REASON_MAX; i++)
+		seq_printf(seq, "  \"%s\":\t%lu\n", ext4_fc_reason_str[i],
+			   stats.fc_ineligible_reasons[i]);
+	return 0;
+}
+
+static int ext4_fc_info_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ext4_fc_info_show, PDE_DATA(inode));
+}
+
+static const struct file_operations ext4_fc_info_fops = {
+	.owner		= THIS_MODULE,
+	.open		= ext4_fc_info_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+int ext4_fc_start(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	journal_t *journal = sbi->s_journal;
+
+	if (EXT4_HAS_RO_COMPAT_FEATURE(sb, EXT4_FEATURE_RO_COMPAT_BIGALLOC)) {
+		ext4_msg(sb, KERN_ERR, "can't mount with "
+			 "both bigalloc and fast_commit");
+		return -EINVAL;
+	}
+	if (!jbd2_journal_set_features(journal, 0, 0,
+				       JBD2_FEATURE_INCOMPAT_FC_LOCAL)) {
+		ext4_msg(sb, KERN_ERR, "can't enable fast commits "
+			 "on this journal");
+		return -EINVAL;
+	}
+
+	sbi->s_fc_buf = vmalloc((journal->j_fc_last - journal->j_fc_first) *
+				journal->j_blocksize);
+	if (!sbi->s_fc_buf)
+		return -ENOMEM;
+
+	if (sbi->s_proc)
+		proc_create_data("fc_info", S_IRUGO, sbi->s_proc,
+				 &ext4_fc_info_fops, sb);
+	return 0;
+}
+
+void ext4_fc_stop(struct super_block *sb)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_fc_dentry_update *fcd, *fcd_n;
+
+	if (!sbi->s_fc_buf)
+		return;
+
+	if (sbi->s_proc)
+		remove_proc_entry("fc_info", sbi->s_proc);
+	vfree(sbi->s_fc_buf);
+	sbi->s_fc_buf = NULL;
+
+	list_for_each_entry_safe(fcd, fcd_n, &sbi->s_fc_dentry_q, fcd_list) {
+		list_del(&fcd->fcd_list);
+		kfree(fcd);
+	}
+}
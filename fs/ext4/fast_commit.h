@@ -0,0 +1,134 @@
+/*
+ *  fs/ext4/fast_commit.h
+ *
+ * Ext4 fast commits: on-disk format and in-memory tracking structures.
+ */
+
+#ifndef _EXT4_FAST_COMMIT_H
+#define _EXT4_FAST_COMMIT_H
+
+/*
+ * A fast commit is a run of tag-length-value records written to the fast
+ * commit area jbd2 reserves at the end of the journal.  Each run starts on
+ * a block boundary with a HEAD record and ends with a TAIL record holding
+ * a crc32 of the run.  All runs in the area describe the same running
+ * transaction, and each run describes every tracked change of that
+ * transaction made so far, so replay only needs the last valid run.
+ *
+ * This is not the upstream fast commit format, whose tags are 1 to 9 and
+ * whose records differ: the area is flagged with its own journal feature,
+ * JBD2_FEATURE_INCOMPAT_FC_LOCAL, and the tags live in a range upstream
+ * parsers stop at, so that upstream tools refuse it instead of misparsing.
+ */
+#define EXT4_FC_TAG_HEAD		0xfc01
+#define EXT4_FC_TAG_ADD_RANGE		0xfc02
+#define EXT4_FC_TAG_DEL_RANGE		0xfc03
+#define EXT4_FC_TAG_CREAT		0xfc04
+#define EXT4_FC_TAG_LINK		0xfc05
+#define EXT4_FC_TAG_UNLINK		0xfc06
+#define EXT4_FC_TAG_INODE		0xfc07
+#define EXT4_FC_TAG_PAD			0xfc08
+#define EXT4_FC_TAG_TAIL		0xfc09
+
+/* Fast commit on-disk format version, recorded in the head */
+#define EXT4_FC_SUPPORTED_FEATURES	0x0
+
+/* Record header */
+struct ext4_fc_tl {
+	__le16 fc_tag;
+	__le16 fc_len;		/* length of the value following the header */
+};
+
+/* EXT4_FC_TAG_HEAD */
+struct ext4_fc_head {
+	__le32 fc_features;
+	__le32 fc_tid;		/* running transaction this run belongs to */
+	__le32 fc_len;		/* bytes in the run, head and tail included */
+};
+
+/* EXT4_FC_TAG_ADD_RANGE: map a logical range to physical blocks */
+#define EXT4_FC_RANGE_UNWRITTEN		0x0001
+
+struct ext4_fc_add_range {
+	__le32 fc_ino;
+	__le32 fc_lblk;
+	__le32 fc_len;
+	__le32 fc_pblk_lo;
+	__le16 fc_pblk_hi;
+	__le16 fc_flags;
+};
+
+/* EXT4_FC_TAG_DEL_RANGE: unmap a logical range */
+struct ext4_fc_del_range {
+	__le32 fc_ino;
+	__le32 fc_lblk;
+	__le32 fc_len;
+};
+
+/* EXT4_FC_TAG_CREAT, EXT4_FC_TAG_LINK and EXT4_FC_TAG_UNLINK */
+struct ext4_fc_dentry_info {
+	__le32 fc_parent_ino;
+	__le32 fc_ino;
+	__u8 fc_dname[0];
+};
+
+/* EXT4_FC_TAG_INODE: raw on-disk inode image, s_inode_size bytes */
+struct ext4_fc_inode {
+	__le32 fc_ino;
+	__u8 fc_raw_inode[0];
+};
+
+/* EXT4_FC_TAG_TAIL */
+struct ext4_fc_tail {
+	__le32 fc_tid;
+	__le32 fc_crc;		/* crc32_be of the run up to fc_crc */
+};
+
+/*
+ * Reasons a transaction cannot be fast committed.  Operations which fast
+ * commit records cannot describe mark the running transaction ineligible,
+ * and fsync then falls back to a full journal commit.
+ */
+enum {
+	EXT4_FC_REASON_XATTR = 0,
+	EXT4_FC_REASON_RENAME,
+	EXT4_FC_REASON_DIR_OP,
+	EXT4_FC_REASON_SPECIAL_FILE,
+	EXT4_FC_REASON_ORPHAN,
+	EXT4_FC_REASON_INODE_FREE,
+	EXT4_FC_REASON_ENCRYPTED_DIR,
+	EXT4_FC_REASON_EXTENT_SHIFT,
+	EXT4_FC_REASON_MIGRATE,
+	EXT4_FC_REASON_MOVE_EXT,
+	EXT4_FC_REASON_RESIZE,
+	EXT4_FC_REASON_JOURNAL_FLAG,
+	EXT4_FC_REASON_QUOTA,
+	EXT4_FC_REASON_INODE_FORMAT,
+	EXT4_FC_REASON_EVICT,
+	EXT4_FC_REASON_NOMEM,
+	EXT4_FC_REASON_TOO_BIG,
+	EXT4_FC_REASON_MAX
+};
+
+struct ext4_fc_stats {
+	unsigned long fc_commits;		/* fast commits written */
+	unsigned long fc_ineligible_commits;	/* fell back to full commits */
+	unsigned long fc_failed_commits;	/* fell back after an error */
+	unsigned long fc_blocks;		/* fast commit blocks written */
+	unsigned long fc_replays;		/* mounts which replayed */
+	unsigned long fc_replayed_records;
+	unsigned long fc_ineligible_reasons[EXT4_FC_REASON_MAX];
+};
+
+/* A namespace change waiting to be fast committed */
+struct ext4_fc_dentry_update {
+	struct list_head fcd_list;	/* entry on s_fc_dentry_q */
+	tid_t fcd_tid;
+	int fcd_op;			/* EXT4_FC_TAG_CREAT, _LINK, _UNLINK */
+	unsigned long fcd_parent;
+	unsigned long fcd_ino;
+	unsigned int fcd_name_len;
+	unsigned char fcd_name[0];
+};
+
+#endif /* _EXT4_FAST_COMMIT_H */
@@ -136,6 +136,17 @@ int ext4_sync_file(struct file *file, loff_t start, loff_t end, int datasync)
 	}
 
 	commit_tid = datasync ? ei->i_datasync_tid : ei->i_sync_tid;
+	if (test_opt2(inode->i_sb, JOURNAL_FAST_COMMIT)) {
+		/*
+		 * The fast commit describes the changes of the running
+		 * transaction to this inode; fall back to a full commit of
+		 * that transaction when it cannot.
+		 */
+		ret = ext4_fc_commit(journal, inode, commit_tid);
+		if (ret != -EAGAIN)
+			goto out;
+		ret = 0;
+	}
 	if (journal->j_flags & JBD2_BARRIER &&
 	    !jbd2_trans_will_send_data_barrier(journal, commit_tid))
 		needs_barrier = true;
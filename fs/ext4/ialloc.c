@@ -235,6 +235,7 @@ void ext4_free_inode(handle_t *handle, struct inode *inode)
 			 __func__, __LINE__, inode->i_ino, inode->i_nlink);
 		return;
 	}
+	ext4_fc_mark_ineligible(sb, EXT4_FC_REASON_INODE_FREE, handle);
 	sbi = EXT4_SB(sb);
 
 	ino = inode->i_ino;
@@ -1081,6 +1082,125 @@ out:
 	return ERR_PTR(err);
 }
 
+/*
+ * Mark inode @ino as in use.  Used by fast commit replay to recreate the
+ * allocation of a regular file whose creation was only recorded in a fast
+ * commit.  Returns 1 if the inode was free and is now marked in use, 0 if it
+ * was in use already.
+ */
+int ext4_mark_inode_used(handle_t *handle, struct super_block *sb,
+			 unsigned long ino)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct buffer_head *inode_bitmap_bh = NULL, *group_desc_bh;
+	struct ext4_group_desc *gdp;
+	ext4_group_t group;
+	int bit, free, err;
+
+	if (ino < EXT4_FIRST_INO(sb) ||
+	    ino > le32_to_cpu(sbi->s_es->s_inodes_count))
+		return -EINVAL;
+
+	group = (ino - 1) / EXT4_INODES_PER_GROUP(sb);
+	bit = (ino - 1) % EXT4_INODES_PER_GROUP(sb);
+	inode_bitmap_bh = ext4_read_inode_bitmap(sb, group);
+	if (!inode_bitmap_bh)
+		return -EIO;
+
+	if (ext4_test_bit(bit, inode_bitmap_bh->b_data)) {
+		brelse(inode_bitmap_bh);
+		return 0;
+	}
+
+	gdp = ext4_get_group_desc(sb, group, &group_desc_bh);
+	if (!gdp) {
+		err = -EIO;
+		goto out;
+	}
+
+	BUFFER_TRACE(inode_bitmap_bh, "get_write_access");
+	err = ext4_journal_get_write_access(handle, inode_bitmap_bh);
+	if (err)
+		goto out;
+	BUFFER_TRACE(group_desc_bh, "get_write_access");
+	err = ext4_journal_get_write_access(handle, group_desc_bh);
+	if (err)
+		goto out;
+
+	/* Same block bitmap initialisation as for a freshly allocated inode */
+	if (ext4_has_group_desc_csum(sb) &&
+	    gdp->bg_flags & cpu_to_le16(EXT4_BG_BLOCK_UNINIT)) {
+		struct buffer_head *block_bitmap_bh;
+
+		block_bitmap_bh = ext4_read_block_bitmap(sb, group);
+		if (!block_bitmap_bh) {
+			err = -EIO;
+			goto out;
+		}
+		err = ext4_journal_get_write_access(handle, block_bitmap_bh);
+		if (!err)
+			err = ext4_handle_dirty_metadata(handle, NULL,
+							 block_bitmap_bh);
+		ext4_lock_group(sb, group);
+		if (!err && (gdp->bg_flags &
+			     cpu_to_le16(EXT4_BG_BLOCK_UNINIT))) {
+			gdp->bg_flags &= cpu_to_le16(~EXT4_BG_BLOCK_UNINIT);
+			ext4_free_group_clusters_set(sb, gdp,
+				ext4_free_clusters_after_init(sb, group, gdp));
+			ext4_block_bitmap_csum_set(sb, group, gdp,
+						   block_bitmap_bh);
+		}
+		ext4_unlock_group(sb, group);
+		brelse(block_bitmap_bh);
+		if (err)
+			goto out;
+	}
+
+	if (ext4_has_group_desc_csum(sb)) {
+		struct ext4_group_info *grp = ext4_get_group_info(sb, group);
+
+		down_read(&grp->alloc_sem); /* protect vs itable lazyinit */
+		ext4_lock_group(sb, group);
+		ext4_set_bit(bit, inode_bitmap_bh->b_data);
+		free = EXT4_INODES_PER_GROUP(sb) -
+			ext4_itable_unused_count(sb, gdp);
+		if (gdp->bg_flags & cpu_to_le16(EXT4_BG_INODE_UNINIT)) {
+			gdp->bg_flags &= cpu_to_le16(~EXT4_BG_INODE_UNINIT);
+			free = 0;
+		}
+		if (bit + 1 > free)
+			ext4_itable_unused_set(sb, gdp,
+					EXT4_INODES_PER_GROUP(sb) - bit - 1);
+		up_read(&grp->alloc_sem);
+	} else {
+		ext4_lock_group(sb, group);
+		ext4_set_bit(bit, inode_bitmap_bh->b_data);
+	}
+	ext4_free_inodes_set(sb, gdp, ext4_free_inodes_count(sb, gdp) - 1);
+	if (ext4_has_group_desc_csum(sb)) {
+		ext4_inode_bitmap_csum_set(sb, group, gdp, inode_bitmap_bh,
+					   EXT4_INODES_PER_GROUP(sb) / 8);
+		ext4_group_desc_csum_set(sb, group, gdp);
+	}
+	ext4_unlock_group(sb, group);
+
+	percpu_counter_dec(&sbi->s_freeinodes_counter);
+	if (sbi->s_log_groups_per_flex)
+		atomic_dec(&sbi->s_flex_groups[ext4_flex_group(sbi,
+							group)].free_inodes);
+
+	BUFFER_TRACE(inode_bitmap_bh, "call ext4_handle_dirty_metadata");
+	err = ext4_handle_dirty_metadata(handle, NULL, inode_bitmap_bh);
+	if (!err) {
+		BUFFER_TRACE(group_desc_bh, "call ext4_handle_dirty_metadata");
+		err = ext4_handle_dirty_metadata(handle, NULL, group_desc_bh);
+	}
+out:
+	brelse(inode_bitmap_bh);
+	ext4_std_error(sb, err);
+	return err ? err : 1;
+}
+
 /* Verify that we are loading a valid orphan from disk */
 struct inode *ext4_orphan_get(struct super_block *sb, unsigned long ino)
 {
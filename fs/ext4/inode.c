@@ -658,6 +658,9 @@ found:
 
 has_zeroout:
 	up_write((&EXT4_I(inode)->i_data_sem));
+	if (retval > 0)
+		ext4_fc_track_range(handle, inode, map->m_lblk,
+				    map->m_lblk + map->m_len - 1);
 	if (retval > 0 && map->m_flags & EXT4_MAP_MAPPED) {
 		ret = check_block_validity(inode, map);
 		if (ret != 0)
@@ -3717,6 +3720,8 @@ int ext4_punch_hole(struct inode *inode, loff_t offset, loff_t length)
 		down_write(&EXT4_I(inode)->i_data_sem);
 		ext4_discard_preallocations(inode);
 
+		ext4_fc_track_range(handle, inode, first_block,
+				    stop_block - 1);
 		ret = ext4_es_remove_extent(inode, first_block,
 					    stop_block - first_block);
 		if (ret) {
@@ -4058,6 +4063,95 @@ int ext4_get_inode_loc(struct inode *inode, struct ext4_iloc *iloc)
 		!ext4_test_inode_state(inode, EXT4_STATE_XATTR));
 }
 
+/*
+ * Write the raw inode image @raw over on-disk inode @ino.  If @keep_blocks
+ * is set, the block map, block count and xattr block of the on-disk inode
+ * are preserved, and so is the size of anything but a regular file.  Used
+ * by fast commit replay, which rebuilds block maps separately and has no
+ * in-core inode to write from.
+ */
+int ext4_write_raw_inode(handle_t *handle, struct super_block *sb,
+			 unsigned long ino, struct ext4_inode *raw,
+			 int keep_blocks)
+{
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_inode_info *ei;
+	struct ext4_inode *dst;
+	struct ext4_iloc iloc;
+	struct inode *inode;
+	__le32 i_block[EXT4_N_BLOCKS];
+	__le32 blocks_lo = 0, acl_lo = 0, size_lo = 0, size_high = 0;
+	__le16 blocks_high = 0, acl_high = 0;
+	int err;
+
+	inode = iget_locked(sb, ino);
+	if (!inode)
+		return -ENOMEM;
+	if (!(inode->i_state & I_NEW)) {
+		/* Someone is using the inode, its in-core copy would win */
+		iput(inode);
+		return -EBUSY;
+	}
+	ei = EXT4_I(inode);
+
+	err = __ext4_get_inode_loc(inode, &iloc, 0);
+	if (err)
+		goto out;
+	BUFFER_TRACE(iloc.bh, "get_write_access");
+	err = ext4_journal_get_write_access(handle, iloc.bh);
+	if (err)
+		goto out_brelse;
+
+	dst = ext4_raw_inode(&iloc);
+	if (keep_blocks) {
+		memcpy(i_block, dst->i_block, sizeof(i_block));
+		blocks_lo = dst->i_blocks_lo;
+		blocks_high = dst->i_blocks_high;
+		acl_lo = dst->i_file_acl_lo;
+		acl_high = dst->i_file_acl_high;
+		size_lo = dst->i_size_lo;
+		size_high = dst->i_size_high;
+	}
+	memcpy(dst, raw, EXT4_INODE_SIZE(sb));
+	if (keep_blocks) {
+		memcpy(dst->i_block, i_block, sizeof(i_block));
+		dst->i_blocks_lo = blocks_lo;
+		dst->i_blocks_high = blocks_high;
+		dst->i_file_acl_lo = acl_lo;
+		dst->i_file_acl_high = acl_high;
+		/* Only regular files have their size tied to the block map */
+		if (!S_ISREG(le16_to_cpu(raw->i_mode))) {
+			dst->i_size_lo = size_lo;
+			dst->i_size_high = size_high;
+		}
+	}
+
+	if (EXT4_INODE_SIZE(sb) > EXT4_GOOD_OLD_INODE_SIZE)
+		ei->i_extra_isize = le16_to_cpu(dst->i_extra_isize);
+	else
+		ei->i_extra_isize = 0;
+	if (ext4_has_metadata_csum(sb)) {
+		__u32 csum;
+		__le32 inum = cpu_to_le32(ino);
+		__le32 gen = dst->i_generation;
+		csum = ext4_chksum(sbi, sbi->s_csum_seed, (__u8 *)&inum,
+				   sizeof(inum));
+		ei->i_csum_seed = ext4_chksum(sbi, csum, (__u8 *)&gen,
+					      sizeof(gen));
+	}
+	ext4_inode_csum_set(inode, dst, ei);
+
+	BUFFER_TRACE(iloc.bh, "call ext4_handle_dirty_metadata");
+	err = ext4_handle_dirty_metadata(handle, NULL, iloc.bh);
+out_brelse:
+	brelse(iloc.bh);
+out:
+	/* Never let the half set up in-core inode be found */
+	remove_inode_hash(inode);
+	iget_failed(inode);
+	return err;
+}
+
 void ext4_set_inode_flags(struct inode *inode)
 {
 	unsigned int flags = EXT4_I(inode)->i_flags;
@@ -4729,6 +4823,9 @@ int ext4_setattr(struct dentry *dentry, struct iattr *attr)
 			error = PTR_ERR(handle);
 			goto err_out;
 		}
+		/* Fast commit replay does not redo quota transfers */
+		ext4_fc_mark_ineligible(inode->i_sb, EXT4_FC_REASON_QUOTA,
+					handle);
 		error = dquot_transfer(inode, attr);
 		if (error) {
 			ext4_journal_stop(handle);
@@ -4983,6 +5080,8 @@ int ext4_mark_iloc_dirty(handle_t *handle,
 	if (IS_I_VERSION(inode))
 		inode_inc_iversion(inode);
 
+	ext4_fc_track_inode(handle, inode);
+
 	/* the do_update_inode consumes one bh->b_count */
 	get_bh(iloc->bh);
 
@@ -5240,6 +5339,8 @@ int ext4_change_inode_journal_flag(struct inode *inode, int val)
 	if (IS_ERR(handle))
 		return PTR_ERR(handle);
 
+	ext4_fc_mark_ineligible(inode->i_sb, EXT4_FC_REASON_JOURNAL_FLAG,
+				handle);
 	err = ext4_mark_inode_dirty(handle, inode);
 	ext4_handle_sync(handle);
 	ext4_journal_stop(handle);
@@ -5019,6 +5019,127 @@ error_return:
 	return err;
 }
 
+/**
+ * ext4_mb_mark_bb_used() -- mark blocks as in use without allocating them
+ * @handle:		handle to this transaction
+ * @sb:			super block
+ * @block:		start physical block
+ * @count:		number of blocks
+ *
+ * Used by fast commit replay, which must claim blocks a fast commit recorded
+ * as allocated before they can be handed out again.  Blocks which are
+ * already in use are left alone, so replay may be restarted.
+ */
+int ext4_mb_mark_bb_used(handle_t *handle, struct super_block *sb,
+			 ext4_fsblk_t block, unsigned long count)
+{
+	struct buffer_head *bitmap_bh = NULL;
+	struct buffer_head *gd_bh;
+	ext4_group_t block_group;
+	ext4_grpblk_t bit, i, end;
+	struct ext4_group_desc *desc;
+	struct ext4_sb_info *sbi = EXT4_SB(sb);
+	struct ext4_free_extent ex;
+	struct ext4_buddy e4b;
+	unsigned long len;
+	int err = 0, ret;
+	ext4_grpblk_t blocks_used;
+
+	while (count > 0 && !err) {
+		ext4_get_group_no_and_offset(sb, block, &block_group, &bit);
+		len = min_t(unsigned long, count,
+			    EXT4_BLOCKS_PER_GROUP(sb) - bit);
+
+		if (!ext4_data_block_valid(sbi, block, len)) {
+			ext4_error(sb, "Marking blocks in system zones - "
+				   "Block = %llu, count = %lu", block, len);
+			err = -EINVAL;
+			break;
+		}
+
+		bitmap_bh = ext4_read_block_bitmap(sb, block_group);
+		if (!bitmap_bh) {
+			err = -EIO;
+			break;
+		}
+
+		desc = ext4_get_group_desc(sb, block_group, &gd_bh);
+		if (!desc) {
+			err = -EIO;
+			break;
+		}
+
+		BUFFER_TRACE(bitmap_bh, "getting write access");
+		err = ext4_journal_get_write_access(handle, bitmap_bh);
+		if (err)
+			break;
+		BUFFER_TRACE(gd_bh, "get_write_access");
+		err = ext4_journal_get_write_access(handle, gd_bh);
+		if (err)
+			break;
+
+		err = ext4_mb_load_buddy(sb, block_group, &e4b);
+		if (err)
+			break;
+
+		ext4_lock_group(sb, block_group);
+		if (ext4_has_group_desc_csum(sb) &&
+		    (desc->bg_flags & cpu_to_le16(EXT4_BG_BLOCK_UNINIT))) {
+			desc->bg_flags &= cpu_to_le16(~EXT4_BG_BLOCK_UNINIT);
+			ext4_free_group_clusters_set(sb, desc,
+				ext4_free_clusters_after_init(sb, block_group,
+							      desc));
+		}
+		blocks_used = 0;
+		for (i = bit; i < bit + len; i = end) {
+			i = mb_find_next_zero_bit(bitmap_bh->b_data,
+						  bit + len, i);
+			if (i >= bit + len)
+				break;
+			end = mb_find_next_bit(bitmap_bh->b_data, bit + len, i);
+			ex.fe_group = block_group;
+			ex.fe_start = i;
+			ex.fe_len = end - i;
+			ex.fe_logical = 0;
+			mb_mark_used(&e4b, &ex);
+			ext4_set_bits(bitmap_bh->b_data, i, end - i);
+			blocks_used += end - i;
+		}
+		ext4_free_group_clusters_set(sb, desc,
+			ext4_free_group_clusters(sb, desc) - blocks_used);
+		ext4_block_bitmap_csum_set(sb, block_group, desc, bitmap_bh);
+		ext4_group_desc_csum_set(sb, block_group, desc);
+		ext4_unlock_group(sb, block_group);
+		percpu_counter_sub(&sbi->s_freeclusters_counter,
+				   EXT4_NUM_B2C(sbi, blocks_used));
+
+		if (sbi->s_log_groups_per_flex) {
+			ext4_group_t flex_group = ext4_flex_group(sbi,
+								  block_group);
+			atomic64_sub(EXT4_NUM_B2C(sbi, blocks_used),
+				     &sbi->s_flex_groups[flex_group].free_clusters);
+		}
+
+		ext4_mb_unload_buddy(&e4b);
+
+		BUFFER_TRACE(bitmap_bh, "dirtied bitmap block");
+		err = ext4_handle_dirty_metadata(handle, NULL, bitmap_bh);
+		BUFFER_TRACE(gd_bh, "dirtied group descriptor block");
+		ret = ext4_handle_dirty_metadata(handle, NULL, gd_bh);
+		if (!err)
+			err = ret;
+
+		brelse(bitmap_bh);
+		bitmap_bh = NULL;
+		block += len;
+		count -= len;
+	}
+
+	brelse(bitmap_bh);
+	ext4_std_error(sb, err);
+	return err;
+}
+
 /**
  * ext4_trim_extent -- function to TRIM one single free extent in the group
  * @sb:		super block for the file system
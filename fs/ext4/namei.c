@@ -2463,6 +2463,8 @@ retry:
 		inode->i_fop = &ext4_file_operations;
 		ext4_set_aops(inode);
 		err = ext4_add_nondir(handle, dentry, inode);
+		if (!err)
+			ext4_fc_track_create(handle, dentry);
 		if (!err && IS_DIRSYNC(dir))
 			ext4_handle_sync(handle);
 	}
@@ -2493,6 +2495,8 @@ retry:
 	handle = ext4_journal_current_handle();
 	err = PTR_ERR(inode);
 	if (!IS_ERR(inode)) {
+		ext4_fc_mark_ineligible(dir->i_sb, EXT4_FC_REASON_SPECIAL_FILE,
+					handle);
 		init_special_inode(inode, inode->i_mode, rdev);
 		inode->i_op = &ext4_special_inode_operations;
 		err = ext4_add_nondir(handle, dentry, inode);
@@ -2637,6 +2641,7 @@ retry:
 	err = PTR_ERR(inode);
 	if (IS_ERR(inode))
 		goto out_stop;
+	ext4_fc_mark_ineligible(dir->i_sb, EXT4_FC_REASON_DIR_OP, handle);
 
 	inode->i_op = &ext4_dir_inode_operations;
 	inode->i_fop = &ext4_dir_operations;
@@ -2766,6 +2771,10 @@ int ext4_orphan_add(handle_t *handle, struct inode *inode)
 	if (!sbi->s_journal || is_bad_inode(inode))
 		return 0;
 
+	/* Replay cannot put inodes on the orphan list */
+	if (!inode->i_nlink)
+		ext4_fc_mark_ineligible(sb, EXT4_FC_REASON_ORPHAN, handle);
+
 	WARN_ON_ONCE(!(inode->i_state & (I_NEW | I_FREEING)) &&
 		     !mutex_is_locked(&inode->i_mutex));
 	/*
@@ -2958,6 +2967,7 @@ static int ext4_rmdir(struct inode *dir, struct dentry *dentry)
 	if (IS_DIRSYNC(dir))
 		ext4_handle_sync(handle);
 
+	ext4_fc_mark_ineligible(dir->i_sb, EXT4_FC_REASON_DIR_OP, handle);
 	retval = ext4_delete_entry(handle, dir, de, bh);
 	if (retval)
 		goto end_rmdir;
@@ -3032,6 +3042,7 @@ static int ext4_unlink(struct inode *dir, struct dentry *dentry)
 	retval = ext4_delete_entry(handle, dir, de, bh);
 	if (retval)
 		goto end_unlink;
+	ext4_fc_track_unlink(handle, dentry);
 	dir->i_ctime = dir->i_mtime = ext4_current_time(dir);
 	ext4_update_dx_flag(dir);
 	ext4_mark_inode_dirty(handle, dir);
@@ -3116,6 +3127,8 @@ static int ext4_symlink(struct inode *dir,
 		err = PTR_ERR(inode);
 		goto err_free_sd;
 	}
+	ext4_fc_mark_ineligible(dir->i_sb, EXT4_FC_REASON_SPECIAL_FILE,
+				handle);
 
 	if (encryption_required) {
 		struct qstr istr;
@@ -3234,9 +3247,13 @@ retry:
 		/* this can happen only for tmpfile being
 		 * linked the first time
 		 */
-		if (inode->i_nlink == 1)
+		if (inode->i_nlink == 1) {
+			ext4_fc_mark_ineligible(dir->i_sb,
+						EXT4_FC_REASON_ORPHAN, handle);
 			ext4_orphan_del(handle, inode);
+		}
 		d_instantiate(dentry, inode);
+		ext4_fc_track_link(handle, dentry);
 	} else {
 		drop_nlink(inode);
 		iput(inode);
@@ -3248,6 +3265,90 @@ retry:
 }
 
 
+/*
+ * Directory entry helpers for fast commit replay.  Replay has no dentries
+ * for the names it recreates, so it builds a throwaway one under an alias
+ * of the directory.  Both are idempotent, in case replay gets restarted.
+ */
+int ext4_fc_add_dentry(struct inode *dir, struct inode *inode,
+		       const struct qstr *name)
+{
+	struct dentry *parent, *dentry;
+	struct ext4_dir_entry_2 *de;
+	struct buffer_head *bh;
+	handle_t *handle;
+	int err;
+
+	bh = ext4_find_entry(dir, name, &de, NULL);
+	if (IS_ERR(bh))
+		return PTR_ERR(bh);
+	if (bh) {
+		err = le32_to_cpu(de->inode) == inode->i_ino ? 0 : -EEXIST;
+		brelse(bh);
+		return err;
+	}
+
+	ihold(dir);
+	parent = d_obtain_alias(dir);
+	if (IS_ERR(parent))
+		return PTR_ERR(parent);
+	dentry = d_alloc(parent, name);
+	if (!dentry) {
+		dput(parent);
+		return -ENOMEM;
+	}
+
+	handle = ext4_journal_start(dir, EXT4_HT_DIR,
+		(EXT4_DATA_TRANS_BLOCKS(dir->i_sb) +
+		 EXT4_INDEX_EXTRA_TRANS_BLOCKS) + 1);
+	if (IS_ERR(handle)) {
+		err = PTR_ERR(handle);
+	} else {
+		err = ext4_add_entry(handle, dentry, inode);
+		ext4_journal_stop(handle);
+	}
+	/* Don't leave the alias holding a stale copy of dir in the dcache */
+	d_drop(parent);
+	dput(dentry);
+	dput(parent);
+	return err;
+}
+
+int ext4_fc_del_dentry(struct inode *dir, unsigned long ino,
+		       const struct qstr *name)
+{
+	struct ext4_dir_entry_2 *de;
+	struct buffer_head *bh;
+	handle_t *handle;
+	int err;
+
+	bh = ext4_find_entry(dir, name, &de, NULL);
+	if (IS_ERR(bh))
+		return PTR_ERR(bh);
+	if (!bh)
+		return 0;
+	if (le32_to_cpu(de->inode) != ino) {
+		brelse(bh);
+		return 0;
+	}
+
+	handle = ext4_journal_start(dir, EXT4_HT_DIR,
+				    EXT4_DATA_TRANS_BLOCKS(dir->i_sb));
+	if (IS_ERR(handle)) {
+		brelse(bh);
+		return PTR_ERR(handle);
+	}
+	err = ext4_delete_entry(handle, dir, de, bh);
+	if (!err) {
+		dir->i_ctime = dir->i_mtime = ext4_current_time(dir);
+		ext4_update_dx_flag(dir);
+		err = ext4_mark_inode_dirty(handle, dir);
+	}
+	ext4_journal_stop(handle);
+	brelse(bh);
+	return err;
+}
+
 /*
  * Try to find buffer head where contains the parent block.
  * It should be the inode block if it is inlined or the 1st block
@@ -3556,6 +3657,7 @@ static int ext4_rename(struct inode *old_dir, struct dentry *old_dentry,
 
 	if (IS_DIRSYNC(old.dir) || IS_DIRSYNC(new.dir))
 		ext4_handle_sync(handle);
+	ext4_fc_mark_ineligible(old.dir->i_sb, EXT4_FC_REASON_RENAME, handle);
 
 	if (S_ISDIR(old.inode->i_mode)) {
 		if (new.inode) {
@@ -3733,6 +3835,7 @@ static int ext4_cross_rename(struct inode *old_dir, struct dentry *old_dentry,
 
 	if (IS_DIRSYNC(old.dir) || IS_DIRSYNC(new.dir))
 		ext4_handle_sync(handle);
+	ext4_fc_mark_ineligible(old.dir->i_sb, EXT4_FC_REASON_RENAME, handle);
 
 	if (S_ISDIR(old.inode->i_mode)) {
 		old.is_dir = true;
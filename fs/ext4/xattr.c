@@ -826,6 +826,8 @@ ext4_xattr_block_set(handle_t *handle, struct inode *inode,
 	int error = 0;
 	struct mb2_cache *ext4_mb_cache = EXT4_GET_MB_CACHE(inode);
 
+	ext4_fc_mark_ineligible(sb, EXT4_FC_REASON_XATTR, handle);
+
 #define header(x) ((struct ext4_xattr_header *)(x))
 
 	if (i->value && i->value_len > sb->s_blocksize)
@@ -0,0 +1,1403 @@
+/*
+ * Shared application/kernel submission and completion ring pairs, for
+ * supporting fast/efficient IO.
+ *
+ * A note on the read/write ordering memory barriers that are matched between
+ * the application and kernel side. When the application reads the CQ ring
+ * tail, it must use an appropriate smp_rmb() to order with the smp_wmb()
+ * the kernel uses after writing the tail. Failure to do so could cause a
+ * delay in when the application notices that completion events available.
+ * This isn't a fatal condition. Likewise, the application must use an
+ * appropriate smp_wmb() both before writing the SQ tail, and after writing
+ * the SQ tail. The first one orders the sqe writes with the tail write, and
+ * the latter is paired with the smp_rmb() the kernel will issue before
+ * reading the SQ tail on submission.
+ *
+ * Requests are first issued from the submitting context without blocking:
+ * regular file reads whose data is in the page cache, and reads, writes and
+ * socket operations on files that are ready according to their ->poll()
+ * method. Reads and writes on files that are not ready yet are parked on the
+ * file's wait queue and retried once it signals. Everything else is handed
+ * to a per ring workqueue, which issues the request on behalf of the task
+ * that created the ring.
+ */
+#include <linux/kernel.h>
+#include <linux/init.h>
+#include <linux/errno.h>
+#include <linux/syscalls.h>
+#include <linux/compat.h>
+#include <linux/uio.h>
+
+#include <linux/sched.h>
+#include <linux/fs.h>
+#include <linux/file.h>
+#include <linux/fdtable.h>
+#include <linux/mm.h>
+#include <linux/mman.h>
+#include <linux/mmu_context.h>
+#include <linux/pagemap.h>
+#include <linux/percpu.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
+#include <linux/kthread.h>
+#include <linux/poll.h>
+#include <linux/net.h>
+#include <linux/socket.h>
+#include <linux/anon_inodes.h>
+#include <linux/cred.h>
+#include <linux/log2.h>
+
+#include <asm/uaccess.h>
+
+#include <uapi/linux/io_uring.h>
+
+#define IORING_MAX_ENTRIES	4096
+
+/*
+ * Reads on regular files are issued inline when this many pages or less
+ * cover the range and all of them are up to date in the page cache.
+ */
+#define IO_CACHED_MAX_PAGES	32
+
+struct io_uring {
+	u32 head ____cacheline_aligned_in_smp;
+	u32 tail ____cacheline_aligned_in_smp;
+};
+
+struct io_sq_ring {
+	struct io_uring		r;
+	u32			ring_mask;
+	u32			ring_entries;
+	u32			dropped;
+	u32			flags;
+	u32			array[];
+};
+
+struct io_cq_ring {
+	struct io_uring		r;
+	u32			ring_mask;
+	u32			ring_entries;
+	u32			overflow;
+	struct io_uring_cqe	cqes[];
+};
+
+struct io_ring_ctx {
+	unsigned int		flags;
+	bool			dying;
+
+	/* SQ ring */
+	struct io_sq_ring	*sq_ring;
+	unsigned		cached_sq_head;
+	unsigned		sq_entries;
+	unsigned		sq_mask;
+	unsigned		sq_thread_idle;
+	struct io_uring_sqe	*sq_sqes;
+
+	/* CQ ring */
+	struct io_cq_ring	*cq_ring;
+	unsigned		cached_cq_tail;
+	unsigned		cq_entries;
+	unsigned		cq_mask;
+
+	/* the task that created the ring, requests run on its behalf */
+	struct task_struct	*sqo_task;
+	struct mm_struct	*sqo_mm;
+	const struct cred	*creds;
+
+	struct task_struct	*sqo_thread;
+	wait_queue_head_t	sqo_wait;
+	struct workqueue_struct	*sqo_wq;
+
+	struct mutex		uring_lock;
+	wait_queue_head_t	wait;
+	wait_queue_head_t	cq_wait;
+
+	spinlock_t		completion_lock ____cacheline_aligned_in_smp;
+	/* requests waiting for their file to become ready */
+	struct list_head	cancel_list;
+
+	/* one per request in flight, plus one for the ring file */
+	atomic_t		refs;
+	struct completion	ctx_done;
+};
+
+struct io_poll_iocb {
+	wait_queue_head_t	*head;
+	unsigned int		events;
+	bool			canceled;
+	bool			arming;
+	wait_queue_t		wait;
+};
+
+struct io_kiocb {
+	struct io_ring_ctx	*ctx;
+	struct file		*file;
+	struct list_head	list;
+	struct io_poll_iocb	poll;
+	struct work_struct	work;
+	struct io_uring_sqe	sqe;
+};
+
+struct io_poll_table {
+	struct poll_table_struct pt;
+	struct io_kiocb		*req;
+	int			error;
+};
+
+static struct kmem_cache *req_cachep;
+
+static const struct file_operations io_uring_fops;
+
+static void io_async_work(struct work_struct *work);
+
+static struct io_ring_ctx *io_ring_ctx_alloc(struct io_uring_params *p)
+{
+	struct io_ring_ctx *ctx;
+
+	ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+	if (!ctx)
+		return NULL;
+
+	ctx->flags = p->flags;
+	init_waitqueue_head(&ctx->sqo_wait);
+	init_waitqueue_head(&ctx->wait);
+	init_waitqueue_head(&ctx->cq_wait);
+	mutex_init(&ctx->uring_lock);
+	spin_lock_init(&ctx->completion_lock);
+	INIT_LIST_HEAD(&ctx->cancel_list);
+	atomic_set(&ctx->refs, 1);
+	init_completion(&ctx->ctx_done);
+	return ctx;
+}
+
+static void io_ring_ctx_put(struct io_ring_ctx *ctx)
+{
+	if (atomic_dec_and_test(&ctx->refs))
+		complete(&ctx->ctx_done);
+}
+
+static void io_commit_cqring(struct io_ring_ctx *ctx)
+{
+	struct io_cq_ring *ring = ctx->cq_ring;
+
+	if (ctx->cached_cq_tail != READ_ONCE(ring->r.tail)) {
+		/* order cqe stores with ring update */
+		smp_store_release(&ring->r.tail, ctx->cached_cq_tail);
+	}
+}
+
+static struct io_uring_cqe *io_get_cqring(struct io_ring_ctx *ctx)
+{
+	struct io_cq_ring *ring = ctx->cq_ring;
+	unsigned tail;
+
+	tail = ctx->cached_cq_tail;
+	/* See comment at the top of the file */
+	smp_rmb();
+	if (tail - READ_ONCE(ring->r.head) >= ctx->cq_entries)
+		return NULL;
+
+	ctx->cached_cq_tail++;
+	return &ring->cqes[tail & ctx->cq_mask];
+}
+
+static void io_cqring_fill_event(struct io_ring_ctx *ctx, u64 ki_user_data,
+				 long res)
+{
+	struct io_uring_cqe *cqe;
+
+	/*
+	 * If we can't get a cq entry, userspace overflowed the
+	 * submission (by quite a lot). Increment the overflow count in
+	 * the ring.
+	 */
+	cqe = io_get_cqring(ctx);
+	if (cqe) {
+		WRITE_ONCE(cqe->user_data, ki_user_data);
+		WRITE_ONCE(cqe->res, res);
+		WRITE_ONCE(cqe->flags, 0);
+	} else {
+		unsigned overflow = READ_ONCE(ctx->cq_ring->overflow);
+
+		WRITE_ONCE(ctx->cq_ring->overflow, overflow + 1);
+	}
+}
+
+static void io_cqring_ev_posted(struct io_ring_ctx *ctx)
+{
+	/* pairs with the barrier implied by prepare_to_wait() */
+	smp_mb();
+	if (waitqueue_active(&ctx->wait))
+		wake_up(&ctx->wait);
+	if (waitqueue_active(&ctx->cq_wait))
+		wake_up_interruptible(&ctx->cq_wait);
+}
+
+static void io_cqring_add_event(struct io_ring_ctx *ctx, u64 user_data,
+				long res)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&ctx->completion_lock, flags);
+	io_cqring_fill_event(ctx, user_data, res);
+	io_commit_cqring(ctx);
+	spin_unlock_irqrestore(&ctx->completion_lock, flags);
+
+	io_cqring_ev_posted(ctx);
+}
+
+static struct io_kiocb *io_get_req(struct io_ring_ctx *ctx)
+{
+	struct io_kiocb *req;
+
+	req = kmem_cache_alloc(req_cachep, GFP_KERNEL);
+	if (!req)
+		return NULL;
+
+	atomic_inc(&ctx->refs);
+	req->ctx = ctx;
+	req->file = NULL;
+	INIT_LIST_HEAD(&req->list);
+	INIT_WORK(&req->work, io_async_work);
+	req->poll.head = NULL;
+	req->poll.canceled = false;
+	return req;
+}
+
+/*
+ * May be called from the wakeup callback of the file a request waits on,
+ * fput() defers the final release in that case.
+ */
+static void io_free_req(struct io_kiocb *req)
+{
+	struct io_ring_ctx *ctx = req->ctx;
+
+	if (req->file)
+		fput(req->file);
+	kmem_cache_free(req_cachep, req);
+	io_ring_ctx_put(ctx);
+}
+
+/*
+ * Workers and the SQ thread issue requests on behalf of the task that
+ * created the ring, borrowing its address space and descriptor table, the
+ * latter so that descriptors passed over sockets end up in the right table.
+ */
+static int io_attach_owner(struct io_ring_ctx *ctx,
+			   struct files_struct **old_files)
+{
+	struct mm_struct *mm = ctx->sqo_mm;
+	struct files_struct *files;
+
+	if (!atomic_inc_not_zero(&mm->mm_users))
+		return -EFAULT;
+
+	files = get_files_struct(ctx->sqo_task);
+	if (!files) {
+		mmput(mm);
+		return -EBADF;
+	}
+
+	use_mm(mm);
+	task_lock(current);
+	*old_files = current->files;
+	current->files = files;
+	task_unlock(current);
+	return 0;
+}
+
+static void io_detach_owner(struct io_ring_ctx *ctx,
+			    struct files_struct *old_files)
+{
+	struct files_struct *files = current->files;
+
+	task_lock(current);
+	current->files = old_files;
+	task_unlock(current);
+	put_files_struct(files);
+
+	unuse_mm(ctx->sqo_mm);
+	mmput(ctx->sqo_mm);
+}
+
+static int io_poll_wake(wait_queue_t *wait, unsigned mode, int sync,
+			void *key)
+{
+	struct io_poll_iocb *poll = container_of(wait, struct io_poll_iocb,
+						 wait);
+	struct io_kiocb *req = container_of(poll, struct io_kiocb, poll);
+	struct io_ring_ctx *ctx = req->ctx;
+	unsigned int mask = (unsigned long)key;
+	unsigned long flags;
+
+	/* for instances that support it check for an event match first */
+	if (mask && !(mask & poll->events))
+		return 0;
+
+	list_del_init(&poll->wait.task_list);
+
+	/* io_poll_arm() picks this up once it is done with the request */
+	if (poll->arming)
+		return 1;
+
+	/*
+	 * A plain poll request completes right here if the event is known,
+	 * anything else is retried from a worker.
+	 */
+	if (req->sqe.opcode == IORING_OP_POLL_ADD && mask &&
+	    spin_trylock_irqsave(&ctx->completion_lock, flags)) {
+		list_del_init(&req->list);
+		io_cqring_fill_event(ctx, req->sqe.user_data, mask);
+		io_commit_cqring(ctx);
+		spin_unlock_irqrestore(&ctx->completion_lock, flags);
+
+		io_cqring_ev_posted(ctx);
+		io_free_req(req);
+	} else {
+		queue_work(ctx->sqo_wq, &req->work);
+	}
+
+	return 1;
+}
+
+static void io_poll_queue_proc(struct file *file, wait_queue_head_t *head,
+			       poll_table *p)
+{
+	struct io_poll_table *pt = container_of(p, struct io_poll_table, pt);
+	struct io_poll_iocb *poll = &pt->req->poll;
+
+	/* multiple wait queues per file are not supported */
+	if (unlikely(poll->head)) {
+		pt->error = -EINVAL;
+		return;
+	}
+
+	pt->error = 0;
+	poll->head = head;
+	add_wait_queue(head, &poll->wait);
+}
+
+/**
+ * io_poll_arm - wait for the file of a request to become ready
+ * @req:	request with a file
+ * @events:	POLL* events to wait for
+ *
+ * Returns the ready events if the file is ready already, in which case the
+ * request is not queued. Returns 0 once the request waits on the file: its
+ * work is queued when the file signals, and the caller must not touch the
+ * request anymore. Returns a negative error if the file can't be waited on.
+ */
+static int io_poll_arm(struct io_kiocb *req, unsigned int events)
+{
+	struct io_poll_iocb *poll = &req->poll;
+	struct io_ring_ctx *ctx = req->ctx;
+	struct file *file = req->file;
+	struct io_poll_table ipt;
+	bool queue = false;
+	unsigned int mask;
+	int ret;
+
+	if (!file->f_op->poll)
+		return -EINVAL;
+
+	poll->head = NULL;
+	poll->arming = true;
+	poll->events = events | POLLERR | POLLHUP;
+	INIT_LIST_HEAD(&poll->wait.task_list);
+	init_waitqueue_func_entry(&poll->wait, io_poll_wake);
+
+	init_poll_funcptr(&ipt.pt, io_poll_queue_proc);
+	ipt.pt._key = poll->events;
+	ipt.req = req;
+	ipt.error = -EINVAL;
+
+	mask = file->f_op->poll(file, &ipt.pt) & poll->events;
+
+	spin_lock_irq(&ctx->completion_lock);
+	ret = ipt.error;
+	if (likely(poll->head)) {
+		spin_lock(&poll->head->lock);
+		poll->arming = false;
+		if (list_empty(&poll->wait.task_list)) {
+			/* woken up while arming, look again from a worker */
+			queue = !mask && !ret;
+		} else if (mask || ret || ctx->dying) {
+			list_del_init(&poll->wait.task_list);
+			if (!mask && !ret)
+				ret = -ECANCELED;
+		} else {
+			list_add_tail(&req->list, &ctx->cancel_list);
+		}
+		spin_unlock(&poll->head->lock);
+	}
+	spin_unlock_irq(&ctx->completion_lock);
+
+	if (queue)
+		queue_work(ctx->sqo_wq, &req->work);
+	if (mask)
+		return mask;
+	return ret;
+}
+
+static void io_poll_remove_one(struct io_kiocb *req)
+{
+	struct io_poll_iocb *poll = &req->poll;
+
+	spin_lock(&poll->head->lock);
+	WRITE_ONCE(poll->canceled, true);
+	if (!list_empty(&poll->wait.task_list)) {
+		list_del_init(&poll->wait.task_list);
+		queue_work(req->ctx->sqo_wq, &req->work);
+	}
+	spin_unlock(&poll->head->lock);
+
+	list_del_init(&req->list);
+}
+
+static void io_poll_remove_all(struct io_ring_ctx *ctx)
+{
+	struct io_kiocb *req;
+
+	spin_lock_irq(&ctx->completion_lock);
+	ctx->dying = true;
+	while (!list_empty(&ctx->cancel_list)) {
+		req = list_first_entry(&ctx->cancel_list, struct io_kiocb,
+				       list);
+		io_poll_remove_one(req);
+	}
+	spin_unlock_irq(&ctx->completion_lock);
+}
+
+/*
+ * Cancel the request waiting on its file whose user_data matches sqe->addr.
+ */
+static int io_poll_remove(struct io_kiocb *req)
+{
+	struct io_ring_ctx *ctx = req->ctx;
+	struct io_kiocb *poll_req, *next;
+	int ret = -ENOENT;
+
+	if (req->sqe.ioprio || req->sqe.off || req->sqe.len ||
+	    req->sqe.poll_events)
+		return -EINVAL;
+
+	spin_lock_irq(&ctx->completion_lock);
+	list_for_each_entry_safe(poll_req, next, &ctx->cancel_list, list) {
+		if (req->sqe.addr == poll_req->sqe.user_data) {
+			io_poll_remove_one(poll_req);
+			ret = 0;
+			break;
+		}
+	}
+	spin_unlock_irq(&ctx->completion_lock);
+
+	return ret;
+}
+
+static int io_poll_add(struct io_kiocb *req)
+{
+	int ret;
+
+	if (req->sqe.addr || req->sqe.ioprio || req->sqe.off ||
+	    req->sqe.len)
+		return -EINVAL;
+
+	ret = io_poll_arm(req, req->sqe.poll_events);
+	if (!ret)
+		return -EIOCBQUEUED;
+	return ret;
+}
+
+static bool io_range_cached(struct file *file, loff_t pos, size_t len)
+{
+	struct address_space *mapping = file->f_mapping;
+	loff_t isize = i_size_read(mapping->host);
+	pgoff_t index, end;
+	struct page *page;
+	bool uptodate;
+
+	if (pos >= isize || !len)
+		return true;
+	if (len > isize - pos)
+		len = isize - pos;
+
+	index = pos >> PAGE_CACHE_SHIFT;
+	end = (pos + len - 1) >> PAGE_CACHE_SHIFT;
+	if (end - index >= IO_CACHED_MAX_PAGES)
+		return false;
+
+	for (; index <= end; index++) {
+		page = find_get_page(mapping, index);
+		if (!page)
+			return false;
+		uptodate = PageUptodate(page);
+		page_cache_release(page);
+		if (!uptodate)
+			return false;
+	}
+
+	return true;
+}
+
+static bool io_read_cached(struct io_kiocb *req)
+{
+	const struct iovec __user *uvec;
+	struct iovec iovstack[UIO_FASTIOV];
+	struct iovec *iov = iovstack;
+	ssize_t len;
+	bool ret;
+
+	if (req->file->f_flags & O_DIRECT)
+		return false;
+
+	uvec = (const struct iovec __user *)(unsigned long)req->sqe.addr;
+	len = rw_copy_check_uvector(READ, uvec, req->sqe.len, UIO_FASTIOV,
+				    iovstack, &iov);
+	/* a bad vector fails the same way inline */
+	ret = len < 0 || io_range_cached(req->file, req->sqe.off, len);
+	if (iov != iovstack)
+		kfree(iov);
+
+	return ret;
+}
+
+/*
+ * Returns 0 if the read or write may be issued without blocking,
+ * -EIOCBQUEUED if it waits for the file to become ready and -EAGAIN if it
+ * has to be issued from a worker.
+ */
+static int io_rw_nowait(struct io_kiocb *req, int rw)
+{
+	struct file *file = req->file;
+	umode_t mode = file_inode(file)->i_mode;
+	int ret;
+
+	if (S_ISREG(mode)) {
+		if (rw == READ && io_read_cached(req))
+			return 0;
+		return -EAGAIN;
+	}
+
+	if (S_ISBLK(mode) || !file->f_op->poll)
+		return -EAGAIN;
+
+	ret = io_poll_arm(req, rw == READ ? POLLIN : POLLOUT);
+	if (ret > 0)
+		return 0;
+	if (!ret)
+		return -EIOCBQUEUED;
+	return -EAGAIN;
+}
+
+static int io_read(struct io_kiocb *req, bool force_nonblock)
+{
+	const struct iovec __user *uvec;
+	loff_t pos = req->sqe.off;
+	int ret;
+
+	if (req->sqe.ioprio || req->sqe.rw_flags)
+		return -EINVAL;
+
+	if (force_nonblock) {
+		ret = io_rw_nowait(req, READ);
+		if (ret)
+			return ret;
+	}
+
+	uvec = (const struct iovec __user *)(unsigned long)req->sqe.addr;
+	return vfs_readv(req->file, uvec, req->sqe.len, &pos);
+}
+
+static int io_write(struct io_kiocb *req, bool force_nonblock)
+{
+	const struct iovec __user *uvec;
+	loff_t pos = req->sqe.off;
+	int ret;
+
+	if (req->sqe.ioprio || req->sqe.rw_flags)
+		return -EINVAL;
+
+	if (force_nonblock) {
+		ret = io_rw_nowait(req, WRITE);
+		if (ret)
+			return ret;
+	}
+
+	uvec = (const struct iovec __user *)(unsigned long)req->sqe.addr;
+	return vfs_writev(req->file, uvec, req->sqe.len, &pos);
+}
+
+static int io_fsync(struct io_kiocb *req, bool force_nonblock)
+{
+	loff_t sqe_off = req->sqe.off;
+	loff_t sqe_len = req->sqe.len;
+	unsigned fsync_flags;
+
+	fsync_flags = req->sqe.fsync_flags;
+	if (unlikely(fsync_flags & ~IORING_FSYNC_DATASYNC))
+		return -EINVAL;
+	if (req->sqe.addr || req->sqe.ioprio)
+		return -EINVAL;
+
+	/* fsync always requires a blocking context */
+	if (force_nonblock)
+		return -EAGAIN;
+
+	/* a zero length syncs to the end of the file */
+	return vfs_fsync_range(req->file, sqe_off,
+			       sqe_len ? sqe_off + sqe_len - 1 : LLONG_MAX,
+			       fsync_flags & IORING_FSYNC_DATASYNC);
+}
+
+static int io_sendrecv_msg(struct io_kiocb *req, bool force_nonblock,
+			   long (*fn)(struct socket *, struct msghdr __user *,
+				      unsigned int), unsigned int events)
+{
+	struct msghdr __user *msg;
+	struct socket *sock;
+	unsigned flags;
+	int ret;
+
+	if (req->sqe.ioprio || req->sqe.off || req->sqe.len)
+		return -EINVAL;
+
+	sock = sock_from_file(req->file, &ret);
+	if (!sock)
+		return ret;
+
+	flags = req->sqe.msg_flags;
+	if (flags & MSG_CMSG_COMPAT)
+		return -EINVAL;
+	if (force_nonblock)
+		flags |= MSG_DONTWAIT;
+
+	msg = (struct msghdr __user *)(unsigned long)req->sqe.addr;
+	ret = fn(sock, msg, flags);
+	if (!force_nonblock || ret != -EAGAIN ||
+	    (req->sqe.msg_flags & MSG_DONTWAIT))
+		return ret;
+
+	/* wait for the socket rather than blocking a worker on it */
+	ret = io_poll_arm(req, events);
+	if (!ret)
+		return -EIOCBQUEUED;
+	return -EAGAIN;
+}
+
+static int io_sendmsg(struct io_kiocb *req, bool force_nonblock)
+{
+	return io_sendrecv_msg(req, force_nonblock, __sys_sendmsg_sock,
+			       POLLOUT);
+}
+
+static int io_recvmsg(struct io_kiocb *req, bool force_nonblock)
+{
+	return io_sendrecv_msg(req, force_nonblock, __sys_recvmsg_sock,
+			       POLLIN);
+}
+
+/*
+ * Issue a request. With @force_nonblock set, -EAGAIN means the request has
+ * to be issued again from a worker without it. -EIOCBQUEUED means the
+ * request completes asynchronously, anything else is its result.
+ */
+static int __io_submit(struct io_kiocb *req, bool force_nonblock)
+{
+	switch (req->sqe.opcode) {
+	case IORING_OP_NOP:
+		return 0;
+	case IORING_OP_READV:
+		return io_read(req, force_nonblock);
+	case IORING_OP_WRITEV:
+		return io_write(req, force_nonblock);
+	case IORING_OP_FSYNC:
+		return io_fsync(req, force_nonblock);
+	case IORING_OP_POLL_ADD:
+		return io_poll_add(req);
+	case IORING_OP_POLL_REMOVE:
+		return io_poll_remove(req);
+	case IORING_OP_SENDMSG:
+		return io_sendmsg(req, force_nonblock);
+	case IORING_OP_RECVMSG:
+		return io_recvmsg(req, force_nonblock);
+	default:
+		return -EINVAL;
+	}
+}
+
+/*
+ * Runs requests handed off by the submission path and requests whose file
+ * signalled readiness.
+ */
+static void io_async_work(struct work_struct *work)
+{
+	struct io_kiocb *req = container_of(work, struct io_kiocb, work);
+	struct io_ring_ctx *ctx = req->ctx;
+	struct files_struct *old_files;
+	const struct cred *old_cred;
+	bool canceled;
+	int ret;
+
+	spin_lock_irq(&ctx->completion_lock);
+	list_del_init(&req->list);
+	canceled = req->poll.canceled;
+	spin_unlock_irq(&ctx->completion_lock);
+
+	if (canceled) {
+		ret = -ECANCELED;
+		goto done;
+	}
+
+	/* poll requests don't touch user memory */
+	if (req->sqe.opcode == IORING_OP_POLL_ADD) {
+		ret = __io_submit(req, true);
+		goto done;
+	}
+
+	old_cred = override_creds(ctx->creds);
+	ret = io_attach_owner(ctx, &old_files);
+	if (!ret) {
+		ret = __io_submit(req, true);
+		if (ret == -EAGAIN)
+			ret = __io_submit(req, false);
+		io_detach_owner(ctx, old_files);
+	}
+	revert_creds(old_cred);
+
+done:
+	/* the request waits on its file again */
+	if (ret == -EIOCBQUEUED)
+		return;
+
+	io_cqring_add_event(ctx, req->sqe.user_data, ret);
+	io_free_req(req);
+}
+
+static bool io_op_needs_file(u8 opcode)
+{
+	return opcode != IORING_OP_NOP && opcode != IORING_OP_POLL_REMOVE;
+}
+
+static struct file *io_file_get(int fd)
+{
+	struct file *file;
+
+	file = fget(fd);
+	/* a ring waiting on itself would never be released */
+	if (file && file->f_op == &io_uring_fops) {
+		fput(file);
+		file = NULL;
+	}
+
+	return file;
+}
+
+static int io_submit_sqe(struct io_ring_ctx *ctx,
+			 const struct io_uring_sqe *sqe)
+{
+	struct io_kiocb *req;
+	int ret;
+
+	req = io_get_req(ctx);
+	if (unlikely(!req))
+		return -EAGAIN;
+
+	/* the application may modify the sqe once it has been consumed */
+	memcpy(&req->sqe, sqe, sizeof(*sqe));
+
+	if (unlikely(req->sqe.flags)) {
+		ret = -EINVAL;
+		goto done;
+	}
+
+	if (io_op_needs_file(req->sqe.opcode)) {
+		req->file = io_file_get(req->sqe.fd);
+		if (unlikely(!req->file)) {
+			ret = -EBADF;
+			goto done;
+		}
+	}
+
+	ret = __io_submit(req, true);
+	if (ret == -EAGAIN) {
+		queue_work(ctx->sqo_wq, &req->work);
+		return 0;
+	}
+	if (ret == -EIOCBQUEUED)
+		return 0;
+
+done:
+	io_cqring_add_event(ctx, req->sqe.user_data, ret);
+	io_free_req(req);
+	return 0;
+}
+
+static void io_commit_sqring(struct io_ring_ctx *ctx)
+{
+	struct io_sq_ring *ring = ctx->sq_ring;
+
+	if (ctx->cached_sq_head != READ_ONCE(ring->r.head)) {
+		/*
+		 * Ensure any loads from the SQEs are done at this point,
+		 * since once we write the new head, the application could
+		 * write new data to them.
+		 */
+		smp_store_release(&ring->r.head, ctx->cached_sq_head);
+	}
+}
+
+/*
+ * Fetch an sqe, if one is available. Note that the returned sqe may point
+ * to memory shared with userspace, so it has to be copied before it is
+ * looked at.
+ */
+static const struct io_uring_sqe *io_get_sqring(struct io_ring_ctx *ctx)
+{
+	struct io_sq_ring *ring = ctx->sq_ring;
+	unsigned head, idx;
+
+	/*
+	 * The cached sq head (or cq tail) serves two purposes:
+	 *
+	 * 1) allows us to batch the cost of updating the user visible
+	 *    head updates.
+	 * 2) allows the kernel side to track the head on its own, even
+	 *    though the application is the one updating it.
+	 */
+	head = ctx->cached_sq_head;
+	/* make sure SQ entry isn't read before tail */
+	while (head != smp_load_acquire(&ring->r.tail)) {
+		idx = READ_ONCE(ring->array[head & ctx->sq_mask]);
+		ctx->cached_sq_head = ++head;
+		if (likely(idx < ctx->sq_entries))
+			return &ctx->sq_sqes[idx];
+
+		/* drop invalid entries */
+		WRITE_ONCE(ring->dropped, READ_ONCE(ring->dropped) + 1);
+	}
+
+	return NULL;
+}
+
+static bool io_sqring_pending(struct io_ring_ctx *ctx)
+{
+	return ctx->cached_sq_head != smp_load_acquire(&ctx->sq_ring->r.tail);
+}
+
+static int io_ring_submit(struct io_ring_ctx *ctx, unsigned int to_submit)
+{
+	const struct io_uring_sqe *sqe;
+	int i, submit = 0, ret = 0;
+
+	for (i = 0; i < to_submit; i++) {
+		sqe = io_get_sqring(ctx);
+		if (!sqe)
+			break;
+
+		ret = io_submit_sqe(ctx, sqe);
+		if (ret) {
+			/* leave the sqe for the next submission */
+			ctx->cached_sq_head--;
+			break;
+		}
+		submit++;
+	}
+	io_commit_sqring(ctx);
+
+	return submit ? submit : ret;
+}
+
+static int io_sq_thread(void *data)
+{
+	struct io_ring_ctx *ctx = data;
+	struct files_struct *old_files;
+	const struct cred *old_cred;
+	unsigned long timeout;
+	bool attached = false;
+	DEFINE_WAIT(wait);
+
+	old_cred = override_creds(ctx->creds);
+
+	timeout = jiffies + ctx->sq_thread_idle;
+	while (!kthread_should_stop()) {
+		if (!io_sqring_pending(ctx)) {
+			/*
+			 * Keep polling for a while before going to sleep, an
+			 * application submitting in a loop then never needs to
+			 * enter the kernel.
+			 */
+			if (time_before(jiffies, timeout)) {
+				cond_resched();
+				continue;
+			}
+
+			if (attached) {
+				io_detach_owner(ctx, old_files);
+				attached = false;
+			}
+
+			prepare_to_wait(&ctx->sqo_wait, &wait,
+					TASK_INTERRUPTIBLE);
+
+			/* Tell userspace we may need a wakeup call */
+			WRITE_ONCE(ctx->sq_ring->flags,
+				   ctx->sq_ring->flags | IORING_SQ_NEED_WAKEUP);
+			/* make sure to read SQ tail after writing flags */
+			smp_mb();
+
+			if (!io_sqring_pending(ctx) && !kthread_should_stop())
+				schedule();
+			finish_wait(&ctx->sqo_wait, &wait);
+
+			WRITE_ONCE(ctx->sq_ring->flags,
+				   ctx->sq_ring->flags & ~IORING_SQ_NEED_WAKEUP);
+			timeout = jiffies + ctx->sq_thread_idle;
+			continue;
+		}
+
+		if (!attached) {
+			/* the owner is exiting, the ring goes away with it */
+			if (io_attach_owner(ctx, &old_files)) {
+				schedule_timeout_interruptible(
+						ctx->sq_thread_idle);
+				continue;
+			}
+			attached = true;
+		}
+
+		mutex_lock(&ctx->uring_lock);
+		io_ring_submit(ctx, ctx->sq_entries);
+		mutex_unlock(&ctx->uring_lock);
+
+		timeout = jiffies + ctx->sq_thread_idle;
+	}
+
+	if (attached)
+		io_detach_owner(ctx, old_files);
+	revert_creds(old_cred);
+
+	return 0;
+}
+
+static int io_cqring_events(struct io_ring_ctx *ctx)
+{
+	struct io_cq_ring *ring = ctx->cq_ring;
+
+	return READ_ONCE(ring->r.tail) - READ_ONCE(ring->r.head);
+}
+
+/*
+ * Wait until events become available, if we don't already have some. The
+ * application must reap them itself, as they reside on the shared cq ring.
+ */
+static int io_cqring_wait(struct io_ring_ctx *ctx, int min_events,
+			  const sigset_t __user *sig, size_t sigsz)
+{
+	sigset_t ksigmask, sigsaved;
+	int ret;
+
+	if (io_cqring_events(ctx) >= min_events)
+		return 0;
+
+	if (sig) {
+		if (sigsz != sizeof(sigset_t))
+			return -EINVAL;
+		if (copy_from_user(&ksigmask, sig, sizeof(ksigmask)))
+			return -EFAULT;
+		sigdelsetmask(&ksigmask, sigmask(SIGKILL) | sigmask(SIGSTOP));
+		sigprocmask(SIG_SETMASK, &ksigmask, &sigsaved);
+	}
+
+	ret = wait_event_interruptible(ctx->wait,
+				       io_cqring_events(ctx) >= min_events);
+	if (ret == -ERESTARTSYS)
+		ret = -EINTR;
+
+	if (sig) {
+		/*
+		 * If we were interrupted by a signal, restore the signal
+		 * mask on the way out so the handler runs with the mask the
+		 * application asked for, same as epoll_pwait().
+		 */
+		if (ret == -EINTR) {
+			memcpy(&current->saved_sigmask, &sigsaved,
+			       sizeof(sigsaved));
+			set_restore_sigmask();
+		} else
+			sigprocmask(SIG_SETMASK, &sigsaved, NULL);
+	}
+
+	return ret;
+}
+
+static void *io_mem_alloc(size_t size)
+{
+	gfp_t gfp_flags = GFP_KERNEL | __GFP_ZERO | __GFP_NOWARN | __GFP_COMP |
+				__GFP_NORETRY;
+
+	return (void *) __get_free_pages(gfp_flags, get_order(size));
+}
+
+static void io_mem_free(void *ptr)
+{
+	if (ptr)
+		free_pages((unsigned long)ptr,
+			   compound_order(virt_to_head_page(ptr)));
+}
+
+static void io_ring_ctx_free(struct io_ring_ctx *ctx)
+{
+	if (ctx->sqo_wq)
+		destroy_workqueue(ctx->sqo_wq);
+	if (ctx->sqo_mm)
+		mmdrop(ctx->sqo_mm);
+	if (ctx->sqo_task)
+		put_task_struct(ctx->sqo_task);
+	if (ctx->creds)
+		put_cred(ctx->creds);
+
+	io_mem_free(ctx->sq_ring);
+	io_mem_free(ctx->sq_sqes);
+	io_mem_free(ctx->cq_ring);
+	kfree(ctx);
+}
+
+static void io_ring_ctx_wait_and_kill(struct io_ring_ctx *ctx)
+{
+	if (ctx->sqo_thread)
+		kthread_stop(ctx->sqo_thread);
+
+	/* complete requests waiting on their files with -ECANCELED */
+	if (ctx->sqo_wq)
+		io_poll_remove_all(ctx);
+
+	if (!atomic_dec_and_test(&ctx->refs))
+		wait_for_completion(&ctx->ctx_done);
+
+	io_ring_ctx_free(ctx);
+}
+
+static unsigned int io_uring_poll(struct file *file, poll_table *wait)
+{
+	struct io_ring_ctx *ctx = file->private_data;
+	unsigned int mask = 0;
+
+	poll_wait(file, &ctx->cq_wait, wait);
+	/* See comment at the top of this file */
+	smp_rmb();
+	if (READ_ONCE(ctx->sq_ring->r.tail) - ctx->cached_sq_head !=
+	    ctx->sq_entries)
+		mask |= POLLOUT | POLLWRNORM;
+	if (READ_ONCE(ctx->cq_ring->r.head) != ctx->cached_cq_tail)
+		mask |= POLLIN | POLLRDNORM;
+
+	return mask;
+}
+
+static int io_uring_release(struct inode *inode, struct file *file)
+{
+	struct io_ring_ctx *ctx = file->private_data;
+
+	file->private_data = NULL;
+	io_ring_ctx_wait_and_kill(ctx);
+	return 0;
+}
+
+static int io_uring_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	loff_t offset = (loff_t) vma->vm_pgoff << PAGE_SHIFT;
+	unsigned long sz = vma->vm_end - vma->vm_start;
+	struct io_ring_ctx *ctx = file->private_data;
+	unsigned long pfn;
+	struct page *page;
+	void *ptr;
+
+	switch (offset) {
+	case IORING_OFF_SQ_RING:
+		ptr = ctx->sq_ring;
+		break;
+	case IORING_OFF_SQES:
+		ptr = ctx->sq_sqes;
+		break;
+	case IORING_OFF_CQ_RING:
+		ptr = ctx->cq_ring;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	page = virt_to_head_page(ptr);
+	if (sz > (PAGE_SIZE << compound_order(page)))
+		return -EINVAL;
+
+	pfn = virt_to_phys(ptr) >> PAGE_SHIFT;
+	return remap_pfn_range(vma, vma->vm_start, pfn, sz, vma->vm_page_prot);
+}
+
+SYSCALL_DEFINE6(io_uring_enter, unsigned int, fd, u32, to_submit,
+		u32, min_complete, u32, flags, const sigset_t __user *, sig,
+		size_t, sigsz)
+{
+	struct io_ring_ctx *ctx;
+	long ret = -EBADF;
+	int submitted = 0;
+	struct fd f;
+
+	if (flags & ~(IORING_ENTER_GETEVENTS | IORING_ENTER_SQ_WAKEUP))
+		return -EINVAL;
+
+	f = fdget(fd);
+	if (!f.file)
+		return -EBADF;
+
+	ret = -EOPNOTSUPP;
+	if (f.file->f_op != &io_uring_fops)
+		goto out_fput;
+
+	ctx = f.file->private_data;
+
+	/*
+	 * For SQ polling, the thread will do all submissions and completions.
+	 * Just return the requested submit count, and wake the thread if
+	 * we were asked to.
+	 */
+	if (ctx->flags & IORING_SETUP_SQPOLL) {
+		if (flags & IORING_ENTER_SQ_WAKEUP)
+			wake_up(&ctx->sqo_wait);
+		submitted = to_submit;
+	} else if (to_submit) {
+		to_submit = min(to_submit, ctx->sq_entries);
+
+		mutex_lock(&ctx->uring_lock);
+		submitted = io_ring_submit(ctx, to_submit);
+		mutex_unlock(&ctx->uring_lock);
+
+		if (submitted < 0) {
+			ret = submitted;
+			submitted = 0;
+			goto out_fput;
+		}
+	}
+
+	ret = 0;
+	if (flags & IORING_ENTER_GETEVENTS) {
+		min_complete = min(min_complete, ctx->cq_entries);
+		ret = io_cqring_wait(ctx, min_complete, sig, sigsz);
+	}
+
+out_fput:
+	fdput(f);
+	return submitted ? submitted : ret;
+}
+
+static int io_sq_offload_start(struct io_ring_ctx *ctx,
+			       struct io_uring_params *p)
+{
+	int ret;
+
+	/* Do QD, or 2 * CPUS, whatever is smallest */
+	ctx->sqo_wq = alloc_workqueue("io_ring-wq", WQ_UNBOUND | WQ_FREEZABLE,
+			min(ctx->sq_entries - 1, 2 * num_online_cpus()));
+	if (!ctx->sqo_wq)
+		return -ENOMEM;
+
+	if (ctx->flags & IORING_SETUP_SQPOLL) {
+		ret = -EPERM;
+		if (!capable(CAP_SYS_ADMIN))
+			goto err;
+
+		ret = -EINVAL;
+		if ((p->flags & IORING_SETUP_SQ_AFF) &&
+		    (p->sq_thread_cpu >= nr_cpu_ids ||
+		     !cpu_online(p->sq_thread_cpu)))
+			goto err;
+
+		ctx->sq_thread_idle = msecs_to_jiffies(p->sq_thread_idle);
+		if (!ctx->sq_thread_idle)
+			ctx->sq_thread_idle = HZ;
+
+		ctx->sqo_thread = kthread_create(io_sq_thread, ctx,
+						 "io_uring-sq");
+		if (IS_ERR(ctx->sqo_thread)) {
+			ret = PTR_ERR(ctx->sqo_thread);
+			ctx->sqo_thread = NULL;
+			goto err;
+		}
+
+		if (p->flags & IORING_SETUP_SQ_AFF)
+			kthread_bind(ctx->sqo_thread, p->sq_thread_cpu);
+		wake_up_process(ctx->sqo_thread);
+	} else if (p->flags & IORING_SETUP_SQ_AFF) {
+		/* Can't have SQ_AFF without SQPOLL */
+		ret = -EINVAL;
+		goto err;
+	}
+
+	return 0;
+err:
+	destroy_workqueue(ctx->sqo_wq);
+	ctx->sqo_wq = NULL;
+	return ret;
+}
+
+static int io_allocate_scq_urings(struct io_ring_ctx *ctx,
+				  struct io_uring_params *p)
+{
+	struct io_sq_ring *sq_ring;
+	struct io_cq_ring *cq_ring;
+	size_t size;
+
+	size = sizeof(struct io_sq_ring) + p->sq_entries * sizeof(u32);
+	sq_ring = io_mem_alloc(size);
+	if (!sq_ring)
+		return -ENOMEM;
+
+	ctx->sq_ring = sq_ring;
+	sq_ring->ring_mask = p->sq_entries - 1;
+	sq_ring->ring_entries = p->sq_entries;
+	ctx->sq_mask = sq_ring->ring_mask;
+	ctx->sq_entries = sq_ring->ring_entries;
+
+	size = sizeof(struct io_uring_sqe) * p->sq_entries;
+	ctx->sq_sqes = io_mem_alloc(size);
+	if (!ctx->sq_sqes)
+		return -ENOMEM;
+
+	size = sizeof(struct io_cq_ring) +
+		p->cq_entries * sizeof(struct io_uring_cqe);
+	cq_ring = io_mem_alloc(size);
+	if (!cq_ring)
+		return -ENOMEM;
+
+	ctx->cq_ring = cq_ring;
+	cq_ring->ring_mask = p->cq_entries - 1;
+	cq_ring->ring_entries = p->cq_entries;
+	ctx->cq_mask = cq_ring->ring_mask;
+	ctx->cq_entries = cq_ring->ring_entries;
+	return 0;
+}
+
+static int io_uring_create(unsigned entries, struct io_uring_params *p,
+			   struct io_uring_params __user *params)
+{
+	struct io_ring_ctx *ctx;
+	struct file *file;
+	int ret, fd;
+
+	if (!entries || entries > IORING_MAX_ENTRIES)
+		return -EINVAL;
+
+	/*
+	 * Use twice as many entries for the CQ ring. It's possible for the
+	 * application to drive a higher depth than the size of the SQ ring,
+	 * since the sqes are only used at submission time. This allows for
+	 * some flexibility in overcommitting a bit.
+	 */
+	p->sq_entries = roundup_pow_of_two(entries);
+	p->cq_entries = 2 * p->sq_entries;
+
+	ctx = io_ring_ctx_alloc(p);
+	if (!ctx)
+		return -ENOMEM;
+
+	atomic_inc(&current->mm->mm_count);
+	ctx->sqo_mm = current->mm;
+	get_task_struct(current);
+	ctx->sqo_task = current;
+	ctx->creds = get_current_cred();
+
+	ret = io_allocate_scq_urings(ctx, p);
+	if (ret)
+		goto err;
+
+	ret = io_sq_offload_start(ctx, p);
+	if (ret)
+		goto err;
+
+	memset(&p->sq_off, 0, sizeof(p->sq_off));
+	p->sq_off.head = offsetof(struct io_sq_ring, r.head);
+	p->sq_off.tail = offsetof(struct io_sq_ring, r.tail);
+	p->sq_off.ring_mask = offsetof(struct io_sq_ring, ring_mask);
+	p->sq_off.ring_entries = offsetof(struct io_sq_ring, ring_entries);
+	p->sq_off.flags = offsetof(struct io_sq_ring, flags);
+	p->sq_off.dropped = offsetof(struct io_sq_ring, dropped);
+	p->sq_off.array = offsetof(struct io_sq_ring, array);
+
+	memset(&p->cq_off, 0, sizeof(p->cq_off));
+	p->cq_off.head = offsetof(struct io_cq_ring, r.head);
+	p->cq_off.tail = offsetof(struct io_cq_ring, r.tail);
+	p->cq_off.ring_mask = offsetof(struct io_cq_ring, ring_mask);
+	p->cq_off.ring_entries = offsetof(struct io_cq_ring, ring_entries);
+	p->cq_off.overflow = offsetof(struct io_cq_ring, overflow);
+	p->cq_off.cqes = offsetof(struct io_cq_ring, cqes);
+
+	fd = get_unused_fd_flags(O_RDWR | O_CLOEXEC);
+	if (fd < 0) {
+		ret = fd;
+		goto err;
+	}
+
+	file = anon_inode_getfile("[io_uring]", &io_uring_fops, ctx,
+				  O_RDWR | O_CLOEXEC);
+	if (IS_ERR(file)) {
+		put_unused_fd(fd);
+		ret = PTR_ERR(file);
+		goto err;
+	}
+
+	/* from here on the ring is torn down by the release of the file */
+	if (copy_to_user(params, p, sizeof(*p))) {
+		put_unused_fd(fd);
+		fput(file);
+		return -EFAULT;
+	}
+
+	fd_install(fd, file);
+	return fd;
+err:
+	io_ring_ctx_wait_and_kill(ctx);
+	return ret;
+}
+
+/*
+ * Sets up an aio uring context, and returns the fd. Applications asks for a
+ * ring size, we return the actual sq/cq ring sizes (among other things) in the
+ * params structure passed in.
+ */
+static long io_uring_setup(u32 entries, struct io_uring_params __user *params)
+{
+	struct io_uring_params p;
+	int i;
+
+	if (copy_from_user(&p, params, sizeof(p)))
+		return -EFAULT;
+	for (i = 0; i < ARRAY_SIZE(p.resv); i++) {
+		if (p.resv[i])
+			return -EINVAL;
+	}
+
+	/* polled block IO is not available in this kernel */
+	if (p.flags & ~(IORING_SETUP_SQPOLL | IORING_SETUP_SQ_AFF))
+		return -EINVAL;
+
+	return io_uring_create(entries, &p, params);
+}
+
+SYSCALL_DEFINE2(io_uring_setup, u32, entries,
+		struct io_uring_params __user *, params)
+{
+	return io_uring_setup(entries, params);
+}
+
+static const struct file_operations io_uring_fops = {
+	.release	= io_uring_release,
+	.mmap		= io_uring_mmap,
+	.poll		= io_uring_poll,
+};
+
+static int __init io_uring_init(void)
+{
+	req_cachep = KMEM_CACHE(io_kiocb, SLAB_HWCACHE_ALIGN | SLAB_PANIC);
+	return 0;
+};
+__initcall(io_uring_init);
@@ -98,6 +98,10 @@ EXPORT_SYMBOL(jbd2_journal_file_inode);
 EXPORT_SYMBOL(jbd2_journal_init_jbd_inode);
 EXPORT_SYMBOL(jbd2_journal_release_jbd_inode);
 EXPORT_SYMBOL(jbd2_journal_begin_ordered_truncate);
+EXPORT_SYMBOL(jbd2_fc_begin_commit);
+EXPORT_SYMBOL(jbd2_fc_get_buf);
+EXPORT_SYMBOL(jbd2_fc_read_buf);
+EXPORT_SYMBOL(jbd2_fc_replay_done);
 EXPORT_SYMBOL(jbd2_inode_cache);
 
 static void __journal_abort_soft (journal_t *journal, int errno);
@@ -836,6 +840,157 @@ struct buffer_head *jbd2_journal_get_descriptor_buffer(journal_t *journal)
 	return bh;
 }
 
+/*
+ * Fast commit area management.
+ *
+ * With JBD2_FEATURE_INCOMPAT_FC_LOCAL the last s_num_fc_blks blocks of
+ * the journal are taken out of the circular log and handed to the client
+ * filesystem, which uses them to persist compact per-inode change records
+ * for the running transaction without committing it.  The area is
+ * rewritten from its start whenever fast commits move on to a new
+ * transaction: once that transaction commits through the log proper the
+ * records describing it are obsolete.
+ */
+static int journal_fc_init(journal_t *journal)
+{
+	journal_superblock_t *sb = journal->j_superblock;
+	unsigned long num;
+
+	if (!JBD2_HAS_INCOMPAT_FEATURE(journal,
+				       JBD2_FEATURE_INCOMPAT_FC_LOCAL)) {
+		journal->j_fc_first = journal->j_fc_last = journal->j_last;
+		return 0;
+	}
+
+	num = be32_to_cpu(sb->s_num_fc_blks);
+	if (!num)
+		num = JBD2_DEFAULT_FAST_COMMIT_BLOCKS;
+	if (journal->j_first + JBD2_MIN_JOURNAL_BLOCKS + num >
+	    journal->j_last) {
+		printk(KERN_ERR "JBD2: Journal too short for %lu fast commit "
+		       "blocks.\n", num);
+		return -EINVAL;
+	}
+
+	journal->j_fc_last = journal->j_last;
+	journal->j_fc_first = journal->j_last - num;
+	journal->j_last = journal->j_fc_first;
+	journal->j_fc_off = 0;
+	return 0;
+}
+
+/**
+ * int jbd2_fc_begin_commit() - prepare the fast commit area for a fast commit
+ * @journal: Journal to act on.
+ * @tid: Transaction the fast commit describes.
+ *
+ * Fast commits are only meaningful for the running transaction: once it has
+ * started committing, the log itself will carry its changes.  Returns
+ * -EALREADY if @tid is no longer running, in which case the caller should
+ * wait for the regular commit instead.  Moving on to a new transaction
+ * recycles the area from its first block.
+ */
+int jbd2_fc_begin_commit(journal_t *journal, tid_t tid)
+{
+	int ret = 0;
+
+	if (journal->j_fc_first == journal->j_fc_last)
+		return -EINVAL;
+
+	write_lock(&journal->j_state_lock);
+	if (!journal->j_running_transaction ||
+	    journal->j_running_transaction->t_tid != tid) {
+		ret = -EALREADY;
+	} else if (journal->j_fc_tid != tid) {
+		journal->j_fc_tid = tid;
+		journal->j_fc_off = 0;
+	}
+	write_unlock(&journal->j_state_lock);
+	return ret;
+}
+
+/**
+ * int jbd2_fc_get_buf() - get the next fast commit block
+ * @journal: Journal to act on.
+ * @bh_out: Returns a zeroed, uptodate buffer for the block.
+ *
+ * Returns -ENOSPC once the area is exhausted for the current transaction.
+ */
+int jbd2_fc_get_buf(journal_t *journal, struct buffer_head **bh_out)
+{
+	struct buffer_head *bh;
+	unsigned long long pblock;
+	unsigned long blocknr;
+	int err;
+
+	write_lock(&journal->j_state_lock);
+	if (journal->j_fc_first + journal->j_fc_off >= journal->j_fc_last) {
+		write_unlock(&journal->j_state_lock);
+		return -ENOSPC;
+	}
+	blocknr = journal->j_fc_first + journal->j_fc_off++;
+	write_unlock(&journal->j_state_lock);
+
+	err = jbd2_journal_bmap(journal, blocknr, &pblock);
+	if (err)
+		return err;
+
+	bh = __getblk(journal->j_dev, pblock, journal->j_blocksize);
+	if (!bh)
+		return -ENOMEM;
+	lock_buffer(bh);
+	memset(bh->b_data, 0, journal->j_blocksize);
+	set_buffer_uptodate(bh);
+	unlock_buffer(bh);
+	*bh_out = bh;
+	return 0;
+}
+
+/**
+ * int jbd2_fc_read_buf() - read a block of the fast commit area
+ * @journal: Journal to act on.
+ * @off: Block offset from the start of the area.
+ * @bh_out: Returns the buffer read.
+ *
+ * Used by the client filesystem to replay fast commits after recovery.
+ * Returns -ENOSPC for offsets beyond the end of the area.
+ */
+int jbd2_fc_read_buf(journal_t *journal, unsigned long off,
+		     struct buffer_head **bh_out)
+{
+	struct buffer_head *bh;
+	unsigned long long pblock;
+	int err;
+
+	if (journal->j_fc_first + off >= journal->j_fc_last)
+		return -ENOSPC;
+
+	err = jbd2_journal_bmap(journal, journal->j_fc_first + off, &pblock);
+	if (err)
+		return err;
+
+	bh = __bread(journal->j_dev, pblock, journal->j_blocksize);
+	if (!bh)
+		return -EIO;
+	*bh_out = bh;
+	return 0;
+}
+
+/**
+ * void jbd2_fc_replay_done() - note that fast commits have been replayed
+ * @journal: Journal to act on.
+ *
+ * The client filesystem must have committed the replayed changes through
+ * the log before calling this, since the next fast commit overwrites the
+ * area.
+ */
+void jbd2_fc_replay_done(journal_t *journal)
+{
+	write_lock(&journal->j_state_lock);
+	journal->j_flags &= ~JBD2_FC_REPLAY;
+	write_unlock(&journal->j_state_lock);
+}
+
 /*
  * Return tid of the oldest transaction in the journal and block in the journal
  * where the transaction starts.
@@ -1297,10 +1452,14 @@ static int journal_reset(journal_t *journal)
 
 	journal->j_first = first;
 	journal->j_last = last;
+	if (journal_fc_init(journal)) {
+		journal_fail_superblock(journal);
+		return -EINVAL;
+	}
 
 	journal->j_head = first;
 	journal->j_tail = first;
-	journal->j_free = last - first;
+	journal->j_free = journal->j_last - first;
 
 	journal->j_tail_sequence = journal->j_transaction_sequence;
 	journal->j_commit_sequence = journal->j_transaction_sequence - 1;
@@ -1457,6 +1616,24 @@ static void jbd2_mark_journal_empty(journal_t *journal, int write_op)
 	write_unlock(&journal->j_state_lock);
 }
 
+/*
+ * Everything the fast commit area described is in the log once the journal
+ * is emptied on unmount, so drop the feature: tools which do not know the
+ * format then accept a cleanly unmounted journal.  The client filesystem
+ * sets it again on the next mount.  Records still awaiting replay keep it.
+ */
+static void journal_fc_clear_feature(journal_t *journal)
+{
+	journal_superblock_t *sb = journal->j_superblock;
+
+	if (!JBD2_HAS_INCOMPAT_FEATURE(journal,
+				       JBD2_FEATURE_INCOMPAT_FC_LOCAL) ||
+	    (journal->j_flags & JBD2_FC_REPLAY))
+		return;
+	sb->s_feature_incompat &= ~cpu_to_be32(JBD2_FEATURE_INCOMPAT_FC_LOCAL);
+	jbd2_write_superblock(journal, WRITE_FUA);
+}
+
 
 /**
  * jbd2_journal_update_sb_errno() - Update error in the journal.
@@ -1616,7 +1793,7 @@ static int load_superblock(journal_t *journal)
 	journal->j_last = be32_to_cpu(sb->s_maxlen);
 	journal->j_errno = be32_to_cpu(sb->s_errno);
 
-	return 0;
+	return journal_fc_init(journal);
 }
 
 
@@ -1741,6 +1918,7 @@ int jbd2_journal_destroy(journal_t *journal)
 			write_unlock(&journal->j_state_lock);
 
 			jbd2_mark_journal_empty(journal, WRITE_FLUSH_FUA);
+			journal_fc_clear_feature(journal);
 			mutex_unlock(&journal->j_checkpoint_mutex);
 		} else
 			err = -EIO;
@@ -1896,6 +2074,32 @@ int jbd2_journal_set_features (journal_t *journal, unsigned long compat,
 		}
 	}
 
+	/*
+	 * Carving out the fast commit area moves the end of the log, which is
+	 * only safe while the log is empty, i.e. right after it was loaded.
+	 */
+	if (INCOMPAT_FEATURE_ON(JBD2_FEATURE_INCOMPAT_FC_LOCAL)) {
+		if (journal->j_head != journal->j_tail ||
+		    journal->j_running_transaction)
+			return 0;
+		if (!sb->s_num_fc_blks)
+			sb->s_num_fc_blks =
+				cpu_to_be32(JBD2_DEFAULT_FAST_COMMIT_BLOCKS);
+		sb->s_feature_incompat |=
+			cpu_to_be32(JBD2_FEATURE_INCOMPAT_FC_LOCAL);
+		write_lock(&journal->j_state_lock);
+		journal->j_last = journal->j_fc_last;
+		if (journal_fc_init(journal)) {
+			sb->s_feature_incompat &=
+				~cpu_to_be32(JBD2_FEATURE_INCOMPAT_FC_LOCAL);
+			journal_fc_init(journal);
+			write_unlock(&journal->j_state_lock);
+			return 0;
+		}
+		journal->j_free = journal->j_last - journal->j_first;
+		write_unlock(&journal->j_state_lock);
+	}
+
 	/* If enabling v1 checksums, downgrade superblock */
 	if (COMPAT_FEATURE_ON(JBD2_FEATURE_COMPAT_CHECKSUM))
 		sb->s_feature_incompat &=
@@ -233,6 +233,19 @@ do {									\
 		var -= ((journal)->j_last - (journal)->j_first);	\
 } while (0)
 
+/*
+ * Tell the client filesystem which transaction the fast commit area may hold
+ * records for.  They are only valid if that transaction never committed.
+ */
+static void jbd2_fc_note_replay(journal_t *journal, tid_t tid)
+{
+	if (!JBD2_HAS_INCOMPAT_FEATURE(journal,
+				       JBD2_FEATURE_INCOMPAT_FC_LOCAL))
+		return;
+	journal->j_fc_replay_tid = tid;
+	journal->j_flags |= JBD2_FC_REPLAY;
+}
+
 /**
  * jbd2_journal_recover - recovers a on-disk journal
  * @journal: the journal to recover
@@ -265,6 +278,7 @@ int jbd2_journal_recover(journal_t *journal)
 		jbd_debug(1, "No recovery required, last transaction %d\n",
 			  be32_to_cpu(sb->s_sequence));
 		journal->j_transaction_sequence = be32_to_cpu(sb->s_sequence) + 1;
+		jbd2_fc_note_replay(journal, be32_to_cpu(sb->s_sequence));
 		return 0;
 	}
 
@@ -280,6 +294,11 @@ int jbd2_journal_recover(journal_t *journal)
 	jbd_debug(1, "JBD2: Replayed %d and revoked %d/%d blocks\n",
 		  info.nr_replays, info.nr_revoke_hits, info.nr_revokes);
 
+	/* Any fast commits in the area describe the transaction which was
+	 * running when we crashed, the first one recovery did not find. */
+	if (!err)
+		jbd2_fc_note_replay(journal, info.end_transaction);
+
 	/* Restart the log at the next transaction ID, thus invalidating
 	 * any existing commit records in the log. */
 	journal->j_transaction_sequence = ++info.end_transaction;
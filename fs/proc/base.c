@@ -76,6 +76,8 @@
 #include <linux/printk.h>
 #include <linux/cgroup.h>
 #include <linux/cpuset.h>
+#include <linux/delayacct.h>
+#include <linux/taskstats.h>
 #include <linux/audit.h>
 #include <linux/poll.h>
 #include <linux/nsproxy.h>
@@ -2655,6 +2657,88 @@ static int proc_tgid_io_accounting(struct seq_file *m, struct pid_namespace *ns,
 }
 #endif /* CONFIG_TASK_IO_ACCOUNTING */
 
+#ifdef CONFIG_TASK_DELAY_ACCT
+/*
+ * The delays a task (or all live threads of a process) spent waiting,
+ * one "<cause> <count> <total ns>" line per cause, as in taskstats.
+ */
+static int do_delayacct(struct task_struct *task, struct seq_file *m, int whole)
+{
+	struct taskstats *d;
+	unsigned long flags;
+	int result;
+
+	result = mutex_lock_killable(&task->signal->cred_guard_mutex);
+	if (result)
+		return result;
+
+	if (!ptrace_may_access(task, PTRACE_MODE_READ_FSCREDS)) {
+		result = -EACCES;
+		goto out_unlock;
+	}
+
+	d = kzalloc(sizeof(*d), GFP_KERNEL);
+	if (!d) {
+		result = -ENOMEM;
+		goto out_unlock;
+	}
+
+	if (!whole) {
+		delayacct_add_tsk(d, task);
+	} else if (lock_task_sighand(task, &flags)) {
+		struct task_struct *t = task;
+
+		do {
+			delayacct_add_tsk(d, t);
+		} while_each_thread(task, t);
+
+		unlock_task_sighand(task, &flags);
+	}
+
+	result = seq_printf(m,
+			"cpu %llu %llu\n"
+			"blkio %llu %llu\n"
+			"swapin %llu %llu\n"
+			"freepages %llu %llu\n"
+			"thrashing %llu %llu\n"
+			"compact %llu %llu\n"
+			"binder %llu %llu\n"
+			"cgmigrate %llu %llu\n",
+			(unsigned long long)d->cpu_count,
+			(unsigned long long)d->cpu_delay_total,
+			(unsigned long long)d->blkio_count,
+			(unsigned long long)d->blkio_delay_total,
+			(unsigned long long)d->swapin_count,
+			(unsigned long long)d->swapin_delay_total,
+			(unsigned long long)d->freepages_count,
+			(unsigned long long)d->freepages_delay_total,
+			(unsigned long long)d->thrashing_count,
+			(unsigned long long)d->thrashing_delay_total,
+			(unsigned long long)d->compact_count,
+			(unsigned long long)d->compact_delay_total,
+			(unsigned long long)d->binder_count,
+			(unsigned long long)d->binder_delay_total,
+			(unsigned long long)d->cgmigrate_count,
+			(unsigned long long)d->cgmigrate_delay_total);
+	kfree(d);
+out_unlock:
+	mutex_unlock(&task->signal->cred_guard_mutex);
+	return result;
+}
+
+static int proc_tid_delayacct(struct seq_file *m, struct pid_namespace *ns,
+			      struct pid *pid, struct task_struct *task)
+{
+	return do_delayacct(task, m, 0);
+}
+
+static int proc_tgid_delayacct(struct seq_file *m, struct pid_namespace *ns,
+			       struct pid *pid, struct task_struct *task)
+{
+	return do_delayacct(task, m, 1);
+}
+#endif /* CONFIG_TASK_DELAY_ACCT */
+
 #ifdef CONFIG_USER_NS
 static int proc_id_map_open(struct inode *inode, struct file *file,
 	const struct seq_operations *seq_ops)
@@ -2859,6 +2943,7 @@ static const struct pid_entry tgid_base_stuff[] = {
 #ifdef CONFIG_PROC_PAGE_MONITOR
 	REG("clear_refs", S_IWUSR, proc_clear_refs_operations),
 	REG("smaps",      S_IRUGO, proc_pid_smaps_operations),
+	REG("smaps_rollup", S_IRUGO, proc_pid_smaps_rollup_operations),
 	REG("pagemap",    S_IRUSR, proc_pagemap_operations),
 #endif
 #ifdef CONFIG_SECURITY
@@ -2898,6 +2983,9 @@ static const struct pid_entry tgid_base_stuff[] = {
 #ifdef CONFIG_TASK_IO_ACCOUNTING
 	ONE("io",	S_IRUSR, proc_tgid_io_accounting),
 #endif
+#ifdef CONFIG_TASK_DELAY_ACCT
+	ONE("delayacct", S_IRUSR, proc_tgid_delayacct),
+#endif
 #ifdef CONFIG_HARDWALL
 	ONE("hardwall",   S_IRUGO, proc_pid_hardwall),
 #endif
@@ -3244,6 +3332,7 @@ static const struct pid_entry tid_base_stuff[] = {
 #ifdef CONFIG_PROC_PAGE_MONITOR
 	REG("clear_refs", S_IWUSR, proc_clear_refs_operations),
 	REG("smaps",     S_IRUGO, proc_tid_smaps_operations),
+	REG("smaps_rollup", S_IRUGO, proc_pid_smaps_rollup_operations),
 	REG("pagemap",    S_IRUSR, proc_pagemap_operations),
 #endif
 #ifdef CONFIG_SECURITY
@@ -3280,6 +3369,9 @@ static const struct pid_entry tid_base_stuff[] = {
 #ifdef CONFIG_TASK_IO_ACCOUNTING
 	ONE("io",	S_IRUSR, proc_tid_io_accounting),
 #endif
+#ifdef CONFIG_TASK_DELAY_ACCT
+	ONE("delayacct", S_IRUSR, proc_tid_delayacct),
+#endif
 #ifdef CONFIG_HARDWALL
 	ONE("hardwall",   S_IRUGO, proc_pid_hardwall),
 #endif
@@ -0,0 +1,107 @@
+/*
+ * Squashfs - a compressed read only filesystem for Linux
+ *
+ * This work is licensed under the terms of the GNU GPL, version 2. See
+ * the COPYING file in the top-level directory.
+ *
+ * zstd_wrapper.c
+ */
+
+#include <linux/buffer_head.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/zstd.h>
+
+#include "squashfs_fs.h"
+#include "squashfs_fs_sb.h"
+#include "squashfs.h"
+#include "decompressor.h"
+#include "page_actor.h"
+
+struct squashfs_zstd {
+	zstd_dctx *dctx;
+	void *wksp;
+	void *input;
+	void *output;
+};
+
+
+static void *zstd_init(struct squashfs_sb_info *msblk, void *buff)
+{
+	int block_size = max_t(int, msblk->block_size, SQUASHFS_METADATA_SIZE);
+	size_t wksp_size = zstd_dctx_workspace_bound();
+	struct squashfs_zstd *stream;
+
+	stream = kzalloc(sizeof(*stream), GFP_KERNEL);
+	if (stream == NULL)
+		goto failed;
+	stream->wksp = vmalloc(wksp_size);
+	if (stream->wksp == NULL)
+		goto failed2;
+	stream->dctx = zstd_init_dctx(stream->wksp, wksp_size);
+	if (stream->dctx == NULL)
+		goto failed3;
+	stream->input = vmalloc(block_size);
+	if (stream->input == NULL)
+		goto failed3;
+	stream->output = vmalloc(block_size);
+	if (stream->output == NULL)
+		goto failed4;
+
+	return stream;
+
+failed4:
+	vfree(stream->input);
+failed3:
+	vfree(stream->wksp);
+failed2:
+	kfree(stream);
+failed:
+	ERROR("Failed to initialise zstd decompressor\n");
+	return ERR_PTR(-ENOMEM);
+}
+
+
+static void zstd_free(void *strm)
+{
+	struct squashfs_zstd *stream = strm;
+
+	if (stream) {
+		vfree(stream->input);
+		vfree(stream->output);
+		vfree(stream->wksp);
+	}
+	kfree(stream);
+}
+
+
+static int zstd_uncompress(struct squashfs_sb_info *msblk, void *strm,
+	struct buffer_head **bh, int b, int offset, int length,
+	struct squashfs_page_actor *output)
+{
+	size_t res;
+	struct squashfs_zstd *stream = strm;
+
+	squashfs_bh_to_buf(bh, b, stream->input, offset, length,
+		msblk->devblksize);
+	res = zstd_decompress_dctx(stream->dctx, stream->output,
+		output->length, stream->input, length);
+	if (zstd_is_error(res)) {
+		ERROR("zstd decompression error: %d\n",
+			zstd_get_error_code(res));
+		return -EIO;
+	}
+	squashfs_buf_to_actor(stream->output, output, res);
+
+	return res;
+}
+
+const struct squashfs_decompressor squashfs_zstd_comp_ops = {
+	.init = zstd_init,
+	.free = zstd_free,
+	.decompress = zstd_uncompress,
+	.id = ZSTD_COMPRESSION,
+	.name = "zstd",
+	.supported = 1
+};
@@ -296,6 +296,9 @@ struct cgroup_root {
  * set for a task.
  */
 
+/* number of migration destinations cached per css_set */
+#define CSS_SET_MG_CACHE	4
+
 struct css_set {
 
 	/* Reference count */
@@ -350,6 +353,18 @@ struct css_set {
 	struct cgroup *mg_src_cgrp;
 	struct css_set *mg_dst_cset;
 
+	/*
+	 * Destination csets recently looked up for migrations out of this
+	 * cset, keyed by the destination cgroup.  The entries don't pin
+	 * the csets and are only valid while mg_cache_gen matches the
+	 * global generation, which changes whenever a cset is released or
+	 * the effective csses may have changed.  Protected by cgroup_mutex.
+	 */
+	struct cgroup *mg_cache_cgrp[CSS_SET_MG_CACHE];
+	struct css_set *mg_cache_cset[CSS_SET_MG_CACHE];
+	unsigned long mg_cache_gen;
+	unsigned int mg_cache_next;
+
 	/*
 	 * On the default hierarhcy, ->subsys[ssid] may point to a css
 	 * attached to an ancestor instead of the cgroup this css_set is
@@ -623,6 +638,7 @@ struct cgroup_subsys {
 			      struct cgroup_taskset *tset);
 	void (*attach)(struct cgroup_subsys_state *css,
 		       struct cgroup_taskset *tset);
+	void (*post_attach)(void);
 	void (*fork)(struct task_struct *task);
 	void (*exit)(struct cgroup_subsys_state *css,
 		     struct cgroup_subsys_state *old_css,
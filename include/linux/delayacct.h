@@ -41,6 +41,14 @@ extern int __delayacct_add_tsk(struct taskstats *, struct task_struct *);
 extern __u64 __delayacct_blkio_ticks(struct task_struct *);
 extern void __delayacct_freepages_start(void);
 extern void __delayacct_freepages_end(void);
+extern void __delayacct_thrashing_start(void);
+extern void __delayacct_thrashing_end(void);
+extern void __delayacct_compact_start(void);
+extern void __delayacct_compact_end(void);
+extern void __delayacct_binder_start(void);
+extern void __delayacct_binder_end(void);
+extern void __delayacct_cgmigrate_start(void);
+extern void __delayacct_cgmigrate_end(void);
 
 static inline int delayacct_is_task_waiting_on_io(struct task_struct *p)
 {
@@ -121,6 +129,54 @@ static inline void delayacct_freepages_end(void)
 		__delayacct_freepages_end();
 }
 
+static inline void delayacct_thrashing_start(void)
+{
+	if (current->delays)
+		__delayacct_thrashing_start();
+}
+
+static inline void delayacct_thrashing_end(void)
+{
+	if (current->delays)
+		__delayacct_thrashing_end();
+}
+
+static inline void delayacct_compact_start(void)
+{
+	if (current->delays)
+		__delayacct_compact_start();
+}
+
+static inline void delayacct_compact_end(void)
+{
+	if (current->delays)
+		__delayacct_compact_end();
+}
+
+static inline void delayacct_binder_start(void)
+{
+	if (current->delays)
+		__delayacct_binder_start();
+}
+
+static inline void delayacct_binder_end(void)
+{
+	if (current->delays)
+		__delayacct_binder_end();
+}
+
+static inline void delayacct_cgmigrate_start(void)
+{
+	if (current->delays)
+		__delayacct_cgmigrate_start();
+}
+
+static inline void delayacct_cgmigrate_end(void)
+{
+	if (current->delays)
+		__delayacct_cgmigrate_end();
+}
+
 #else
 static inline void delayacct_set_flag(int flag)
 {}
@@ -147,6 +203,22 @@ static inline void delayacct_freepages_start(void)
 {}
 static inline void delayacct_freepages_end(void)
 {}
+static inline void delayacct_thrashing_start(void)
+{}
+static inline void delayacct_thrashing_end(void)
+{}
+static inline void delayacct_compact_start(void)
+{}
+static inline void delayacct_compact_end(void)
+{}
+static inline void delayacct_binder_start(void)
+{}
+static inline void delayacct_binder_end(void)
+{}
+static inline void delayacct_cgmigrate_start(void)
+{}
+static inline void delayacct_cgmigrate_end(void)
+{}
 
 #endif /* CONFIG_TASK_DELAY_ACCT */
 
@@ -68,4 +68,21 @@ static inline void exit_pi_state_list(struct task_struct *curr)
 {
 }
 #endif
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+extern int sysctl_futex_private_hash;
+extern void futex_mm_init(struct mm_struct *mm);
+extern void futex_mm_free(struct mm_struct *mm);
+extern void futex_mm_new_thread(struct mm_struct *mm);
+#else
+static inline void futex_mm_init(struct mm_struct *mm)
+{
+}
+static inline void futex_mm_free(struct mm_struct *mm)
+{
+}
+static inline void futex_mm_new_thread(struct mm_struct *mm)
+{
+}
+#endif
 #endif
@@ -269,7 +269,9 @@ typedef struct journal_superblock_s
 /* 0x0050 */
 	__u8	s_checksum_type;	/* checksum type */
 	__u8	s_padding2[3];
-	__u32	s_padding[42];
+/* 0x0054 */
+	__be32	s_num_fc_blks;		/* Number of fast commit blocks */
+	__u32	s_padding[41];
 	__be32	s_checksum;		/* crc32c(superblock) */
 
 /* 0x0100 */
@@ -294,6 +296,13 @@ typedef struct journal_superblock_s
 #define JBD2_FEATURE_INCOMPAT_ASYNC_COMMIT	0x00000004
 #define JBD2_FEATURE_INCOMPAT_CSUM_V2		0x00000008
 #define JBD2_FEATURE_INCOMPAT_CSUM_V3		0x00000010
+/*
+ * Fast commit area in this kernel's own format (see fs/ext4/fast_commit.h).
+ * Deliberately not upstream's FAST_COMMIT bit (0x20), whose records differ:
+ * tools which do not know this format must refuse the journal rather than
+ * misparse or drop the area.  Only set while the fs is mounted.
+ */
+#define JBD2_FEATURE_INCOMPAT_FC_LOCAL		0x80000000
 
 /* Features known to this kernel version: */
 #define JBD2_KNOWN_COMPAT_FEATURES	JBD2_FEATURE_COMPAT_CHECKSUM
@@ -302,7 +311,14 @@ typedef struct journal_superblock_s
 					JBD2_FEATURE_INCOMPAT_64BIT | \
 					JBD2_FEATURE_INCOMPAT_ASYNC_COMMIT | \
 					JBD2_FEATURE_INCOMPAT_CSUM_V2 | \
-					JBD2_FEATURE_INCOMPAT_CSUM_V3)
+					JBD2_FEATURE_INCOMPAT_CSUM_V3 | \
+					JBD2_FEATURE_INCOMPAT_FC_LOCAL)
+
+/*
+ * Default number of blocks reserved at the end of the log for fast commits
+ * when the superblock does not specify s_num_fc_blks.
+ */
+#define JBD2_DEFAULT_FAST_COMMIT_BLOCKS	256
 
 #ifdef __KERNEL__
 
@@ -712,6 +728,11 @@ jbd2_time_diff(unsigned long start, unsigned long end)
  * @j_free: Journal free - how many free blocks are there in the journal?
  * @j_first: The block number of the first usable block
  * @j_last: The block number one beyond the last usable block
+ * @j_fc_first: The block number of the first fast commit block
+ * @j_fc_last: The block number one beyond the last fast commit block
+ * @j_fc_off: Number of fast commit blocks used by the current fast commit tid
+ * @j_fc_tid: Transaction the fast commit area currently holds records for
+ * @j_fc_replay_tid: Transaction whose fast commits recovery left for replay
  * @j_dev: Device where we store the journal
  * @j_blocksize: blocksize for the location where we store the journal.
  * @j_blk_offset: starting block offset for into the device where we store the
@@ -856,6 +877,23 @@ struct journal_s
 	unsigned long		j_first;
 	unsigned long		j_last;
 
+	/*
+	 * Fast commit area: the block numbers of the first block and one
+	 * beyond the last block reserved for fast commits at the end of the
+	 * log, and the number of area blocks handed out for transaction
+	 * j_fc_tid so far.  [j_state_lock]
+	 */
+	unsigned long		j_fc_first;
+	unsigned long		j_fc_last;
+	unsigned long		j_fc_off;
+	tid_t			j_fc_tid;
+
+	/*
+	 * Transaction following the last one found by recovery; fast commits
+	 * tagged with it are still to be replayed by the client filesystem.
+	 */
+	tid_t			j_fc_replay_tid;
+
 	/*
 	 * Device, blocksize and starting block offset for the location where we
 	 * store the journal.
@@ -1008,6 +1046,7 @@ struct journal_s
 						 * data write error in ordered
 						 * mode */
 #define JBD2_REC_ERR	0x080	/* The errno in the sb has been recorded */
+#define JBD2_FC_REPLAY	0x100	/* Fast commits are awaiting replay */
 
 /*
  * Function declarations for the journaling transaction and buffer
@@ -1169,6 +1208,11 @@ extern int	   jbd2_journal_clear_err  (journal_t *);
 extern int	   jbd2_journal_bmap(journal_t *, unsigned long, unsigned long long *);
 extern int	   jbd2_journal_force_commit(journal_t *);
 extern int	   jbd2_journal_force_commit_nested(journal_t *);
+extern int	   jbd2_fc_begin_commit(journal_t *, tid_t);
+extern int	   jbd2_fc_get_buf(journal_t *, struct buffer_head **);
+extern int	   jbd2_fc_read_buf(journal_t *, unsigned long,
+				    struct buffer_head **);
+extern void	   jbd2_fc_replay_done(journal_t *);
 extern int	   jbd2_journal_file_inode(handle_t *handle, struct jbd2_inode *inode);
 extern int	   jbd2_journal_begin_ordered_truncate(journal_t *journal,
 				struct jbd2_inode *inode, loff_t new_size);
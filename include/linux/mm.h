@@ -135,6 +135,11 @@ extern unsigned int kobjsize(const void *objp);
 
 #define VM_DONTCOPY	0x00020000      /* Do not copy this vma on fork */
 #define VM_DONTEXPAND	0x00040000	/* Cannot expand with mremap() */
+#ifdef CONFIG_LAZY_FORK
+# define VM_SHARE_PGTABLE 0x00080000	/* Share PTE tables with children */
+#else
+# define VM_SHARE_PGTABLE 0
+#endif
 #define VM_ACCOUNT	0x00100000	/* Is a VM accounted object */
 #define VM_NORESERVE	0x00200000	/* should the VM suppress accounting */
 #define VM_HUGETLB	0x00400000	/* Huge TLB Page VM */
@@ -1179,6 +1184,21 @@ void free_pgd_range(struct mmu_gather *tlb, unsigned long addr,
 		unsigned long end, unsigned long floor, unsigned long ceiling);
 int copy_page_range(struct mm_struct *dst, struct mm_struct *src,
 			struct vm_area_struct *vma);
+#ifdef CONFIG_LAZY_FORK
+#define pmd_table_shared(pmd)	pmd_table_wrprotected(pmd)
+int unshare_pte_table(struct vm_area_struct *vma, pmd_t *pmd,
+		unsigned long address, gfp_t gfp);
+#else
+static inline int pmd_table_shared(pmd_t pmd)
+{
+	return 0;
+}
+static inline int unshare_pte_table(struct vm_area_struct *vma, pmd_t *pmd,
+		unsigned long address, gfp_t gfp)
+{
+	return 0;
+}
+#endif
 void unmap_mapping_range(struct address_space *mapping,
 		loff_t const holebegin, loff_t const holelen, int even_cows);
 int follow_pfn(struct vm_area_struct *vma, unsigned long address,
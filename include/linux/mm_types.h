@@ -8,6 +8,7 @@
 #include <linux/spinlock.h>
 #include <linux/rbtree.h>
 #include <linux/rwsem.h>
+#include <linux/mutex.h>
 #include <linux/stacktrace.h>
 #include <linux/completion.h>
 #include <linux/cpumask.h>
@@ -357,6 +358,7 @@ struct mm_rss_stat {
 };
 
 struct kioctx_table;
+struct futex_private_hash;
 struct mm_struct {
 	struct vm_area_struct *mmap;		/* list of VMAs */
 	struct rb_root mm_rb;
@@ -421,6 +423,11 @@ struct mm_struct {
 	spinlock_t			ioctx_lock;
 	struct kioctx_table __rcu	*ioctx_table;
 #endif
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	/* hash table for PTHREAD_PROCESS_PRIVATE futexes, grown under the mutex */
+	struct futex_private_hash	*futex_phash;
+	struct mutex			futex_phash_lock;
+#endif
 #ifdef CONFIG_MEMCG
 	/*
 	 * "owner" points to a task that is regarded as the canonical
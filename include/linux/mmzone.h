@@ -173,6 +173,7 @@ enum zone_stat_item {
 	NR_ANON_TRANSPARENT_HUGEPAGES,
 	NR_FREE_CMA_PAGES,
 	NR_SWAPCACHE,
+	NR_SHARED_PAGETABLE,	/* pagetables saved by sharing them */
 	NR_VM_ZONE_STAT_ITEMS };
 
 /*
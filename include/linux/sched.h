@@ -486,6 +486,7 @@ static inline int get_dumpable(struct mm_struct *mm)
 
 #define MMF_HAS_UPROBES		19	/* has uprobes */
 #define MMF_RECALC_UPROBES	20	/* MMF_HAS_UPROBES can be wrong */
+#define MMF_LAZY_FORK		21	/* share PTE tables with children */
 
 #define MMF_INIT_MASK		(MMF_DUMPABLE_MASK | MMF_DUMP_FILTER_MASK)
 
@@ -871,6 +872,22 @@ struct task_delay_info {
 	u64 freepages_start;
 	u64 freepages_delay;	/* wait for memory reclaim */
 	u32 freepages_count;	/* total count of memory reclaim */
+
+	u64 thrashing_start;
+	u64 thrashing_delay;	/* wait for refaulted workingset pages */
+	u32 thrashing_count;	/* total count of thrashing waits */
+
+	u64 compact_start;
+	u64 compact_delay;	/* wait for direct compaction */
+	u32 compact_count;	/* total count of direct compaction */
+
+	u64 binder_start;
+	u64 binder_delay;	/* wait for binder transaction replies */
+	u32 binder_count;	/* total count of binder reply waits */
+
+	u64 cgmigrate_start;
+	u64 cgmigrate_delay;	/* wait for cgroup migration */
+	u32 cgmigrate_count;	/* total count of cgroup migration waits */
 };
 #endif	/* CONFIG_TASK_DELAY_ACCT */
 
@@ -2821,9 +2838,12 @@ static inline void unlock_task_sighand(struct task_struct *tsk,
 }
 
 #ifdef CONFIG_CGROUPS
+extern void __threadgroup_change_begin(struct task_struct *tsk);
+
 static inline void threadgroup_change_begin(struct task_struct *tsk)
 {
-	down_read(&tsk->signal->group_rwsem);
+	if (unlikely(!down_read_trylock(&tsk->signal->group_rwsem)))
+		__threadgroup_change_begin(tsk);
 }
 static inline void threadgroup_change_end(struct task_struct *tsk)
 {
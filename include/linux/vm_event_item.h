@@ -63,6 +63,11 @@ enum vm_event_item { PGPGIN, PGPGOUT, PGPGOUTCLEAN, PSWPIN, PSWPOUT,
 		UNEVICTABLE_PGMUNLOCKED,
 		UNEVICTABLE_PGCLEARED,	/* on COW, page truncate */
 		UNEVICTABLE_PGSTRANDED,	/* unable to isolate on unlock */
+#ifdef CONFIG_LAZY_FORK
+		PGTABLE_SHARE,		/* PTE tables shared on fork */
+		PGTABLE_UNSHARE,	/* shared PTE tables copied on fault */
+		PGTABLE_SHARE_FAULT_AVOIDED,
+#endif
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
 		THP_FAULT_ALLOC,
 		THP_FAULT_FALLBACK,
@@ -64,6 +64,7 @@ struct unix_sock {
 #define UNIX_GC_MAYBE_CYCLE	1
 	struct socket_wq	peer_wq;
 	wait_queue_t		peer_wake;
+	struct sk_buff		*skb_cache;
 };
 
 static inline struct unix_sock *unix_sk(struct sock *sk)
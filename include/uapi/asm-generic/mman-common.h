@@ -52,6 +52,9 @@
 					   overrides the coredump filter bits */
 #define MADV_DODUMP	17		/* Clear the MADV_DONTDUMP flag */
 
+#define MADV_SHARE_PGTABLE 64		/* Share PTE tables across fork */
+#define MADV_NOSHARE_PGTABLE 65		/* Stop sharing them */
+
 /* compatibility flags */
 #define MAP_FILE	0
 
@@ -708,8 +708,14 @@ __SYSCALL(__NR_memfd_create, sys_memfd_create)
 #define __NR_bpf 280
 __SYSCALL(__NR_bpf, sys_bpf)
 
+/* numbered as upstream so existing io_uring userspace works unchanged */
+#define __NR_io_uring_setup 425
+__SYSCALL(__NR_io_uring_setup, sys_io_uring_setup)
+#define __NR_io_uring_enter 426
+__SYSCALL(__NR_io_uring_enter, sys_io_uring_enter)
+
 #undef __NR_syscalls
-#define __NR_syscalls 281
+#define __NR_syscalls 427
 
 /*
  * All syscalls below here should go away really,
@@ -195,6 +195,7 @@ struct inodes_stat_t {
 #define FS_ENCRYPTION_MODE_AES_128_CTS		6
 #define FS_ENCRYPTION_MODE_SPECK128_256_XTS	7
 #define FS_ENCRYPTION_MODE_SPECK128_256_CTS	8
+#define FS_ENCRYPTION_MODE_ADIANTUM		9
 
 
 struct fscrypt_policy {
@@ -188,6 +188,13 @@ struct prctl_mm_map {
 #define PR_SET_VMA		0x53564d41
 # define PR_SET_VMA_ANON_NAME		0
 
+/*
+ * Let fork() share the PTE tables of private anonymous memory with the
+ * child until either side faults on them, instead of copying them.
+ */
+#define PR_SET_LAZY_FORK	0x4c5a4653
+#define PR_GET_LAZY_FORK	0x4c5a4647
+
 /* Control the ambient capability set */
 #define PR_CAP_AMBIENT			47
 # define PR_CAP_AMBIENT_IS_SET		1
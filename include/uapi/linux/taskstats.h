@@ -33,7 +33,7 @@
  */
 
 
-#define TASKSTATS_VERSION	8
+#define TASKSTATS_VERSION	9
 #define TS_COMM_LEN		32	/* should be >= TASK_COMM_LEN
 					 * in linux/sched.h */
 
@@ -163,6 +163,22 @@ struct taskstats {
 	/* Delay waiting for memory reclaim */
 	__u64	freepages_count;
 	__u64	freepages_delay_total;
+
+	/* Delay waiting for refaulted workingset pages (thrashing) */
+	__u64	thrashing_count;
+	__u64	thrashing_delay_total;
+
+	/* Delay waiting for direct memory compaction */
+	__u64	compact_count;
+	__u64	compact_delay_total;
+
+	/* Delay waiting for binder transaction replies */
+	__u64	binder_count;
+	__u64	binder_delay_total;
+
+	/* Delay waiting for cgroup migration */
+	__u64	cgmigrate_count;
+	__u64	cgmigrate_delay_total;
 };
 
 
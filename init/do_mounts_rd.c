@@ -62,6 +62,7 @@ static int __init crd_load(int in_fd, int out_fd, decompress_fn deco);
  *	xz
  *	lzo
  *	lz4
+ *	zstd
  */
 static int __init
 identify_ramdisk_image(int fd, int start_block, decompress_fn *decompressor)
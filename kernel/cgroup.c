@@ -485,6 +485,64 @@ static unsigned long css_set_hash(struct cgroup_subsys_state *css[])
 	return key;
 }
 
+/*
+ * Generation of the css_set->mg_cache entries.  Bumped whenever a cset is
+ * released or the effective csses a cset lookup depends on may change.
+ */
+static atomic_long_t css_set_mg_gen = ATOMIC_LONG_INIT(1);
+
+static void css_set_mg_cache_invalidate(void)
+{
+	atomic_long_inc(&css_set_mg_gen);
+}
+
+/**
+ * css_set_mg_cache_lookup - look up a cached migration destination
+ * @old_cset: the source css_set
+ * @cgrp: the destination cgroup
+ *
+ * Return the cset find_css_set() last returned for @old_cset and @cgrp,
+ * or %NULL.  The caller must hold cgroup_mutex and css_set_rwsem, which
+ * keeps a valid entry from being released under it.
+ */
+static struct css_set *css_set_mg_cache_lookup(struct css_set *old_cset,
+					       struct cgroup *cgrp)
+{
+	int i;
+
+	lockdep_assert_held(&cgroup_mutex);
+	lockdep_assert_held(&css_set_rwsem);
+
+	if (old_cset->mg_cache_gen != atomic_long_read(&css_set_mg_gen))
+		return NULL;
+
+	for (i = 0; i < CSS_SET_MG_CACHE; i++)
+		if (old_cset->mg_cache_cgrp[i] == cgrp)
+			return old_cset->mg_cache_cset[i];
+	return NULL;
+}
+
+static void css_set_mg_cache_add(struct css_set *old_cset,
+				 struct cgroup *cgrp, struct css_set *cset)
+{
+	unsigned long gen = atomic_long_read(&css_set_mg_gen);
+	unsigned int i;
+
+	lockdep_assert_held(&cgroup_mutex);
+	lockdep_assert_held(&css_set_rwsem);
+
+	if (old_cset->mg_cache_gen != gen) {
+		memset(old_cset->mg_cache_cgrp, 0,
+		       sizeof(old_cset->mg_cache_cgrp));
+		old_cset->mg_cache_gen = gen;
+		old_cset->mg_cache_next = 0;
+	}
+
+	i = old_cset->mg_cache_next++ % CSS_SET_MG_CACHE;
+	old_cset->mg_cache_cgrp[i] = cgrp;
+	old_cset->mg_cache_cset[i] = cset;
+}
+
 static void put_css_set_locked(struct css_set *cset)
 {
 	struct cgrp_cset_link *link, *tmp_link;
@@ -497,6 +555,7 @@ static void put_css_set_locked(struct css_set *cset)
 		return;
 
 	/* This css_set is dead. unlink it and release cgroup refcounts */
+	css_set_mg_cache_invalidate();
 	for_each_subsys(ss, ssid)
 		list_del(&cset->e_cset_node[ssid]);
 	hash_del(&cset->hlist);
@@ -756,7 +815,12 @@ static struct css_set *find_css_set(struct css_set *old_cset,
 	/* First see if we already have a cgroup group that matches
 	 * the desired set */
 	down_read(&css_set_rwsem);
-	cset = find_existing_css_set(old_cset, cgrp, template);
+	cset = css_set_mg_cache_lookup(old_cset, cgrp);
+	if (!cset) {
+		cset = find_existing_css_set(old_cset, cgrp, template);
+		if (cset)
+			css_set_mg_cache_add(old_cset, cgrp, cset);
+	}
 	if (cset)
 		get_css_set(cset);
 	up_read(&css_set_rwsem);
@@ -808,6 +872,7 @@ static struct css_set *find_css_set(struct css_set *old_cset,
 		list_add_tail(&cset->e_cset_node[ssid],
 			      &cset->subsys[ssid]->cgroup->e_csets[ssid]);
 
+	css_set_mg_cache_add(old_cset, cgrp, cset);
 	up_write(&css_set_rwsem);
 
 	return cset;
@@ -1042,6 +1107,8 @@ static void cgroup_refresh_child_subsys_mask(struct cgroup *cgrp)
 
 	lockdep_assert_held(&cgroup_mutex);
 
+	css_set_mg_cache_invalidate();
+
 	if (!cgroup_on_dfl(cgrp)) {
 		cgrp->child_subsys_mask = cur_ss_mask;
 		return;
@@ -1176,6 +1243,8 @@ static int rebind_subsystems(struct cgroup_root *dst_root, unsigned int ss_mask)
 
 	lockdep_assert_held(&cgroup_mutex);
 
+	css_set_mg_cache_invalidate();
+
 	for_each_subsys(ss, ssid) {
 		if (!(ss_mask & (1 << ssid)))
 			continue;
@@ -2358,9 +2427,11 @@ static ssize_t __cgroup_procs_write(struct kernfs_open_file *of, char *buf,
 {
 	struct task_struct *tsk;
 	const struct cred *cred = current_cred(), *tcred;
+	struct cgroup_subsys *ss;
 	struct cgroup *cgrp;
+	bool noop = false;
 	pid_t pid;
-	int ret;
+	int ssid, ret;
 
 	if (kstrtoint(strstrip(buf), 0, &pid) || pid < 0)
 		return -EINVAL;
@@ -2411,9 +2482,22 @@ retry_find_task:
 	get_task_struct(tsk);
 	rcu_read_unlock();
 
-	threadgroup_lock(tsk);
-	if (threadgroup) {
-		if (!thread_group_leader(tsk)) {
+	/*
+	 * Moving a single thread into the cgroup it already is in changes
+	 * nothing.  Don't stall its thread group for it.
+	 */
+	if (!threadgroup) {
+		down_read(&css_set_rwsem);
+		noop = task_cgroup_from_root(tsk, cgrp->root) == cgrp;
+		up_read(&css_set_rwsem);
+	}
+
+	if (noop) {
+		ret = 0;
+	} else {
+		delayacct_cgmigrate_start();
+		threadgroup_lock(tsk);
+		if (threadgroup && !thread_group_leader(tsk)) {
 			/*
 			 * a race with de_thread from another thread's exec()
 			 * may strip us of our leadership, if this happens,
@@ -2422,12 +2506,15 @@ retry_find_task:
 			 * "double-double-toil-and-trouble-check locking".
 			 */
 			threadgroup_unlock(tsk);
+			delayacct_cgmigrate_end();
 			put_task_struct(tsk);
 			goto retry_find_task;
 		}
-	}
 
-	ret = cgroup_attach_task(cgrp, tsk, threadgroup);
+		ret = cgroup_attach_task(cgrp, tsk, threadgroup);
+		threadgroup_unlock(tsk);
+		delayacct_cgmigrate_end();
+	}
 
 	/* Boost CPU to the max for 500 ms when launcher becomes a top app */
 	if (!memcmp(tsk->comm, "s.nexuslauncher", sizeof("s.nexuslauncher")) &&
@@ -2436,14 +2523,29 @@ retry_find_task:
 		devfreq_boost_kick_max(DEVFREQ_MSM_CPUBW, 500);
 	}
 
-	threadgroup_unlock(tsk);
-
 	put_task_struct(tsk);
 out_unlock_cgroup:
 	cgroup_kn_unlock(of->kn);
+
+	/* let controllers finish deferred work without cgroup_mutex held */
+	for_each_subsys(ss, ssid)
+		if (ss->post_attach)
+			ss->post_attach();
 	return ret ?: nbytes;
 }
 
+/*
+ * Slow path of threadgroup_change_begin(): the threadgroup is locked,
+ * which only happens while cgroup is migrating it.  Forks, exits and
+ * execs of its threads wait here for the migration to finish.
+ */
+void __threadgroup_change_begin(struct task_struct *tsk)
+{
+	delayacct_cgmigrate_start();
+	down_read(&tsk->signal->group_rwsem);
+	delayacct_cgmigrate_end();
+}
+
 /**
  * cgroup_attach_task_all - attach task 'tsk' to all cgroups of task 'from'
  * @from: attach to all cgroups of a given task
@@ -4519,6 +4621,7 @@ static int online_css(struct cgroup_subsys_state *css)
 	if (!ret) {
 		css->flags |= CSS_ONLINE;
 		rcu_assign_pointer(css->cgroup->subsys[ss->id], css);
+		css_set_mg_cache_invalidate();
 	}
 	return ret;
 }
@@ -4538,6 +4641,7 @@ static void offline_css(struct cgroup_subsys_state *css)
 
 	css->flags &= ~CSS_ONLINE;
 	RCU_INIT_POINTER(css->cgroup->subsys[ss->id], NULL);
+	css_set_mg_cache_invalidate();
 
 	wake_up_all(&css->cgroup->offline_waitq);
 }
@@ -127,6 +127,18 @@ int __delayacct_add_tsk(struct taskstats *d, struct task_struct *tsk)
 	d->blkio_count += tsk->delays->blkio_count;
 	d->swapin_count += tsk->delays->swapin_count;
 	d->freepages_count += tsk->delays->freepages_count;
+	tmp = d->thrashing_delay_total + tsk->delays->thrashing_delay;
+	d->thrashing_delay_total = (tmp < d->thrashing_delay_total) ? 0 : tmp;
+	d->thrashing_count += tsk->delays->thrashing_count;
+	tmp = d->compact_delay_total + tsk->delays->compact_delay;
+	d->compact_delay_total = (tmp < d->compact_delay_total) ? 0 : tmp;
+	d->compact_count += tsk->delays->compact_count;
+	tmp = d->binder_delay_total + tsk->delays->binder_delay;
+	d->binder_delay_total = (tmp < d->binder_delay_total) ? 0 : tmp;
+	d->binder_count += tsk->delays->binder_count;
+	tmp = d->cgmigrate_delay_total + tsk->delays->cgmigrate_delay;
+	d->cgmigrate_delay_total = (tmp < d->cgmigrate_delay_total) ? 0 : tmp;
+	d->cgmigrate_count += tsk->delays->cgmigrate_count;
 	spin_unlock_irqrestore(&tsk->delays->lock, flags);
 
 	return 0;
@@ -156,3 +168,50 @@ void __delayacct_freepages_end(void)
 			&current->delays->freepages_count);
 }
 
+void __delayacct_thrashing_start(void)
+{
+	current->delays->thrashing_start = ktime_get_ns();
+}
+
+void __delayacct_thrashing_end(void)
+{
+	delayacct_end(&current->delays->thrashing_start,
+			&current->delays->thrashing_delay,
+			&current->delays->thrashing_count);
+}
+
+void __delayacct_compact_start(void)
+{
+	current->delays->compact_start = ktime_get_ns();
+}
+
+void __delayacct_compact_end(void)
+{
+	delayacct_end(&current->delays->compact_start,
+			&current->delays->compact_delay,
+			&current->delays->compact_count);
+}
+
+void __delayacct_binder_start(void)
+{
+	current->delays->binder_start = ktime_get_ns();
+}
+
+void __delayacct_binder_end(void)
+{
+	delayacct_end(&current->delays->binder_start,
+			&current->delays->binder_delay,
+			&current->delays->binder_count);
+}
+
+void __delayacct_cgmigrate_start(void)
+{
+	current->delays->cgmigrate_start = ktime_get_ns();
+}
+
+void __delayacct_cgmigrate_end(void)
+{
+	delayacct_end(&current->delays->cgmigrate_start,
+			&current->delays->cgmigrate_delay,
+			&current->delays->cgmigrate_count);
+}
@@ -42,6 +42,8 @@
 #include <linux/module.h>
 #include <linux/mman.h>
 #include <linux/compat.h>
+#include <linux/filter.h>
+#include <linux/bpf.h>
 
 #include "internal.h"
 
@@ -3414,6 +3416,7 @@ errout:
 }
 
 static void perf_event_free_filter(struct perf_event *event);
+static void perf_event_free_bpf_prog(struct perf_event *event);
 
 static void free_event_rcu(struct rcu_head *head)
 {
@@ -3491,6 +3494,8 @@ static void _free_event(struct perf_event *event)
 
 	unaccount_event(event);
 
+	perf_event_free_bpf_prog(event);
+
 	if (event->rb) {
 		/*
 		 * Can happen when we close an event with re-directed output.
@@ -3990,6 +3995,7 @@ static inline int perf_fget_light(int fd, struct fd *p)
 static int perf_event_set_output(struct perf_event *event,
 				 struct perf_event *output_event);
 static int perf_event_set_filter(struct perf_event *event, void __user *arg);
+static int perf_event_set_bpf_prog(struct perf_event *event, u32 prog_fd);
 
 static long _perf_ioctl(struct perf_event *event, unsigned int cmd, unsigned long arg)
 {
@@ -4043,6 +4049,9 @@ static long _perf_ioctl(struct perf_event *event, unsigned int cmd, unsigned lon
 	case PERF_EVENT_IOC_SET_FILTER:
 		return perf_event_set_filter(event, (void __user *)arg);
 
+	case PERF_EVENT_IOC_SET_BPF:
+		return perf_event_set_bpf_prog(event, arg);
+
 	default:
 		return -ENOTTY;
 	}
@@ -6472,6 +6481,71 @@ static void perf_event_free_filter(struct perf_event *event)
 	ftrace_profile_free_filter(event);
 }
 
+/* serializes attaching and detaching programs to tp_event->prog */
+static DEFINE_MUTEX(bpf_event_mutex);
+
+static int perf_event_set_bpf_prog(struct perf_event *event, u32 prog_fd)
+{
+	bool is_kprobe, is_tracepoint;
+	struct bpf_prog *prog;
+	int ret = 0;
+
+	if (event->attr.type != PERF_TYPE_TRACEPOINT)
+		return -EINVAL;
+
+	is_kprobe = event->tp_event->flags & TRACE_EVENT_FL_KPROBE;
+	is_tracepoint = event->tp_event->flags & TRACE_EVENT_FL_TRACEPOINT;
+	if (!is_kprobe && !is_tracepoint)
+		/* bpf programs can only be attached to kprobes and tracepoints */
+		return -EINVAL;
+
+	prog = bpf_prog_get(prog_fd);
+	if (IS_ERR(prog))
+		return PTR_ERR(prog);
+
+	if ((is_kprobe && prog->aux->prog_type != BPF_PROG_TYPE_KPROBE) ||
+	    (is_tracepoint && prog->aux->prog_type != BPF_PROG_TYPE_TRACEPOINT)) {
+		/* valid fd, but invalid bpf program type */
+		bpf_prog_put(prog);
+		return -EINVAL;
+	}
+
+	/* the program must not read past the end of the fixed record */
+	if (is_tracepoint &&
+	    prog->aux->max_ctx_offset > trace_event_get_offsets(event->tp_event)) {
+		bpf_prog_put(prog);
+		return -EACCES;
+	}
+
+	mutex_lock(&bpf_event_mutex);
+	if (event->prog || event->tp_event->prog) {
+		ret = -EEXIST;
+	} else {
+		event->prog = prog;
+		event->tp_event->prog = prog;
+	}
+	mutex_unlock(&bpf_event_mutex);
+
+	if (ret)
+		bpf_prog_put(prog);
+	return ret;
+}
+
+static void perf_event_free_bpf_prog(struct perf_event *event)
+{
+	struct bpf_prog *prog = event->prog;
+
+	if (!prog)
+		return;
+
+	mutex_lock(&bpf_event_mutex);
+	event->tp_event->prog = NULL;
+	event->prog = NULL;
+	mutex_unlock(&bpf_event_mutex);
+	/* the event handlers run the program under rcu_read_lock() */
+	bpf_prog_put_rcu(prog);
+}
+
 #else
 
 static inline void perf_tp_register(void)
@@ -6487,6 +6561,15 @@ static void perf_event_free_filter(struct perf_event *event)
 {
 }
 
+static int perf_event_set_bpf_prog(struct perf_event *event, u32 prog_fd)
+{
+	return -ENOENT;
+}
+
+static void perf_event_free_bpf_prog(struct perf_event *event)
+{
+}
+
 #endif /* CONFIG_EVENT_TRACING */
 
 #ifdef CONFIG_HAVE_HW_BREAKPOINT
@@ -64,6 +64,10 @@
 #include <linux/hugetlb.h>
 #include <linux/freezer.h>
 #include <linux/bootmem.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/log2.h>
+#include <linux/vmalloc.h>
 
 #include <asm/futex.h>
 
@@ -252,12 +256,103 @@ struct futex_hash_bucket {
 	atomic_t waiters;
 	spinlock_t lock;
 	struct plist_head chain;
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	struct futex_private_hash *fph;
+#endif
 } ____cacheline_aligned_in_smp;
 
 static unsigned long __read_mostly futex_hashsize;
 
 static struct futex_hash_bucket *futex_queues;
 
+enum {
+	FUTEX_STAT_LOOKUP,
+	FUTEX_STAT_COLLISION,
+	FUTEX_STAT_NR,
+};
+
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+/*
+ * Per process hash table for PTHREAD_PROCESS_PRIVATE futexes.
+ *
+ * A process gets its own table when it creates its first thread, so private
+ * futexes of one process no longer share buckets (and bucket locks) with
+ * every other process in the system. The table is grown as the thread count
+ * goes up, up to the size of the global table.
+ *
+ * Growing replaces mm->futex_phash with a larger table. The old table is
+ * marked dead and its waiters are moved over bucket by bucket while holding
+ * the old bucket lock. Anyone who locks a bucket of a dead table drops the
+ * lock, waits for the resize to finish on mm->futex_phash_lock and hashes
+ * the key again. Retired tables stay on the ->retired list until the mm is
+ * freed, so a stale bucket pointer can always be locked and checked.
+ */
+struct futex_private_hash {
+	struct mm_struct *mm;
+	unsigned int hashmask;
+	int dead;
+	struct futex_private_hash *retired;
+	struct futex_hash_bucket queues[0];
+};
+
+#define FUTEX_PRIVATE_HASH_MIN		16
+#define FUTEX_PRIVATE_SLOTS_PER_THREAD	4
+
+int sysctl_futex_private_hash __read_mostly = 1;
+
+/*
+ * Lookups and waiters of other futexes walked past in a bucket chain, for
+ * the global table ([0]) and the per process tables ([1]).
+ */
+struct futex_hash_stats {
+	unsigned long count[2][FUTEX_STAT_NR];
+	unsigned long resizes;
+	unsigned long migrated;
+};
+
+static DEFINE_PER_CPU(struct futex_hash_stats, futex_hash_stats);
+
+static inline void futex_stat_inc(struct futex_hash_bucket *hb, int item)
+{
+	this_cpu_inc(futex_hash_stats.count[hb->fph != NULL][item]);
+}
+
+/*
+ * Return 1 if @hb belongs to a table which is being or has been replaced.
+ * The answer is only final once hb->lock is held: waiters are moved off a
+ * bucket under its lock after ->dead is set.
+ */
+static inline int futex_hb_stale(struct futex_hash_bucket *hb)
+{
+	return hb->fph && ACCESS_ONCE(hb->fph->dead);
+}
+
+/*
+ * Wait for a resize of the table @hb belongs to. The caller hashes the key
+ * again afterwards.
+ */
+static void futex_hash_wait(struct futex_hash_bucket *hb)
+{
+	struct mm_struct *mm = hb->fph->mm;
+
+	mutex_lock(&mm->futex_phash_lock);
+	mutex_unlock(&mm->futex_phash_lock);
+}
+#else
+static inline void futex_stat_inc(struct futex_hash_bucket *hb, int item)
+{
+}
+
+static inline int futex_hb_stale(struct futex_hash_bucket *hb)
+{
+	return 0;
+}
+
+static inline void futex_hash_wait(struct futex_hash_bucket *hb)
+{
+}
+#endif
+
 static inline void futex_get_mm(union futex_key *key)
 {
 	atomic_inc(&key->private.mm->mm_count);
@@ -306,12 +401,31 @@ static inline int hb_waiters_pending(struct futex_hash_bucket *hb)
 /*
  * We hash on the keys returned from get_futex_key (see below).
  */
+static inline u32 futex_key_hash(union futex_key *key)
+{
+	return jhash2((u32*)&key->both.word,
+		      (sizeof(key->both.word)+sizeof(key->both.ptr))/4,
+		      key->both.offset);
+}
+
 static struct futex_hash_bucket *hash_futex(union futex_key *key)
 {
-	u32 hash = jhash2((u32*)&key->both.word,
-			  (sizeof(key->both.word)+sizeof(key->both.ptr))/4,
-			  key->both.offset);
-	return &futex_queues[hash & (futex_hashsize - 1)];
+	struct futex_hash_bucket *hb;
+	u32 hash = futex_key_hash(key);
+
+	hb = &futex_queues[hash & (futex_hashsize - 1)];
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+	if (!(key->both.offset & (FUT_OFF_INODE | FUT_OFF_MMSHARED))) {
+		struct futex_private_hash *fph;
+
+		/* Pairs with the release in futex_private_hash_resize() */
+		fph = smp_load_acquire(&key->private.mm->futex_phash);
+		if (fph)
+			hb = &fph->queues[hash & fph->hashmask];
+	}
+#endif
+	futex_stat_inc(hb, FUTEX_STAT_LOOKUP);
+	return hb;
 }
 
 /*
@@ -667,6 +781,7 @@ static struct futex_q *futex_top_waiter(struct futex_hash_bucket *hb,
 	plist_for_each_entry(this, &hb->chain, list) {
 		if (match_futex(&this->key, key))
 			return this;
+		futex_stat_inc(hb, FUTEX_STAT_COLLISION);
 	}
 	return NULL;
 }
@@ -815,6 +930,12 @@ void exit_pi_state_list(struct task_struct *curr)
 		raw_spin_unlock_irq(&curr->pi_lock);
 
 		spin_lock(&hb->lock);
+		if (unlikely(futex_hb_stale(hb))) {
+			spin_unlock(&hb->lock);
+			futex_hash_wait(hb);
+			raw_spin_lock_irq(&curr->pi_lock);
+			continue;
+		}
 
 		raw_spin_lock_irq(&curr->pi_lock);
 		/*
@@ -1319,13 +1440,25 @@ futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
 	if (unlikely(ret != 0))
 		goto out;
 
+rehash:
 	hb = hash_futex(&key);
 
-	/* Make sure we really have tasks to wakeup */
-	if (!hb_waiters_pending(hb))
-		goto out_put_key;
+	/*
+	 * Make sure we really have tasks to wakeup. Waiters moved to a
+	 * grown private hash table are no longer accounted in @hb.
+	 */
+	if (!hb_waiters_pending(hb)) {
+		smp_rmb();
+		if (likely(!futex_hb_stale(hb)))
+			goto out_put_key;
+	}
 
 	spin_lock(&hb->lock);
+	if (unlikely(futex_hb_stale(hb))) {
+		spin_unlock(&hb->lock);
+		futex_hash_wait(hb);
+		goto rehash;
+	}
 
 	plist_for_each_entry_safe(this, next, &hb->chain, list) {
 		if (match_futex (&this->key, &key)) {
@@ -1341,6 +1474,8 @@ futex_wake(u32 __user *uaddr, unsigned int flags, int nr_wake, u32 bitset)
 			wake_futex(this);
 			if (++ret >= nr_wake)
 				break;
+		} else {
+			futex_stat_inc(hb, FUTEX_STAT_COLLISION);
 		}
 	}
 
@@ -1372,11 +1507,17 @@ retry:
 	if (unlikely(ret != 0))
 		goto out_put_key1;
 
+rehash:
 	hb1 = hash_futex(&key1);
 	hb2 = hash_futex(&key2);
 
 retry_private:
 	double_lock_hb(hb1, hb2);
+	if (unlikely(futex_hb_stale(hb1) || futex_hb_stale(hb2))) {
+		double_unlock_hb(hb1, hb2);
+		futex_hash_wait(futex_hb_stale(hb1) ? hb1 : hb2);
+		goto rehash;
+	}
 	op_ret = futex_atomic_op_inuser(op, uaddr2);
 	if (unlikely(op_ret < 0)) {
 
@@ -1417,6 +1558,8 @@ retry_private:
 			wake_futex(this);
 			if (++ret >= nr_wake)
 				break;
+		} else {
+			futex_stat_inc(hb1, FUTEX_STAT_COLLISION);
 		}
 	}
 
@@ -1431,6 +1574,8 @@ retry_private:
 				wake_futex(this);
 				if (++op_ret >= nr_wake2)
 					break;
+			} else {
+				futex_stat_inc(hb2, FUTEX_STAT_COLLISION);
 			}
 		}
 		ret += op_ret;
@@ -1647,12 +1792,19 @@ retry:
 		goto out_put_keys;
 	}
 
+rehash:
 	hb1 = hash_futex(&key1);
 	hb2 = hash_futex(&key2);
 
 retry_private:
 	hb_waiters_inc(hb2);
 	double_lock_hb(hb1, hb2);
+	if (unlikely(futex_hb_stale(hb1) || futex_hb_stale(hb2))) {
+		double_unlock_hb(hb1, hb2);
+		hb_waiters_dec(hb2);
+		futex_hash_wait(futex_hb_stale(hb1) ? hb1 : hb2);
+		goto rehash;
+	}
 
 	if (likely(cmpval != NULL)) {
 		u32 curval;
@@ -1753,8 +1905,10 @@ retry_private:
 		if (task_count - nr_wake >= nr_requeue)
 			break;
 
-		if (!match_futex(&this->key, &key1))
+		if (!match_futex(&this->key, &key1)) {
+			futex_stat_inc(hb1, FUTEX_STAT_COLLISION);
 			continue;
+		}
 
 		/*
 		 * FUTEX_WAIT_REQEUE_PI and FUTEX_CMP_REQUEUE_PI should always
@@ -1841,6 +1995,7 @@ static inline struct futex_hash_bucket *queue_lock(struct futex_q *q)
 {
 	struct futex_hash_bucket *hb;
 
+retry:
 	hb = hash_futex(&q->key);
 
 	/*
@@ -1856,6 +2011,12 @@ static inline struct futex_hash_bucket *queue_lock(struct futex_q *q)
 	q->lock_ptr = &hb->lock;
 
 	spin_lock(&hb->lock); /* implies MB (A) */
+	if (unlikely(futex_hb_stale(hb))) {
+		spin_unlock(&hb->lock);
+		hb_waiters_dec(hb);
+		futex_hash_wait(hb);
+		goto retry;
+	}
 	return hb;
 }
 
@@ -1867,6 +2028,25 @@ queue_unlock(struct futex_hash_bucket *hb)
 	hb_waiters_dec(hb);
 }
 
+/*
+ * Lock the hash bucket a queued futex_q is on. q->lock_ptr changes under
+ * the old bucket lock when the futex_q is requeued or moved to a grown
+ * private hash table, so recheck it once we hold the lock.
+ */
+static void futex_q_lock(struct futex_q *q)
+	__acquires(q->lock_ptr)
+{
+	spinlock_t *lock_ptr;
+
+retry:
+	lock_ptr = ACCESS_ONCE(q->lock_ptr);
+	spin_lock(lock_ptr);
+	if (unlikely(lock_ptr != q->lock_ptr)) {
+		spin_unlock(lock_ptr);
+		goto retry;
+	}
+}
+
 /**
  * queue_me() - Enqueue the futex_q on the futex_hash_bucket
  * @q:	The futex_q to enqueue
@@ -2052,7 +2232,7 @@ handle_fault:
 
 	ret = fault_in_user_writeable(uaddr);
 
-	spin_lock(q->lock_ptr);
+	futex_q_lock(q);
 
 	/*
 	 * Check if someone else fixed it for us:
@@ -2424,7 +2604,7 @@ retry_private:
 		ret = ret ? 0 : -EWOULDBLOCK;
 	}
 
-	spin_lock(q.lock_ptr);
+	futex_q_lock(&q);
 	/*
 	 * Fixup the pi_state owner and possibly acquire the lock if we
 	 * haven't already.
@@ -2499,8 +2679,14 @@ retry:
 	if (ret)
 		return ret;
 
+rehash:
 	hb = hash_futex(&key);
 	spin_lock(&hb->lock);
+	if (unlikely(futex_hb_stale(hb))) {
+		spin_unlock(&hb->lock);
+		futex_hash_wait(hb);
+		goto rehash;
+	}
 
 	/*
 	 * Check waiters first. We do not trust user space values at
@@ -2713,7 +2899,12 @@ static int futex_wait_requeue_pi(u32 __user *uaddr, unsigned int flags,
 	/* Queue the futex_q, drop the hb lock, wait for wakeup. */
 	futex_wait_queue_me(hb, &q, to);
 
-	spin_lock(&hb->lock);
+	/*
+	 * hb is stale if the private hash table was grown while we slept,
+	 * lock the bucket q is queued on now instead.
+	 */
+	futex_q_lock(&q);
+	hb = container_of(q.lock_ptr, struct futex_hash_bucket, lock);
 	ret = handle_early_requeue_pi_wakeup(hb, &q, &key2, to);
 	spin_unlock(&hb->lock);
 	if (ret)
@@ -2735,7 +2926,7 @@ static int futex_wait_requeue_pi(u32 __user *uaddr, unsigned int flags,
 		 * did a lock-steal - fix up the PI-state in that case.
 		 */
 		if (q.pi_state && (q.pi_state->owner != current)) {
-			spin_lock(q.lock_ptr);
+			futex_q_lock(&q);
 			ret = fixup_pi_state_owner(uaddr2, &q, current);
 			if (ret && rt_mutex_owner(&q.pi_state->pi_mutex) == current)
 				rt_mutex_unlock(&q.pi_state->pi_mutex);
@@ -2759,7 +2950,7 @@ static int futex_wait_requeue_pi(u32 __user *uaddr, unsigned int flags,
 		ret = rt_mutex_finish_proxy_lock(pi_mutex, to, &rt_waiter);
 		debug_rt_mutex_free_waiter(&rt_waiter);
 
-		spin_lock(q.lock_ptr);
+		futex_q_lock(&q);
 		/*
 		 * Fixup the pi_state owner and possibly acquire the lock if we
 		 * haven't already.
@@ -3141,6 +3332,191 @@ static void __init futex_detect_cmpxchg(void)
 #endif
 }
 
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+static struct futex_private_hash *
+futex_private_hash_alloc(struct mm_struct *mm, unsigned int slots)
+{
+	struct futex_private_hash *fph;
+	size_t size = sizeof(*fph) + slots * sizeof(fph->queues[0]);
+	unsigned int i;
+
+	fph = kzalloc(size, GFP_KERNEL | __GFP_NOWARN);
+	if (!fph)
+		fph = vzalloc(size);
+	if (!fph)
+		return NULL;
+
+	fph->mm = mm;
+	fph->hashmask = slots - 1;
+	for (i = 0; i < slots; i++) {
+		atomic_set(&fph->queues[i].waiters, 0);
+		plist_head_init(&fph->queues[i].chain);
+		spin_lock_init(&fph->queues[i].lock);
+		fph->queues[i].fph = fph;
+	}
+
+	return fph;
+}
+
+/*
+ * Install a private hash table with @slots buckets for @mm and move the
+ * waiters of the current one, if any, over to it.
+ */
+static void futex_private_hash_resize(struct mm_struct *mm, unsigned int slots)
+{
+	struct futex_private_hash *old, *new;
+	struct futex_hash_bucket *ohb, *nhb;
+	struct futex_q *this, *next;
+	unsigned long moved = 0;
+	unsigned int i;
+
+	new = futex_private_hash_alloc(mm, slots);
+	if (!new)
+		return;
+
+	mutex_lock(&mm->futex_phash_lock);
+	old = mm->futex_phash;
+	if (old && old->hashmask >= new->hashmask) {
+		mutex_unlock(&mm->futex_phash_lock);
+		kvfree(new);
+		return;
+	}
+
+	if (old) {
+		/*
+		 * Once a bucket lock holder can observe ->dead it backs off
+		 * and waits on futex_phash_lock, so whatever we find queued
+		 * below stays put until we have moved it.
+		 */
+		ACCESS_ONCE(old->dead) = 1;
+		smp_mb();
+
+		for (i = 0; i <= old->hashmask; i++) {
+			ohb = &old->queues[i];
+			spin_lock(&ohb->lock);
+			plist_for_each_entry_safe(this, next, &ohb->chain, list) {
+				nhb = &new->queues[futex_key_hash(&this->key) &
+						   new->hashmask];
+				spin_lock_nested(&nhb->lock, SINGLE_DEPTH_NESTING);
+				plist_del(&this->list, &ohb->chain);
+				hb_waiters_dec(ohb);
+				plist_add(&this->list, &nhb->chain);
+				hb_waiters_inc(nhb);
+				this->lock_ptr = &nhb->lock;
+				spin_unlock(&nhb->lock);
+				moved++;
+			}
+			spin_unlock(&ohb->lock);
+		}
+		new->retired = old;
+	}
+
+	/* Pairs with the acquire in hash_futex() */
+	smp_store_release(&mm->futex_phash, new);
+	mutex_unlock(&mm->futex_phash_lock);
+
+	this_cpu_inc(futex_hash_stats.resizes);
+	this_cpu_add(futex_hash_stats.migrated, moved);
+}
+
+void futex_mm_init(struct mm_struct *mm)
+{
+	mm->futex_phash = NULL;
+	mutex_init(&mm->futex_phash_lock);
+}
+
+void futex_mm_free(struct mm_struct *mm)
+{
+	struct futex_private_hash *fph = mm->futex_phash, *next;
+
+	while (fph) {
+		next = fph->retired;
+		kvfree(fph);
+		fph = next;
+	}
+}
+
+/**
+ * futex_mm_new_thread() - Size the private futex hash of a growing process
+ * @mm:		the mm of the process a thread is being added to
+ *
+ * Called from copy_process() before the new thread shares @mm. The table
+ * is only created while @mm has a single user: private futex waiters
+ * already hashed into the global table would otherwise be missed by
+ * wakers looking them up in the new table.
+ */
+void futex_mm_new_thread(struct mm_struct *mm)
+{
+	struct futex_private_hash *fph;
+	unsigned int slots;
+
+	if (!sysctl_futex_private_hash || !mm)
+		return;
+
+	fph = ACCESS_ONCE(mm->futex_phash);
+	if (!fph && atomic_read(&mm->mm_users) != 1)
+		return;
+
+	slots = (get_nr_threads(current) + 1) * FUTEX_PRIVATE_SLOTS_PER_THREAD;
+	slots = clamp_t(unsigned int, roundup_pow_of_two(slots),
+			FUTEX_PRIVATE_HASH_MIN, futex_hashsize);
+	if (fph && slots <= fph->hashmask + 1)
+		return;
+
+	futex_private_hash_resize(mm, slots);
+}
+
+#ifdef CONFIG_DEBUG_FS
+static int futex_hash_stats_show(struct seq_file *m, void *v)
+{
+	static const char * const table[] = { "global", "private" };
+	unsigned long count[2][FUTEX_STAT_NR] = { };
+	unsigned long resizes = 0, migrated = 0;
+	struct futex_hash_stats *st;
+	int cpu, i, j;
+
+	for_each_possible_cpu(cpu) {
+		st = &per_cpu(futex_hash_stats, cpu);
+		for (i = 0; i < 2; i++)
+			for (j = 0; j < FUTEX_STAT_NR; j++)
+				count[i][j] += st->count[i][j];
+		resizes += st->resizes;
+		migrated += st->migrated;
+	}
+
+	seq_printf(m, "global buckets: %lu\n", futex_hashsize);
+	seq_printf(m, "%-8s %16s %16s\n", "table", "lookups", "collisions");
+	for (i = 0; i < 2; i++)
+		seq_printf(m, "%-8s %16lu %16lu\n", table[i],
+			   count[i][FUTEX_STAT_LOOKUP],
+			   count[i][FUTEX_STAT_COLLISION]);
+	seq_printf(m, "private resizes: %lu\n", resizes);
+	seq_printf(m, "private waiters migrated: %lu\n", migrated);
+	return 0;
+}
+
+static int futex_hash_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, futex_hash_stats_show, NULL);
+}
+
+static const struct file_operations futex_hash_stats_fops = {
+	.open		= futex_hash_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init futex_hash_debugfs_init(void)
+{
+	debugfs_create_file("futex_hash_stats", S_IRUSR, NULL, NULL,
+			    &futex_hash_stats_fops);
+	return 0;
+}
+late_initcall(futex_hash_debugfs_init);
+#endif /* CONFIG_DEBUG_FS */
+#endif /* CONFIG_FUTEX_PRIVATE_HASH */
+
 static int __init futex_init(void)
 {
 	unsigned int futex_shift;
@@ -3165,6 +3541,9 @@ static int __init futex_init(void)
 		atomic_set(&futex_queues[i].waiters, 0);
 		plist_head_init(&futex_queues[i].chain);
 		spin_lock_init(&futex_queues[i].lock);
+#ifdef CONFIG_FUTEX_PRIVATE_HASH
+		futex_queues[i].fph = NULL;
+#endif
 	}
 
 	return 0;
@@ -0,0 +1,436 @@
+/*
+ * Queued spinlock
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include <linux/smp.h>
+#include <linux/bug.h>
+#include <linux/cpumask.h>
+#include <linux/percpu.h>
+#include <linux/hardirq.h>
+#include <linux/prefetch.h>
+#include <linux/topology.h>
+#include <linux/export.h>
+#include <linux/spinlock.h>
+
+#include "mcs_spinlock.h"
+
+/*
+ * The basic principle of a queue-based spinlock can best be understood
+ * by studying a classic queue-based spinlock implementation called the
+ * MCS lock. The MCS lock keeps every waiter spinning on its own cache
+ * line, so a release only touches the line of the next waiter instead of
+ * bouncing one line between all of them as the ticket lock does.
+ *
+ * An MCS lock needs a pointer sized tail plus a node per waiter passed in
+ * by the caller. To keep the spinlock 4 bytes and the spin_lock() API
+ * unchanged, the tail is encoded as a CPU number and a nesting level
+ * (task, softirq, hardirq, nmi), and the nodes are per-cpu.
+ *
+ * The first contender does not queue at all: it sets the pending bit and
+ * spins on the lock word, which avoids touching its queue node for the
+ * common case of two CPUs fighting over a lock.
+ *
+ * The lock word is a 3-tuple (queue tail, pending bit, lock value) in the
+ * comments below.
+ */
+
+#define MAX_NODES	4
+
+/*
+ * With CONFIG_QUEUED_SPINLOCKS_CLUSTER_AWARE the MCS handoff prefers
+ * waiters in the releaser's cluster. Waiters of other clusters found ahead
+ * of such a waiter are moved to a secondary queue, and the lock returns to
+ * them when no waiter in the cluster is left or after
+ * CLUSTER_HANDOFF_THRESHOLD consecutive handoffs within the cluster.
+ *
+ * The head of the main queue learns about the secondary queue from the
+ * value its predecessor stores in mcs.locked: 1 means there is none, any
+ * other value is the encoded tail of the first node of the secondary
+ * queue. Encoded tails are never 0 or 1.
+ */
+#define CLUSTER_HANDOFF_THRESHOLD	256
+
+struct qnode {
+	struct mcs_spinlock mcs;
+#ifdef CONFIG_QUEUED_SPINLOCKS_CLUSTER_AWARE
+	int cluster;		/* cluster of the CPU owning the node */
+	u32 tail;		/* encoded tail of this node */
+	unsigned int handoffs;	/* in-cluster handoffs in a row */
+	struct qnode *sec_tail;	/* last node of the secondary queue */
+#endif
+};
+
+/*
+ * Per-CPU queue node structures; we can never have more than 4 nested
+ * contexts: task, softirq, hardirq, nmi.
+ *
+ * Exactly fits one 64-byte cacheline on a 64-bit architecture without the
+ * cluster aware handoff.
+ */
+static DEFINE_PER_CPU_ALIGNED(struct qnode, qnodes[MAX_NODES]);
+
+/*
+ * We must be able to distinguish between no-tail and the tail at 0:0,
+ * therefore increment the cpu number by one.
+ */
+static inline u32 encode_tail(int cpu, int idx)
+{
+	u32 tail;
+
+	tail  = (cpu + 1) << _Q_TAIL_CPU_OFFSET;
+	tail |= idx << _Q_TAIL_IDX_OFFSET; /* assume < 4 */
+
+	return tail;
+}
+
+static inline struct qnode *decode_tail(u32 tail)
+{
+	int cpu = (tail >> _Q_TAIL_CPU_OFFSET) - 1;
+	int idx = (tail &  _Q_TAIL_IDX_MASK) >> _Q_TAIL_IDX_OFFSET;
+
+	return per_cpu_ptr(&qnodes[idx], cpu);
+}
+
+/**
+ * clear_pending_set_locked - take ownership and clear the pending bit.
+ * @lock: Pointer to queued spinlock structure
+ *
+ * *,1,0 -> *,0,1
+ */
+static __always_inline void clear_pending_set_locked(struct qspinlock *lock)
+{
+	WRITE_ONCE(lock->locked_pending, _Q_LOCKED_VAL);
+}
+
+/**
+ * xchg_tail - Put in the new queue tail code word & retrieve previous one
+ * @lock : Pointer to queued spinlock structure
+ * @tail : The new queue tail code word
+ * Return: The previous queue tail code word
+ *
+ * xchg(lock, tail)
+ *
+ * p,*,* -> n,*,* ; prev = xchg(lock, node)
+ */
+static __always_inline u32 xchg_tail(struct qspinlock *lock, u32 tail)
+{
+	return (u32)xchg(&lock->tail, tail >> _Q_TAIL_OFFSET) << _Q_TAIL_OFFSET;
+}
+
+/**
+ * set_locked - Set the lock bit and own the lock
+ * @lock: Pointer to queued spinlock structure
+ *
+ * *,*,0 -> *,0,1
+ */
+static __always_inline void set_locked(struct qspinlock *lock)
+{
+	WRITE_ONCE(lock->locked, _Q_LOCKED_VAL);
+}
+
+#ifdef CONFIG_QUEUED_SPINLOCKS_CLUSTER_AWARE
+static __always_inline void cluster_init_node(struct qnode *node, u32 tail)
+{
+	node->cluster = topology_physical_package_id(smp_processor_id());
+	node->tail = tail;
+	node->handoffs = 0;
+}
+
+static __always_inline struct qnode *cluster_sec_head(struct qnode *node)
+{
+	u32 val = node->mcs.locked;
+
+	return val > 1 ? decode_tail(val) : NULL;
+}
+
+/*
+ * We are the last waiter of the main queue and own the lock: clear the
+ * tail, or make the secondary queue the main queue if there is one.
+ *
+ * n,0,0 -> 0,0,1 or s,0,1
+ */
+static __always_inline u32
+cluster_clear_tail(struct qspinlock *lock, u32 val, struct qnode *node)
+{
+	struct qnode *sec = cluster_sec_head(node);
+	u32 old;
+
+	if (!sec)
+		return atomic_cmpxchg(&lock->val, val, _Q_LOCKED_VAL);
+
+	old = atomic_cmpxchg(&lock->val, val,
+			     sec->sec_tail->tail | _Q_LOCKED_VAL);
+	if (old == val) {
+		sec->handoffs = 0;
+		smp_store_release(&sec->mcs.locked, 1);
+	}
+	return old;
+}
+
+/*
+ * Make the first waiter of our cluster the head of the main queue. Only
+ * nodes whose ->next is already set are moved to the secondary queue, so
+ * the lock tail and concurrent enqueuers are never affected.
+ */
+static void cluster_pass_lock(struct qnode *node, struct qnode *next)
+{
+	struct qnode *sec = cluster_sec_head(node);
+	struct qnode *this = next, *prev = NULL, *n;
+
+	if (!sec || node->handoffs < CLUSTER_HANDOFF_THRESHOLD) {
+		while (this->cluster != node->cluster) {
+			n = (struct qnode *)READ_ONCE(this->mcs.next);
+			if (!n) {
+				this = NULL;
+				break;
+			}
+			prev = this;
+			this = n;
+		}
+
+		if (this) {
+			if (prev) {
+				if (sec)
+					sec->sec_tail->mcs.next = &next->mcs;
+				else
+					sec = next;
+				sec->sec_tail = prev;
+				prev->mcs.next = NULL;
+			}
+			this->handoffs = node->handoffs + 1;
+			smp_store_release(&this->mcs.locked,
+					  sec ? sec->tail : 1);
+			return;
+		}
+	}
+
+	/*
+	 * Nobody of our cluster is waiting, or the secondary queue waited
+	 * long enough: put it back in front of the main queue.
+	 */
+	if (sec) {
+		sec->sec_tail->mcs.next = &next->mcs;
+		next = sec;
+	}
+	next->handoffs = 0;
+	arch_mcs_spin_unlock_contended(&next->mcs.locked);
+}
+#else
+static __always_inline void cluster_init_node(struct qnode *node, u32 tail)
+{
+}
+
+static __always_inline u32
+cluster_clear_tail(struct qspinlock *lock, u32 val, struct qnode *node)
+{
+	return atomic_cmpxchg(&lock->val, val, _Q_LOCKED_VAL);
+}
+
+static __always_inline void cluster_pass_lock(struct qnode *node,
+					      struct qnode *next)
+{
+	arch_mcs_spin_unlock_contended(&next->mcs.locked);
+}
+#endif /* CONFIG_QUEUED_SPINLOCKS_CLUSTER_AWARE */
+
+/**
+ * queued_spin_lock_slowpath - acquire the queued spinlock
+ * @lock: Pointer to queued spinlock structure
+ * @val: Current value of the queued spinlock 32-bit word
+ *
+ * (queue tail, pending bit, lock value)
+ *
+ *              fast     :    slow                                  :    unlock
+ *                       :                                          :
+ * uncontended  (0,0,0) -:--> (0,0,1) ------------------------------:--> (*,*,0)
+ *                       :       | ^--------.------.             /  :
+ *                       :       v           \      \            |  :
+ * pending               :    (0,1,1) +--> (0,1,0)   \           |  :
+ *                       :       | ^--'              |           |  :
+ *                       :       v                   |           |  :
+ * uncontended           :    (n,x,y) +--> (n,0,0) --'           |  :
+ *   queue               :       | ^--'                          |  :
+ *                       :       v                               |  :
+ * contended             :    (*,x,y) +--> (*,0,0) ---> (*,0,1) -'  :
+ *   queue               :         ^--'                             :
+ */
+void queued_spin_lock_slowpath(struct qspinlock *lock, u32 val)
+{
+	struct qnode *prev, *next, *node;
+	u32 new, old, tail;
+	int idx;
+
+	BUILD_BUG_ON(CONFIG_NR_CPUS >= (1U << _Q_TAIL_CPU_BITS));
+
+	/*
+	 * wait for in-progress pending->locked hand-overs
+	 *
+	 * 0,1,0 -> 0,0,1
+	 */
+	if (val == _Q_PENDING_VAL) {
+		while ((val = atomic_read(&lock->val)) == _Q_PENDING_VAL)
+			cpu_relax();
+	}
+
+	/*
+	 * trylock || pending
+	 *
+	 * 0,0,0 -> 0,0,1 ; trylock
+	 * 0,0,1 -> 0,1,1 ; pending
+	 */
+	for (;;) {
+		/*
+		 * If we observe any contention; queue.
+		 */
+		if (val & ~_Q_LOCKED_MASK)
+			goto queue;
+
+		new = _Q_LOCKED_VAL;
+		if (val == new)
+			new |= _Q_PENDING_VAL;
+
+		old = atomic_cmpxchg(&lock->val, val, new);
+		if (old == val)
+			break;
+
+		val = old;
+	}
+
+	/*
+	 * we won the trylock
+	 */
+	if (new == _Q_LOCKED_VAL)
+		return;
+
+	/*
+	 * we're pending, wait for the owner to go away.
+	 *
+	 * *,1,1 -> *,1,0
+	 */
+	while ((val = smp_load_acquire(&lock->val.counter)) & _Q_LOCKED_MASK)
+		cpu_relax();
+
+	/*
+	 * take ownership and clear the pending bit.
+	 *
+	 * *,1,0 -> *,0,1
+	 */
+	clear_pending_set_locked(lock);
+	return;
+
+	/*
+	 * End of pending bit optimistic spinning and beginning of MCS
+	 * queuing.
+	 */
+queue:
+	node = this_cpu_ptr(&qnodes[0]);
+	idx = node->mcs.count++;
+	tail = encode_tail(smp_processor_id(), idx);
+
+	node += idx;
+	node->mcs.locked = 0;
+	node->mcs.next = NULL;
+	cluster_init_node(node, tail);
+
+	/*
+	 * We touched a (possibly) cold cacheline in the per-cpu queue node;
+	 * attempt the trylock once more in the hope someone let go while we
+	 * weren't watching.
+	 */
+	if (queued_spin_trylock(lock))
+		goto release;
+
+	/*
+	 * Ensure that the initialisation of @node is complete before we
+	 * publish the updated tail and link @node into the waitqueue.
+	 */
+	smp_wmb();
+
+	/*
+	 * We have already touched the queueing cacheline; don't bother with
+	 * pending stuff.
+	 *
+	 * p,*,* -> n,*,*
+	 */
+	old = xchg_tail(lock, tail);
+	next = NULL;
+
+	/*
+	 * if there was a previous node; link it and wait until reaching the
+	 * head of the waitqueue.
+	 */
+	if (old & _Q_TAIL_MASK) {
+		prev = decode_tail(old);
+		WRITE_ONCE(prev->mcs.next, &node->mcs);
+
+		arch_mcs_spin_lock_contended(&node->mcs.locked);
+
+		/*
+		 * While waiting for the MCS lock, the next pointer may have
+		 * been set by another lock waiter. We optimistically load
+		 * the next pointer & prefetch the cacheline for writing
+		 * to reduce latency in the upcoming MCS unlock operation.
+		 */
+		next = (struct qnode *)READ_ONCE(node->mcs.next);
+		if (next)
+			prefetchw(next);
+	}
+
+	/*
+	 * we're at the head of the waitqueue, wait for the owner & pending to
+	 * go away.
+	 *
+	 * *,x,y -> *,0,0
+	 */
+	while ((val = smp_load_acquire(&lock->val.counter)) &
+			_Q_LOCKED_PENDING_MASK)
+		cpu_relax();
+
+	/*
+	 * claim the lock:
+	 *
+	 * n,0,0 -> 0,0,1 : lock, uncontended
+	 * *,0,0 -> *,0,1 : lock, contended
+	 *
+	 * If the queue head is the only one in the queue (lock value == tail),
+	 * clear the tail code and grab the lock. Otherwise, we only need
+	 * to grab the lock.
+	 */
+	for (;;) {
+		if ((val & _Q_TAIL_MASK) != tail) {
+			set_locked(lock);
+			break;
+		}
+		old = cluster_clear_tail(lock, val, node);
+		if (old == val)
+			goto release;	/* No contention */
+
+		val = old;
+	}
+
+	/*
+	 * contended path; wait for next, release.
+	 */
+	if (!next) {
+		while (!(next = (struct qnode *)READ_ONCE(node->mcs.next)))
+			cpu_relax();
+	}
+
+	cluster_pass_lock(node, next);
+
+release:
+	/*
+	 * release the node
+	 */
+	this_cpu_dec(qnodes[0].mcs.count);
+}
+EXPORT_SYMBOL(queued_spin_lock_slowpath);
@@ -46,6 +46,8 @@
 #include <linux/irq_work.h>
 #include <linux/utsname.h>
 #include <linux/ctype.h>
+#include <linux/kthread.h>
+#include <linux/slab.h>
 
 #include <asm/uaccess.h>
 
@@ -1576,7 +1578,8 @@ static void cont_flush(enum log_flags flags)
 	}
 }
 
-static bool cont_add(int facility, int level, const char *text, size_t len)
+static bool cont_add(int facility, int level, struct task_struct *owner,
+		     u64 ts_nsec, const char *text, size_t len)
 {
 	if (cont.len && cont.flushed)
 		return false;
@@ -1590,8 +1593,8 @@ static bool cont_add(int facility, int level, const char *text, size_t len)
 	if (!cont.len) {
 		cont.facility = facility;
 		cont.level = level;
-		cont.owner = current;
-		cont.ts_nsec = local_clock();
+		cont.owner = owner;
+		cont.ts_nsec = ts_nsec ? ts_nsec : local_clock();
 		cont.flags = 0;
 		cont.cons = 0;
 		cont.flushed = false;
@@ -1634,6 +1637,437 @@ static size_t cont_print_text(char *text, size_t size)
 	return textlen;
 }
 
+/*
+ * Mark and strip a trailing newline and, for kernel messages, the syslog
+ * prefix. The log level and flags are updated from what was found.
+ */
+static char *printk_parse_text(int facility, int *level, const char *dict,
+			       enum log_flags *lflags, char *text,
+			       size_t *text_len)
+{
+	/* mark and strip a trailing newline */
+	if (*text_len && text[*text_len-1] == '\n') {
+		(*text_len)--;
+		*lflags |= LOG_NEWLINE;
+	}
+
+	/* strip kernel syslog prefix and extract log level or control flags */
+	if (facility == 0) {
+		int kern_level = printk_get_level(text);
+
+		if (kern_level) {
+			const char *end_of_header = printk_skip_level(text);
+			switch (kern_level) {
+			case '0' ... '7':
+				if (*level == -1)
+					*level = kern_level - '0';
+			case 'd':	/* KERN_DEFAULT */
+				*lflags |= LOG_PREFIX;
+			}
+			/*
+			 * No need to check length here because vscnprintf
+			 * put '\0' at the end of the string. Only valid and
+			 * newly printed level is detected.
+			 */
+			*text_len -= end_of_header - text;
+			text = (char *)end_of_header;
+		}
+	}
+
+	if (*level == -1)
+		*level = default_message_loglevel;
+
+	if (dict)
+		*lflags |= LOG_PREFIX|LOG_NEWLINE;
+
+	return text;
+}
+
+/*
+ * Store a parsed message, merging continuation lines of the same owner.
+ * A zero ts_nsec means now. Called with logbuf_lock held.
+ */
+static int printk_store(int facility, int level, enum log_flags lflags,
+			u64 ts_nsec, struct task_struct *owner,
+			const char *dict, u16 dictlen,
+			const char *text, size_t text_len)
+{
+	int printed_len = 0;
+
+	if (!(lflags & LOG_NEWLINE)) {
+		/*
+		 * Flush the conflicting buffer. An earlier newline was missing,
+		 * or another task also prints continuation lines.
+		 */
+		if (cont.len && (lflags & LOG_PREFIX || cont.owner != owner))
+			cont_flush(LOG_NEWLINE);
+
+		/* buffer line if possible, otherwise store it right away */
+		if (cont_add(facility, level, owner, ts_nsec, text, text_len))
+			printed_len += text_len;
+		else
+			printed_len += log_store(facility, level,
+						 lflags | LOG_CONT, ts_nsec,
+						 dict, dictlen, text, text_len);
+	} else {
+		bool stored = false;
+
+		/*
+		 * If an earlier newline was missing and it was the same task,
+		 * either merge it with the current buffer and flush, or if
+		 * there was a race with interrupts (prefix == true) then just
+		 * flush it out and store this line separately.
+		 * If the preceding printk was from a different task and missed
+		 * a newline, flush and append the newline.
+		 */
+		if (cont.len) {
+			if (cont.owner == owner && !(lflags & LOG_PREFIX))
+				stored = cont_add(facility, level, owner,
+						  ts_nsec, text, text_len);
+			cont_flush(LOG_NEWLINE);
+		}
+
+		if (stored)
+			printed_len += text_len;
+		else
+			printed_len += log_store(facility, level, lflags,
+						 ts_nsec, dict, dictlen,
+						 text, text_len);
+	}
+
+	return printed_len;
+}
+
+#ifdef CONFIG_PRINTK_ASYNC
+/*
+ * Asynchronous printk.
+ *
+ * Every CPU has a ring of message records. printk() callers reserve space
+ * with a cmpxchg on the ring head, which only has to be atomic against
+ * interrupts and NMIs on the same CPU, fill in the record and mark it
+ * committed. The "printk" kthread moves committed records, oldest first
+ * across all CPUs, into the kernel log buffer under logbuf_lock and then
+ * prints them to the consoles. Holding logbuf_lock is what serializes the
+ * consumers of the rings; the synchronous path drains them the same way
+ * before storing its own message so that the log stays in order.
+ */
+#define PRINTK_ASYNC_BUF_LEN	(1 << CONFIG_PRINTK_ASYNC_BUF_SHIFT)
+#define PRINTK_ASYNC_MAX_REC	(PRINTK_ASYNC_BUF_LEN / 4)
+#define PRINTK_ASYNC_NEST	4	/* task, softirq, hardirq, NMI */
+#define PRINTK_ASYNC_BATCH	32
+
+enum {
+	PRINTK_REC_FREE,
+	PRINTK_REC_MSG,
+	PRINTK_REC_PAD,		/* skip to the end of the buffer */
+};
+
+struct printk_async_rec {
+	u64 ts_nsec;			/* time of the printk */
+	struct task_struct *owner;	/* only compared, for continuations */
+	u16 size;			/* size of the entire record */
+	u16 text_len;			/* length of text buffer */
+	u16 dict_len;			/* length of dictionary buffer */
+	u8 facility;			/* syslog facility */
+	u8 level:3;			/* syslog level */
+	u8 flags:5;			/* internal record flags */
+	u8 state;			/* PRINTK_REC_* */
+};
+
+struct printk_async_ring {
+	unsigned long head;		/* reserved by producers */
+	unsigned long tail ____cacheline_aligned_in_smp; /* consumed */
+	char text[PRINTK_ASYNC_NEST][LOG_LINE_MAX];
+	char buf[PRINTK_ASYNC_BUF_LEN] __aligned(8);
+};
+
+static bool __read_mostly printk_async = true;
+module_param_named(async, printk_async, bool, S_IRUGO | S_IWUSR);
+
+static struct task_struct *printk_kthread;
+static DEFINE_PER_CPU(struct printk_async_ring *, printk_async_ring);
+static DEFINE_PER_CPU(int, printk_async_nesting);
+
+static void printk_async_work_func(struct irq_work *irq_work)
+{
+	wake_up_process(printk_kthread);
+}
+
+static DEFINE_PER_CPU(struct irq_work, printk_async_work) = {
+	.func = printk_async_work_func,
+	.flags = IRQ_WORK_LAZY,
+};
+
+static bool printk_async_active(void)
+{
+	return printk_async && READ_ONCE(printk_kthread) &&
+	       !oops_in_progress && system_state == SYSTEM_RUNNING;
+}
+
+static struct printk_async_rec *
+printk_async_reserve(struct printk_async_ring *r, u32 size)
+{
+	struct printk_async_rec *rec;
+	unsigned long head, next, off, pad;
+
+	do {
+		head = READ_ONCE(r->head);
+		off = head & (PRINTK_ASYNC_BUF_LEN - 1);
+		pad = 0;
+		if (off + size > PRINTK_ASYNC_BUF_LEN)
+			pad = PRINTK_ASYNC_BUF_LEN - off;
+		next = head + pad + size;
+		/* pairs with the release in printk_async_consume() */
+		if (next - smp_load_acquire(&r->tail) > PRINTK_ASYNC_BUF_LEN)
+			return NULL;
+	} while (cmpxchg_local(&r->head, head, next) != head);
+
+	/*
+	 * A wrap gap too small for a header is skipped by the consumer
+	 * without looking at it, a larger one needs a padding record.
+	 */
+	if (pad >= sizeof(*rec)) {
+		rec = (struct printk_async_rec *)(r->buf + off);
+		rec->size = pad;
+		smp_wmb();
+		WRITE_ONCE(rec->state, PRINTK_REC_PAD);
+	}
+
+	return (struct printk_async_rec *)(r->buf +
+			((head + pad) & (PRINTK_ASYNC_BUF_LEN - 1)));
+}
+
+/*
+ * Store the message in this CPU's ring. Returns the length of the text,
+ * or -1 if the caller has to fall back to the synchronous path.
+ */
+static int printk_async_emit(int facility, int level,
+			     const char *dict, size_t dictlen,
+			     const char *fmt, va_list args)
+{
+	struct printk_async_ring *r;
+	struct printk_async_rec *rec;
+	enum log_flags lflags = 0;
+	size_t text_len, size;
+	char *text;
+	int nest, ret = -1;
+
+	preempt_disable();
+	nest = this_cpu_inc_return(printk_async_nesting) - 1;
+	r = __this_cpu_read(printk_async_ring);
+	if (!r || nest >= PRINTK_ASYNC_NEST)
+		goto out;
+
+	text = r->text[nest];
+	text_len = vscnprintf(text, LOG_LINE_MAX, fmt, args);
+	text = printk_parse_text(facility, &level, dict, &lflags,
+				 text, &text_len);
+
+	size = ALIGN(sizeof(*rec) + text_len + dictlen, 8);
+	if (size > PRINTK_ASYNC_MAX_REC)
+		goto out;
+	rec = printk_async_reserve(r, size);
+	if (!rec)
+		goto out;
+
+	rec->ts_nsec = local_clock();
+	rec->owner = current;
+	rec->size = size;
+	rec->text_len = text_len;
+	rec->dict_len = dictlen;
+	rec->facility = facility;
+	rec->level = level & 7;
+	rec->flags = lflags & 0x1f;
+	memcpy(rec + 1, text, text_len);
+	if (dictlen)
+		memcpy((char *)(rec + 1) + text_len, dict, dictlen);
+	/* pairs with the read barrier in printk_async_peek() */
+	smp_wmb();
+	WRITE_ONCE(rec->state, PRINTK_REC_MSG);
+
+#ifdef CONFIG_EARLY_PRINTK_DIRECT
+	printascii(text);
+#endif
+	irq_work_queue(this_cpu_ptr(&printk_async_work));
+	ret = text_len;
+out:
+	this_cpu_dec(printk_async_nesting);
+	preempt_enable();
+	return ret;
+}
+
+/* Return the oldest committed record of a ring, skipping padding */
+static struct printk_async_rec *printk_async_peek(struct printk_async_ring *r)
+{
+	struct printk_async_rec *rec;
+	unsigned long tail = r->tail;
+	unsigned long off;
+
+	while (tail != READ_ONCE(r->head)) {
+		off = tail & (PRINTK_ASYNC_BUF_LEN - 1);
+		if (PRINTK_ASYNC_BUF_LEN - off < sizeof(*rec)) {
+			tail += PRINTK_ASYNC_BUF_LEN - off;
+			smp_store_release(&r->tail, tail);
+			continue;
+		}
+
+		rec = (struct printk_async_rec *)(r->buf + off);
+		switch (READ_ONCE(rec->state)) {
+		case PRINTK_REC_FREE:
+			/* reserved, but not committed yet */
+			return NULL;
+		case PRINTK_REC_PAD:
+			smp_rmb();
+			tail += rec->size;
+			memset(rec, 0, sizeof(*rec));
+			smp_store_release(&r->tail, tail);
+			continue;
+		}
+		smp_rmb();
+		return rec;
+	}
+	return NULL;
+}
+
+static void printk_async_consume(struct printk_async_ring *r,
+				 struct printk_async_rec *rec)
+{
+	unsigned long size = rec->size;
+
+	/*
+	 * Free space is kept zeroed, a later record header may start
+	 * anywhere in it and must read as PRINTK_REC_FREE until committed.
+	 */
+	memset(rec, 0, size);
+	/* pairs with the acquire in printk_async_reserve() */
+	smp_store_release(&r->tail, r->tail + size);
+}
+
+/*
+ * Move up to max records from the rings into the log buffer, oldest
+ * first. Called with logbuf_lock held. Returns the number of records.
+ */
+static unsigned int printk_async_drain(unsigned int max)
+{
+	struct printk_async_ring *r, *oldest_ring;
+	struct printk_async_rec *rec, *oldest;
+	unsigned int done = 0;
+	const char *text;
+	int cpu;
+
+	if (!READ_ONCE(printk_kthread))
+		return 0;
+
+	while (done < max) {
+		oldest = NULL;
+		oldest_ring = NULL;
+		for_each_possible_cpu(cpu) {
+			r = per_cpu(printk_async_ring, cpu);
+			if (!r)
+				continue;
+			rec = printk_async_peek(r);
+			if (rec && (!oldest || rec->ts_nsec < oldest->ts_nsec)) {
+				oldest = rec;
+				oldest_ring = r;
+			}
+		}
+		if (!oldest)
+			break;
+
+		text = (const char *)(oldest + 1);
+		printk_store(oldest->facility, oldest->level, oldest->flags,
+			     oldest->ts_nsec, oldest->owner,
+			     oldest->dict_len ? text + oldest->text_len : NULL,
+			     oldest->dict_len, text, oldest->text_len);
+		printk_async_consume(oldest_ring, oldest);
+		done++;
+	}
+	return done;
+}
+
+static bool printk_async_pending(void)
+{
+	struct printk_async_ring *r;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		r = per_cpu(printk_async_ring, cpu);
+		if (r && READ_ONCE(r->head) != READ_ONCE(r->tail))
+			return true;
+	}
+	return false;
+}
+
+static int printk_kthread_func(void *data)
+{
+	unsigned long flags;
+	unsigned int done;
+
+	for (;;) {
+		set_current_state(TASK_INTERRUPTIBLE);
+		if (!printk_async_pending())
+			schedule();
+		__set_current_state(TASK_RUNNING);
+
+		do {
+			raw_spin_lock_irqsave(&logbuf_lock, flags);
+			done = printk_async_drain(PRINTK_ASYNC_BATCH);
+			raw_spin_unlock_irqrestore(&logbuf_lock, flags);
+
+			/* print each batch, the consoles are the bottleneck */
+			console_lock();
+			console_unlock();
+		} while (done == PRINTK_ASYNC_BATCH);
+	}
+	return 0;
+}
+
+/*
+ * Move whatever the rings hold into the log buffer when printing is
+ * about to happen synchronously, for example on panic. The lock may be
+ * held by a CPU that was stopped, so only try to take it.
+ */
+static void printk_async_flush(void)
+{
+	unsigned long flags;
+
+	if (!raw_spin_trylock_irqsave(&logbuf_lock, flags))
+		return;
+	printk_async_drain(UINT_MAX);
+	raw_spin_unlock_irqrestore(&logbuf_lock, flags);
+}
+
+static void __init printk_async_init(void)
+{
+	struct task_struct *task;
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		per_cpu(printk_async_ring, cpu) =
+			kzalloc_node(sizeof(struct printk_async_ring),
+				     GFP_KERNEL, cpu_to_node(cpu));
+
+	task = kthread_run(printk_kthread_func, NULL, "printk");
+	if (IS_ERR(task)) {
+		pr_err("printk: unable to start printing thread\n");
+		return;
+	}
+	/* the rings are published before the thread that enables them */
+	smp_store_release(&printk_kthread, task);
+}
+#else
+static inline bool printk_async_active(void) { return false; }
+static inline int printk_async_emit(int facility, int level,
+				    const char *dict, size_t dictlen,
+				    const char *fmt, va_list args)
+{
+	return -1;
+}
+static inline unsigned int printk_async_drain(unsigned int max) { return 0; }
+static inline void printk_async_flush(void) {}
+static inline void printk_async_init(void) {}
+#endif /* CONFIG_PRINTK_ASYNC */
+
 asmlinkage int vprintk_emit(int facility, int level,
 			    const char *dict, size_t dictlen,
 			    const char *fmt, va_list args)
@@ -1658,6 +2092,18 @@ asmlinkage int vprintk_emit(int facility, int level,
 	boot_delay_msec(level);
 	printk_delay();
 
+	if (printk_async_active()) {
+		va_list ap;
+
+		va_copy(ap, args);
+		printed_len = printk_async_emit(facility, level, dict, dictlen,
+						fmt, ap);
+		va_end(ap);
+		if (printed_len >= 0)
+			return printed_len;
+		printed_len = 0;
+	}
+
 	/* This stops the holder of console_sem just where we want him */
 	local_irq_save(flags);
 	this_cpu = smp_processor_id();
@@ -1685,6 +2131,9 @@ asmlinkage int vprintk_emit(int facility, int level,
 	raw_spin_lock(&logbuf_lock);
 	logbuf_cpu = this_cpu;
 
+	/* keep the log in order with messages printed asynchronously */
+	printk_async_drain(UINT_MAX);
+
 	if (unlikely(recursion_bug)) {
 		static const char recursion_msg[] =
 			"BUG: recent printk recursion!";
@@ -1701,85 +2150,15 @@ asmlinkage int vprintk_emit(int facility, int level,
 	 * prefix which might be passed-in as a parameter.
 	 */
 	text_len = vscnprintf(text, sizeof(textbuf), fmt, args);
-
-	/* mark and strip a trailing newline */
-	if (text_len && text[text_len-1] == '\n') {
-		text_len--;
-		lflags |= LOG_NEWLINE;
-	}
-
-	/* strip kernel syslog prefix and extract log level or control flags */
-	if (facility == 0) {
-		int kern_level = printk_get_level(text);
-
-		if (kern_level) {
-			const char *end_of_header = printk_skip_level(text);
-			switch (kern_level) {
-			case '0' ... '7':
-				if (level == -1)
-					level = kern_level - '0';
-			case 'd':	/* KERN_DEFAULT */
-				lflags |= LOG_PREFIX;
-			}
-			/*
-			 * No need to check length here because vscnprintf
-			 * put '\0' at the end of the string. Only valid and
-			 * newly printed level is detected.
-			 */
-			text_len -= end_of_header - text;
-			text = (char *)end_of_header;
-		}
-	}
+	text = printk_parse_text(facility, &level, dict, &lflags,
+				 text, &text_len);
 
 #ifdef CONFIG_EARLY_PRINTK_DIRECT
 	printascii(text);
 #endif
 
-	if (level == -1)
-		level = default_message_loglevel;
-
-	if (dict)
-		lflags |= LOG_PREFIX|LOG_NEWLINE;
-
-	if (!(lflags & LOG_NEWLINE)) {
-		/*
-		 * Flush the conflicting buffer. An earlier newline was missing,
-		 * or another task also prints continuation lines.
-		 */
-		if (cont.len && (lflags & LOG_PREFIX || cont.owner != current))
-			cont_flush(LOG_NEWLINE);
-
-		/* buffer line if possible, otherwise store it right away */
-		if (cont_add(facility, level, text, text_len))
-			printed_len += text_len;
-		else
-			printed_len += log_store(facility, level,
-						 lflags | LOG_CONT, 0,
-						 dict, dictlen, text, text_len);
-	} else {
-		bool stored = false;
-
-		/*
-		 * If an earlier newline was missing and it was the same task,
-		 * either merge it with the current buffer and flush, or if
-		 * there was a race with interrupts (prefix == true) then just
-		 * flush it out and store this line separately.
-		 * If the preceding printk was from a different task and missed
-		 * a newline, flush and append the newline.
-		 */
-		if (cont.len) {
-			if (cont.owner == current && !(lflags & LOG_PREFIX))
-				stored = cont_add(facility, level, text,
-						  text_len);
-			cont_flush(LOG_NEWLINE);
-		}
-
-		if (stored)
-			printed_len += text_len;
-		else
-			printed_len += log_store(facility, level, lflags, 0,
-						 dict, dictlen, text, text_len);
-	}
+	printed_len += printk_store(facility, level, lflags, 0, current,
+				    dict, dictlen, text, text_len);
 
 	logbuf_cpu = UINT_MAX;
 	raw_spin_unlock(&logbuf_lock);
@@ -1900,6 +2279,8 @@ static void call_console_drivers(int level, const char *text, size_t len) {}
 static size_t msg_print_text(const struct printk_log *msg, enum log_flags prev,
 			     bool syslog, char *buf, size_t size) { return 0; }
 static size_t cont_print_text(char *text, size_t size) { return 0; }
+static inline void printk_async_flush(void) {}
+static inline void printk_async_init(void) {}
 
 #endif /* CONFIG_PRINTK */
 
@@ -2378,6 +2759,7 @@ void console_flush_on_panic(void)
 	 * context and we don't want to get preempted while flushing,
 	 * ensure may_schedule is cleared.
 	 */
+	printk_async_flush();
 	console_trylock();
 	console_may_schedule = 0;
 	console_unlock();
@@ -2664,6 +3046,7 @@ static int __init printk_late_init(void)
 		}
 	}
 	hotcpu_notifier(console_cpu_notify, 0);
+	printk_async_init();
 	return 0;
 }
 late_initcall(printk_late_init);
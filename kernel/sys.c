@@ -2372,6 +2372,20 @@ SYSCALL_DEFINE5(prctl, int, option, unsigned long, arg2, unsigned long, arg3,
 	case PR_SET_VMA:
 		error = prctl_set_vma(arg2, arg3, arg4, arg5);
 		break;
+	case PR_GET_LAZY_FORK:
+		if (!IS_ENABLED(CONFIG_LAZY_FORK) || arg2 || arg3 || arg4 ||
+		    arg5)
+			return -EINVAL;
+		error = !!test_bit(MMF_LAZY_FORK, &me->mm->flags);
+		break;
+	case PR_SET_LAZY_FORK:
+		if (!IS_ENABLED(CONFIG_LAZY_FORK) || arg3 || arg4 || arg5)
+			return -EINVAL;
+		if (arg2)
+			set_bit(MMF_LAZY_FORK, &me->mm->flags);
+		else
+			clear_bit(MMF_LAZY_FORK, &me->mm->flags);
+		break;
 	default:
 		error = -EINVAL;
 		break;
@@ -27,6 +27,8 @@
 #include <linux/wait.h>
 #include <linux/delay.h>
 #include <linux/completion.h>
+#include <linux/percpu.h>
+#include <linux/cpumask.h>
 #include <linux/ipc_logging.h>
 
 #include "ipc_logging_private.h"
@@ -274,37 +276,32 @@ static void msg_drop(struct ipc_log_context *ilctxt)
 	if (!is_read_empty(ilctxt)) {
 		ipc_log_drop(ilctxt, &hdr, sizeof(hdr));
 		ipc_log_drop(ilctxt, NULL, (int)hdr.size);
+		ilctxt->overwritten++;
 	}
 }
 
 /*
- * Commits messages to the FIFO.  If the FIFO is full, then enough
+ * Commits a message to the FIFO.  If the FIFO is full, then enough
  * messages are dropped to create space for the new message.
+ *
+ * Called with context_lock_lhb1 held and interrupts disabled.
  */
-void ipc_log_write(void *ctxt, struct encode_context *ectxt)
+static void ipc_log_commit(struct ipc_log_context *ilctxt,
+			   char *buff, int len)
 {
-	struct ipc_log_context *ilctxt = (struct ipc_log_context *)ctxt;
 	int bytes_to_write;
-	unsigned long flags;
-
-	if (!ilctxt || !ectxt) {
-		pr_err("%s: Invalid ipc_log or encode context\n", __func__);
-		return;
-	}
 
-	read_lock_irqsave(&context_list_lock_lha1, flags);
-	spin_lock(&ilctxt->context_lock_lhb1);
-	while (ilctxt->write_avail <= ectxt->offset)
+	while (ilctxt->write_avail <= len)
 		msg_drop(ilctxt);
 
 	bytes_to_write = MIN(LOG_PAGE_DATA_SIZE
 				- ilctxt->write_page->hdr.write_offset,
-				ectxt->offset);
+				len);
 	memcpy((ilctxt->write_page->data +
 		ilctxt->write_page->hdr.write_offset),
-		ectxt->buff, bytes_to_write);
+		buff, bytes_to_write);
 
-	if (bytes_to_write != ectxt->offset) {
+	if (bytes_to_write != len) {
 		uint64_t t_now = sched_clock();
 
 		ilctxt->write_page->hdr.write_offset += bytes_to_write;
@@ -316,18 +313,188 @@ void ipc_log_write(void *ctxt, struct encode_context *ectxt)
 		ilctxt->write_page->hdr.start_time = t_now;
 		memcpy((ilctxt->write_page->data +
 			ilctxt->write_page->hdr.write_offset),
-		       (ectxt->buff + bytes_to_write),
-		       (ectxt->offset - bytes_to_write));
-		bytes_to_write = (ectxt->offset - bytes_to_write);
+		       (buff + bytes_to_write),
+		       (len - bytes_to_write));
+		bytes_to_write = (len - bytes_to_write);
 	}
 	ilctxt->write_page->hdr.write_offset += bytes_to_write;
-	ilctxt->write_avail -= ectxt->offset;
-	complete(&ilctxt->read_avail);
-	spin_unlock(&ilctxt->context_lock_lhb1);
-	read_unlock_irqrestore(&context_list_lock_lha1, flags);
+	ilctxt->write_avail -= len;
+}
+
+static void cpu_buf_copy_in(struct ipc_log_cpu_buf *cb, uint32_t pos,
+			    void *src, uint32_t len)
+{
+	uint32_t offset = pos & (IPC_LOG_CPU_BUF_SIZE - 1);
+	uint32_t bytes = MIN(IPC_LOG_CPU_BUF_SIZE - offset, len);
+
+	memcpy(cb->data + offset, src, bytes);
+	memcpy(cb->data, src + bytes, len - bytes);
+}
+
+static void cpu_buf_copy_out(struct ipc_log_cpu_buf *cb, uint32_t pos,
+			     void *dst, uint32_t len)
+{
+	uint32_t offset = pos & (IPC_LOG_CPU_BUF_SIZE - 1);
+	uint32_t bytes = MIN(IPC_LOG_CPU_BUF_SIZE - offset, len);
+
+	memcpy(dst, cb->data + offset, bytes);
+	memcpy(dst + bytes, cb->data, len - bytes);
+}
+
+static bool cpu_bufs_pending(struct ipc_log_context *ilctxt)
+{
+	struct ipc_log_cpu_buf *cb;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		cb = per_cpu_ptr(ilctxt->cpu_buf, cpu);
+		if (ACCESS_ONCE(cb->head) != cb->tail)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Moves the messages of the per-CPU write buffers into the log pages,
+ * oldest first.  Only what was buffered on entry is merged so that busy
+ * writers can't keep us here.
+ *
+ * Called with context_lock_lhb1 held and interrupts disabled.
+ */
+static void ipc_log_merge(struct ipc_log_context *ilctxt)
+{
+	struct ipc_log_cpu_buf *cb, *oldest;
+	struct ipc_log_cpu_rec rec, oldest_rec;
+	char buff[MAX_MSG_SIZE];
+	long budget = 0;
+	uint32_t head;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		cb = per_cpu_ptr(ilctxt->cpu_buf, cpu);
+		budget += ACCESS_ONCE(cb->head) - cb->tail;
+	}
+
+	while (budget > 0) {
+		oldest = NULL;
+		for_each_possible_cpu(cpu) {
+			cb = per_cpu_ptr(ilctxt->cpu_buf, cpu);
+			head = ACCESS_ONCE(cb->head);
+			if (head == cb->tail)
+				continue;
+			smp_rmb(); /* read head before the record */
+			cpu_buf_copy_out(cb, cb->tail, &rec, sizeof(rec));
+			if (!oldest || rec.time < oldest_rec.time) {
+				oldest = cb;
+				oldest_rec = rec;
+			}
+		}
+		if (!oldest)
+			break;
+
+		cpu_buf_copy_out(oldest, oldest->tail + sizeof(oldest_rec),
+				 buff, oldest_rec.size);
+		ipc_log_commit(ilctxt, buff, oldest_rec.size);
+
+		/* the record is read before the writer may reuse its space */
+		smp_mb();
+		ACCESS_ONCE(oldest->tail) = oldest->tail +
+			sizeof(oldest_rec) + oldest_rec.size;
+		budget -= sizeof(oldest_rec) + oldest_rec.size;
+	}
+}
+
+/*
+ * Wakes up a reader waiting on read_avail, once per read; the reader
+ * clears read_pending when it runs out of data.
+ */
+static void ipc_log_wake_reader(struct ipc_log_context *ilctxt)
+{
+	smp_mb(); /* message published before read_pending is checked */
+	if (!test_bit(0, &ilctxt->read_pending) &&
+	    !test_and_set_bit(0, &ilctxt->read_pending))
+		complete(&ilctxt->read_avail);
+}
+
+/*
+ * Commits messages to the FIFO.  Messages are buffered per CPU without
+ * taking any lock and merged into the log pages when the log is read, or
+ * when this CPU's buffer is half full and nobody else holds the log.  If
+ * the buffer is full and the log is busy, the message is dropped and
+ * accounted in the CPU's dropped counter.
+ */
+void ipc_log_write(void *ctxt, struct encode_context *ectxt)
+{
+	struct ipc_log_context *ilctxt = (struct ipc_log_context *)ctxt;
+	struct ipc_log_cpu_buf *cb;
+	struct ipc_log_cpu_rec rec;
+	uint32_t head, used, len;
+	unsigned long flags;
+
+	if (!ilctxt || !ectxt) {
+		pr_err("%s: Invalid ipc_log or encode context\n", __func__);
+		return;
+	}
+
+	len = sizeof(rec) + ectxt->offset;
+
+	local_irq_save(flags);
+	cb = this_cpu_ptr(ilctxt->cpu_buf);
+	head = cb->head;
+	used = head - ACCESS_ONCE(cb->tail);
+	if (used + len > IPC_LOG_CPU_BUF_SIZE) {
+		if (spin_trylock(&ilctxt->context_lock_lhb1)) {
+			ipc_log_merge(ilctxt);
+			spin_unlock(&ilctxt->context_lock_lhb1);
+			used = head - ACCESS_ONCE(cb->tail);
+		}
+		if (used + len > IPC_LOG_CPU_BUF_SIZE) {
+			cb->dropped++;
+			local_irq_restore(flags);
+			return;
+		}
+	}
+	/* the space is known to be free before it is overwritten */
+	smp_mb();
+
+	rec.time = sched_clock();
+	rec.size = ectxt->offset;
+	cpu_buf_copy_in(cb, head, &rec, sizeof(rec));
+	cpu_buf_copy_in(cb, head + sizeof(rec), ectxt->buff, ectxt->offset);
+	smp_wmb(); /* record written before it is published */
+	ACCESS_ONCE(cb->head) = head + len;
+
+	if (used + len >= IPC_LOG_CPU_BUF_SIZE / 2 &&
+	    spin_trylock(&ilctxt->context_lock_lhb1)) {
+		ipc_log_merge(ilctxt);
+		spin_unlock(&ilctxt->context_lock_lhb1);
+	}
+	local_irq_restore(flags);
+
+	ipc_log_wake_reader(ilctxt);
 }
 EXPORT_SYMBOL(ipc_log_write);
 
+/*
+ * Returns the number of messages lost by a logging context, either
+ * because a per-CPU write buffer was full or because they were
+ * overwritten in the log pages.
+ */
+void ipc_log_get_stats(struct ipc_log_context *ilctxt,
+		       unsigned long *dropped, uint64_t *overwritten)
+{
+	unsigned long flags;
+	int cpu;
+
+	*dropped = 0;
+	for_each_possible_cpu(cpu)
+		*dropped += per_cpu_ptr(ilctxt->cpu_buf, cpu)->dropped;
+
+	spin_lock_irqsave(&ilctxt->context_lock_lhb1, flags);
+	*overwritten = ilctxt->overwritten;
+	spin_unlock_irqrestore(&ilctxt->context_lock_lhb1, flags);
+}
+
 /*
  * Starts a new message after which you can add serialized data and
  * then complete the message by calling msg_encode_end().
@@ -547,6 +714,7 @@ int ipc_log_extract(void *ctxt, char *buff, int size)
 	dctxt.size = size;
 	read_lock_irqsave(&context_list_lock_lha1, flags);
 	spin_lock(&ilctxt->context_lock_lhb1);
+	ipc_log_merge(ilctxt);
 	while (dctxt.size >= MAX_MSG_DECODED_SIZE &&
 	       !is_nd_read_empty(ilctxt)) {
 		msg_read(ilctxt, &ectxt);
@@ -562,8 +730,14 @@ int ipc_log_extract(void *ctxt, char *buff, int size)
 		read_lock_irqsave(&context_list_lock_lha1, flags);
 		spin_lock(&ilctxt->context_lock_lhb1);
 	}
-	if ((size - dctxt.size) == 0)
+	if ((size - dctxt.size) == 0) {
 		reinit_completion(&ilctxt->read_avail);
+		clear_bit(0, &ilctxt->read_pending);
+		/* pairs with the barrier in ipc_log_wake_reader() */
+		smp_mb__after_atomic();
+		if (cpu_bufs_pending(ilctxt))
+			complete(&ilctxt->read_avail);
+	}
 	spin_unlock(&ilctxt->context_lock_lhb1);
 	read_unlock_irqrestore(&context_list_lock_lha1, flags);
 	return size - dctxt.size;
@@ -776,6 +950,13 @@ void *ipc_log_context_create(int max_num_pages,
 		return 0;
 	}
 
+	ctxt->cpu_buf = alloc_percpu(struct ipc_log_cpu_buf);
+	if (!ctxt->cpu_buf) {
+		pr_err("%s: cannot create ipc_log_cpu_buf\n", __func__);
+		kfree(ctxt);
+		return 0;
+	}
+
 	init_completion(&ctxt->read_avail);
 	INIT_LIST_HEAD(&ctxt->page_list);
 	INIT_LIST_HEAD(&ctxt->dfunc_info_list);
@@ -828,6 +1009,7 @@ release_ipc_log_context:
 		list_del(&pg->hdr.list);
 		kfree(pg);
 	}
+	free_percpu(ctxt->cpu_buf);
 	kfree(ctxt);
 	return 0;
 }
@@ -847,6 +1029,9 @@ int ipc_log_context_destroy(void *ctxt)
 	if (!ilctxt)
 		return 0;
 
+	/* writers run with interrupts disabled */
+	synchronize_sched();
+
 	while (!list_empty(&ilctxt->page_list)) {
 		pg = get_first_page(ctxt);
 		list_del(&pg->hdr.list);
@@ -859,6 +1044,7 @@ int ipc_log_context_destroy(void *ctxt)
 
 	debugfs_remove_recursive(ilctxt->dent);
 
+	free_percpu(ilctxt->cpu_buf);
 	kfree(ilctxt);
 	return 0;
 }
@@ -122,6 +122,28 @@ static const struct file_operations debug_ops_cont = {
 	.open = debug_open,
 };
 
+static ssize_t debug_read_stats(struct file *file, char __user *buff,
+				size_t count, loff_t *ppos)
+{
+	struct ipc_log_context *ilctxt = file->private_data;
+	unsigned long dropped;
+	uint64_t overwritten;
+	char buffer[64];
+	int bsize;
+
+	ipc_log_get_stats(ilctxt, &dropped, &overwritten);
+	bsize = scnprintf(buffer, sizeof(buffer),
+			  "dropped: %lu\noverwritten: %llu\n",
+			  dropped, overwritten);
+
+	return simple_read_from_buffer(buff, count, ppos, buffer, bsize);
+}
+
+static const struct file_operations debug_ops_stats = {
+	.read = debug_read_stats,
+	.open = debug_open,
+};
+
 static void debug_create(const char *name, mode_t mode,
 			 struct dentry *dent,
 			 struct ipc_log_context *ilctxt,
@@ -176,6 +198,8 @@ void create_ctx_debugfs(struct ipc_log_context *ctxt,
 				     ctxt, &debug_ops);
 			debug_create("log_cont", 0444, ctxt->dent,
 				     ctxt, &debug_ops_cont);
+			debug_create("stats", 0444, ctxt->dent,
+				     ctxt, &debug_ops_stats);
 		}
 	}
 	add_deserialization_func((void *)ctxt,
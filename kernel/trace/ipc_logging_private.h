@@ -17,6 +17,7 @@
 
 #define IPC_LOG_VERSION 0x0003
 #define IPC_LOG_MAX_CONTEXT_NAME_LEN 32
+#define IPC_LOG_CPU_BUF_SIZE 2048
 
 /**
  * struct ipc_log_page_header - Individual log page header
@@ -70,6 +71,37 @@ struct ipc_log_page {
 	char data[PAGE_SIZE - sizeof(struct ipc_log_page_header)];
 };
 
+/**
+ * struct ipc_log_cpu_rec - Header of a message in a per-CPU write buffer
+ *
+ * @time:  Scheduler clock when the message was written, used to merge the
+ *         buffers of all CPUs in order
+ * @size:  Size of the message following the header
+ */
+struct ipc_log_cpu_rec {
+	uint64_t time;
+	uint32_t size;
+};
+
+/**
+ * struct ipc_log_cpu_buf - Per-CPU write buffer of a logging context
+ *
+ * @head:  Bytes written, only updated by the owning CPU
+ * @tail:  Bytes merged into the log pages, updated under context_lock_lhb1
+ * @dropped:  Messages dropped because the buffer was full
+ * @data:  Messages, each preceded by a struct ipc_log_cpu_rec
+ *
+ * Writers only ever touch the buffer of their own CPU with interrupts
+ * disabled.  The buffers are merged into the log pages when read, or by a
+ * writer once its buffer is half full.
+ */
+struct ipc_log_cpu_buf {
+	uint32_t head;
+	uint32_t tail;
+	unsigned long dropped;
+	char data[IPC_LOG_CPU_BUF_SIZE];
+};
+
 /**
  * struct ipc_log_context - main logging context
  *
@@ -95,6 +127,9 @@ struct ipc_log_page {
  * @dfunc_info_list:  List of deserialization functions
  * @context_lock_lhb1:  Lock for entire structure
  * @read_avail:  Completed when new data is added to the log
+ * @cpu_buf:  Per-CPU write buffers (struct ipc_log_cpu_buf)
+ * @read_pending:  Bit 0 set once read_avail has been completed for new data
+ * @overwritten:  Messages dropped from the log pages to make room
  */
 struct ipc_log_context {
 	uint32_t magic;
@@ -119,6 +154,9 @@ struct ipc_log_context {
 	struct list_head dfunc_info_list;
 	spinlock_t context_lock_lhb1;
 	struct completion read_avail;
+	struct ipc_log_cpu_buf __percpu *cpu_buf;
+	unsigned long read_pending;
+	uint64_t overwritten;
 };
 
 struct dfunc_info {
@@ -147,6 +185,9 @@ enum {
 			((x) < TSV_TYPE_MSG_END))
 #define MAX_MSG_DECODED_SIZE (MAX_MSG_SIZE*4)
 
+void ipc_log_get_stats(struct ipc_log_context *ilctxt,
+		       unsigned long *dropped, uint64_t *overwritten);
+
 #if (defined(CONFIG_DEBUG_FS))
 void check_and_create_debugfs(void);
 
@@ -144,6 +144,26 @@ int trace_define_field(struct ftrace_event_call *call, const char *type,
 }
 EXPORT_SYMBOL_GPL(trace_define_field);
 
+/*
+ * Return the size of the fixed part of @call's record, up to the end of
+ * its last field.
+ */
+int trace_event_get_offsets(struct ftrace_event_call *call)
+{
+	struct ftrace_event_field *tail;
+	struct list_head *head;
+
+	head = trace_get_fields(call);
+	if (list_empty(head))
+		return sizeof(struct trace_entry);
+	/*
+	 * head->next is the field with the largest offset, since
+	 * trace_define_field() adds each field at the head
+	 */
+	tail = list_first_entry(head, struct ftrace_event_field, link);
+	return tail->offset + tail->size;
+}
+
 #define __common_field(type, item)					\
 	ret = __trace_define_field(&ftrace_common_fields, #type,	\
 				   "common_" #item,			\
@@ -1589,9 +1609,14 @@ event_create_dir(struct dentry *parent, struct ftrace_event_file *file)
 	 * Only event directories that can be enabled should have
 	 * triggers.
 	 */
-	if (!(call->flags & TRACE_EVENT_FL_IGNORE_ENABLE))
+	if (!(call->flags & TRACE_EVENT_FL_IGNORE_ENABLE)) {
 		trace_create_file("trigger", 0644, file->dir, file,
 				  &event_trigger_fops);
+#ifdef CONFIG_HIST_TRIGGERS
+		trace_create_file("hist", 0444, file->dir, file,
+				  &event_hist_fops);
+#endif
+	}
 
 	trace_create_file("format", 0444, file->dir, call,
 			  &ftrace_event_format_fops);
@@ -0,0 +1,1575 @@
+/*
+ * trace_events_hist - trace event hist triggers
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * A hist trigger aggregates event data into a tracing_map keyed on
+ * one or more event fields, and shows the result in the event's
+ * 'hist' file, so that e.g. latency distributions can be collected in
+ * the kernel without streaming every event to userspace.
+ *
+ * Besides event fields, keys and values can use variables.  A
+ * variable is saved per key when the event hits and can be read back
+ * from the trigger of another event as $name, which pairs the two
+ * events on the 'match' fields of the second one.  Reading a variable
+ * consumes it.  For instance the wakeup latency of each task:
+ *
+ *   echo 'hist:keys=pid:ts0=common_timestamp.usecs' > \
+ *	events/sched/sched_wakeup/trigger
+ *   echo 'hist:keys=lat.log2:lat=common_timestamp.usecs-$ts0:match=next_pid' > \
+ *	events/sched/sched_switch/trigger
+ *   cat events/sched/sched_switch/hist
+ */
+
+#include <linux/module.h>
+#include <linux/kallsyms.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/log2.h>
+
+#include "tracing_map.h"
+#include "trace.h"
+
+struct hist_field;
+struct hist_eval_ctx;
+
+typedef u64 (*hist_field_fn_t) (struct hist_field *field, void *event,
+				struct hist_eval_ctx *ctx);
+
+#define HIST_FIELD_OPERANDS_MAX	2
+#define HIST_FIELDS_MAX		TRACING_MAP_FIELDS_MAX
+#define HIST_KEY_SIZE_MAX	(MAX_FILTER_STR_VAL + sizeof(u64))
+
+enum hist_field_flags {
+	HIST_FIELD_FL_HITCOUNT		= 1 << 0,
+	HIST_FIELD_FL_KEY		= 1 << 1,
+	HIST_FIELD_FL_STRING		= 1 << 2,
+	HIST_FIELD_FL_HEX		= 1 << 3,
+	HIST_FIELD_FL_SYM		= 1 << 4,
+	HIST_FIELD_FL_LOG2		= 1 << 5,
+	HIST_FIELD_FL_TIMESTAMP		= 1 << 6,
+	HIST_FIELD_FL_USECS		= 1 << 7,
+	HIST_FIELD_FL_CPU		= 1 << 8,
+	HIST_FIELD_FL_VAR		= 1 << 9,
+	HIST_FIELD_FL_VAR_REF		= 1 << 10,
+	HIST_FIELD_FL_EXPR		= 1 << 11,
+};
+
+/*
+ * Values computed for a single hit: the timestamp, the variables of
+ * the other trigger referenced as $name, and this trigger's own
+ * variables.
+ */
+struct hist_eval_ctx {
+	u64				ts;
+	u64				ref_vals[TRACING_MAP_VARS_MAX];
+	u64				var_vals[TRACING_MAP_VARS_MAX];
+};
+
+struct hist_field {
+	struct ftrace_event_field	*field;
+	unsigned long			flags;
+	hist_field_fn_t			fn;
+	unsigned int			size;
+	unsigned int			offset;
+	unsigned int			var_idx;
+	char				*name;
+	char				op;
+	struct hist_field		*operands[HIST_FIELD_OPERANDS_MAX];
+};
+
+struct hist_trigger_attrs {
+	char				*keys_str;
+	char				*vals_str;
+	char				*sort_key_str;
+	char				*match_str;
+	char				*var_str[TRACING_MAP_VARS_MAX];
+	unsigned int			n_vars;
+	bool				pause;
+	bool				cont;
+	bool				clear;
+	unsigned int			map_bits;
+};
+
+/*
+ * @fields holds the values first, hitcount always being the first of
+ * them, followed by the keys.  @ref is held by the trigger itself and
+ * by each trigger referencing one of its variables.
+ */
+struct hist_trigger_data {
+	struct hist_field		*fields[HIST_FIELDS_MAX];
+	unsigned int			n_vals;
+	unsigned int			n_keys;
+	unsigned int			n_fields;
+	unsigned int			key_size;
+	struct hist_field		*vars[TRACING_MAP_VARS_MAX];
+	unsigned int			n_vars;
+	struct hist_field		*match[TRACING_MAP_KEYS_MAX];
+	unsigned int			n_match;
+	struct hist_trigger_data	*ref_hist;
+	unsigned int			ref_var_idx[TRACING_MAP_VARS_MAX];
+	unsigned int			n_refs;
+	struct tracing_map_sort_key	sort_key;
+	struct hist_trigger_attrs	*attrs;
+	struct tracing_map		*map;
+	struct ftrace_event_file	*event_file;
+	bool				needs_ts;
+	bool				paused;
+	int				ref;
+};
+
+static u64 hist_field_counter(struct hist_field *field, void *event,
+			      struct hist_eval_ctx *ctx)
+{
+	return 1;
+}
+
+static u64 hist_field_string(struct hist_field *hist_field, void *event,
+			     struct hist_eval_ctx *ctx)
+{
+	char *addr = (char *)(event + hist_field->field->offset);
+
+	return (u64)(unsigned long)addr;
+}
+
+static u64 hist_field_dynstring(struct hist_field *hist_field, void *event,
+				struct hist_eval_ctx *ctx)
+{
+	u32 str_item = *(u32 *)(event + hist_field->field->offset);
+	int str_loc = str_item & 0xffff;
+	char *addr = (char *)(event + str_loc);
+
+	return (u64)(unsigned long)addr;
+}
+
+static u64 hist_field_pstring(struct hist_field *hist_field, void *event,
+			      struct hist_eval_ctx *ctx)
+{
+	char **addr = (char **)(event + hist_field->field->offset);
+
+	return (u64)(unsigned long)*addr;
+}
+
+static u64 hist_field_timestamp(struct hist_field *hist_field, void *event,
+				struct hist_eval_ctx *ctx)
+{
+	if (hist_field->flags & HIST_FIELD_FL_USECS)
+		return div_u64(ctx->ts, NSEC_PER_USEC);
+
+	return ctx->ts;
+}
+
+static u64 hist_field_cpu(struct hist_field *hist_field, void *event,
+			  struct hist_eval_ctx *ctx)
+{
+	return raw_smp_processor_id();
+}
+
+static u64 hist_field_var(struct hist_field *hist_field, void *event,
+			  struct hist_eval_ctx *ctx)
+{
+	return ctx->var_vals[hist_field->var_idx];
+}
+
+static u64 hist_field_var_ref(struct hist_field *hist_field, void *event,
+			      struct hist_eval_ctx *ctx)
+{
+	return ctx->ref_vals[hist_field->var_idx];
+}
+
+static u64 hist_field_expr(struct hist_field *hist_field, void *event,
+			   struct hist_eval_ctx *ctx)
+{
+	struct hist_field *a = hist_field->operands[0];
+	struct hist_field *b = hist_field->operands[1];
+	u64 val_a = a->fn(a, event, ctx);
+	u64 val_b = b->fn(b, event, ctx);
+
+	if (hist_field->op == '-')
+		return val_a - val_b;
+
+	return val_a + val_b;
+}
+
+#define DEFINE_HIST_FIELD_FN(type)					\
+static u64 hist_field_##type(struct hist_field *hist_field,		\
+			     void *event, struct hist_eval_ctx *ctx)	\
+{									\
+	type *addr = (type *)(event + hist_field->field->offset);	\
+									\
+	return (u64)*addr;						\
+}
+
+DEFINE_HIST_FIELD_FN(s64);
+DEFINE_HIST_FIELD_FN(u64);
+DEFINE_HIST_FIELD_FN(s32);
+DEFINE_HIST_FIELD_FN(u32);
+DEFINE_HIST_FIELD_FN(s16);
+DEFINE_HIST_FIELD_FN(u16);
+DEFINE_HIST_FIELD_FN(s8);
+DEFINE_HIST_FIELD_FN(u8);
+
+static hist_field_fn_t select_value_fn(int field_size, int field_is_signed)
+{
+	hist_field_fn_t fn = NULL;
+
+	switch (field_size) {
+	case 8:
+		if (field_is_signed)
+			fn = hist_field_s64;
+		else
+			fn = hist_field_u64;
+		break;
+	case 4:
+		if (field_is_signed)
+			fn = hist_field_s32;
+		else
+			fn = hist_field_u32;
+		break;
+	case 2:
+		if (field_is_signed)
+			fn = hist_field_s16;
+		else
+			fn = hist_field_u16;
+		break;
+	case 1:
+		if (field_is_signed)
+			fn = hist_field_s8;
+		else
+			fn = hist_field_u8;
+		break;
+	}
+
+	return fn;
+}
+
+static u64 hist_field_value(struct hist_field *hist_field, void *event,
+			    struct hist_eval_ctx *ctx)
+{
+	u64 val = hist_field->fn(hist_field, event, ctx);
+
+	if (hist_field->flags & HIST_FIELD_FL_LOG2)
+		val = val ? ilog2(roundup_pow_of_two(val)) : 0;
+
+	return val;
+}
+
+static bool hist_field_is_signed(struct hist_field *hist_field)
+{
+	return hist_field->field && hist_field->field->is_signed;
+}
+
+static void destroy_hist_field(struct hist_field *hist_field)
+{
+	unsigned int i;
+
+	if (!hist_field)
+		return;
+
+	for (i = 0; i < HIST_FIELD_OPERANDS_MAX; i++)
+		destroy_hist_field(hist_field->operands[i]);
+
+	kfree(hist_field->name);
+	kfree(hist_field);
+}
+
+static struct hist_field *create_hist_field(struct ftrace_event_field *field,
+					    unsigned long flags,
+					    const char *name)
+{
+	struct hist_field *hist_field;
+
+	hist_field = kzalloc(sizeof(*hist_field), GFP_KERNEL);
+	if (!hist_field)
+		return NULL;
+
+	hist_field->name = kstrdup(name, GFP_KERNEL);
+	if (!hist_field->name)
+		goto free;
+
+	hist_field->size = sizeof(u64);
+
+	if (flags & HIST_FIELD_FL_HITCOUNT) {
+		hist_field->fn = hist_field_counter;
+		goto out;
+	}
+
+	if (flags & HIST_FIELD_FL_TIMESTAMP) {
+		hist_field->fn = hist_field_timestamp;
+		goto out;
+	}
+
+	if (flags & HIST_FIELD_FL_CPU) {
+		hist_field->fn = hist_field_cpu;
+		goto out;
+	}
+
+	if (flags & HIST_FIELD_FL_VAR) {
+		hist_field->fn = hist_field_var;
+		goto out;
+	}
+
+	if (flags & HIST_FIELD_FL_VAR_REF) {
+		hist_field->fn = hist_field_var_ref;
+		goto out;
+	}
+
+	if (flags & HIST_FIELD_FL_EXPR) {
+		hist_field->fn = hist_field_expr;
+		goto out;
+	}
+
+	if (WARN_ON_ONCE(!field))
+		goto free;
+
+	if (is_string_field(field)) {
+		flags |= HIST_FIELD_FL_STRING;
+
+		if (field->filter_type == FILTER_STATIC_STRING) {
+			hist_field->fn = hist_field_string;
+			hist_field->size = field->size;
+		} else if (field->filter_type == FILTER_DYN_STRING) {
+			hist_field->fn = hist_field_dynstring;
+			hist_field->size = MAX_FILTER_STR_VAL;
+		} else {
+			hist_field->fn = hist_field_pstring;
+			hist_field->size = MAX_FILTER_STR_VAL;
+		}
+		/* keep whatever follows the string in the key aligned */
+		hist_field->size = ALIGN(hist_field->size, sizeof(u64));
+	} else {
+		hist_field->fn = select_value_fn(field->size,
+						 field->is_signed);
+		if (!hist_field->fn)
+			goto free;
+	}
+ out:
+	hist_field->field = field;
+	hist_field->flags = flags;
+
+	return hist_field;
+ free:
+	destroy_hist_field(hist_field);
+	return NULL;
+}
+
+static struct hist_field *find_var(struct hist_trigger_data *hist_data,
+				   const char *name)
+{
+	unsigned int i;
+
+	for (i = 0; i < hist_data->n_vars; i++)
+		if (strcmp(hist_data->vars[i]->name, name) == 0)
+			return hist_data->vars[i];
+
+	return NULL;
+}
+
+/*
+ * Look for the trigger defining @var_name among the hist triggers of
+ * the same trace array.  Must be called with event_mutex held.
+ */
+static struct hist_trigger_data *
+find_var_hist(struct hist_trigger_data *hist_data, const char *var_name,
+	      unsigned int *var_idx)
+{
+	struct trace_array *tr = hist_data->event_file->tr;
+	struct hist_trigger_data *test;
+	struct event_trigger_data *data;
+	struct ftrace_event_file *file;
+	unsigned int i;
+
+	list_for_each_entry(file, &tr->events, list) {
+		list_for_each_entry(data, &file->triggers, list) {
+			if (data->cmd_ops->trigger_type != ETT_EVENT_HIST)
+				continue;
+			test = data->private_data;
+			for (i = 0; i < test->n_vars; i++) {
+				if (strcmp(test->vars[i]->name, var_name) == 0) {
+					*var_idx = i;
+					return test;
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static struct hist_field *create_var_ref(struct hist_trigger_data *hist_data,
+					 char *var_name)
+{
+	struct hist_trigger_data *ref_hist;
+	struct hist_field *hist_field;
+	unsigned int var_idx, i;
+
+	ref_hist = find_var_hist(hist_data, var_name + 1, &var_idx);
+	if (!ref_hist)
+		return ERR_PTR(-EINVAL);
+
+	/* all the variables read by a trigger are keyed the same way */
+	if (hist_data->ref_hist && hist_data->ref_hist != ref_hist)
+		return ERR_PTR(-EINVAL);
+	hist_data->ref_hist = ref_hist;
+
+	for (i = 0; i < hist_data->n_refs; i++)
+		if (hist_data->ref_var_idx[i] == var_idx)
+			break;
+
+	if (i == hist_data->n_refs) {
+		if (hist_data->n_refs == TRACING_MAP_VARS_MAX)
+			return ERR_PTR(-EINVAL);
+		hist_data->ref_var_idx[hist_data->n_refs++] = var_idx;
+	}
+
+	hist_field = create_hist_field(NULL, HIST_FIELD_FL_VAR_REF, var_name);
+	if (!hist_field)
+		return ERR_PTR(-ENOMEM);
+
+	hist_field->var_idx = i;
+
+	return hist_field;
+}
+
+/*
+ * Parse a single operand: an event field, common_timestamp,
+ * common_cpu, a variable of this trigger or a $variable of another
+ * one, optionally followed by a .modifier.
+ */
+static struct hist_field *parse_atom(struct hist_trigger_data *hist_data,
+				     char *str, unsigned long flags)
+{
+	struct ftrace_event_call *call = hist_data->event_file->event_call;
+	struct ftrace_event_field *field = NULL;
+	struct hist_field *hist_field, *var = NULL;
+	char *field_name, *modifier;
+
+	modifier = str;
+	field_name = strsep(&modifier, ".");
+
+	if (modifier) {
+		if (strcmp(modifier, "hex") == 0)
+			flags |= HIST_FIELD_FL_HEX;
+		else if (strcmp(modifier, "sym") == 0)
+			flags |= HIST_FIELD_FL_SYM;
+		else if (strcmp(modifier, "log2") == 0)
+			flags |= HIST_FIELD_FL_LOG2;
+		else if (strcmp(modifier, "usecs") == 0)
+			flags |= HIST_FIELD_FL_USECS;
+		else
+			return ERR_PTR(-EINVAL);
+	}
+
+	if (field_name[0] == '$') {
+		if (flags & (HIST_FIELD_FL_KEY | HIST_FIELD_FL_USECS))
+			return ERR_PTR(-EINVAL);
+		return create_var_ref(hist_data, field_name);
+	}
+
+	if (strcmp(field_name, "common_timestamp") == 0) {
+		flags |= HIST_FIELD_FL_TIMESTAMP;
+		hist_data->needs_ts = true;
+	} else if (flags & HIST_FIELD_FL_USECS) {
+		return ERR_PTR(-EINVAL);
+	} else if (strcmp(field_name, "common_cpu") == 0) {
+		flags |= HIST_FIELD_FL_CPU;
+	} else if ((var = find_var(hist_data, field_name))) {
+		flags |= HIST_FIELD_FL_VAR;
+	} else {
+		field = trace_find_event_field(call, field_name);
+		if (!field || field->filter_type == FILTER_TRACE_FN)
+			return ERR_PTR(-EINVAL);
+	}
+
+	hist_field = create_hist_field(field, flags, field_name);
+	if (!hist_field)
+		return ERR_PTR(-ENOMEM);
+
+	/* strings can only be used as they are */
+	if ((hist_field->flags & HIST_FIELD_FL_STRING) &&
+	    (flags & (HIST_FIELD_FL_HEX | HIST_FIELD_FL_SYM |
+		      HIST_FIELD_FL_LOG2))) {
+		destroy_hist_field(hist_field);
+		return ERR_PTR(-EINVAL);
+	}
+
+	if (flags & HIST_FIELD_FL_VAR)
+		hist_field->var_idx = var->var_idx;
+
+	return hist_field;
+}
+
+/*
+ * An expression is an operand, or two numeric operands combined with
+ * '+' or '-', e.g. common_timestamp.usecs-$ts0.
+ */
+static struct hist_field *parse_expr(struct hist_trigger_data *hist_data,
+				     char *str, unsigned long flags)
+{
+	struct hist_field *expr, *operand;
+	char *op_pos, op;
+	unsigned int i;
+
+	op_pos = strpbrk(str, "+-");
+	if (!op_pos)
+		return parse_atom(hist_data, str, flags);
+
+	op = *op_pos;
+	*op_pos++ = '\0';
+	if (strpbrk(op_pos, "+-"))
+		return ERR_PTR(-EINVAL);
+
+	expr = create_hist_field(NULL, flags | HIST_FIELD_FL_EXPR, "expr");
+	if (!expr)
+		return ERR_PTR(-ENOMEM);
+
+	expr->op = op;
+
+	for (i = 0; i < HIST_FIELD_OPERANDS_MAX; i++) {
+		operand = parse_atom(hist_data, i ? op_pos : str, 0);
+		if (IS_ERR(operand)) {
+			destroy_hist_field(expr);
+			return operand;
+		}
+		expr->operands[i] = operand;
+		if (operand->flags & HIST_FIELD_FL_STRING) {
+			destroy_hist_field(expr);
+			return ERR_PTR(-EINVAL);
+		}
+	}
+
+	return expr;
+}
+
+static int create_var_fields(struct hist_trigger_data *hist_data)
+{
+	struct ftrace_event_call *call = hist_data->event_file->event_call;
+	struct hist_trigger_attrs *attrs = hist_data->attrs;
+	struct hist_field *var;
+	char *var_name, *expr;
+	unsigned int i;
+	char *name;
+
+	for (i = 0; i < attrs->n_vars; i++) {
+		expr = attrs->var_str[i];
+		var_name = strsep(&expr, "=");
+		if (!expr || !*var_name || !*expr)
+			return -EINVAL;
+
+		if (find_var(hist_data, var_name) ||
+		    trace_find_event_field(call, var_name))
+			return -EINVAL;
+
+		/* the attribute string is kept for printing the trigger */
+		expr = kstrdup(expr, GFP_KERNEL);
+		name = kstrdup(var_name, GFP_KERNEL);
+		var_name[strlen(var_name)] = '=';
+		if (!expr || !name) {
+			kfree(expr);
+			kfree(name);
+			return -ENOMEM;
+		}
+
+		var = parse_expr(hist_data, expr, 0);
+		kfree(expr);
+		if (IS_ERR(var)) {
+			kfree(name);
+			return PTR_ERR(var);
+		}
+		if (var->flags & HIST_FIELD_FL_STRING) {
+			destroy_hist_field(var);
+			kfree(name);
+			return -EINVAL;
+		}
+
+		kfree(var->name);
+		var->name = name;
+		var->var_idx = i;
+		hist_data->vars[hist_data->n_vars++] = var;
+	}
+
+	return 0;
+}
+
+static int create_hitcount_val(struct hist_trigger_data *hist_data)
+{
+	hist_data->fields[0] = create_hist_field(NULL, HIST_FIELD_FL_HITCOUNT,
+						 "hitcount");
+	if (!hist_data->fields[0])
+		return -ENOMEM;
+
+	hist_data->n_vals++;
+
+	return 0;
+}
+
+static int create_val_fields(struct hist_trigger_data *hist_data)
+{
+	struct hist_field *hist_field;
+	char *fields_str, *field_str;
+	int ret;
+
+	ret = create_hitcount_val(hist_data);
+	if (ret || !hist_data->attrs->vals_str)
+		return ret;
+
+	fields_str = kstrdup(hist_data->attrs->vals_str, GFP_KERNEL);
+	if (!fields_str)
+		return -ENOMEM;
+
+	while ((field_str = strsep(&fields_str, ","))) {
+		if (strcmp(field_str, "hitcount") == 0)
+			continue;
+
+		ret = -EINVAL;
+		if (hist_data->n_vals == TRACING_MAP_VALS_MAX)
+			break;
+
+		hist_field = parse_atom(hist_data, field_str, 0);
+		if (IS_ERR(hist_field)) {
+			ret = PTR_ERR(hist_field);
+			break;
+		}
+		hist_data->fields[hist_data->n_vals++] = hist_field;
+
+		if (hist_field->flags & (HIST_FIELD_FL_STRING |
+					 HIST_FIELD_FL_LOG2))
+			break;
+		ret = 0;
+	}
+	kfree(fields_str);
+
+	return ret;
+}
+
+static int create_key_fields(struct hist_trigger_data *hist_data)
+{
+	struct hist_field *hist_field;
+	char *fields_str, *field_str;
+	unsigned int n = hist_data->n_vals;
+	int ret = 0;
+
+	fields_str = kstrdup(hist_data->attrs->keys_str, GFP_KERNEL);
+	if (!fields_str)
+		return -ENOMEM;
+
+	while ((field_str = strsep(&fields_str, ","))) {
+		ret = -EINVAL;
+		if (hist_data->n_keys == TRACING_MAP_KEYS_MAX)
+			break;
+
+		hist_field = parse_atom(hist_data, field_str,
+					HIST_FIELD_FL_KEY);
+		if (IS_ERR(hist_field)) {
+			ret = PTR_ERR(hist_field);
+			break;
+		}
+		hist_data->fields[n + hist_data->n_keys++] = hist_field;
+
+		hist_field->offset = hist_data->key_size;
+		hist_data->key_size += hist_field->size;
+		if (hist_data->key_size > HIST_KEY_SIZE_MAX)
+			break;
+		ret = 0;
+	}
+	kfree(fields_str);
+
+	hist_data->n_fields = n + hist_data->n_keys;
+
+	return ret;
+}
+
+/*
+ * The match fields are laid out like the keys of the trigger whose
+ * variables are referenced, so that looking them up in its map finds
+ * the element the variables were saved in.
+ */
+static int create_match_fields(struct hist_trigger_data *hist_data)
+{
+	struct hist_trigger_data *ref_hist = hist_data->ref_hist;
+	struct hist_field *hist_field, *key_field;
+	char *fields_str, *field_str, *match_str;
+	int ret = 0;
+
+	if (!ref_hist)
+		return hist_data->attrs->match_str ? -EINVAL : 0;
+
+	match_str = hist_data->attrs->match_str ?: hist_data->attrs->keys_str;
+	fields_str = kstrdup(match_str, GFP_KERNEL);
+	if (!fields_str)
+		return -ENOMEM;
+
+	while ((field_str = strsep(&fields_str, ","))) {
+		ret = -EINVAL;
+		if (hist_data->n_match == ref_hist->n_keys)
+			break;
+
+		hist_field = parse_atom(hist_data, field_str,
+					HIST_FIELD_FL_KEY);
+		if (IS_ERR(hist_field)) {
+			ret = PTR_ERR(hist_field);
+			break;
+		}
+		hist_data->match[hist_data->n_match] = hist_field;
+
+		key_field = ref_hist->fields[ref_hist->n_vals +
+					     hist_data->n_match++];
+		if (hist_field->flags & (HIST_FIELD_FL_VAR |
+					 HIST_FIELD_FL_TIMESTAMP))
+			break;
+		if (hist_field->size != key_field->size)
+			break;
+		hist_field->offset = key_field->offset;
+		ret = 0;
+	}
+	kfree(fields_str);
+
+	if (!ret && hist_data->n_match != ref_hist->n_keys)
+		ret = -EINVAL;
+
+	return ret;
+}
+
+static int create_sort_key(struct hist_trigger_data *hist_data)
+{
+	char *fields_str = hist_data->attrs->sort_key_str;
+	char *field_str, *field_name;
+	unsigned int i;
+	int ret = 0;
+
+	hist_data->sort_key.field_idx = 0; /* hitcount */
+
+	if (!fields_str)
+		return 0;
+
+	fields_str = kstrdup(fields_str, GFP_KERNEL);
+	if (!fields_str)
+		return -ENOMEM;
+
+	field_str = fields_str;
+	field_name = strsep(&field_str, ".");
+
+	if (field_str) {
+		if (strcmp(field_str, "descending") == 0)
+			hist_data->sort_key.descending = true;
+		else if (strcmp(field_str, "ascending") != 0)
+			ret = -EINVAL;
+	}
+
+	if (!ret) {
+		for (i = 0; i < hist_data->n_fields; i++)
+			if (strcmp(field_name, hist_data->fields[i]->name) == 0)
+				break;
+
+		if (i == hist_data->n_fields)
+			ret = -EINVAL;
+		else
+			hist_data->sort_key.field_idx = i;
+	}
+	kfree(fields_str);
+
+	return ret;
+}
+
+static int create_tracing_map_fields(struct hist_trigger_data *hist_data)
+{
+	struct tracing_map *map = hist_data->map;
+	struct hist_field *hist_field;
+	tracing_map_cmp_fn_t cmp_fn;
+	unsigned int i;
+	int idx;
+
+	for (i = 0; i < hist_data->n_fields; i++) {
+		hist_field = hist_data->fields[i];
+
+		if (hist_field->flags & HIST_FIELD_FL_KEY) {
+			if (hist_field->flags & HIST_FIELD_FL_STRING)
+				cmp_fn = tracing_map_cmp_string;
+			else
+				cmp_fn = tracing_map_cmp_num(sizeof(u64),
+					hist_field_is_signed(hist_field));
+			idx = tracing_map_add_key_field(map,
+							hist_field->offset,
+							cmp_fn);
+		} else {
+			idx = tracing_map_add_sum_field(map);
+		}
+
+		if (idx < 0)
+			return idx;
+	}
+
+	for (i = 0; i < hist_data->n_vars; i++) {
+		idx = tracing_map_add_var(map);
+		if (idx < 0)
+			return idx;
+	}
+
+	return 0;
+}
+
+static void destroy_hist_trigger_attrs(struct hist_trigger_attrs *attrs)
+{
+	unsigned int i;
+
+	if (!attrs)
+		return;
+
+	for (i = 0; i < attrs->n_vars; i++)
+		kfree(attrs->var_str[i]);
+	kfree(attrs->match_str);
+	kfree(attrs->sort_key_str);
+	kfree(attrs->keys_str);
+	kfree(attrs->vals_str);
+	kfree(attrs);
+}
+
+static void put_hist_data(struct hist_trigger_data *hist_data);
+
+static void destroy_hist_data(struct hist_trigger_data *hist_data)
+{
+	unsigned int i;
+
+	for (i = 0; i < hist_data->n_fields; i++)
+		destroy_hist_field(hist_data->fields[i]);
+	for (i = 0; i < hist_data->n_vars; i++)
+		destroy_hist_field(hist_data->vars[i]);
+	for (i = 0; i < hist_data->n_match; i++)
+		destroy_hist_field(hist_data->match[i]);
+
+	if (hist_data->ref_hist)
+		put_hist_data(hist_data->ref_hist);
+
+	tracing_map_destroy(hist_data->map);
+	destroy_hist_trigger_attrs(hist_data->attrs);
+	kfree(hist_data);
+}
+
+/*
+ * Drop a reference on @hist_data.  The map of a trigger whose
+ * variables are read by other triggers must outlive them, even when
+ * all the triggers of a trace array are cleared at once.  Called with
+ * event_mutex held.
+ */
+static void put_hist_data(struct hist_trigger_data *hist_data)
+{
+	if (WARN_ON_ONCE(hist_data->ref <= 0))
+		return;
+
+	if (!--hist_data->ref)
+		destroy_hist_data(hist_data);
+}
+
+static struct hist_trigger_data *
+create_hist_data(unsigned int map_bits,
+		 struct hist_trigger_attrs *attrs,
+		 struct ftrace_event_file *file)
+{
+	struct hist_trigger_data *hist_data;
+	int ret = 0;
+
+	hist_data = kzalloc(sizeof(*hist_data), GFP_KERNEL);
+	if (!hist_data)
+		return ERR_PTR(-ENOMEM);
+
+	hist_data->attrs = attrs;
+	hist_data->event_file = file;
+	hist_data->ref = 1;
+
+	ret = create_var_fields(hist_data);
+	if (ret)
+		goto free;
+
+	ret = create_val_fields(hist_data);
+	if (ret)
+		goto free;
+
+	ret = create_key_fields(hist_data);
+	if (ret)
+		goto free;
+
+	ret = create_match_fields(hist_data);
+	if (ret)
+		goto free;
+
+	ret = create_sort_key(hist_data);
+	if (ret)
+		goto free;
+
+	hist_data->map = tracing_map_create(map_bits, hist_data->key_size,
+					    hist_data);
+	if (IS_ERR(hist_data->map)) {
+		ret = PTR_ERR(hist_data->map);
+		hist_data->map = NULL;
+		goto free;
+	}
+
+	ret = create_tracing_map_fields(hist_data);
+	if (ret)
+		goto free;
+
+	ret = tracing_map_init(hist_data->map);
+	if (ret)
+		goto free;
+
+	if (hist_data->ref_hist)
+		hist_data->ref_hist->ref++;
+
+	return hist_data;
+ free:
+	/* no reference has been taken on the referenced trigger yet */
+	hist_data->ref_hist = NULL;
+	hist_data->attrs = NULL;
+	destroy_hist_data(hist_data);
+
+	return ERR_PTR(ret);
+}
+
+static int parse_map_size(char *str)
+{
+	unsigned long size, map_bits;
+	int ret;
+
+	ret = kstrtoul(str, 0, &size);
+	if (ret)
+		return ret;
+
+	if (!size)
+		return -EINVAL;
+
+	map_bits = ilog2(roundup_pow_of_two(size));
+	if (map_bits < TRACING_MAP_BITS_MIN ||
+	    map_bits > TRACING_MAP_BITS_MAX)
+		return -EINVAL;
+
+	return map_bits;
+}
+
+static int parse_assignment(char *str, struct hist_trigger_attrs *attrs)
+{
+	char **dest = NULL;
+	char *val = strchr(str, '=') + 1;
+	int ret;
+
+	if (strncmp(str, "key=", 4) == 0 || strncmp(str, "keys=", 5) == 0)
+		dest = &attrs->keys_str;
+	else if (strncmp(str, "val=", 4) == 0 ||
+		 strncmp(str, "vals=", 5) == 0 ||
+		 strncmp(str, "values=", 7) == 0)
+		dest = &attrs->vals_str;
+	else if (strncmp(str, "sort=", 5) == 0)
+		dest = &attrs->sort_key_str;
+	else if (strncmp(str, "match=", 6) == 0)
+		dest = &attrs->match_str;
+	else if (strncmp(str, "size=", 5) == 0) {
+		ret = parse_map_size(val);
+		if (ret < 0)
+			return ret;
+		attrs->map_bits = ret;
+		return 0;
+	} else {
+		/* anything else assigns a variable */
+		if (attrs->n_vars == TRACING_MAP_VARS_MAX)
+			return -EINVAL;
+		dest = &attrs->var_str[attrs->n_vars++];
+		val = str;
+	}
+
+	if (*dest || !*val)
+		return -EINVAL;
+
+	*dest = kstrdup(val, GFP_KERNEL);
+	if (!*dest)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static struct hist_trigger_attrs *parse_hist_trigger_attrs(char *trigger_str)
+{
+	struct hist_trigger_attrs *attrs;
+	int ret = 0;
+
+	attrs = kzalloc(sizeof(*attrs), GFP_KERNEL);
+	if (!attrs)
+		return ERR_PTR(-ENOMEM);
+
+	while (trigger_str) {
+		char *str = strsep(&trigger_str, ":");
+
+		if (strchr(str, '=')) {
+			ret = parse_assignment(str, attrs);
+			if (ret)
+				goto free;
+		} else if (strcmp(str, "pause") == 0)
+			attrs->pause = true;
+		else if ((strcmp(str, "cont") == 0) ||
+			 (strcmp(str, "continue") == 0))
+			attrs->cont = true;
+		else if (strcmp(str, "clear") == 0)
+			attrs->clear = true;
+		else {
+			ret = -EINVAL;
+			goto free;
+		}
+	}
+
+	if (!attrs->keys_str) {
+		ret = -EINVAL;
+		goto free;
+	}
+
+	return attrs;
+ free:
+	destroy_hist_trigger_attrs(attrs);
+
+	return ERR_PTR(ret);
+}
+
+static void hist_build_key(struct hist_field **key_fields, unsigned int n,
+			   void *rec, struct hist_eval_ctx *ctx,
+			   char *compound_key)
+{
+	struct hist_field *key_field;
+	unsigned int i;
+	u64 val;
+
+	for (i = 0; i < n; i++) {
+		key_field = key_fields[i];
+
+		val = hist_field_value(key_field, rec, ctx);
+		if (key_field->flags & HIST_FIELD_FL_STRING)
+			strncpy(compound_key + key_field->offset,
+				(char *)(unsigned long)val,
+				key_field->size - 1);
+		else
+			memcpy(compound_key + key_field->offset, &val,
+			       sizeof(val));
+	}
+}
+
+/*
+ * Fetch the variables of the referenced trigger saved under the match
+ * key.  Nothing is consumed unless all of them are set.
+ */
+static bool hist_read_refs(struct hist_trigger_data *hist_data, void *rec,
+			   struct hist_eval_ctx *ctx, char *key)
+{
+	struct hist_trigger_data *ref_hist = hist_data->ref_hist;
+	struct tracing_map_elt *elt;
+	unsigned int i;
+
+	memset(key, 0, ref_hist->key_size);
+	hist_build_key(hist_data->match, hist_data->n_match, rec, ctx, key);
+
+	elt = tracing_map_lookup(ref_hist->map, key);
+	if (!elt)
+		return false;
+
+	for (i = 0; i < hist_data->n_refs; i++)
+		if (!tracing_map_var_set(elt, hist_data->ref_var_idx[i]))
+			return false;
+
+	for (i = 0; i < hist_data->n_refs; i++)
+		ctx->ref_vals[i] =
+			tracing_map_read_var_once(elt, hist_data->ref_var_idx[i]);
+
+	return true;
+}
+
+static void event_hist_trigger(struct event_trigger_data *data, void *rec)
+{
+	struct hist_trigger_data *hist_data = data->private_data;
+	char compound_key[HIST_KEY_SIZE_MAX];
+	struct tracing_map_elt *elt;
+	struct hist_eval_ctx ctx;
+	unsigned int i;
+
+	if (!rec || ACCESS_ONCE(hist_data->paused))
+		return;
+
+	ctx.ts = hist_data->needs_ts ? trace_clock_local() : 0;
+
+	if (hist_data->ref_hist &&
+	    !hist_read_refs(hist_data, rec, &ctx, compound_key))
+		return;
+
+	for (i = 0; i < hist_data->n_vars; i++)
+		ctx.var_vals[i] = hist_field_value(hist_data->vars[i], rec, &ctx);
+
+	memset(compound_key, 0, hist_data->key_size);
+	hist_build_key(&hist_data->fields[hist_data->n_vals],
+		       hist_data->n_keys, rec, &ctx, compound_key);
+
+	elt = tracing_map_insert(hist_data->map, compound_key);
+	if (!elt)
+		return;
+
+	tracing_map_update_sum(elt, 0, 1);
+	for (i = 1; i < hist_data->n_vals; i++)
+		tracing_map_update_sum(elt, i,
+			hist_field_value(hist_data->fields[i], rec, &ctx));
+
+	for (i = 0; i < hist_data->n_vars; i++)
+		tracing_map_set_var(elt, i, ctx.var_vals[i]);
+}
+
+static void hist_field_print(struct seq_file *m, struct hist_field *hist_field)
+{
+	seq_puts(m, hist_field->name);
+
+	if (hist_field->flags & HIST_FIELD_FL_HEX)
+		seq_puts(m, ".hex");
+	else if (hist_field->flags & HIST_FIELD_FL_SYM)
+		seq_puts(m, ".sym");
+	else if (hist_field->flags & HIST_FIELD_FL_LOG2)
+		seq_puts(m, ".log2");
+	else if (hist_field->flags & HIST_FIELD_FL_USECS)
+		seq_puts(m, ".usecs");
+}
+
+static int event_hist_trigger_print(struct seq_file *m,
+				    struct event_trigger_ops *ops,
+				    struct event_trigger_data *data)
+{
+	struct hist_trigger_data *hist_data = data->private_data;
+	struct hist_trigger_attrs *attrs = hist_data->attrs;
+	struct hist_field *sort_field;
+	unsigned int i;
+
+	seq_puts(m, "hist:keys=");
+	for (i = hist_data->n_vals; i < hist_data->n_fields; i++) {
+		if (i > hist_data->n_vals)
+			seq_puts(m, ",");
+		hist_field_print(m, hist_data->fields[i]);
+	}
+
+	seq_puts(m, ":vals=");
+	for (i = 0; i < hist_data->n_vals; i++) {
+		if (i > 0)
+			seq_puts(m, ",");
+		hist_field_print(m, hist_data->fields[i]);
+	}
+
+	for (i = 0; i < attrs->n_vars; i++)
+		seq_printf(m, ":%s", attrs->var_str[i]);
+
+	if (attrs->match_str)
+		seq_printf(m, ":match=%s", attrs->match_str);
+
+	sort_field = hist_data->fields[hist_data->sort_key.field_idx];
+	seq_printf(m, ":sort=%s", sort_field->name);
+	if (hist_data->sort_key.descending)
+		seq_puts(m, ".descending");
+
+	seq_printf(m, ":size=%u", (1 << hist_data->map->map_bits));
+
+	if (data->filter_str)
+		seq_printf(m, " if %s", data->filter_str);
+
+	if (hist_data->paused)
+		seq_puts(m, " [paused]");
+	else
+		seq_puts(m, " [active]");
+
+	seq_putc(m, '\n');
+
+	return 0;
+}
+
+static void hist_trigger_print_key(struct seq_file *m,
+				   struct hist_trigger_data *hist_data,
+				   void *key)
+{
+	char str[KSYM_SYMBOL_LEN];
+	struct hist_field *key_field;
+	unsigned int i;
+	u64 uval;
+
+	seq_puts(m, "{ ");
+
+	for (i = hist_data->n_vals; i < hist_data->n_fields; i++) {
+		key_field = hist_data->fields[i];
+
+		if (i > hist_data->n_vals)
+			seq_puts(m, ", ");
+
+		if (key_field->flags & HIST_FIELD_FL_STRING) {
+			seq_printf(m, "%s: %-50s", key_field->name,
+				   (char *)(key + key_field->offset));
+			continue;
+		}
+
+		uval = *(u64 *)(key + key_field->offset);
+		if (key_field->flags & HIST_FIELD_FL_HEX) {
+			seq_printf(m, "%s: %llx", key_field->name, uval);
+		} else if (key_field->flags & HIST_FIELD_FL_SYM) {
+			sprint_symbol_no_offset(str, uval);
+			seq_printf(m, "%s: [%llx] %-45s",
+				   key_field->name, uval, str);
+		} else if (key_field->flags & HIST_FIELD_FL_LOG2) {
+			seq_printf(m, "%s: ~ 2^%-2llu", key_field->name, uval);
+		} else if (hist_field_is_signed(key_field)) {
+			seq_printf(m, "%s: %10lld", key_field->name, uval);
+		} else {
+			seq_printf(m, "%s: %10llu", key_field->name, uval);
+		}
+	}
+
+	seq_puts(m, " }");
+}
+
+static void hist_trigger_entry_print(struct seq_file *m,
+				     struct hist_trigger_data *hist_data,
+				     void *key, struct tracing_map_elt *elt)
+{
+	struct hist_field *val_field;
+	unsigned int i;
+
+	hist_trigger_print_key(m, hist_data, key);
+
+	seq_printf(m, " hitcount: %10llu", tracing_map_read_sum(elt, 0));
+
+	for (i = 1; i < hist_data->n_vals; i++) {
+		val_field = hist_data->fields[i];
+		if (val_field->flags & HIST_FIELD_FL_HEX)
+			seq_printf(m, "  %s: %10llx", val_field->name,
+				   tracing_map_read_sum(elt, i));
+		else
+			seq_printf(m, "  %s: %10llu", val_field->name,
+				   tracing_map_read_sum(elt, i));
+	}
+
+	seq_puts(m, "\n");
+}
+
+static int print_entries(struct seq_file *m,
+			 struct hist_trigger_data *hist_data)
+{
+	struct tracing_map_sort_entry *sort_entries = NULL;
+	int i, n_entries;
+
+	n_entries = tracing_map_sort_entries(hist_data->map,
+					     &hist_data->sort_key,
+					     &sort_entries);
+	if (n_entries < 0)
+		return n_entries;
+
+	for (i = 0; i < n_entries; i++)
+		hist_trigger_entry_print(m, hist_data, sort_entries[i].key,
+					 sort_entries[i].elt);
+
+	tracing_map_destroy_sort_entries(sort_entries);
+
+	return n_entries;
+}
+
+static void hist_trigger_show(struct seq_file *m,
+			      struct event_trigger_data *data)
+{
+	struct hist_trigger_data *hist_data = data->private_data;
+	int n_entries;
+
+	seq_puts(m, "# event histogram\n#\n# trigger info: ");
+	data->ops->print(m, data->ops, data);
+	seq_puts(m, "#\n\n");
+
+	n_entries = print_entries(m, hist_data);
+	if (n_entries < 0)
+		n_entries = 0;
+
+	seq_printf(m, "\nTotals:\n    Hits: %llu\n    Entries: %d\n    Dropped: %llu\n",
+		   (u64)atomic64_read(&hist_data->map->hits),
+		   n_entries, (u64)atomic64_read(&hist_data->map->drops));
+}
+
+static int hist_show(struct seq_file *m, void *v)
+{
+	struct event_trigger_data *data;
+	struct ftrace_event_file *event_file;
+	int ret = 0;
+
+	mutex_lock(&event_mutex);
+
+	event_file = event_file_data(m->private);
+	if (unlikely(!event_file)) {
+		ret = -ENODEV;
+		goto out_unlock;
+	}
+
+	list_for_each_entry_rcu(data, &event_file->triggers, list) {
+		if (data->cmd_ops->trigger_type == ETT_EVENT_HIST)
+			hist_trigger_show(m, data);
+	}
+
+ out_unlock:
+	mutex_unlock(&event_mutex);
+
+	return ret;
+}
+
+static int event_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, hist_show, file);
+}
+
+const struct file_operations event_hist_fops = {
+	.open = event_hist_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static void event_hist_trigger_free(struct event_trigger_ops *ops,
+				    struct event_trigger_data *data)
+{
+	struct hist_trigger_data *hist_data = data->private_data;
+
+	if (WARN_ON_ONCE(data->ref <= 0))
+		return;
+
+	data->ref--;
+	if (!data->ref) {
+		/* waits for the running trigger functions */
+		trigger_data_free(data);
+		put_hist_data(hist_data);
+	}
+}
+
+static struct event_trigger_ops event_hist_trigger_ops = {
+	.func			= event_hist_trigger,
+	.print			= event_hist_trigger_print,
+	.init			= event_trigger_init,
+	.free			= event_hist_trigger_free,
+};
+
+static struct event_trigger_ops *event_hist_get_trigger_ops(char *cmd,
+							    char *param)
+{
+	return &event_hist_trigger_ops;
+}
+
+static void hist_clear(struct event_trigger_data *data)
+{
+	struct hist_trigger_data *hist_data = data->private_data;
+	bool paused;
+
+	paused = hist_data->paused;
+	hist_data->paused = true;
+
+	synchronize_sched(); /* make sure the trigger isn't updating the map */
+
+	tracing_map_clear(hist_data->map);
+
+	hist_data->paused = paused;
+}
+
+static struct event_trigger_data *
+find_hist_trigger(struct ftrace_event_file *file)
+{
+	struct event_trigger_data *data;
+
+	list_for_each_entry_rcu(data, &file->triggers, list) {
+		if (data->cmd_ops->trigger_type == ETT_EVENT_HIST)
+			return data;
+	}
+
+	return NULL;
+}
+
+/*
+ * An event has at most one hist trigger.  Writing pause, cont or
+ * clear with a hist command applies to the existing one.
+ */
+static int hist_register_trigger(char *glob, struct event_trigger_ops *ops,
+				 struct event_trigger_data *data,
+				 struct ftrace_event_file *file)
+{
+	struct hist_trigger_data *hist_data = data->private_data;
+	struct event_trigger_data *test;
+	struct hist_trigger_data *test_hist;
+	int ret = 0;
+
+	test = find_hist_trigger(file);
+	if (test) {
+		test_hist = test->private_data;
+		if (hist_data->attrs->pause)
+			test_hist->paused = true;
+		else if (hist_data->attrs->cont)
+			test_hist->paused = false;
+		else if (hist_data->attrs->clear)
+			hist_clear(test);
+		else
+			ret = -EEXIST;
+		goto out;
+	}
+
+	if (hist_data->attrs->cont || hist_data->attrs->clear) {
+		ret = -ENOENT;
+		goto out;
+	}
+
+	if (hist_data->attrs->pause)
+		hist_data->paused = true;
+
+	if (data->ops->init) {
+		ret = data->ops->init(data->ops, data);
+		if (ret < 0)
+			goto out;
+	}
+
+	list_add_rcu(&data->list, &file->triggers);
+	ret++;
+
+	update_cond_flag(file);
+
+	if (trace_event_trigger_enable_disable(file, 1) < 0) {
+		list_del_rcu(&data->list);
+		update_cond_flag(file);
+		ret--;
+	}
+ out:
+	return ret;
+}
+
+static void hist_unregister_trigger(char *glob, struct event_trigger_ops *ops,
+				    struct event_trigger_data *test,
+				    struct ftrace_event_file *file)
+{
+	struct event_trigger_data *data;
+
+	data = find_hist_trigger(file);
+	if (!data)
+		return;
+
+	list_del_rcu(&data->list);
+	update_cond_flag(file);
+	trace_event_trigger_enable_disable(file, 0);
+
+	if (data->ops->free)
+		data->ops->free(data->ops, data);
+}
+
+static int event_hist_trigger_func(struct event_command *cmd_ops,
+				   struct ftrace_event_file *file,
+				   char *glob, char *cmd, char *param)
+{
+	unsigned int hist_trigger_bits = TRACING_MAP_BITS_DEFAULT;
+	struct event_trigger_data *trigger_data;
+	struct hist_trigger_attrs *attrs;
+	struct event_trigger_ops *trigger_ops;
+	struct hist_trigger_data *hist_data;
+	char *trigger;
+	bool modify;
+	int ret = 0;
+
+	if (glob[0] == '!') {
+		trigger_data = find_hist_trigger(file);
+		if (!trigger_data)
+			return -ENOENT;
+
+		/* other triggers still read its variables */
+		hist_data = trigger_data->private_data;
+		if (hist_data->ref > 1)
+			return -EBUSY;
+
+		cmd_ops->unreg(glob + 1, trigger_data->ops, trigger_data, file);
+		return 0;
+	}
+
+	if (!param)
+		return -EINVAL;
+
+	/* separate the trigger from the filter (k:v [if filter]) */
+	trigger = strsep(&param, " \t");
+	if (!trigger)
+		return -EINVAL;
+
+	attrs = parse_hist_trigger_attrs(trigger);
+	if (IS_ERR(attrs))
+		return PTR_ERR(attrs);
+
+	if (attrs->map_bits)
+		hist_trigger_bits = attrs->map_bits;
+
+	modify = attrs->pause || attrs->cont || attrs->clear;
+
+	hist_data = create_hist_data(hist_trigger_bits, attrs, file);
+	if (IS_ERR(hist_data)) {
+		destroy_hist_trigger_attrs(attrs);
+		return PTR_ERR(hist_data);
+	}
+
+	trigger_ops = cmd_ops->get_trigger_ops(cmd, trigger);
+
+	ret = -ENOMEM;
+	trigger_data = kzalloc(sizeof(*trigger_data), GFP_KERNEL);
+	if (!trigger_data)
+		goto out_put;
+
+	trigger_data->count = -1;
+	trigger_data->ops = trigger_ops;
+	trigger_data->cmd_ops = cmd_ops;
+	INIT_LIST_HEAD(&trigger_data->list);
+	RCU_INIT_POINTER(trigger_data->filter, NULL);
+	trigger_data->private_data = hist_data;
+
+	if (param) { /* if param is non-empty, it's supposed to be a filter */
+		ret = cmd_ops->set_filter(param, trigger_data, file);
+		if (ret < 0)
+			goto out_free;
+	}
+
+	ret = cmd_ops->reg(glob, trigger_ops, trigger_data, file);
+	/*
+	 * The above returns on success the # of triggers registered,
+	 * but if it didn't register any it returns zero, which is
+	 * expected only when modifying an existing trigger.
+	 */
+	if (!ret) {
+		if (!modify)
+			ret = -ENOENT;
+		goto out_free;
+	} else if (ret < 0)
+		goto out_free;
+
+	/* Just return zero, not the number of registered triggers */
+	ret = 0;
+ out:
+	return ret;
+ out_free:
+	cmd_ops->set_filter(NULL, trigger_data, NULL);
+	kfree(trigger_data);
+ out_put:
+	put_hist_data(hist_data);
+	goto out;
+}
+
+static struct event_command trigger_hist_cmd = {
+	.name			= "hist",
+	.trigger_type		= ETT_EVENT_HIST,
+	.needs_rec		= true,
+	.func			= event_hist_trigger_func,
+	.reg			= hist_register_trigger,
+	.unreg			= hist_unregister_trigger,
+	.get_trigger_ops	= event_hist_get_trigger_ops,
+	.set_filter		= set_trigger_filter,
+};
+
+__init int register_trigger_hist_cmd(void)
+{
+	int ret;
+
+	ret = register_event_command(&trigger_hist_cmd);
+	WARN_ON(ret < 0);
+
+	return ret;
+}
@@ -0,0 +1,643 @@
+/*
+ * tracing_map - lock-free map for tracing
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * The map is meant to be updated from the event trigger hot path:
+ * inserting a key and bumping its sums takes no locks and performs no
+ * allocation.  Everything is set up front by tracing_map_init().
+ */
+
+#include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/jhash.h>
+#include <linux/sort.h>
+
+#include "tracing_map.h"
+#include "trace.h"
+
+/**
+ * tracing_map_update_sum - Add a value to a tracing_map_elt's sum field
+ * @elt: The tracing_map_elt
+ * @i: The index of the given sum associated with the tracing_map_elt
+ * @n: The value to add to the sum
+ */
+void tracing_map_update_sum(struct tracing_map_elt *elt, unsigned int i, u64 n)
+{
+	atomic64_add(n, &elt->fields[i].sum);
+}
+
+/**
+ * tracing_map_read_sum - Return the value of a tracing_map_elt's sum field
+ * @elt: The tracing_map_elt
+ * @i: The index of the given sum associated with the tracing_map_elt
+ */
+u64 tracing_map_read_sum(struct tracing_map_elt *elt, unsigned int i)
+{
+	return (u64)atomic64_read(&elt->fields[i].sum);
+}
+
+/**
+ * tracing_map_set_var - Assign a tracing_map_elt's variable field
+ * @elt: The tracing_map_elt
+ * @i: The index of the given variable associated with the tracing_map_elt
+ * @n: The value to assign
+ */
+void tracing_map_set_var(struct tracing_map_elt *elt, unsigned int i, u64 n)
+{
+	atomic64_set(&elt->vars[i], n);
+	smp_wmb(); /* value visible before it is marked set */
+	ACCESS_ONCE(elt->var_set[i]) = true;
+}
+
+/**
+ * tracing_map_var_set - Return whether a variable has been set
+ * @elt: The tracing_map_elt
+ * @i: The index of the given variable associated with the tracing_map_elt
+ */
+bool tracing_map_var_set(struct tracing_map_elt *elt, unsigned int i)
+{
+	return ACCESS_ONCE(elt->var_set[i]);
+}
+
+/**
+ * tracing_map_read_var_once - Return and reset a variable's value
+ * @elt: The tracing_map_elt
+ * @i: The index of the given variable associated with the tracing_map_elt
+ *
+ * A variable read this way is consumed: it reads as unset until the
+ * next tracing_map_set_var(), so that e.g. a wakeup timestamp only
+ * ever pairs with the first switch that follows it.
+ */
+u64 tracing_map_read_var_once(struct tracing_map_elt *elt, unsigned int i)
+{
+	ACCESS_ONCE(elt->var_set[i]) = false;
+	smp_rmb(); /* pairs with tracing_map_set_var() */
+	return (u64)atomic64_read(&elt->vars[i]);
+}
+
+int tracing_map_cmp_string(void *val_a, void *val_b)
+{
+	char *a = val_a;
+	char *b = val_b;
+
+	return strcmp(a, b);
+}
+
+int tracing_map_cmp_none(void *val_a, void *val_b)
+{
+	return 0;
+}
+
+static int tracing_map_cmp_atomic64(void *val_a, void *val_b)
+{
+	u64 a = atomic64_read((atomic64_t *)val_a);
+	u64 b = atomic64_read((atomic64_t *)val_b);
+
+	return (a > b) ? 1 : ((a < b) ? -1 : 0);
+}
+
+#define DEFINE_TRACING_MAP_CMP_FN(type)					\
+static int tracing_map_cmp_##type(void *val_a, void *val_b)		\
+{									\
+	type a = *(type *)val_a;					\
+	type b = *(type *)val_b;					\
+									\
+	return (a > b) ? 1 : ((a < b) ? -1 : 0);			\
+}
+
+DEFINE_TRACING_MAP_CMP_FN(s64);
+DEFINE_TRACING_MAP_CMP_FN(u64);
+DEFINE_TRACING_MAP_CMP_FN(s32);
+DEFINE_TRACING_MAP_CMP_FN(u32);
+DEFINE_TRACING_MAP_CMP_FN(s16);
+DEFINE_TRACING_MAP_CMP_FN(u16);
+DEFINE_TRACING_MAP_CMP_FN(s8);
+DEFINE_TRACING_MAP_CMP_FN(u8);
+
+tracing_map_cmp_fn_t tracing_map_cmp_num(int field_size,
+					 int field_is_signed)
+{
+	tracing_map_cmp_fn_t fn = tracing_map_cmp_none;
+
+	switch (field_size) {
+	case 8:
+		if (field_is_signed)
+			fn = tracing_map_cmp_s64;
+		else
+			fn = tracing_map_cmp_u64;
+		break;
+	case 4:
+		if (field_is_signed)
+			fn = tracing_map_cmp_s32;
+		else
+			fn = tracing_map_cmp_u32;
+		break;
+	case 2:
+		if (field_is_signed)
+			fn = tracing_map_cmp_s16;
+		else
+			fn = tracing_map_cmp_u16;
+		break;
+	case 1:
+		if (field_is_signed)
+			fn = tracing_map_cmp_s8;
+		else
+			fn = tracing_map_cmp_u8;
+		break;
+	}
+
+	return fn;
+}
+
+static int tracing_map_add_field(struct tracing_map *map,
+				 tracing_map_cmp_fn_t cmp_fn)
+{
+	int ret = -EINVAL;
+
+	if (map->n_fields < TRACING_MAP_FIELDS_MAX) {
+		ret = map->n_fields;
+		map->fields[map->n_fields++].cmp_fn = cmp_fn;
+	}
+
+	return ret;
+}
+
+/**
+ * tracing_map_add_sum_field - Add a field describing a tracing_map sum
+ * @map: The tracing_map
+ *
+ * Add a sum field to the map.  Every element of the map will carry
+ * its own copy of the sum, updated with tracing_map_update_sum().
+ * Must be called before tracing_map_init().
+ *
+ * Return: The index identifying the field in the map, or -EINVAL.
+ */
+int tracing_map_add_sum_field(struct tracing_map *map)
+{
+	return tracing_map_add_field(map, tracing_map_cmp_atomic64);
+}
+
+/**
+ * tracing_map_add_key_field - Add a field describing a tracing_map key
+ * @map: The tracing_map
+ * @offset: The offset of the key within the compound key
+ * @cmp_fn: The comparison function used when sorting on this key
+ *
+ * Keys aren't updated by the map, describing them only serves to
+ * sort the elements on a key.  Must be called before
+ * tracing_map_init().
+ *
+ * Return: The index identifying the field in the map, or -EINVAL.
+ */
+int tracing_map_add_key_field(struct tracing_map *map,
+			      unsigned int offset,
+			      tracing_map_cmp_fn_t cmp_fn)
+{
+	int idx = tracing_map_add_field(map, cmp_fn);
+
+	if (idx < 0)
+		return idx;
+
+	map->fields[idx].offset = offset;
+	map->n_keys++;
+
+	return idx;
+}
+
+/**
+ * tracing_map_add_var - Add a variable to every element of the map
+ * @map: The tracing_map
+ *
+ * Must be called before tracing_map_init().
+ *
+ * Return: The index identifying the variable in the map, or -EINVAL.
+ */
+int tracing_map_add_var(struct tracing_map *map)
+{
+	if (map->n_vars >= TRACING_MAP_VARS_MAX)
+		return -EINVAL;
+
+	return map->n_vars++;
+}
+
+static void tracing_map_elt_clear(struct tracing_map_elt *elt)
+{
+	struct tracing_map *map = elt->map;
+	unsigned int i;
+
+	for (i = 0; i < map->n_fields; i++)
+		if (map->fields[i].cmp_fn == tracing_map_cmp_atomic64)
+			atomic64_set(&elt->fields[i].sum, 0);
+
+	for (i = 0; i < map->n_vars; i++) {
+		atomic64_set(&elt->vars[i], 0);
+		elt->var_set[i] = false;
+	}
+
+	memset(elt->key, 0, map->key_size);
+}
+
+static void tracing_map_elt_free(struct tracing_map_elt *elt)
+{
+	if (!elt)
+		return;
+
+	kfree(elt->key);
+	kfree(elt->var_set);
+	kfree(elt->vars);
+	kfree(elt->fields);
+	kfree(elt);
+}
+
+static struct tracing_map_elt *tracing_map_elt_alloc(struct tracing_map *map)
+{
+	struct tracing_map_elt *elt;
+	unsigned int i;
+
+	elt = kzalloc(sizeof(*elt), GFP_KERNEL);
+	if (!elt)
+		return NULL;
+
+	elt->map = map;
+
+	elt->key = kzalloc(map->key_size, GFP_KERNEL);
+	elt->fields = kcalloc(map->n_fields, sizeof(*elt->fields), GFP_KERNEL);
+	if (!elt->key || !elt->fields)
+		goto free;
+
+	if (map->n_vars) {
+		elt->vars = kcalloc(map->n_vars, sizeof(*elt->vars),
+				    GFP_KERNEL);
+		elt->var_set = kcalloc(map->n_vars, sizeof(*elt->var_set),
+				       GFP_KERNEL);
+		if (!elt->vars || !elt->var_set)
+			goto free;
+	}
+
+	for (i = 0; i < map->n_fields; i++) {
+		elt->fields[i].cmp_fn = map->fields[i].cmp_fn;
+		if (elt->fields[i].cmp_fn != tracing_map_cmp_atomic64)
+			elt->fields[i].offset = map->fields[i].offset;
+	}
+
+	return elt;
+ free:
+	tracing_map_elt_free(elt);
+	return NULL;
+}
+
+static void tracing_map_free_elts(struct tracing_map *map)
+{
+	unsigned int i;
+
+	if (!map->elts)
+		return;
+
+	for (i = 0; i < map->max_elts; i++)
+		tracing_map_elt_free(map->elts[i]);
+
+	vfree(map->elts);
+	map->elts = NULL;
+}
+
+static int tracing_map_alloc_elts(struct tracing_map *map)
+{
+	unsigned int i;
+
+	map->elts = vzalloc(map->max_elts * sizeof(*map->elts));
+	if (!map->elts)
+		return -ENOMEM;
+
+	for (i = 0; i < map->max_elts; i++) {
+		map->elts[i] = tracing_map_elt_alloc(map);
+		if (!map->elts[i]) {
+			tracing_map_free_elts(map);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+static inline bool keys_match(void *key, void *test_key, unsigned key_size)
+{
+	return memcmp(key, test_key, key_size) == 0;
+}
+
+static struct tracing_map_elt *get_free_elt(struct tracing_map *map)
+{
+	int idx;
+
+	/* Don't let the index wrap once the map is full */
+	if (atomic_read(&map->next_elt) >= (int)map->max_elts - 1)
+		return NULL;
+
+	idx = atomic_inc_return(&map->next_elt);
+	if (idx < map->max_elts)
+		return map->elts[idx];
+
+	return NULL;
+}
+
+static struct tracing_map_elt *
+__tracing_map_insert(struct tracing_map *map, void *key, bool lookup_only)
+{
+	struct tracing_map_entry *entry;
+	struct tracing_map_elt *elt;
+	u32 idx, key_hash, test_key;
+	unsigned int dup_try = 0;
+
+	key_hash = jhash(key, map->key_size, 0);
+	if (key_hash == 0)
+		key_hash = 1;
+	idx = key_hash >> (32 - (map->map_bits + 1));
+
+	while (1) {
+		idx &= (map->map_size - 1);
+		entry = &map->map[idx];
+		test_key = ACCESS_ONCE(entry->key);
+
+		if (test_key && test_key == key_hash) {
+			elt = ACCESS_ONCE(entry->val);
+			if (elt && keys_match(key, elt->key, map->key_size)) {
+				if (!lookup_only)
+					atomic64_inc(&map->hits);
+				return elt;
+			} else if (unlikely(!elt)) {
+				/*
+				 * The slot has been claimed but its element
+				 * isn't published yet.  It may be ours, so
+				 * wait a bit rather than inserting the key
+				 * twice.
+				 */
+				if (++dup_try > map->map_size) {
+					atomic64_inc(&map->drops);
+					break;
+				}
+				continue;
+			}
+		}
+
+		if (!test_key) {
+			if (lookup_only)
+				break;
+
+			if (!cmpxchg(&entry->key, 0, key_hash)) {
+				elt = get_free_elt(map);
+				if (!elt) {
+					atomic64_inc(&map->drops);
+					entry->key = 0;
+					break;
+				}
+
+				memcpy(elt->key, key, map->key_size);
+				/* key copied before the element is visible */
+				smp_wmb();
+				entry->val = elt;
+				atomic64_inc(&map->hits);
+
+				return elt;
+			} else {
+				/* Lost the race, look at the same slot again */
+				if (++dup_try > map->map_size) {
+					atomic64_inc(&map->drops);
+					break;
+				}
+				continue;
+			}
+		}
+
+		idx++;
+	}
+
+	return NULL;
+}
+
+/**
+ * tracing_map_insert - Insert key and/or retrieve val from a tracing_map
+ * @map: The tracing_map to insert into
+ * @key: The key to insert
+ *
+ * Look up the element for @key, claiming a free element for it if
+ * the key isn't in the map yet.  This is lock-free and doesn't
+ * allocate, so it can be called from the tracing hot path.
+ *
+ * Return: The tracing_map_elt of @key, or NULL if the map is full, in
+ * which case the drop is accounted in the map's drops counter.
+ */
+struct tracing_map_elt *tracing_map_insert(struct tracing_map *map, void *key)
+{
+	return __tracing_map_insert(map, key, false);
+}
+
+/**
+ * tracing_map_lookup - Retrieve val from a tracing_map
+ * @map: The tracing_map to perform the lookup on
+ * @key: The key to look up
+ *
+ * Same as tracing_map_insert() except that a missing key isn't
+ * inserted.
+ *
+ * Return: The tracing_map_elt of @key, or NULL if it isn't in the map.
+ */
+struct tracing_map_elt *tracing_map_lookup(struct tracing_map *map, void *key)
+{
+	return __tracing_map_insert(map, key, true);
+}
+
+/**
+ * tracing_map_destroy - Destroy a tracing_map
+ * @map: The tracing_map to destroy
+ *
+ * The caller must make sure nothing can access the map anymore,
+ * typically by removing the trigger using it and waiting for a
+ * sched RCU grace period.
+ */
+void tracing_map_destroy(struct tracing_map *map)
+{
+	if (!map)
+		return;
+
+	tracing_map_free_elts(map);
+	vfree(map->map);
+	kfree(map);
+}
+
+/**
+ * tracing_map_clear - Clear a tracing_map
+ * @map: The tracing_map to clear
+ *
+ * Reset all the elements and entries of the map, as if it had just
+ * been initialized.  The caller must make sure no insertion can run
+ * concurrently, e.g. by pausing the trigger and waiting for a sched
+ * RCU grace period.
+ */
+void tracing_map_clear(struct tracing_map *map)
+{
+	unsigned int i, n;
+
+	n = min_t(int, atomic_read(&map->next_elt) + 1, map->max_elts);
+
+	memset(map->map, 0, map->map_size * sizeof(*map->map));
+	for (i = 0; i < n; i++)
+		tracing_map_elt_clear(map->elts[i]);
+
+	atomic_set(&map->next_elt, -1);
+	atomic64_set(&map->hits, 0);
+	atomic64_set(&map->drops, 0);
+}
+
+/**
+ * tracing_map_create - Create a lock-free map and element pool
+ * @map_bits: The size of the map (2 ** map_bits)
+ * @key_size: The size of the key for the map in bytes
+ * @private_data: Client data associated with the map
+ *
+ * Create the map.  The table has 2 ** (map_bits + 1) entries so that
+ * it is never more than half full, which keeps the probe sequences
+ * short, and up to 2 ** map_bits elements can be inserted.
+ *
+ * The fields and variables of the elements are then described with
+ * tracing_map_add_sum_field(), tracing_map_add_key_field() and
+ * tracing_map_add_var() before calling tracing_map_init().
+ *
+ * Return: the tracing_map pointer if successful, ERR_PTR if not.
+ */
+struct tracing_map *tracing_map_create(unsigned int map_bits,
+				       unsigned int key_size,
+				       void *private_data)
+{
+	struct tracing_map *map;
+
+	if (map_bits < TRACING_MAP_BITS_MIN ||
+	    map_bits > TRACING_MAP_BITS_MAX || !key_size)
+		return ERR_PTR(-EINVAL);
+
+	map = kzalloc(sizeof(*map), GFP_KERNEL);
+	if (!map)
+		return ERR_PTR(-ENOMEM);
+
+	map->map_bits = map_bits;
+	map->max_elts = (1 << map_bits);
+	map->map_size = (1 << (map_bits + 1));
+	map->key_size = key_size;
+	map->private_data = private_data;
+	atomic_set(&map->next_elt, -1);
+
+	map->map = vzalloc(map->map_size * sizeof(*map->map));
+	if (!map->map) {
+		kfree(map);
+		return ERR_PTR(-ENOMEM);
+	}
+
+	return map;
+}
+
+/**
+ * tracing_map_init - Allocate the elements of a tracing_map
+ * @map: The tracing_map to initialize
+ *
+ * Preallocate all the elements of the map, now that their fields and
+ * variables are known.
+ *
+ * Return: 0 if successful, -ENOMEM otherwise.
+ */
+int tracing_map_init(struct tracing_map *map)
+{
+	if (map->n_fields < 1)
+		return -EINVAL;
+
+	return tracing_map_alloc_elts(map);
+}
+
+static int cmp_entries(const void *A, const void *B)
+{
+	const struct tracing_map_sort_entry *a = A;
+	const struct tracing_map_sort_entry *b = B;
+	struct tracing_map *map = a->elt->map;
+	struct tracing_map_sort_key *sort_key = &map->sort_key;
+	struct tracing_map_field *field = &map->fields[sort_key->field_idx];
+	void *val_a, *val_b;
+	int ret;
+
+	if (field->cmp_fn == tracing_map_cmp_atomic64) {
+		val_a = &a->elt->fields[sort_key->field_idx].sum;
+		val_b = &b->elt->fields[sort_key->field_idx].sum;
+	} else {
+		val_a = a->key + field->offset;
+		val_b = b->key + field->offset;
+	}
+
+	ret = field->cmp_fn(val_a, val_b);
+	if (sort_key->descending)
+		ret = -ret;
+
+	return ret;
+}
+
+/**
+ * tracing_map_sort_entries - Sort the current set of tracing_map_elts in a map
+ * @map: The tracing_map
+ * @sort_key: The sort key to use for sorting
+ * @sort_entries: outval: pointer to allocated and sorted array of entries
+ *
+ * Take a snapshot of the elements currently in the map and sort them
+ * on the given key, which may be either a sum or a key field.  The
+ * elements keep being updated while and after they're sorted, the
+ * snapshot only fixes which of them are reported.
+ *
+ * The array must be freed with tracing_map_destroy_sort_entries().
+ *
+ * Return: the number of sort_entries in the array, negative on error.
+ */
+int tracing_map_sort_entries(struct tracing_map *map,
+			     struct tracing_map_sort_key *sort_key,
+			     struct tracing_map_sort_entry **sort_entries)
+{
+	struct tracing_map_sort_entry *entries;
+	struct tracing_map_elt *elt;
+	int i, n_entries = 0;
+
+	entries = vmalloc(map->max_elts * sizeof(*entries));
+	if (!entries)
+		return -ENOMEM;
+
+	for (i = 0; i < map->map_size; i++) {
+		elt = ACCESS_ONCE(map->map[i].val);
+		if (!ACCESS_ONCE(map->map[i].key) || !elt)
+			continue;
+		if (n_entries == map->max_elts)
+			break;
+
+		entries[n_entries].key = elt->key;
+		entries[n_entries].elt = elt;
+		n_entries++;
+	}
+
+	if (n_entries == 0) {
+		vfree(entries);
+		*sort_entries = NULL;
+		return 0;
+	}
+
+	map->sort_key = *sort_key;
+	sort(entries, n_entries, sizeof(*entries), cmp_entries, NULL);
+
+	*sort_entries = entries;
+
+	return n_entries;
+}
+
+void tracing_map_destroy_sort_entries(struct tracing_map_sort_entry *entries)
+{
+	vfree(entries);
+}
@@ -0,0 +1,127 @@
+#ifndef __TRACING_MAP_H
+#define __TRACING_MAP_H
+
+#define TRACING_MAP_BITS_DEFAULT	11
+#define TRACING_MAP_BITS_MAX		17
+#define TRACING_MAP_BITS_MIN		7
+
+#define TRACING_MAP_KEYS_MAX		2
+#define TRACING_MAP_VALS_MAX		3
+#define TRACING_MAP_FIELDS_MAX		(TRACING_MAP_KEYS_MAX + \
+					 TRACING_MAP_VALS_MAX)
+#define TRACING_MAP_VARS_MAX		4
+
+typedef int (*tracing_map_cmp_fn_t) (void *val_a, void *val_b);
+
+/*
+ * A tracing_map field is either a sum, updated atomically by the
+ * tracing hot path, or a key, in which case @offset locates it in the
+ * compound key of the element.  @cmp_fn is used when sorting on it.
+ */
+struct tracing_map_field {
+	tracing_map_cmp_fn_t		cmp_fn;
+	union {
+		atomic64_t		sum;
+		unsigned int		offset;
+	};
+};
+
+struct tracing_map_elt {
+	struct tracing_map		*map;
+	struct tracing_map_field	*fields;
+	atomic64_t			*vars;
+	bool				*var_set;
+	void				*key;
+};
+
+struct tracing_map_entry {
+	u32				key;
+	struct tracing_map_elt		*val;
+};
+
+struct tracing_map_sort_key {
+	unsigned int			field_idx;
+	bool				descending;
+};
+
+struct tracing_map_sort_entry {
+	void				*key;
+	struct tracing_map_elt		*elt;
+};
+
+/**
+ * struct tracing_map - a lock-free map for aggregating event data
+ *
+ * The map is a linearly probed hash table of 2^(map_bits + 1)
+ * entries, each holding the 32-bit hash of a key and a pointer to
+ * the element carrying the key and its fields.  Elements are all
+ * allocated by tracing_map_init() and handed out from a free index
+ * as new keys get inserted, so insertion never allocates and can be
+ * done from any context, including NMI.  An entry is claimed with a
+ * cmpxchg() on its hash, after which the slot is never released;
+ * once max_elts elements have been used further new keys are
+ * counted as drops.
+ *
+ * Only tracing_map_clear() and tracing_map_destroy() may run
+ * concurrently with nothing else, the caller ensuring no inserts are
+ * in flight.
+ */
+struct tracing_map {
+	unsigned int			key_size;
+	unsigned int			map_bits;
+	unsigned int			map_size;
+	unsigned int			max_elts;
+	atomic_t			next_elt;
+	struct tracing_map_elt		**elts;
+	struct tracing_map_entry	*map;
+	struct tracing_map_sort_key	sort_key;
+	unsigned int			n_fields;
+	unsigned int			n_keys;
+	unsigned int			n_vars;
+	struct tracing_map_field	fields[TRACING_MAP_FIELDS_MAX];
+	atomic64_t			hits;
+	atomic64_t			drops;
+	void				*private_data;
+};
+
+extern struct tracing_map *tracing_map_create(unsigned int map_bits,
+					      unsigned int key_size,
+					      void *private_data);
+extern int tracing_map_init(struct tracing_map *map);
+
+extern int tracing_map_add_sum_field(struct tracing_map *map);
+extern int tracing_map_add_key_field(struct tracing_map *map,
+				     unsigned int offset,
+				     tracing_map_cmp_fn_t cmp_fn);
+extern int tracing_map_add_var(struct tracing_map *map);
+
+extern void tracing_map_destroy(struct tracing_map *map);
+extern void tracing_map_clear(struct tracing_map *map);
+
+extern struct tracing_map_elt *
+tracing_map_insert(struct tracing_map *map, void *key);
+extern struct tracing_map_elt *
+tracing_map_lookup(struct tracing_map *map, void *key);
+
+extern tracing_map_cmp_fn_t tracing_map_cmp_num(int field_size,
+						int field_is_signed);
+extern int tracing_map_cmp_string(void *val_a, void *val_b);
+extern int tracing_map_cmp_none(void *val_a, void *val_b);
+
+extern void tracing_map_update_sum(struct tracing_map_elt *elt,
+				   unsigned int i, u64 n);
+extern u64 tracing_map_read_sum(struct tracing_map_elt *elt, unsigned int i);
+extern void tracing_map_set_var(struct tracing_map_elt *elt,
+				unsigned int i, u64 n);
+extern bool tracing_map_var_set(struct tracing_map_elt *elt, unsigned int i);
+extern u64 tracing_map_read_var_once(struct tracing_map_elt *elt,
+				     unsigned int i);
+
+extern int
+tracing_map_sort_entries(struct tracing_map *map,
+			 struct tracing_map_sort_key *sort_key,
+			 struct tracing_map_sort_entry **sort_entries);
+extern void
+tracing_map_destroy_sort_entries(struct tracing_map_sort_entry *entries);
+
+#endif /* __TRACING_MAP_H */
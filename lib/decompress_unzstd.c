@@ -0,0 +1,220 @@
+/*
+ * Wrapper for decompressing zstd-compressed initramfs and initrd
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+/*
+ * The input may be a single buffer, in which case it is decompressed in
+ * one shot, or be pulled through fill() in chunks, with the output pushed
+ * out through flush().  Concatenated frames are handled by the caller
+ * using *pos, as with the other formats.
+ *
+ * Unlike the other wrappers this one is not usable by the boot
+ * decompressors: STATIC builds would need the whole of lib/zstd.
+ */
+
+#include <linux/decompress/unzstd.h>
+#include <linux/decompress/mm.h>
+#include <linux/types.h>
+#include <linux/kernel.h>
+#include <linux/zstd.h>
+
+/* 128KB is the zstd block size, the most a single call can produce */
+#define ZSTD_IOBUF_SIZE		(1 << 17)
+
+static int INIT handle_zstd_error(size_t ret, void (*error)(char *x))
+{
+	const zstd_error_code err = zstd_get_error_code(ret);
+
+	if (!zstd_is_error(ret))
+		return 0;
+
+	switch (err) {
+	case ZSTD_error_memory_allocation:
+		error("ZSTD decompressor ran out of memory");
+		break;
+	case ZSTD_error_prefix_unknown:
+		error("Input is not in the ZSTD format (wrong magic bytes)");
+		break;
+	case ZSTD_error_dstSize_tooSmall:
+	case ZSTD_error_corruption_detected:
+	case ZSTD_error_checksum_wrong:
+		error("ZSTD-compressed data is corrupt");
+		break;
+	default:
+		error("ZSTD-compressed data is probably corrupt");
+		break;
+	}
+	return -1;
+}
+
+static int INIT decompress_single(const u8 *in_buf, long in_len, u8 *out_buf,
+				  size_t out_len, long *in_pos,
+				  void (*error)(char *x))
+{
+	const size_t wksp_size = zstd_dctx_workspace_bound();
+	void *wksp = large_malloc(wksp_size);
+	zstd_dctx *dctx = wksp ? zstd_init_dctx(wksp, wksp_size) : NULL;
+	int err;
+	size_t ret;
+
+	if (!dctx) {
+		error("Out of memory while allocating zstd_dctx");
+		err = -1;
+		goto out;
+	}
+
+	/* decompress only the first frame, the caller deals with the rest */
+	ret = zstd_find_frame_compressed_size(in_buf, in_len);
+	err = handle_zstd_error(ret, error);
+	if (err)
+		goto out;
+	in_len = (long)ret;
+
+	ret = zstd_decompress_dctx(dctx, out_buf, out_len, in_buf, in_len);
+	err = handle_zstd_error(ret, error);
+	if (err)
+		goto out;
+
+	if (in_pos)
+		*in_pos = in_len;
+out:
+	if (wksp)
+		large_free(wksp);
+	return err;
+}
+
+STATIC int INIT unzstd(unsigned char *in_buf, long in_len,
+		       long (*fill)(void*, unsigned long),
+		       long (*flush)(void*, unsigned long),
+		       unsigned char *out_buf, long *in_pos,
+		       void (*error)(char *x))
+{
+	zstd_in_buffer in;
+	zstd_out_buffer out;
+	zstd_frame_header header;
+	void *in_allocated = NULL;
+	void *out_allocated = NULL;
+	void *wksp = NULL;
+	size_t wksp_size;
+	zstd_dstream *dstream;
+	/* without flush() the output buffer is assumed to be large enough */
+	size_t out_len = ULONG_MAX - (unsigned long)out_buf;
+	int err;
+	size_t ret;
+
+	if (!fill && !flush)
+		return decompress_single(in_buf, in_len, out_buf, out_len,
+					 in_pos, error);
+
+	if (!in_buf) {
+		in_allocated = large_malloc(ZSTD_IOBUF_SIZE);
+		if (!in_allocated) {
+			error("Out of memory while allocating input buffer");
+			err = -1;
+			goto out;
+		}
+		in_buf = in_allocated;
+		in_len = 0;
+	}
+
+	if (!out_buf) {
+		out_allocated = large_malloc(ZSTD_IOBUF_SIZE);
+		if (!out_allocated) {
+			error("Out of memory while allocating output buffer");
+			err = -1;
+			goto out;
+		}
+		out_buf = out_allocated;
+		out_len = ZSTD_IOBUF_SIZE;
+	}
+
+	if (in_pos)
+		*in_pos = 0;
+
+	if (fill)
+		in_len = fill(in_buf, ZSTD_IOBUF_SIZE);
+	if (in_len < 0) {
+		error("ZSTD-compressed data is truncated");
+		err = -1;
+		goto out;
+	}
+
+	in.src = in_buf;
+	in.pos = 0;
+	in.size = in_len;
+	out.dst = out_buf;
+	out.pos = 0;
+	out.size = out_len;
+
+	/* size the workspace for the window the frame actually needs */
+	ret = zstd_get_frame_header(&header, in.src, in.size);
+	if (ret != 0) {
+		error("ZSTD-compressed data has an incomplete frame header");
+		err = -1;
+		goto out;
+	}
+	if (header.windowSize > (1ULL << ZSTD_WINDOWLOG_MAX)) {
+		error("ZSTD-compressed data has too large a window size");
+		err = -1;
+		goto out;
+	}
+
+	wksp_size = zstd_dstream_workspace_bound(header.windowSize);
+	wksp = large_malloc(wksp_size);
+	dstream = wksp ? zstd_init_dstream(header.windowSize, wksp,
+					   wksp_size) : NULL;
+	if (!dstream) {
+		error("Out of memory while allocating zstd_dstream");
+		err = -1;
+		goto out;
+	}
+
+	for (;;) {
+		if (in.pos == in.size) {
+			if (in_pos)
+				*in_pos += in.pos;
+			in_len = fill ? fill(in_buf, ZSTD_IOBUF_SIZE) : -1;
+			if (in_len < 0) {
+				error("ZSTD-compressed data is truncated");
+				err = -1;
+				goto out;
+			}
+			in.pos = 0;
+			in.size = in_len;
+		}
+
+		ret = zstd_decompress_stream(dstream, &out, &in);
+		err = handle_zstd_error(ret, error);
+		if (err)
+			goto out;
+
+		if (flush && out.pos > 0) {
+			if (out.pos != flush(out.dst, out.pos)) {
+				error("Failed to flush()");
+				err = -1;
+				goto out;
+			}
+			out.pos = 0;
+		}
+
+		/* the frame is complete and fully flushed */
+		if (ret == 0)
+			break;
+	}
+
+	if (in_pos)
+		*in_pos += in.pos;
+	err = 0;
+out:
+	if (in_allocated)
+		large_free(in_allocated);
+	if (out_allocated)
+		large_free(out_allocated);
+	if (wksp)
+		large_free(wksp);
+	return err;
+}
@@ -61,6 +61,12 @@ typedef uintptr_t uptrval;
 #define LZ4_ARCH64 0
 #endif
 
+/*
+ * The fast decoding loop copies literals and matches in 16-byte stripes,
+ * which pays off on 64-bit CPUs.
+ */
+#define LZ4_FAST_DEC_LOOP LZ4_ARCH64
+
 #if defined(__LITTLE_ENDIAN)
 #define LZ4_LITTLE_ENDIAN 1
 #else
@@ -80,6 +86,7 @@ typedef uintptr_t uptrval;
  * without overflowing output buffer
  */
 #define MATCH_SAFEGUARD_DISTANCE  ((2 * WILDCOPYLENGTH) - MINMATCH)
+#define FASTLOOP_SAFE_DISTANCE 64
 
 /* Increase this value ==> compression run slower on incompressible data */
 #define LZ4_SKIPTRIGGER 6
@@ -170,6 +177,27 @@ static FORCE_INLINE void LZ4_wildCopy(void *dstPtr,
 	} while (d < e);
 }
 
+/*
+ * customized variant of memcpy,
+ * which can overwrite up to 32 bytes beyond dstEnd.
+ * It copies two times 16 bytes rather than 32 bytes at once,
+ * so that it can be used for matches with offsets >= 16
+ */
+static FORCE_INLINE void LZ4_wildCopy32(void *dstPtr,
+	const void *srcPtr, void *dstEnd)
+{
+	BYTE *d = (BYTE *)dstPtr;
+	const BYTE *s = (const BYTE *)srcPtr;
+	BYTE *const e = (BYTE *)dstEnd;
+
+	do {
+		memcpy(d, s, 16);
+		memcpy(d + 16, s + 16, 16);
+		d += 32;
+		s += 32;
+	} while (d < e);
+}
+
 static FORCE_INLINE unsigned int LZ4_NbCommonBytes(register size_t val)
 {
 #if LZ4_LITTLE_ENDIAN
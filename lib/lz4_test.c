@@ -0,0 +1,269 @@
+/*
+ * LZ4 throughput benchmark.
+ *
+ * Compresses and decompresses a buffer filled with one of a few synthetic
+ * corpora, page by page as zram does, and reports the compression ratio
+ * and the throughput of LZ4_compress_fast() for a range of acceleration
+ * factors, as well as of LZ4_decompress_safe(), LZ4_decompress_fast() and
+ * LZ4_decompress_safe_partial(). Every decompressed page is checked
+ * against the original.
+ */
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/vmalloc.h>
+#include <linux/slab.h>
+#include <linux/random.h>
+#include <linux/ktime.h>
+#include <linux/lz4.h>
+
+#define __param(type, name, init, msg)		\
+	static type name = init;		\
+	module_param(name, type, 0444);		\
+	MODULE_PARM_DESC(name, msg);
+
+__param(int, nr_pages, 256, "Number of pages in the corpus");
+__param(int, loops, 8, "Number of passes over the corpus per measurement");
+__param(int, accel_max, 16, "Largest acceleration factor, doubled from 1");
+
+enum corpus {
+	CORPUS_ZEROS,
+	CORPUS_TEXT,
+	CORPUS_RANDOM,
+	CORPUS_MIXED,
+	NR_CORPUS,
+};
+
+static const char * const corpus_names[NR_CORPUS] = {
+	"zeros", "text", "random", "mixed",
+};
+
+static const char * const words[] = {
+	"the ", "kernel ", "memory ", "page ", "android ", "process ",
+	"struct ", "return ", "if (", "NULL", ") {\n", "\t", "0x", "int ",
+	"unsigned long ", "lock", "=", ";\n", "}\n", "static ",
+};
+
+static void fill_text(u8 *buf, size_t len)
+{
+	size_t pos = 0;
+
+	while (pos < len) {
+		const char *w = words[prandom_u32() % ARRAY_SIZE(words)];
+		size_t n = min(strlen(w), len - pos);
+
+		memcpy(buf + pos, w, n);
+		pos += n;
+	}
+}
+
+static void fill_corpus(u8 *buf, size_t len, enum corpus c)
+{
+	size_t off;
+
+	switch (c) {
+	case CORPUS_ZEROS:
+		memset(buf, 0, len);
+		break;
+	case CORPUS_TEXT:
+		fill_text(buf, len);
+		break;
+	case CORPUS_RANDOM:
+		prandom_bytes(buf, len);
+		break;
+	case CORPUS_MIXED:
+		/* of every four pages, one zero, one random and two text */
+		for (off = 0; off < len; off += PAGE_SIZE) {
+			switch ((off / PAGE_SIZE) % 4) {
+			case 0:
+				memset(buf + off, 0, PAGE_SIZE);
+				break;
+			case 1:
+				prandom_bytes(buf + off, PAGE_SIZE);
+				break;
+			default:
+				fill_text(buf + off, PAGE_SIZE);
+				break;
+			}
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+struct lz4_bench {
+	u8 *src;
+	u8 *dst;
+	u8 *out;
+	int *clen;
+	void *wrkmem;
+};
+
+static u64 mb_per_s(u64 bytes, s64 ns)
+{
+	return ns > 0 ? div64_u64(bytes * NSEC_PER_SEC, (u64)ns << 20) : 0;
+}
+
+static int bench_compress(struct lz4_bench *b, int accel, s64 *ns, u64 *total)
+{
+	size_t bound = LZ4_COMPRESSBOUND(PAGE_SIZE);
+	ktime_t start;
+	int i, l;
+
+	*total = 0;
+	start = ktime_get();
+	for (l = 0; l < loops; l++) {
+		for (i = 0; i < nr_pages; i++) {
+			b->clen[i] = LZ4_compress_fast(
+				(char *)b->src + i * PAGE_SIZE,
+				(char *)b->dst + i * bound, PAGE_SIZE, bound,
+				accel, b->wrkmem);
+			if (!b->clen[i])
+				return -EINVAL;
+			if (!l)
+				*total += b->clen[i];
+		}
+		cond_resched();
+	}
+	*ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+	return 0;
+}
+
+enum decomp_mode {
+	DECOMP_SAFE,
+	DECOMP_FAST,
+	DECOMP_PARTIAL,
+	NR_DECOMP,
+};
+
+static const char * const decomp_names[NR_DECOMP] = {
+	"safe", "fast", "partial",
+};
+
+static int bench_decompress(struct lz4_bench *b, enum decomp_mode mode,
+			    s64 *ns)
+{
+	size_t want = mode == DECOMP_PARTIAL ? PAGE_SIZE / 2 : PAGE_SIZE;
+	ktime_t start;
+	int i, l, ret;
+
+	start = ktime_get();
+	for (l = 0; l < loops; l++) {
+		for (i = 0; i < nr_pages; i++) {
+			const char *in = (char *)b->dst +
+					 i * LZ4_COMPRESSBOUND(PAGE_SIZE);
+			char *out = (char *)b->out + i * PAGE_SIZE;
+
+			switch (mode) {
+			case DECOMP_SAFE:
+				ret = LZ4_decompress_safe(in, out, b->clen[i],
+							  PAGE_SIZE);
+				break;
+			case DECOMP_FAST:
+				ret = LZ4_decompress_fast(in, out, PAGE_SIZE);
+				ret = ret == b->clen[i] ? PAGE_SIZE : -1;
+				break;
+			default:
+				ret = LZ4_decompress_safe_partial(in, out,
+						b->clen[i], want, PAGE_SIZE);
+				break;
+			}
+			if (ret < (int)want)
+				return -EINVAL;
+		}
+		cond_resched();
+	}
+	*ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	for (i = 0; i < nr_pages; i++)
+		if (memcmp(b->src + i * PAGE_SIZE, b->out + i * PAGE_SIZE,
+			   want))
+			return -EIO;
+	return 0;
+}
+
+static int lz4_bench_corpus(struct lz4_bench *b, enum corpus c)
+{
+	u64 bytes = (u64)nr_pages * PAGE_SIZE * loops;
+	u64 total;
+	s64 ns;
+	int accel, mode, ret;
+
+	fill_corpus(b->src, (size_t)nr_pages * PAGE_SIZE, c);
+
+	for (accel = 1; accel <= accel_max; accel <<= 1) {
+		ret = bench_compress(b, accel, &ns, &total);
+		if (ret)
+			return ret;
+		pr_alert("lz4 test: %-6s accel %2d: ratio %llu.%02llu, compress %llu MB/s\n",
+			 corpus_names[c], accel,
+			 div64_u64((u64)nr_pages * PAGE_SIZE, total),
+			 div64_u64((u64)nr_pages * PAGE_SIZE * 100,
+				   total) % 100,
+			 mb_per_s(bytes, ns));
+	}
+
+	/* decompress what the default acceleration produces */
+	ret = bench_compress(b, LZ4_ACCELERATION_DEFAULT, &ns, &total);
+	if (ret)
+		return ret;
+	for (mode = 0; mode < NR_DECOMP; mode++) {
+		ret = bench_decompress(b, mode, &ns);
+		if (ret) {
+			pr_alert("lz4 test: %s decompression of %s failed\n",
+				 decomp_names[mode], corpus_names[c]);
+			return ret;
+		}
+		pr_alert("lz4 test: %-6s decompress %-7s %llu MB/s\n",
+			 corpus_names[c], decomp_names[mode],
+			 mb_per_s(mode == DECOMP_PARTIAL ? bytes / 2 : bytes,
+				  ns));
+	}
+	return 0;
+}
+
+static int __init lz4_test_init(void)
+{
+	struct lz4_bench b;
+	int c, ret = 0;
+
+	if (nr_pages <= 0 || loops <= 0 || accel_max <= 0)
+		return -EINVAL;
+
+	b.src = vmalloc((size_t)nr_pages * PAGE_SIZE);
+	b.out = vmalloc((size_t)nr_pages * PAGE_SIZE);
+	b.dst = vmalloc((size_t)nr_pages * LZ4_COMPRESSBOUND(PAGE_SIZE));
+	b.clen = kcalloc(nr_pages, sizeof(*b.clen), GFP_KERNEL);
+	b.wrkmem = vmalloc(LZ4_MEM_COMPRESS);
+	if (!b.src || !b.out || !b.dst || !b.clen || !b.wrkmem) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (c = 0; c < NR_CORPUS; c++) {
+		ret = lz4_bench_corpus(&b, c);
+		if (ret)
+			break;
+	}
+
+out:
+	vfree(b.wrkmem);
+	kfree(b.clen);
+	vfree(b.dst);
+	vfree(b.out);
+	vfree(b.src);
+	if (ret)
+		return ret;
+	return -EAGAIN; /* Fail will directly unload the module */
+}
+
+static void __exit lz4_test_exit(void)
+{
+	printk(KERN_ALERT "test exit\n");
+}
+
+module_init(lz4_test_init)
+module_exit(lz4_test_exit)
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("LZ4 throughput benchmark");
@@ -0,0 +1,127 @@
+/*
+ * printk() caller latency benchmark.
+ *
+ * One kthread per online CPU prints a number of messages, optionally with
+ * interrupts disabled around each call, and measures how long every
+ * printk() takes for the caller. With synchronous printing a caller may
+ * end up writing the whole backlog to the consoles; with
+ * CONFIG_PRINTK_ASYNC it only stores its own record. Reported are the
+ * average and the worst latency over all callers.
+ */
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/kthread.h>
+#include <linux/completion.h>
+#include <linux/slab.h>
+#include <linux/cpu.h>
+#include <linux/sched.h>
+
+#define __param(type, name, init, msg)		\
+	static type name = init;		\
+	module_param(name, type, 0444);		\
+	MODULE_PARM_DESC(name, msg);
+
+__param(int, nr_msgs, 1000, "Messages printed by every CPU");
+__param(int, level, 6, "Log level of the messages");
+__param(bool, irqs_off, false, "Call printk() with interrupts disabled");
+
+struct bench_worker {
+	struct task_struct *task;
+	u64 total_ns;
+	u64 max_ns;
+	int cpu;
+};
+
+static struct bench_worker *workers;
+static atomic_t bench_running;
+static DECLARE_COMPLETION(bench_done);
+
+static int bench_thread(void *arg)
+{
+	struct bench_worker *w = arg;
+	unsigned long flags = 0;
+	u64 t0, t;
+	int i;
+
+	for (i = 0; i < nr_msgs; i++) {
+		if (irqs_off)
+			local_irq_save(flags);
+		t0 = local_clock();
+		printk(KERN_SOH "%dprintk_test: cpu %d message %d of %d\n",
+		       level, w->cpu, i, nr_msgs);
+		t = local_clock() - t0;
+		if (irqs_off)
+			local_irq_restore(flags);
+
+		w->total_ns += t;
+		w->max_ns = max(w->max_ns, t);
+		cond_resched();
+	}
+
+	if (atomic_dec_and_test(&bench_running))
+		complete(&bench_done);
+
+	while (!kthread_should_stop())
+		schedule_timeout_interruptible(1);
+	return 0;
+}
+
+static int __init printk_test_init(void)
+{
+	u64 total = 0, max = 0;
+	int cpu, nr = 0;
+
+	if (nr_msgs <= 0 || level < 0 || level > 7)
+		return -EINVAL;
+
+	workers = kcalloc(nr_cpu_ids, sizeof(*workers), GFP_KERNEL);
+	if (!workers)
+		return -ENOMEM;
+
+	get_online_cpus();
+	atomic_set(&bench_running, 1);
+	for_each_online_cpu(cpu) {
+		workers[cpu].cpu = cpu;
+		workers[cpu].task = kthread_create_on_node(bench_thread,
+					&workers[cpu], cpu_to_node(cpu),
+					"printk_test/%d", cpu);
+		if (IS_ERR(workers[cpu].task)) {
+			workers[cpu].task = NULL;
+			continue;
+		}
+		kthread_bind(workers[cpu].task, cpu);
+		atomic_inc(&bench_running);
+		wake_up_process(workers[cpu].task);
+	}
+	if (!atomic_dec_and_test(&bench_running))
+		wait_for_completion(&bench_done);
+
+	for_each_online_cpu(cpu) {
+		if (!workers[cpu].task)
+			continue;
+		kthread_stop(workers[cpu].task);
+		total += workers[cpu].total_ns;
+		max = max(max, workers[cpu].max_ns);
+		nr++;
+	}
+	put_online_cpus();
+
+	if (nr)
+		pr_alert("printk test: %d cpus, %d messages each%s: avg %llu ns, max %llu ns per printk\n",
+			 nr, nr_msgs, irqs_off ? ", irqs off" : "",
+			 div64_u64(total, (u64)nr * nr_msgs), max);
+
+	kfree(workers);
+	return -EAGAIN; /* Fail will directly unload the module */
+}
+
+static void __exit printk_test_exit(void)
+{
+	printk(KERN_ALERT "test exit\n");
+}
+
+module_init(printk_test_init)
+module_exit(printk_test_exit)
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("printk caller latency benchmark");
@@ -0,0 +1,147 @@
+/*
+ * Spinlock contention benchmark.
+ *
+ * One kthread per online CPU hammers a single spinlock. The critical
+ * section writes a few cache lines of shared data, as a lock protecting a
+ * small structure would. Reported are the total acquisitions per second,
+ * the spread between the fastest and slowest CPU, and how often the lock
+ * moved to a CPU of another cluster, which is what the cluster aware
+ * queued spinlock handoff is meant to reduce.
+ */
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/kthread.h>
+#include <linux/spinlock.h>
+#include <linux/delay.h>
+#include <linux/slab.h>
+#include <linux/cpu.h>
+#include <linux/topology.h>
+#include <linux/ktime.h>
+
+#define __param(type, name, init, msg)		\
+	static type name = init;		\
+	module_param(name, type, 0444);		\
+	MODULE_PARM_DESC(name, msg);
+
+__param(int, duration_ms, 1000, "Length of the run in milliseconds");
+__param(int, cs_lines, 2, "Cache lines written inside the critical section");
+__param(int, think_loops, 10, "cpu_relax() loops between acquisitions");
+
+#define MAX_CS_LINES	16
+
+static DEFINE_SPINLOCK(bench_lock);
+
+static struct {
+	int last_cluster;
+	unsigned long cross_cluster;
+	unsigned long lines[MAX_CS_LINES][L1_CACHE_BYTES / sizeof(long)];
+} bench_data ____cacheline_aligned_in_smp;
+
+struct bench_worker {
+	struct task_struct *task;
+	unsigned long acquired;
+};
+
+static struct bench_worker *workers;
+static atomic_t bench_ready;
+static int bench_stop;
+
+static int bench_thread(void *arg)
+{
+	struct bench_worker *w = arg;
+	int cluster = topology_physical_package_id(raw_smp_processor_id());
+	int i;
+
+	atomic_inc(&bench_ready);
+	while (atomic_read(&bench_ready) < num_online_cpus())
+		cond_resched();
+
+	while (!ACCESS_ONCE(bench_stop)) {
+		spin_lock(&bench_lock);
+		if (bench_data.last_cluster != cluster) {
+			bench_data.cross_cluster++;
+			bench_data.last_cluster = cluster;
+		}
+		for (i = 0; i < cs_lines; i++)
+			bench_data.lines[i][0]++;
+		spin_unlock(&bench_lock);
+		w->acquired++;
+
+		for (i = 0; i < think_loops; i++)
+			cpu_relax();
+		/* Let the module loader on this CPU end the run */
+		cond_resched();
+	}
+
+	while (!kthread_should_stop())
+		schedule_timeout_interruptible(1);
+	return 0;
+}
+
+static int __init spinlock_test_init(void)
+{
+	unsigned long total = 0, max = 0, min = ULONG_MAX;
+	int cpu, nr = 0;
+	s64 elapsed;
+	ktime_t start;
+
+	if (cs_lines < 0 || cs_lines > MAX_CS_LINES || duration_ms <= 0)
+		return -EINVAL;
+
+	workers = kcalloc(nr_cpu_ids, sizeof(*workers), GFP_KERNEL);
+	if (!workers)
+		return -ENOMEM;
+
+	get_online_cpus();
+	bench_data.last_cluster = -1;
+	atomic_set(&bench_ready, 0);
+	for_each_online_cpu(cpu) {
+		workers[cpu].task = kthread_create_on_node(bench_thread,
+					&workers[cpu], cpu_to_node(cpu),
+					"spinlock_test/%d", cpu);
+		if (IS_ERR(workers[cpu].task)) {
+			workers[cpu].task = NULL;
+			/* let the others start, they wait for all CPUs */
+			atomic_inc(&bench_ready);
+			continue;
+		}
+		kthread_bind(workers[cpu].task, cpu);
+		wake_up_process(workers[cpu].task);
+	}
+
+	start = ktime_get();
+	msleep(duration_ms);
+	ACCESS_ONCE(bench_stop) = 1;
+	elapsed = ktime_us_delta(ktime_get(), start);
+
+	for_each_online_cpu(cpu) {
+		if (!workers[cpu].task)
+			continue;
+		kthread_stop(workers[cpu].task);
+		total += workers[cpu].acquired;
+		max = max(max, workers[cpu].acquired);
+		min = min(min, workers[cpu].acquired);
+		nr++;
+	}
+	put_online_cpus();
+
+	if (nr)
+		pr_alert("spinlock test: %d cpus: %llu acquisitions/s, per cpu max/min %lu/%lu, %lu cross-cluster handoffs (%lu per 1000)\n",
+			 nr, div64_s64((s64)total * USEC_PER_SEC, elapsed),
+			 max, min, bench_data.cross_cluster,
+			 total ? bench_data.cross_cluster * 1000 / total : 0);
+
+	kfree(workers);
+	return -EAGAIN; /* Fail will directly unload the module */
+}
+
+static void __exit spinlock_test_exit(void)
+{
+	printk(KERN_ALERT "test exit\n");
+}
+
+module_init(spinlock_test_init)
+module_exit(spinlock_test_exit)
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Spinlock contention benchmark");
@@ -35,6 +35,7 @@
 #include <linux/memcontrol.h>
 #include <linux/cleancache.h>
 #include <linux/rmap.h>
+#include <linux/delayacct.h>
 #include "internal.h"
 
 #define CREATE_TRACE_POINTS
@@ -678,25 +679,51 @@ wait_queue_head_t *page_waitqueue(struct page *page)
 }
 EXPORT_SYMBOL(page_waitqueue);
 
+/*
+ * A page cache page that the workingset code found to be refaulting is
+ * activated before it is read back in (see add_to_page_cache_lru), so
+ * waiting for such a page to be unlocked is time lost to thrashing.
+ */
+static inline bool page_thrashing(struct page *page, int bit_nr)
+{
+	return bit_nr == PG_locked && PageActive(page) && !PageUptodate(page);
+}
+
 void wait_on_page_bit(struct page *page, int bit_nr)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, bit_nr);
+	bool thrashing;
 
-	if (test_bit(bit_nr, &page->flags))
-		__wait_on_bit(page_waitqueue(page), &wait, bit_wait_io,
+	if (!test_bit(bit_nr, &page->flags))
+		return;
+
+	thrashing = page_thrashing(page, bit_nr);
+	if (thrashing)
+		delayacct_thrashing_start();
+	__wait_on_bit(page_waitqueue(page), &wait, bit_wait_io,
 							TASK_UNINTERRUPTIBLE);
+	if (thrashing)
+		delayacct_thrashing_end();
 }
 EXPORT_SYMBOL(wait_on_page_bit);
 
 int wait_on_page_bit_killable(struct page *page, int bit_nr)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, bit_nr);
+	bool thrashing;
+	int ret;
 
 	if (!test_bit(bit_nr, &page->flags))
 		return 0;
 
-	return __wait_on_bit(page_waitqueue(page), &wait,
-			     bit_wait_io, TASK_KILLABLE);
+	thrashing = page_thrashing(page, bit_nr);
+	if (thrashing)
+		delayacct_thrashing_start();
+	ret = __wait_on_bit(page_waitqueue(page), &wait,
+			    bit_wait_io, TASK_KILLABLE);
+	if (thrashing)
+		delayacct_thrashing_end();
+	return ret;
 }
 
 int wait_on_page_bit_killable_timeout(struct page *page,
@@ -809,18 +836,30 @@ EXPORT_SYMBOL_GPL(page_endio);
 void __lock_page(struct page *page)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, PG_locked);
+	bool thrashing = page_thrashing(page, PG_locked);
 
+	if (thrashing)
+		delayacct_thrashing_start();
 	__wait_on_bit_lock(page_waitqueue(page), &wait, bit_wait_io,
 							TASK_UNINTERRUPTIBLE);
+	if (thrashing)
+		delayacct_thrashing_end();
 }
 EXPORT_SYMBOL(__lock_page);
 
 int __lock_page_killable(struct page *page)
 {
 	DEFINE_WAIT_BIT(wait, &page->flags, PG_locked);
+	bool thrashing = page_thrashing(page, PG_locked);
+	int ret;
 
-	return __wait_on_bit_lock(page_waitqueue(page), &wait,
+	if (thrashing)
+		delayacct_thrashing_start();
+	ret = __wait_on_bit_lock(page_waitqueue(page), &wait,
 					bit_wait_io, TASK_KILLABLE);
+	if (thrashing)
+		delayacct_thrashing_end();
+	return ret;
 }
 EXPORT_SYMBOL_GPL(__lock_page_killable);
 
@@ -216,6 +216,9 @@ struct page *follow_page_mask(struct vm_area_struct *vma,
 		} else
 			spin_unlock(ptl);
 	}
+	/* let the fault unshare a PTE table shared by lazy fork */
+	if ((flags & FOLL_WRITE) && pmd_table_shared(*pmd))
+		return no_page_table(vma, flags);
 	return follow_page_pte(vma, address, pmd, flags);
 }
 
@@ -898,6 +901,9 @@ static int gup_pmd_range(pud_t pud, unsigned long addr, unsigned long end,
 				pages, nr))
 				return 0;
 
+		} else if (write && pmd_table_shared(pmd)) {
+			/* the slowpath unshares PTE tables shared by lazy fork */
+			return 0;
 		} else if (!gup_pte_range(pmd, addr, next, write, pages, nr))
 				return 0;
 	} while (pmdp++, addr = next, addr != end);
@@ -2471,7 +2471,7 @@ static void collapse_huge_page(struct mm_struct *mm,
 	if (!hugepage_vma_check(vma))
 		goto out;
 	pmd = mm_find_pmd(mm, address);
-	if (!pmd)
+	if (!pmd || pmd_table_shared(*pmd))
 		goto out;
 
 	anon_vma_lock_write(vma->anon_vma);
@@ -2571,7 +2571,8 @@ static int khugepaged_scan_pmd(struct mm_struct *mm,
 	VM_BUG_ON(address & ~HPAGE_PMD_MASK);
 
 	pmd = mm_find_pmd(mm, address);
-	if (!pmd)
+	/* a PTE table shared by lazy fork is not collapsed */
+	if (!pmd || pmd_table_shared(*pmd))
 		goto out;
 
 	memset(khugepaged_node_load, 0, sizeof(khugepaged_node_load));
@@ -93,6 +93,17 @@ static long madvise_behavior(struct vm_area_struct *vma,
 		if (error)
 			goto out;
 		break;
+	case MADV_SHARE_PGTABLE:
+		/* only private file mappings: see pgtable_share_vma() */
+		if (!vma->vm_file || (vma->vm_flags & VM_SHARED)) {
+			error = -EINVAL;
+			goto out;
+		}
+		new_flags |= VM_SHARE_PGTABLE;
+		break;
+	case MADV_NOSHARE_PGTABLE:
+		new_flags &= ~VM_SHARE_PGTABLE;
+		break;
 	}
 
 	if (new_flags == vma->vm_flags) {
@@ -407,6 +418,10 @@ madvise_behavior_valid(int behavior)
 #ifdef CONFIG_TRANSPARENT_HUGEPAGE
 	case MADV_HUGEPAGE:
 	case MADV_NOHUGEPAGE:
+#endif
+#ifdef CONFIG_LAZY_FORK
+	case MADV_SHARE_PGTABLE:
+	case MADV_NOSHARE_PGTABLE:
 #endif
 	case MADV_DONTDUMP:
 	case MADV_DODUMP:
@@ -447,6 +462,10 @@ madvise_behavior_valid(int behavior)
  *  MADV_MERGEABLE - the application recommends that KSM try to merge pages in
  *		this area with pages of identical content from other such areas.
  *  MADV_UNMERGEABLE- cancel MADV_MERGEABLE: no longer merge pages with others.
+ *  MADV_SHARE_PGTABLE - let children forked from now on share the page
+ *		tables of this read-only private file mapping until they
+ *		fault on it, rather than each faulting it in again.
+ *  MADV_NOSHARE_PGTABLE - cancel MADV_SHARE_PGTABLE.
  *
  * return values:
  *  zero    - success
@@ -61,6 +61,7 @@
 #include <linux/string.h>
 #include <linux/dma-debug.h>
 #include <linux/debugfs.h>
+#include <linux/backing-dev.h>
 
 #include <asm/io.h>
 #include <asm/pgalloc.h>
@@ -947,12 +948,364 @@ again:
 	return 0;
 }
 
+#ifdef CONFIG_LAZY_FORK
+/*
+ * Lazy fork: rather than copying the ptes of a pmd lying entirely in a
+ * private anonymous vma, the child points its pmd at the parent's PTE
+ * table and both pmds write-protect everything below them with
+ * pmd_table_wrprotect().  Read-only private file mappings marked with
+ * MADV_SHARE_PGTABLE are shared the same way by every fork, so that all
+ * the processes forked from one parent (zygote) keep using its tables
+ * for the libraries they all map instead of faulting them in again.
+ * The refcount of the table page counts the mms sharing it, as
+ * huge_pmd_share() does for hugetlb.  The first fault on a shared pmd
+ * gives the faulting mm a private copy, taking the page and swap
+ * references copy_pte_range() would have taken at fork.
+ *
+ * Until then the pages a shared table maps hold one mapcount for all
+ * its sharers; only rss is accounted to each mm.  smaps splits their
+ * Pss by the table refcount instead.
+ *
+ * A shared table is never modified other than to write-protect its ptes:
+ * gup and khugepaged leave it alone, and rmap_walk() unshares it before
+ * reclaim or migration touch the pages it maps.  Nor is it ever freed
+ * while shared: the last mm holding it makes it private again in place.
+ */
+static bool pgtable_share_vma(struct mm_struct *mm, struct vm_area_struct *vma)
+{
+	/* secondary MMUs would not see the table write protection */
+	if (mm_has_notifiers(mm) || !is_cow_mapping(vma->vm_flags))
+		return false;
+	if (vma->vm_flags & (VM_HUGETLB | VM_NONLINEAR | VM_PFNMAP |
+			     VM_MIXEDMAP | VM_IO | VM_LOCKED | VM_MERGEABLE))
+		return false;
+	/* every normal page of such a vma is a page cache page */
+	if (vma->vm_file)
+		return (vma->vm_flags & VM_SHARE_PGTABLE) &&
+		       !(vma->vm_flags & VM_WRITE) && !vma->anon_vma;
+	/* every normal page of such a vma is an anonymous page */
+	return !vma->vm_ops && test_bit(MMF_LAZY_FORK, &mm->flags);
+}
+
+/*
+ * Add up what the ptes of a whole table contribute to rss.  Returns false
+ * on a migration or hwpoison entry, which keep a table from being shared.
+ */
+static bool count_pte_table(struct vm_area_struct *vma, unsigned long addr,
+			    pte_t *pte, int *rss)
+{
+	int member = vma->vm_file ? MM_FILEPAGES : MM_ANONPAGES;
+	int i;
+
+	for (i = 0; i < PTRS_PER_PTE; i++, pte++, addr += PAGE_SIZE) {
+		pte_t ptent = *pte;
+
+		if (pte_none(ptent))
+			continue;
+		if (pte_present(ptent)) {
+			if (vm_normal_page(vma, addr, ptent))
+				rss[member]++;
+			continue;
+		}
+		if (pte_file(ptent) || non_swap_entry(pte_to_swp_entry(ptent)))
+			return false;
+		rss[MM_SWAPENTS]++;
+	}
+	return true;
+}
+
+static bool share_pte_table(struct mm_struct *dst_mm, struct mm_struct *src_mm,
+			    pmd_t *dst_pmd, pmd_t *src_pmd,
+			    struct vm_area_struct *vma, unsigned long addr)
+{
+	int rss[NR_MM_COUNTERS];
+	spinlock_t *ptl;
+	pte_t *pte;
+	bool shared;
+
+	init_rss_vec(rss);
+	pte = pte_offset_map(src_pmd, addr);
+	ptl = pte_lockptr(src_mm, src_pmd);
+	spin_lock(ptl);
+	shared = count_pte_table(vma, addr, pte, rss);
+	if (shared) {
+		get_page(pmd_page(*src_pmd));
+		inc_zone_page_state(pmd_page(*src_pmd), NR_SHARED_PAGETABLE);
+		set_pmd(src_pmd, pmd_table_wrprotect(*src_pmd));
+		set_pmd(dst_pmd, *src_pmd);
+	}
+	spin_unlock(ptl);
+	pte_unmap(pte);
+	if (!shared)
+		return false;
+
+	count_vm_event(PGTABLE_SHARE);
+	/* the child would have faulted these in */
+	count_vm_events(PGTABLE_SHARE_FAULT_AVOIDED, rss[MM_FILEPAGES]);
+	atomic_long_inc(&dst_mm->nr_ptes);
+	add_mm_rss_vec(dst_mm, rss);
+	/* make sure dst_mm is on swapoff's mmlist. */
+	if (rss[MM_SWAPENTS] && unlikely(list_empty(&dst_mm->mmlist))) {
+		spin_lock(&mmlist_lock);
+		if (list_empty(&dst_mm->mmlist))
+			list_add(&dst_mm->mmlist, &src_mm->mmlist);
+		spin_unlock(&mmlist_lock);
+	}
+	return true;
+}
+
+/*
+ * Drop the references a private copy of a shared table took on
+ * [addr, end), and free it.
+ */
+static void free_pte_copy(struct mm_struct *mm, struct vm_area_struct *vma,
+			  pgtable_t table, unsigned long addr, unsigned long end)
+{
+	pte_t *start_pte, *pte;
+
+	start_pte = kmap_atomic(table);
+	pte = start_pte + pte_index(addr);
+	for (; addr != end; pte++, addr += PAGE_SIZE) {
+		pte_t ptent = *pte;
+		struct page *page;
+
+		if (pte_none(ptent))
+			continue;
+		if (pte_present(ptent)) {
+			page = vm_normal_page(vma, addr, ptent);
+			if (page) {
+				page_remove_rmap(page);
+				put_page(page);
+			}
+		} else {
+			free_swap_and_cache(pte_to_swp_entry(ptent));
+		}
+		pte_clear(mm, addr, pte);
+	}
+	kunmap_atomic(start_pte);
+	pte_free(mm, table);
+}
+
+static pgtable_t alloc_pte_copy(gfp_t gfp)
+{
+	struct page *table;
+
+	table = alloc_page(gfp | __GFP_NOTRACK | __GFP_ZERO);
+	if (table && !pgtable_page_ctor(table)) {
+		__free_page(table);
+		table = NULL;
+	}
+	return table;
+}
+
+/**
+ * unshare_pte_table - give @vma's mm a private copy of a shared PTE table
+ * @vma: vma the shared table maps
+ * @pmd: pmd pointing to the table
+ * @address: any address the table maps
+ * @gfp: allocation flags for the copy; __GFP_NOFAIL retries until it
+ *	 can be allocated
+ *
+ * The ptes of both copies are left write-protected, so that the pages
+ * they map are COWed on the next write.  Returns -ENOMEM if a table or
+ * a swap count continuation could not be allocated.
+ */
+int unshare_pte_table(struct vm_area_struct *vma, pmd_t *pmd,
+		      unsigned long address, gfp_t gfp)
+{
+	bool nofail = gfp & __GFP_NOFAIL;
+	struct mm_struct *mm = vma->vm_mm;
+	unsigned long start = address & PMD_MASK;
+	unsigned long end = start + PMD_SIZE;
+	unsigned long addr = start;
+	int rss[NR_MM_COUNTERS];
+	pgtable_t new = NULL;
+	pte_t *orig_src, *orig_dst;
+	spinlock_t *ptl, *tptl;
+	struct page *table;
+	pte_t *src, *dst;
+	swp_entry_t entry;
+	pmd_t orig;
+
+again:
+	ptl = pmd_lock(mm, pmd);
+	orig = *pmd;
+	if (!pmd_table_shared(orig)) {
+		/* unshared by another thread meanwhile */
+		spin_unlock(ptl);
+		if (new)
+			free_pte_copy(mm, vma, new, start, addr);
+		return 0;
+	}
+	table = pmd_page(orig);
+	if (page_count(table) == 1) {
+		set_pmd(pmd, pmd_table_mkwrite(orig));
+		spin_unlock(ptl);
+		if (new)
+			free_pte_copy(mm, vma, new, start, addr);
+		goto flush;
+	}
+	if (!new) {
+		spin_unlock(ptl);
+		gfp &= ~__GFP_NOFAIL;
+		while (!(new = alloc_pte_copy(gfp))) {
+			if (!nofail)
+				return -ENOMEM;
+			congestion_wait(BLK_RW_ASYNC, HZ/50);
+		}
+		goto again;
+	}
+
+	tptl = pte_lockptr(mm, &orig);
+	if (tptl != ptl)
+		spin_lock_nested(tptl, SINGLE_DEPTH_NESTING);
+	orig_src = src = pte_offset_map(&orig, addr);
+	orig_dst = kmap_atomic(new);
+	dst = orig_dst + pte_index(addr);
+	entry.val = 0;
+	/* rss was accounted when the table was shared */
+	init_rss_vec(rss);
+	for (; addr != end; src++, dst++, addr += PAGE_SIZE) {
+		if (pte_none(*src))
+			continue;
+		entry.val = copy_one_pte(mm, mm, dst, src, vma, addr, rss);
+		if (entry.val)
+			break;
+	}
+	kunmap_atomic(orig_dst);
+	pte_unmap(orig_src);
+
+	if (entry.val) {
+		if (tptl != ptl)
+			spin_unlock(tptl);
+		spin_unlock(ptl);
+		while (add_swap_count_continuation(entry, gfp) < 0) {
+			if (!nofail) {
+				free_pte_copy(mm, vma, new, start, addr);
+				return -ENOMEM;
+			}
+			congestion_wait(BLK_RW_ASYNC, HZ/50);
+		}
+		goto again;
+	}
+
+	if (atomic_add_unless(&table->_count, -1, 1)) {
+		dec_zone_page_state(table, NR_SHARED_PAGETABLE);
+		count_vm_event(PGTABLE_UNSHARE);
+		smp_wmb(); /* See comment in __pte_alloc */
+		pmd_populate(mm, pmd, new);
+		new = NULL;
+	} else {
+		/* everybody else let go of it while we copied */
+		set_pmd(pmd, pmd_table_mkwrite(orig));
+	}
+	if (tptl != ptl)
+		spin_unlock(tptl);
+	spin_unlock(ptl);
+	if (new)
+		free_pte_copy(mm, vma, new, start, end);
+flush:
+	flush_tlb_range(vma, start, end);
+	return 0;
+}
+
+/*
+ * Drop a shared table from the mm being unmapped.  Returns false if the
+ * table is private again and is to be zapped as usual.
+ */
+static bool zap_shared_pte_table(struct mmu_gather *tlb,
+				 struct vm_area_struct *vma, pmd_t *pmd,
+				 unsigned long addr, unsigned long end)
+{
+	struct mm_struct *mm = tlb->mm;
+	int rss[NR_MM_COUNTERS];
+	struct page *table;
+	spinlock_t *ptl;
+	pte_t *pte;
+	pmd_t orig;
+	int i;
+
+	/*
+	 * Every vma goes away on exit, so the whole table can be dropped
+	 * as soon as one of them is zapped; otherwise only a table lying
+	 * entirely in the range can be, the rest must be unshared first.
+	 *
+	 * unmap_mapping_range() gets here with i_mmap_mutex held, which
+	 * reclaim may take again, so the copy of a file table must not
+	 * enter reclaim.  Such a table maps nothing but page cache: if it
+	 * cannot be copied, drop all of it and let the rest refault.
+	 */
+	if (end - addr != PMD_SIZE && !tlb->fullmm) {
+		if (!vma->vm_file) {
+			unshare_pte_table(vma, pmd, addr,
+					  GFP_KERNEL | __GFP_NOFAIL);
+			return false;
+		}
+		if (!unshare_pte_table(vma, pmd, addr,
+				       GFP_NOWAIT | __GFP_NOWARN))
+			return false;
+	}
+	addr &= PMD_MASK;
+
+	init_rss_vec(rss);
+	ptl = pmd_lock(mm, pmd);
+	orig = *pmd;
+	if (!pmd_table_shared(orig)) {
+		spin_unlock(ptl);
+		return false;
+	}
+	table = pmd_page(orig);
+	pte = pte_offset_map(&orig, addr);
+	count_pte_table(vma, addr, pte, rss);
+	pte_unmap(pte);
+	if (!atomic_add_unless(&table->_count, -1, 1)) {
+		set_pmd(pmd, pmd_table_mkwrite(orig));
+		spin_unlock(ptl);
+		return false;
+	}
+	dec_zone_page_state(table, NR_SHARED_PAGETABLE);
+	pmd_clear(pmd);
+	spin_unlock(ptl);
+
+	atomic_long_dec(&mm->nr_ptes);
+	for (i = 0; i < NR_MM_COUNTERS; i++)
+		rss[i] = -rss[i];
+	add_mm_rss_vec(mm, rss);
+	if (!tlb->fullmm)
+		flush_tlb_range(vma, addr, addr + PMD_SIZE);
+	return true;
+}
+#else
+static inline bool pgtable_share_vma(struct mm_struct *mm,
+				     struct vm_area_struct *vma)
+{
+	return false;
+}
+
+static inline bool share_pte_table(struct mm_struct *dst_mm,
+				   struct mm_struct *src_mm,
+				   pmd_t *dst_pmd, pmd_t *src_pmd,
+				   struct vm_area_struct *vma,
+				   unsigned long addr)
+{
+	return false;
+}
+
+static inline bool zap_shared_pte_table(struct mmu_gather *tlb,
+					struct vm_area_struct *vma, pmd_t *pmd,
+					unsigned long addr, unsigned long end)
+{
+	return false;
+}
+#endif /* CONFIG_LAZY_FORK */
+
 static inline int copy_pmd_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 		pud_t *dst_pud, pud_t *src_pud, struct vm_area_struct *vma,
 		unsigned long addr, unsigned long end)
 {
 	pmd_t *src_pmd, *dst_pmd;
 	unsigned long next;
+	bool share = pgtable_share_vma(src_mm, vma);
 
 	dst_pmd = pmd_alloc(dst_mm, dst_pud, addr);
 	if (!dst_pmd)
@@ -973,6 +1326,12 @@ static inline int copy_pmd_range(struct mm_struct *dst_mm, struct mm_struct *src
 		}
 		if (pmd_none_or_clear_bad(src_pmd))
 			continue;
+		if (share && next - addr == PMD_SIZE &&
+		    share_pte_table(dst_mm, src_mm, dst_pmd, src_pmd, vma, addr))
+			continue;
+		/* the rest of a file mapping is left to faults, see below */
+		if (!vma->anon_vma && share)
+			continue;
 		if (copy_pte_range(dst_mm, src_mm, dst_pmd, src_pmd,
 						vma, addr, next))
 			return -ENOMEM;
@@ -1022,7 +1381,7 @@ int copy_page_range(struct mm_struct *dst_mm, struct mm_struct *src_mm,
 	 */
 	if (!(vma->vm_flags & (VM_HUGETLB | VM_NONLINEAR |
 			       VM_PFNMAP | VM_MIXEDMAP))) {
-		if (!vma->anon_vma)
+		if (!vma->anon_vma && !pgtable_share_vma(src_mm, vma))
 			return 0;
 	}
 
@@ -1242,6 +1601,9 @@ static inline unsigned long zap_pmd_range(struct mmu_gather *tlb,
 		 */
 		if (pmd_none_or_trans_huge_or_clear_bad(pmd))
 			goto next;
+		if (pmd_table_shared(*pmd) &&
+		    zap_shared_pte_table(tlb, vma, pmd, addr, next))
+			goto next;
 		next = zap_pte_range(tlb, vma, pmd, addr, next, details);
 next:
 		cond_resched();
@@ -3298,6 +3660,10 @@ static int __handle_mm_fault(struct mm_struct *mm, struct vm_area_struct *vma,
 	 */
 	if (unlikely(pmd_trans_unstable(pmd)))
 		return 0;
+	/* A PTE table shared by lazy fork is copied on the first fault */
+	if (unlikely(pmd_table_shared(*pmd)) &&
+	    unshare_pte_table(vma, pmd, address, GFP_KERNEL))
+		return VM_FAULT_OOM;
 	/*
 	 * A regular pmd is established and it can't morph into a huge pmd
 	 * from under us anymore at this point because we hold the mmap_sem
@@ -174,6 +174,13 @@ static inline unsigned long change_pmd_range(struct vm_area_struct *vma,
 			}
 			/* fall through, the trans huge pmd just split */
 		}
+		if (pmd_table_shared(*pmd)) {
+			/* NUMA hinting can wait for the table to be unshared */
+			if (prot_numa)
+				continue;
+			unshare_pte_table(vma, pmd, addr,
+					  GFP_KERNEL | __GFP_NOFAIL);
+		}
 		this_pages = change_pte_range(vma, pmd, addr, next, newprot,
 				 dirty_accountable, prot_numa);
 		pages += this_pages;
@@ -228,6 +228,12 @@ unsigned long move_page_tables(struct vm_area_struct *vma,
 			}
 			VM_BUG_ON(pmd_trans_huge(*old_pmd));
 		}
+		if (pmd_table_shared(*old_pmd) &&
+		    unshare_pte_table(vma, old_pmd, old_addr, GFP_KERNEL))
+			break;
+		if (pmd_table_shared(*new_pmd) &&
+		    unshare_pte_table(new_vma, new_pmd, new_addr, GFP_KERNEL))
+			break;
 		if (pmd_none(*new_pmd) && __pte_alloc(new_vma->vm_mm, new_vma,
 						      new_pmd, new_addr))
 			break;
@@ -649,7 +649,8 @@ out:
 pte_t *__page_check_address(struct page *page, struct mm_struct *mm,
 			  unsigned long address, spinlock_t **ptlp, int sync)
 {
-	pmd_t *pmd;
+	pmd_t *pmd = NULL;
+	pmd_t pmde;
 	pte_t *pte;
 	spinlock_t *ptl;
 
@@ -667,20 +668,29 @@ pte_t *__page_check_address(struct page *page, struct mm_struct *mm,
 	if (!pmd)
 		return NULL;
 
-	pte = pte_offset_map(pmd, address);
+	/* rmap_walk() unshares PTE tables shared by lazy fork first */
+	pmde = ACCESS_ONCE(*pmd);
+	if (pmd_table_shared(pmde))
+		return NULL;
+
+	pte = pte_offset_map(&pmde, address);
 	/* Make a quick check before getting the lock */
 	if (!sync && !pte_present(*pte)) {
 		pte_unmap(pte);
 		return NULL;
 	}
 
-	ptl = pte_lockptr(mm, pmd);
+	ptl = pte_lockptr(mm, &pmde);
 check:
 	spin_lock(ptl);
+	/* fork may have shared the table before we got the lock */
+	if (pmd && unlikely(pmd_val(*pmd) != pmd_val(pmde)))
+		goto out;
 	if (pte_present(*pte) && page_to_pfn(page) == pte_pfn(*pte)) {
 		*ptlp = ptl;
 		return pte;
 	}
+out:
 	pte_unmap_unlock(pte, ptl);
 	return NULL;
 }
@@ -1671,6 +1681,36 @@ static struct anon_vma *rmap_walk_anon_lock(struct page *page,
 	return anon_vma;
 }
 
+#ifdef CONFIG_LAZY_FORK
+/*
+ * __page_check_address() does not look into a PTE table shared by lazy
+ * fork, so give @vma's mm its own copy of the table before the walk
+ * visits it: otherwise a page mapped by a shared table could be neither
+ * reclaimed nor migrated until every sharer faulted on the table.
+ *
+ * The walk holds the anon_vma or i_mmap lock, which reclaim may need to
+ * take again, so the copy is allocated without entering reclaim or
+ * dipping into the reserves.  If that fails, the mapping is skipped as
+ * before.
+ */
+static void rmap_unshare_pte_table(struct vm_area_struct *vma,
+				   unsigned long address)
+{
+	pmd_t *pmd;
+
+	pmd = mm_find_pmd(vma->vm_mm, address);
+	if (!pmd || !pmd_table_shared(ACCESS_ONCE(*pmd)))
+		return;
+
+	unshare_pte_table(vma, pmd, address, GFP_NOWAIT | __GFP_NOWARN);
+}
+#else
+static inline void rmap_unshare_pte_table(struct vm_area_struct *vma,
+					  unsigned long address)
+{
+}
+#endif
+
 /*
  * rmap_walk_anon - do something to anonymous page using the object-based
  * rmap method
@@ -1694,6 +1734,7 @@ static int rmap_walk_anon(struct page *page, struct rmap_walk_control *rwc)
 
        if (rwc->target_vma) {
                unsigned long address = vma_address(page, rwc->target_vma);
+               rmap_unshare_pte_table(rwc->target_vma, address);
                return rwc->rmap_one(page, rwc->target_vma, address, rwc->arg);
        }
 
@@ -1708,6 +1749,7 @@ static int rmap_walk_anon(struct page *page, struct rmap_walk_control *rwc)
 		if (rwc->invalid_vma && rwc->invalid_vma(vma, rwc->arg))
 			continue;
 
+		rmap_unshare_pte_table(vma, address);
 		ret = rwc->rmap_one(page, vma, address, rwc->arg);
 		if (ret != SWAP_AGAIN)
 			break;
@@ -1755,6 +1797,7 @@ static int rmap_walk_file(struct page *page, struct rmap_walk_control *rwc)
                if (unlikely(!list_empty(&mapping->i_mmap_nonlinear)))
                         goto done;
                address = vma_address(page, rwc->target_vma);
+               rmap_unshare_pte_table(rwc->target_vma, address);
                ret = rwc->rmap_one(page, rwc->target_vma, address, rwc->arg);
                goto done;
 	}
@@ -1765,6 +1808,7 @@ static int rmap_walk_file(struct page *page, struct rmap_walk_control *rwc)
 		if (rwc->invalid_vma && rwc->invalid_vma(vma, rwc->arg))
 			continue;
 
+		rmap_unshare_pte_table(vma, address);
 		ret = rwc->rmap_one(page, vma, address, rwc->arg);
 		if (ret != SWAP_AGAIN)
 			goto done;
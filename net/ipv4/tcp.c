@@ -394,6 +394,7 @@ void tcp_init_sock(struct sock *sk)
 
 	icsk->icsk_rto = TCP_TIMEOUT_INIT;
 	tp->mdev_us = jiffies_to_usecs(TCP_TIMEOUT_INIT);
+	minmax_reset(&tp->rtt_min, tcp_time_stamp, ~0U);
 
 	/* So many TCP implementations out there (incorrectly) count the
 	 * initial SYN frame in their delayed-ACK and congestion control
@@ -413,6 +414,8 @@ void tcp_init_sock(struct sock *sk)
 	tcp_enable_early_retrans(tp);
 	tcp_assign_congestion_control(sk);
 
+	tp->app_limited = ~0U;
+
 	tp->tsoffset = 0;
 
 	sk->sk_state = TCP_CLOSE;
@@ -869,6 +872,14 @@ static unsigned int tcp_xmit_size_goal(struct sock *sk, u32 mss_now,
 		gso_size = max_t(u32, gso_size,
 				 sysctl_tcp_min_tso_segs * mss_now);
 
+		/* Congestion control may have its own idea of skb size */
+		if (inet_csk(sk)->icsk_ca_ops->tso_segs_goal) {
+			u32 segs = inet_csk(sk)->icsk_ca_ops->tso_segs_goal(sk);
+
+			if (segs)
+				gso_size = segs * mss_now;
+		}
+
 		xmit_size_goal = min_t(u32, gso_size,
 				       sk->sk_gso_max_size - 1 - hlen);
 
@@ -922,6 +933,8 @@ static ssize_t do_tcp_sendpages(struct sock *sk, struct page *page, int offset,
 
 	clear_bit(SOCK_ASYNC_NOSPACE, &sk->sk_socket->flags);
 
+	tcp_rate_check_app_limited(sk);  /* is sending application-limited? */
+
 	mss_now = tcp_send_mss(sk, &size_goal, flags);
 	copied = 0;
 
@@ -1149,6 +1162,8 @@ int tcp_sendmsg(struct kiocb *iocb, struct sock *sk, struct msghdr *msg,
 	/* This should be in poll */
 	clear_bit(SOCK_ASYNC_NOSPACE, &sk->sk_socket->flags);
 
+	tcp_rate_check_app_limited(sk);  /* is sending application-limited? */
+
 	mss_now = tcp_send_mss(sk, &size_goal, flags);
 
 	/* Ok commence sending. */
@@ -8,6 +8,7 @@
  *	2 of the License, or (at your option) any later version.
  *
  *	UDPv4 GSO support
+ *	UDP payload segmentation (UDP_SEGMENT) and aggregation (UDP_GRO)
  */
 
 #include <linux/skbuff.h>
@@ -142,6 +143,89 @@ out_unlock:
 	return segs;
 }
 
+/* Split a UDP_SEGMENT skb built by udp_sendmsg() into gso_size datagrams,
+ * each with its own UDP header. The last datagram may be shorter.
+ */
+static struct sk_buff *__udp_gso_segment(struct sk_buff *gso_skb,
+					 netdev_features_t features)
+{
+	struct sk_buff *segs = ERR_PTR(-EINVAL);
+	unsigned int sum_truesize = 0;
+	struct sk_buff *skb;
+	struct udphdr *uh;
+	unsigned int oldlen;
+	unsigned int mss;
+	__sum16 newcheck;
+	bool copy_destructor;
+	__be32 delta;
+
+	if (!pskb_may_pull(gso_skb, sizeof(*uh)))
+		goto out;
+
+	oldlen = (u16)~gso_skb->len;
+	__skb_pull(gso_skb, sizeof(*uh));
+
+	mss = skb_shinfo(gso_skb)->gso_size;
+	if (unlikely(gso_skb->len <= mss))
+		goto out;
+
+	copy_destructor = gso_skb->destructor == sock_wfree;
+
+	segs = skb_segment(gso_skb, features);
+	if (IS_ERR_OR_NULL(segs))
+		goto out;
+
+	skb = segs;
+	uh = udp_hdr(skb);
+
+	/* The pseudo header checksum still covers the original length,
+	 * adjust it for a full sized datagram.
+	 */
+	delta = htonl(oldlen + (sizeof(*uh) + mss));
+	newcheck = ~csum_fold((__force __wsum)((__force u32)uh->check +
+					       (__force u32)delta));
+
+	do {
+		uh->len = htons(sizeof(*uh) + mss);
+		uh->check = newcheck;
+
+		if (skb->ip_summed != CHECKSUM_PARTIAL)
+			uh->check = gso_make_checksum(skb, ~uh->check) ? :
+				    CSUM_MANGLED_0;
+
+		if (copy_destructor) {
+			skb->destructor = gso_skb->destructor;
+			skb->sk = gso_skb->sk;
+			sum_truesize += skb->truesize;
+		}
+		skb = skb->next;
+		uh = udp_hdr(skb);
+	} while (skb->next);
+
+	/* Hand the socket reference over to the last segment, so that send
+	 * buffer space is only released once all of them have left.
+	 */
+	if (copy_destructor) {
+		swap(gso_skb->sk, skb->sk);
+		swap(gso_skb->destructor, skb->destructor);
+		sum_truesize += skb->truesize;
+		atomic_add(sum_truesize - gso_skb->truesize,
+			   &skb->sk->sk_wmem_alloc);
+	}
+
+	/* last datagram can be shorter than gso_size */
+	uh->len = htons(skb_tail_pointer(skb) - skb_transport_header(skb) +
+			skb->data_len);
+	delta = htonl(oldlen + ntohs(uh->len));
+	uh->check = ~csum_fold((__force __wsum)((__force u32)uh->check +
+				(__force u32)delta));
+	if (skb->ip_summed != CHECKSUM_PARTIAL)
+		uh->check = gso_make_checksum(skb, ~uh->check) ? :
+			    CSUM_MANGLED_0;
+out:
+	return segs;
+}
+
 static struct sk_buff *udp4_ufo_fragment(struct sk_buff *skb,
 					 netdev_features_t features)
 {
@@ -158,6 +242,11 @@ static struct sk_buff *udp4_ufo_fragment(struct sk_buff *skb,
 		goto out;
 	}
 
+	if (skb_shinfo(skb)->gso_type & SKB_GSO_UDP_L4) {
+		segs = __udp_gso_segment(skb, features);
+		goto out;
+	}
+
 	if (!pskb_may_pull(skb, sizeof(struct udphdr)))
 		goto out;
 
@@ -315,6 +404,86 @@ out:
 	return pp;
 }
 
+/* Does the local socket for this datagram accept GRO aggregated skbs? */
+static bool udp4_gro_enabled(struct sk_buff *skb, const struct udphdr *uh)
+{
+	const struct iphdr *iph = skb_gro_network_header(skb);
+	struct sock *sk;
+	bool ret = false;
+
+	if (!static_key_false(&udp_gro_needed))
+		return false;
+
+	sk = __udp4_lib_lookup(dev_net(skb->dev), iph->saddr, uh->source,
+			       iph->daddr, uh->dest, skb->dev->ifindex,
+			       &udp_table);
+	if (sk) {
+		ret = udp_sk(sk)->gro_enabled;
+		sock_put(sk);
+	}
+	return ret;
+}
+
+#define UDP_GRO_CNT_MAX 64
+
+/* Coalesce datagrams of one flow into a single skb. All but the last
+ * datagram must have the same length, which becomes the gso_size reported
+ * to the receiving socket.
+ */
+static struct sk_buff **udp_gro_receive_segment(struct sk_buff **head,
+						struct sk_buff *skb,
+						struct udphdr *uh)
+{
+	struct sk_buff *p, **pp = NULL;
+	struct udphdr *uh2;
+	unsigned int ulen;
+
+	/* requires non zero csum, for symmetry with GSO */
+	if (!uh->check || NAPI_GRO_CB(skb)->flush) {
+		NAPI_GRO_CB(skb)->flush = 1;
+		return NULL;
+	}
+
+	/* Do not deal with padded or malicious packets, sorry ! */
+	ulen = ntohs(uh->len);
+	if (ulen <= sizeof(*uh) || ulen != skb_gro_len(skb)) {
+		NAPI_GRO_CB(skb)->flush = 1;
+		return NULL;
+	}
+
+	NAPI_GRO_CB(skb)->is_udp_l4 = 1;
+	skb_gro_pull(skb, sizeof(struct udphdr));
+	skb_gro_postpull_rcsum(skb, uh, sizeof(struct udphdr));
+
+	for (; (p = *head); head = &p->next) {
+		if (!NAPI_GRO_CB(p)->same_flow)
+			continue;
+
+		uh2 = udp_hdr(p);
+
+		/* Match ports only, as csum is always non zero */
+		if (*(u32 *)&uh->source != *(u32 *)&uh2->source) {
+			NAPI_GRO_CB(p)->same_flow = 0;
+			continue;
+		}
+
+		/* Terminate the flow on a datagram larger than the segment
+		 * size, after merging a shorter one, or if it grew "too much":
+		 * under small packet flood the GRO count could otherwise grow
+		 * a lot, leading to excessive truesize values.
+		 */
+		if (NAPI_GRO_CB(p)->flush || ulen > ntohs(uh2->len) ||
+		    skb_gro_receive(head, skb) || ulen != ntohs(uh2->len) ||
+		    NAPI_GRO_CB(*head)->count >= UDP_GRO_CNT_MAX)
+			pp = head;
+
+		return pp;
+	}
+
+	/* mismatch, but we never need to flush */
+	return NULL;
+}
+
 static struct sk_buff **udp4_gro_receive(struct sk_buff **head,
 					 struct sk_buff *skb)
 {
@@ -335,6 +504,8 @@ static struct sk_buff **udp4_gro_receive(struct sk_buff **head,
 					     inet_gro_compute_pseudo);
 skip:
 	NAPI_GRO_CB(skb)->is_ipv6 = 0;
+	if (udp4_gro_enabled(skb, uh))
+		return udp_gro_receive_segment(head, skb, uh);
 	return udp_gro_receive(head, skb, uh);
 
 flush:
@@ -369,6 +540,17 @@ int udp_gro_complete(struct sk_buff *skb, int nhoff)
 	return err;
 }
 
+static int udp_gro_complete_segment(struct sk_buff *skb, struct udphdr *uh)
+{
+	skb->csum_start = (unsigned char *)uh - skb->head;
+	skb->csum_offset = offsetof(struct udphdr, check);
+	skb->ip_summed = CHECKSUM_PARTIAL;
+
+	skb_shinfo(skb)->gso_segs = NAPI_GRO_CB(skb)->count;
+	skb_shinfo(skb)->gso_type |= SKB_GSO_UDP_L4;
+	return 0;
+}
+
 static int udp4_gro_complete(struct sk_buff *skb, int nhoff)
 {
 	const struct iphdr *iph = ip_hdr(skb);
@@ -378,6 +560,11 @@ static int udp4_gro_complete(struct sk_buff *skb, int nhoff)
 		uh->check = ~udp_v4_check(skb->len - nhoff, iph->saddr,
 					  iph->daddr, 0);
 
+	if (NAPI_GRO_CB(skb)->is_udp_l4) {
+		uh->len = htons(skb->len - nhoff);
+		return udp_gro_complete_segment(skb, uh);
+	}
+
 	return udp_gro_complete(skb, nhoff);
 }
 
@@ -479,6 +479,9 @@ try_again:
 		*addr_len = sizeof(*sin6);
 	}
 
+	if (udp_sk(sk)->gro_enabled)
+		udp_cmsg_recv(msg, sk, skb);
+
 	if (np->rxopt.all)
 		ip6_datagram_recv_common_ctl(sk, msg, skb);
 
@@ -1147,6 +1150,10 @@ do_udp_sendmsg:
 	if (up->pending == AF_INET)
 		return udp_sendmsg(iocb, sk, msg, len);
 
+	/* UDP_SEGMENT is only supported on the IPv4 send path */
+	if (up->gso_size)
+		return -EOPNOTSUPP;
+
 	/* Rough check on arithmetic overflow,
 	   better check is made in ip6_append_data().
 	   */
@@ -1221,6 +1228,16 @@ do_udp_sendmsg:
 	fl6.flowi6_uid = sk->sk_uid;
 
 	if (msg->msg_controllen) {
+		u16 gso_size = 0;
+
+		err = udp_cmsg_send(sk, msg, &gso_size);
+		if (err >= 0 && gso_size)
+			err = -EOPNOTSUPP;
+		if (err < 0) {
+			fl6_sock_release(flowlabel);
+			return err;
+		}
+
 		opt = &opt_space;
 		memset(opt, 0, sizeof(struct ipv6_txoptions));
 		opt->tot_len = sizeof(*opt);
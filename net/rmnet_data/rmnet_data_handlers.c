@@ -27,6 +27,7 @@
 #include "rmnet_data_vnd.h"
 #include "rmnet_map.h"
 #include "rmnet_data_stats.h"
+#include "rmnet_data_steer.h"
 #include "rmnet_data_trace.h"
 
 RMNET_LOG_MODULE(RMNET_DATA_LOGMASK_HANDLER);
@@ -251,6 +252,33 @@ static void rmnet_optional_gro_flush(struct napi_struct *napi,
 	}
 }
 
+/**
+ * rmnet_rx_deliver() - Hand a packet to the network stack
+ * @napi:     NAPI context the packet is processed in
+ * @skb:      Packet to deliver
+ *
+ * Packets which can be coalesced are passed through GRO, everything else goes
+ * straight to netif_receive_skb().
+ *
+ * Return:
+ *      - RMNET_DATA_GRO_RCV_PASS if packet is sent to napi_gro_receive()
+ *      - RMNET_DATA_GRO_RCV_FAIL if packet is sent to netif_receive_skb()
+ */
+int rmnet_rx_deliver(struct napi_struct *napi, struct sk_buff *skb)
+{
+	gro_result_t gro_res;
+
+	if (rmnet_check_skb_can_gro(skb) &&
+	    (skb->dev->features & NETIF_F_GRO)) {
+		gro_res = napi_gro_receive(napi, skb);
+		trace_rmnet_gro_downlink(gro_res);
+		return RMNET_DATA_GRO_RCV_PASS;
+	}
+
+	netif_receive_skb(skb);
+	return RMNET_DATA_GRO_RCV_FAIL;
+}
+
 /**
  * __rmnet_deliver_skb() - Deliver skb
  *
@@ -265,7 +293,6 @@ static rx_handler_result_t __rmnet_deliver_skb(struct sk_buff *skb,
 					 struct rmnet_logical_ep_conf_s *ep)
 {
 	struct napi_struct *napi = NULL;
-	gro_result_t gro_res;
 
 	trace___rmnet_deliver_skb(skb);
 	switch (ep->rmnet_mode) {
@@ -285,19 +312,21 @@ static rx_handler_result_t __rmnet_deliver_skb(struct sk_buff *skb,
 		case RX_HANDLER_PASS:
 			skb->pkt_type = PACKET_HOST;
 			rmnet_reset_mac_header(skb);
-			if (rmnet_check_skb_can_gro(skb) &&
-			    (skb->dev->features & NETIF_F_GRO)) {
-				napi = get_current_napi_context();
-				if (napi != NULL) {
-					gro_res = napi_gro_receive(napi, skb);
-					trace_rmnet_gro_downlink(gro_res);
+			if (rmnet_steer_enabled()) {
+				rmnet_steer_skb(skb);
+				return RX_HANDLER_CONSUMED;
+			}
+
+			napi = get_current_napi_context();
+			if (napi != NULL) {
+				if (rmnet_rx_deliver(napi, skb))
 					rmnet_optional_gro_flush(napi, ep);
-				} else {
-					WARN_ONCE(1, "current napi is NULL\n");
-					netif_receive_skb(skb);
-				}
 			} else {
-				netif_receive_skb(skb);
+				/* Not called from a NAPI poll. Queue the
+				 * packet to this CPU's steering context so it
+				 * still gets the benefit of GRO.
+				 */
+				rmnet_steer_skb(skb);
 			}
 			return RX_HANDLER_CONSUMED;
 		}
@@ -592,6 +621,11 @@ rx_handler_result_t rmnet_ingress_handler(struct sk_buff *skb)
 		__rmnet_data_set_skb_proto(skb);
 	}
 
+	/* Steered packets are queued and their target CPUs kicked from this
+	 * CPU, and NET_RX must run afterwards: keep bottom halves off even
+	 * when not called from a NAPI poll.
+	 */
+	local_bh_disable();
 	if (config->ingress_data_format & RMNET_INGRESS_FORMAT_MAP) {
 			rc = rmnet_map_ingress_handler(skb, config);
 	} else {
@@ -622,6 +656,8 @@ rx_handler_result_t rmnet_ingress_handler(struct sk_buff *skb)
 		}
 	}
 
+	rmnet_steer_flush();
+	local_bh_enable();
 	return rc;
 }
 
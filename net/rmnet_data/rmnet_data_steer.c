@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2017, The Linux Foundation. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 and
+ * only version 2 as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * RMNET Data ingress flow steering
+ *
+ * De-aggregated packets are hashed by flow onto a set of CPUs. Each CPU owns
+ * a NAPI context which drains its input queue through the GRO engine, so TCP
+ * segments of one flow coalesce on the CPU the flow is pinned to while the
+ * physical device's NAPI context is left to do nothing but de-aggregation.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/skbuff.h>
+#include <linux/netdevice.h>
+#include <linux/cpumask.h>
+#include <linux/percpu.h>
+#include <linux/smp.h>
+#include <linux/topology.h>
+#include <linux/cpu.h>
+#include "rmnet_data_private.h"
+#include "rmnet_data_config.h"
+#include "rmnet_data_handlers.h"
+#include "rmnet_data_stats.h"
+#include "rmnet_data_steer.h"
+
+/* ***************** Local Definitions ************************************** */
+
+#define RMNET_STEER_NAPI_WEIGHT 64
+
+unsigned long rps_mask __read_mostly;
+module_param(rps_mask, ulong, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(rps_mask, "CPUs de-aggregated flows are steered to");
+
+unsigned int rps_cluster_local __read_mostly = 1;
+module_param(rps_cluster_local, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(rps_cluster_local, "Prefer CPUs in the receiving cluster");
+
+unsigned int rps_queue_max __read_mostly = 1000;
+module_param(rps_queue_max, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(rps_queue_max, "Maximum packets queued per CPU");
+
+/**
+ * struct rmnet_steer_queue_s - Per CPU steering target
+ * @input: Packets steered to this CPU and not yet processed
+ * @napi: NAPI context draining @input through GRO
+ * @csd: IPI used to schedule @napi from a remote CPU
+ * @ipi_pending: Set while @csd is in flight
+ * @pending: CPUs this CPU queued packets to during the current burst. Only
+ *           used on the CPU doing de-aggregation
+ */
+struct rmnet_steer_queue_s {
+	struct sk_buff_head input;
+	struct napi_struct napi;
+	struct call_single_data csd;
+	unsigned long ipi_pending;
+	struct cpumask pending;
+};
+
+static DEFINE_PER_CPU(struct rmnet_steer_queue_s, rmnet_steer_queue);
+static struct net_device rmnet_steer_dev;
+
+/* ***************** Helper Functions *************************************** */
+
+/**
+ * rmnet_steer_get_cpu() - Pick the CPU a packet is processed on
+ * @skb:      Packet with valid network header
+ *
+ * Packets of one flow always hash to the same CPU as long as the configured
+ * mask does not change, which keeps them in order. If rps_cluster_local is
+ * set and the mask contains CPUs in the cluster of the receiving CPU, flows
+ * stay in that cluster to avoid pulling packet data across cluster caches.
+ *
+ * Return:
+ *      - CPU number
+ */
+static int rmnet_steer_get_cpu(struct sk_buff *skb)
+{
+	struct cpumask mask;
+	unsigned int weight, index;
+	int cpu;
+
+	cpumask_and(&mask, to_cpumask(&rps_mask), cpu_online_mask);
+	if (rps_cluster_local &&
+	    cpumask_intersects(&mask,
+			       topology_core_cpumask(smp_processor_id())))
+		cpumask_and(&mask, &mask,
+			    topology_core_cpumask(smp_processor_id()));
+
+	weight = cpumask_weight(&mask);
+	if (!weight)
+		return smp_processor_id();
+
+	index = reciprocal_scale(skb_get_hash(skb), weight);
+	for_each_cpu(cpu, &mask)
+		if (!index--)
+			break;
+
+	return cpu;
+}
+
+/**
+ * rmnet_steer_ipi() - Schedule the steering NAPI context on this CPU
+ * @data:     Per CPU queue
+ *
+ * Runs in IPI context, raising NET_RX on this CPU.
+ */
+static void rmnet_steer_ipi(void *data)
+{
+	struct rmnet_steer_queue_s *q = data;
+
+	clear_bit(0, &q->ipi_pending);
+	napi_schedule(&q->napi);
+}
+
+/**
+ * rmnet_steer_poll() - NAPI poll for steered packets
+ * @napi:     NAPI context of this CPU
+ * @budget:   Maximum number of packets to process
+ *
+ * Return:
+ *      - Number of packets processed
+ */
+static int rmnet_steer_poll(struct napi_struct *napi, int budget)
+{
+	struct rmnet_steer_queue_s *q;
+	struct net_device *dev;
+	struct sk_buff *skb;
+	int work = 0;
+
+	q = container_of(napi, struct rmnet_steer_queue_s, napi);
+	while (work < budget) {
+		skb = skb_dequeue(&q->input);
+		if (!skb)
+			break;
+
+		dev = skb->dev;
+		rmnet_rx_deliver(napi, skb);
+		dev_put(dev);
+		work++;
+	}
+
+	if (work < budget) {
+		napi_complete(napi);
+		/* A packet may have been queued after our last dequeue but
+		 * before the NAPI context was released. Pairs with the barrier
+		 * in rmnet_steer_flush()
+		 */
+		smp_mb__after_atomic();
+		if (!skb_queue_empty(&q->input))
+			napi_schedule(napi);
+	}
+
+	return work;
+}
+
+/* ***************** Steering *********************************************** */
+
+/**
+ * rmnet_steer_enabled() - Check if ingress packets should be steered
+ *
+ * Return:
+ *      - 1 if a steering mask is configured
+ *      - 0 otherwise
+ */
+int rmnet_steer_enabled(void)
+{
+	return ACCESS_ONCE(rps_mask) != 0;
+}
+
+/**
+ * rmnet_steer_skb() - Queue a packet to the CPU owning its flow
+ * @skb:      Packet ready for the network stack
+ *
+ * The target CPU is only recorded here. IPIs are batched and sent once per
+ * de-aggregated frame by rmnet_steer_flush() so that a burst of packets to
+ * one CPU costs a single interrupt. Must be called with bottom halves
+ * disabled.
+ */
+void rmnet_steer_skb(struct sk_buff *skb)
+{
+	struct rmnet_steer_queue_s *q, *local;
+	int cpu;
+
+	cpu = rmnet_steer_get_cpu(skb);
+	q = &per_cpu(rmnet_steer_queue, cpu);
+
+	if (skb_queue_len(&q->input) >= rps_queue_max) {
+		rmnet_kfree_skb(skb, RMNET_STATS_SKBFREE_STEER_QUEUE_FULL);
+		return;
+	}
+
+	dev_hold(skb->dev);
+	skb_queue_tail(&q->input, skb);
+
+	local = this_cpu_ptr(&rmnet_steer_queue);
+	cpumask_set_cpu(cpu, &local->pending);
+}
+
+/**
+ * rmnet_steer_flush() - Kick the CPUs packets were steered to
+ *
+ * Must be called on the CPU which called rmnet_steer_skb(), with bottom
+ * halves still disabled.
+ */
+void rmnet_steer_flush(void)
+{
+	struct rmnet_steer_queue_s *q, *local;
+	int cpu;
+
+	local = this_cpu_ptr(&rmnet_steer_queue);
+	/* Order the queueing in rmnet_steer_skb() before the NAPI state
+	 * checks below, against the poll releasing its NAPI context and
+	 * then checking for packets
+	 */
+	smp_mb();
+	for_each_cpu(cpu, &local->pending) {
+		q = &per_cpu(rmnet_steer_queue, cpu);
+		if (cpu == smp_processor_id()) {
+			napi_schedule(&q->napi);
+			continue;
+		}
+
+		if (test_bit(NAPI_STATE_SCHED, &q->napi.state))
+			continue;
+
+		if (!test_and_set_bit(0, &q->ipi_pending))
+			smp_call_function_single_async(cpu, &q->csd);
+	}
+	cpumask_clear(&local->pending);
+}
+
+/**
+ * rmnet_steer_cpu_callback() - Move packets off a CPU going offline
+ *
+ * Packets already steered to a dead CPU are handed to the CPU running the
+ * notifier so they are neither stranded nor leak device references.
+ */
+static int rmnet_steer_cpu_callback(struct notifier_block *nfb,
+				    unsigned long action, void *hcpu)
+{
+	struct rmnet_steer_queue_s *q, *local;
+	int cpu = (unsigned long)hcpu;
+	struct sk_buff *skb;
+
+	if (action != CPU_DEAD && action != CPU_DEAD_FROZEN)
+		return NOTIFY_OK;
+
+	q = &per_cpu(rmnet_steer_queue, cpu);
+	local_bh_disable();
+	local = this_cpu_ptr(&rmnet_steer_queue);
+	while ((skb = skb_dequeue(&q->input)) != 0)
+		skb_queue_tail(&local->input, skb);
+	napi_schedule(&local->napi);
+	local_bh_enable();
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block rmnet_steer_cpu_notifier = {
+	.notifier_call = rmnet_steer_cpu_callback,
+};
+
+/* ***************** Startup/Shutdown *************************************** */
+
+/**
+ * rmnet_steer_init() - Initialize the per CPU steering queues
+ *
+ * Return:
+ *      - 0 always
+ */
+int rmnet_steer_init(void)
+{
+	struct rmnet_steer_queue_s *q;
+	int cpu;
+
+	init_dummy_netdev(&rmnet_steer_dev);
+
+	for_each_possible_cpu(cpu) {
+		q = &per_cpu(rmnet_steer_queue, cpu);
+		skb_queue_head_init(&q->input);
+		q->csd.func = rmnet_steer_ipi;
+		q->csd.info = q;
+		cpumask_clear(&q->pending);
+		netif_napi_add(&rmnet_steer_dev, &q->napi, rmnet_steer_poll,
+			       RMNET_STEER_NAPI_WEIGHT);
+		napi_enable(&q->napi);
+	}
+
+	register_hotcpu_notifier(&rmnet_steer_cpu_notifier);
+	return 0;
+}
+
+/**
+ * rmnet_steer_exit() - Release the per CPU steering queues
+ */
+void rmnet_steer_exit(void)
+{
+	struct rmnet_steer_queue_s *q;
+	struct sk_buff *skb;
+	int cpu;
+
+	unregister_hotcpu_notifier(&rmnet_steer_cpu_notifier);
+	for_each_possible_cpu(cpu) {
+		q = &per_cpu(rmnet_steer_queue, cpu);
+		napi_disable(&q->napi);
+		while ((skb = skb_dequeue(&q->input)) != 0) {
+			dev_put(skb->dev);
+			kfree_skb(skb);
+		}
+		netif_napi_del(&q->napi);
+	}
+}
@@ -2188,6 +2188,19 @@ out:
 	return err;
 }
 
+/*
+ *	BSD sendmsg interface on an already looked up socket, for callers
+ *	that do not run in the context of the descriptor table owner
+ */
+
+long __sys_sendmsg_sock(struct socket *sock, struct msghdr __user *msg,
+			unsigned flags)
+{
+	struct msghdr msg_sys;
+
+	return ___sys_sendmsg(sock, msg, &msg_sys, flags, NULL);
+}
+
 SYSCALL_DEFINE3(sendmsg, int, fd, struct msghdr __user *, msg, unsigned int, flags)
 {
 	if (flags & MSG_CMSG_COMPAT)
@@ -2374,6 +2387,14 @@ out:
 	return err;
 }
 
+long __sys_recvmsg_sock(struct socket *sock, struct msghdr __user *msg,
+			unsigned flags)
+{
+	struct msghdr msg_sys;
+
+	return ___sys_recvmsg(sock, msg, &msg_sys, flags, 0);
+}
+
 SYSCALL_DEFINE3(recvmsg, int, fd, struct msghdr __user *, msg,
 		unsigned int, flags)
 {
@@ -147,12 +147,20 @@ static inline void unix_set_secdata(struct scm_cookie *scm, struct sk_buff *skb)
 {
 	scm->secid = *UNIXSID(skb);
 }
+
+static inline void unix_get_peersec_skb(struct socket *sock, struct sk_buff *skb)
+{
+	security_socket_getpeersec_dgram(sock, NULL, UNIXSID(skb));
+}
 #else
 static inline void unix_get_secdata(struct scm_cookie *scm, struct sk_buff *skb)
 { }
 
 static inline void unix_set_secdata(struct scm_cookie *scm, struct sk_buff *skb)
 { }
+
+static inline void unix_get_peersec_skb(struct socket *sock, struct sk_buff *skb)
+{ }
 #endif /* CONFIG_SECURITY_NETWORK */
 
 /*
@@ -474,6 +482,7 @@ static void unix_sock_destructor(struct sock *sk)
 	struct unix_sock *u = unix_sk(sk);
 
 	skb_queue_purge(&sk->sk_receive_queue);
+	kfree_skb(u->skb_cache);
 
 	WARN_ON(atomic_read(&sk->sk_wmem_alloc));
 	WARN_ON(!sk_unhashed(sk));
@@ -768,6 +777,7 @@ static struct sock *unix_create1(struct net *net, struct socket *sock)
 	mutex_init(&u->readlock); /* single task reading lock */
 	init_waitqueue_head(&u->peer_wait);
 	init_waitqueue_func_entry(&u->peer_wake, unix_dgram_peer_wake_relay);
+	u->skb_cache = NULL;
 	unix_insert_socket(unix_sockets_unbound(sk), sk);
 out:
 	if (sk == NULL)
@@ -1586,6 +1596,69 @@ static void maybe_add_creds(struct sk_buff *skb, const struct socket *sock,
 	}
 }
 
+/*
+ * Small datagrams without ancillary data take a fast path: the skb comes
+ * from a one entry per-socket cache refilled by the receive side, and no
+ * scm_cookie is set up or torn down. In a request/response exchange the
+ * buffer a socket receives is the one it sends its reply in.
+ */
+#define UNIX_SKB_FAST_SIZE	512
+
+static inline bool unix_dgram_fast_ok(struct msghdr *msg, size_t len)
+{
+	return msg->msg_controllen == 0 && len <= UNIX_SKB_FAST_SIZE;
+}
+
+static struct sk_buff *unix_alloc_fast_skb(struct socket *sock, int noblock,
+					   int *err)
+{
+	struct sock *sk = sock->sk;
+	struct unix_sock *u = unix_sk(sk);
+	struct sk_buff *skb;
+
+	skb = xchg(&u->skb_cache, NULL);
+	if (skb) {
+		/* Leave errors and blocking on a full send buffer to
+		 * sock_alloc_send_pskb()
+		 */
+		if (likely(!sk->sk_err &&
+			   !(sk->sk_shutdown & SEND_SHUTDOWN) &&
+			   atomic_read(&sk->sk_wmem_alloc) < sk->sk_sndbuf)) {
+			skb_set_owner_w(skb, sk);
+			goto init;
+		}
+		kfree_skb(skb);
+	}
+
+	skb = sock_alloc_send_pskb(sk, UNIX_SKB_FAST_SIZE + NET_SKB_PAD, 0,
+				   noblock, err, 0);
+	if (skb == NULL)
+		return NULL;
+	skb_reserve(skb, NET_SKB_PAD);
+
+init:
+	/* scm_send() would have recorded them: SO_PASSCRED may be set later */
+	UNIXCB(skb).pid = get_pid(task_tgid(current));
+	current_uid_gid(&UNIXCB(skb).uid, &UNIXCB(skb).gid);
+	UNIXCB(skb).fp = NULL;
+	unix_get_peersec_skb(sock, skb);
+	skb->destructor = unix_destruct_scm;
+	return skb;
+}
+
+static void unix_free_rcv_skb(struct sock *sk, struct sk_buff *skb)
+{
+	struct unix_sock *u = unix_sk(sk);
+
+	if (u->skb_cache || !skb_recycle_check(skb, UNIX_SKB_FAST_SIZE)) {
+		skb_free_datagram(sk, skb);
+		return;
+	}
+
+	if (cmpxchg(&u->skb_cache, NULL, skb))
+		kfree_skb(skb);
+}
+
 /*
  *	Send AF_UNIX data.
  */
@@ -1608,13 +1681,16 @@ static int unix_dgram_sendmsg(struct kiocb *kiocb, struct socket *sock,
 	int max_level;
 	int data_len = 0;
 	int sk_locked;
+	bool fast = unix_dgram_fast_ok(msg, len);
 
 	if (NULL == siocb->scm)
 		siocb->scm = &tmp_scm;
 	wait_for_unix_gc();
-	err = scm_send(sock, msg, siocb->scm, false);
-	if (err < 0)
-		return err;
+	if (!fast) {
+		err = scm_send(sock, msg, siocb->scm, false);
+		if (err < 0)
+			return err;
+	}
 
 	err = -EOPNOTSUPP;
 	if (msg->msg_flags&MSG_OOB)
@@ -1641,6 +1717,15 @@ static int unix_dgram_sendmsg(struct kiocb *kiocb, struct socket *sock,
 	if (len > sk->sk_sndbuf - 32)
 		goto out;
 
+	if (fast) {
+		skb = unix_alloc_fast_skb(sock, msg->msg_flags & MSG_DONTWAIT,
+					  &err);
+		if (skb == NULL)
+			goto out;
+		max_level = 1;
+		goto copy;
+	}
+
 	if (len > SKB_MAX_ALLOC) {
 		data_len = min_t(size_t,
 				 len - SKB_MAX_ALLOC,
@@ -1662,6 +1747,8 @@ static int unix_dgram_sendmsg(struct kiocb *kiocb, struct socket *sock,
 	max_level = err + 1;
 	unix_get_secdata(siocb->scm, skb);
 
+copy:
+
 	skb_put(skb, len - data_len);
 	skb->data_len = data_len;
 	skb->len = len;
@@ -1783,7 +1870,8 @@ restart_locked:
 	unix_state_unlock(other);
 	other->sk_data_ready(other);
 	sock_put(other);
-	scm_destroy(siocb->scm);
+	if (!fast)
+		scm_destroy(siocb->scm);
 	return len;
 
 out_unlock:
@@ -1795,7 +1883,8 @@ out_free:
 out:
 	if (other)
 		sock_put(other);
-	scm_destroy(siocb->scm);
+	if (!fast)
+		scm_destroy(siocb->scm);
 	return err;
 }
 
@@ -1993,8 +2082,13 @@ static int unix_dgram_recvmsg(struct kiocb *iocb, struct socket *sock,
 		goto out_unlock;
 	}
 
-	wake_up_interruptible_sync_poll(&u->peer_wait,
-					POLLOUT | POLLWRNORM | POLLWRBAND);
+	/* Senders blocked on a full queue are rare; skip the wait queue
+	 * lock unless someone is actually sleeping on it.
+	 */
+	if (wq_has_sleeper(&u->peer_wq))
+		wake_up_interruptible_sync_poll(&u->peer_wait,
+						POLLOUT | POLLWRNORM |
+						POLLWRBAND);
 
 	if (msg->msg_name)
 		unix_copy_addr(msg, skb->sk);
@@ -2047,7 +2141,7 @@ static int unix_dgram_recvmsg(struct kiocb *iocb, struct socket *sock,
 	scm_recv(sock, msg, siocb->scm, flags);
 
 out_free:
-	skb_free_datagram(sk, skb);
+	unix_free_rcv_skb(sk, skb);
 out_unlock:
 	mutex_unlock(&u->readlock);
 out:
@@ -23,6 +23,8 @@
 #include <linux/skbuff.h>
 #include <linux/percpu.h>
 #include <linux/list.h>
+#include <linux/log2.h>
+#include <linux/sched.h>
 #include <net/sock.h>
 #include <linux/un.h>
 #include <net/af_unix.h>
@@ -34,14 +36,20 @@
 #include "avc_ss.h"
 #include "classmap.h"
 
-#define AVC_CACHE_SLOTS			512
+#define AVC_DEF_CACHE_SLOTS		512
+#define AVC_MAX_CACHE_SLOTS		65536
 #define AVC_DEF_CACHE_THRESHOLD		512
 #define AVC_CACHE_RECLAIM		16
+#define AVC_PCPU_SLOTS			32
 
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 #define avc_cache_stats_incr(field)	this_cpu_inc(avc_cache_stats.field)
+#define avc_cache_stats_add(field, val)	this_cpu_add(avc_cache_stats.field, val)
+#define avc_cache_stats_clock()		local_clock()
 #else
 #define avc_cache_stats_incr(field)	do {} while (0)
+#define avc_cache_stats_add(field, val)	do { (void)(val); } while (0)
+#define avc_cache_stats_clock()		0
 #endif
 
 struct avc_entry {
@@ -69,13 +77,35 @@ struct avc_xperms_node {
 };
 
 struct avc_cache {
-	struct hlist_head	slots[AVC_CACHE_SLOTS]; /* head for avc_node->list */
-	spinlock_t		slots_lock[AVC_CACHE_SLOTS]; /* lock for writes */
+	struct hlist_head	*slots; /* head for avc_node->list */
+	spinlock_t		*slots_lock; /* lock for writes */
 	atomic_t		lru_hint;	/* LRU hint for reclaim scan */
 	atomic_t		active_nodes;
+	atomic_t		pcpu_gen;	/* generation of per-cpu entries */
 	u32			latest_notif;	/* latest revocation notification */
 };
 
+/*
+ * A small direct mapped cache of recent decisions in front of the
+ * shared one.  It is only touched from its own cpu, so the only writer
+ * an entry can race with is an interrupt on that cpu: seq is odd while
+ * the entry is being written, and a writer that finds it odd leaves the
+ * entry alone.  Entries are valid while their gen is avc_cache.pcpu_gen,
+ * which is bumped whenever a cached decision changes.
+ */
+struct avc_pcpu_entry {
+	unsigned int		seq;
+	unsigned int		gen;
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	struct av_decision	avd;
+};
+
+struct avc_pcpu_cache {
+	struct avc_pcpu_entry	entries[AVC_PCPU_SLOTS];
+};
+
 struct avc_callback_node {
 	int (*callback) (u32 event);
 	u32 events;
@@ -85,11 +115,25 @@ struct avc_callback_node {
 /* Exported via selinufs */
 unsigned int avc_cache_threshold = AVC_DEF_CACHE_THRESHOLD;
 
+static unsigned int avc_cache_slots = AVC_DEF_CACHE_SLOTS;
+
+static int __init avc_cache_slots_setup(char *str)
+{
+	unsigned long slots;
+
+	if (!kstrtoul(str, 0, &slots) && slots)
+		avc_cache_slots = roundup_pow_of_two(min_t(unsigned long, slots,
+						AVC_MAX_CACHE_SLOTS));
+	return 1;
+}
+__setup("avc_cache_slots=", avc_cache_slots_setup);
+
 #ifdef CONFIG_SECURITY_SELINUX_AVC_STATS
 DEFINE_PER_CPU(struct avc_cache_stats, avc_cache_stats) = { 0 };
 #endif
 
 static struct avc_cache avc_cache;
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
 static struct avc_callback_node *avc_callbacks;
 static struct kmem_cache *avc_node_cachep;
 static struct kmem_cache *avc_xperms_data_cachep;
@@ -98,7 +142,12 @@ static struct kmem_cache *avc_xperms_cachep;
 
 static inline int avc_hash(u32 ssid, u32 tsid, u16 tclass)
 {
-	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_CACHE_SLOTS - 1);
+	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (avc_cache_slots - 1);
+}
+
+static inline int avc_pcpu_hash(u32 ssid, u32 tsid, u16 tclass)
+{
+	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_PCPU_SLOTS - 1);
 }
 
 /**
@@ -177,12 +226,25 @@ void __init avc_init(void)
 {
 	int i;
 
-	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
+	avc_cache.slots = kcalloc(avc_cache_slots, sizeof(*avc_cache.slots),
+				  GFP_KERNEL);
+	avc_cache.slots_lock = kcalloc(avc_cache_slots,
+				       sizeof(*avc_cache.slots_lock),
+				       GFP_KERNEL);
+	if (!avc_cache.slots || !avc_cache.slots_lock)
+		panic("SELinux: unable to allocate %u AVC slots\n",
+		      avc_cache_slots);
+
+	for (i = 0; i < avc_cache_slots; i++) {
 		INIT_HLIST_HEAD(&avc_cache.slots[i]);
 		spin_lock_init(&avc_cache.slots_lock[i]);
 	}
 	atomic_set(&avc_cache.active_nodes, 0);
 	atomic_set(&avc_cache.lru_hint, 0);
+	/* per-cpu entries start out zeroed, i.e. with an invalid gen */
+	atomic_set(&avc_cache.pcpu_gen, 1);
+	if (avc_cache_slots > AVC_DEF_CACHE_THRESHOLD)
+		avc_cache_threshold = avc_cache_slots;
 
 	avc_node_cachep = kmem_cache_create("avc_node", sizeof(struct avc_node),
 					0, SLAB_PANIC, NULL);
@@ -210,7 +272,7 @@ int avc_get_hash_stats(char *page)
 
 	slots_used = 0;
 	max_chain_len = 0;
-	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
+	for (i = 0; i < avc_cache_slots; i++) {
 		head = &avc_cache.slots[i];
 		if (!hlist_empty(head)) {
 			slots_used++;
@@ -227,7 +289,7 @@ int avc_get_hash_stats(char *page)
 	return scnprintf(page, PAGE_SIZE, "entries: %d\nbuckets used: %d/%d\n"
 			 "longest chain: %d\n",
 			 atomic_read(&avc_cache.active_nodes),
-			 slots_used, AVC_CACHE_SLOTS, max_chain_len);
+			 slots_used, avc_cache_slots, max_chain_len);
 }
 
 /*
@@ -522,9 +584,10 @@ static inline int avc_reclaim_node(void)
 	unsigned long flags;
 	struct hlist_head *head;
 	spinlock_t *lock;
+	u64 start = avc_cache_stats_clock();
 
-	for (try = 0, ecx = 0; try < AVC_CACHE_SLOTS; try++) {
-		hvalue = atomic_inc_return(&avc_cache.lru_hint) & (AVC_CACHE_SLOTS - 1);
+	for (try = 0, ecx = 0; try < avc_cache_slots; try++) {
+		hvalue = atomic_inc_return(&avc_cache.lru_hint) & (avc_cache_slots - 1);
 		head = &avc_cache.slots[hvalue];
 		lock = &avc_cache.slots_lock[hvalue];
 
@@ -546,6 +609,7 @@ static inline int avc_reclaim_node(void)
 		spin_unlock_irqrestore(lock, flags);
 	}
 out:
+	avc_cache_stats_add(reclaim_ns, avc_cache_stats_clock() - start);
 	return ecx;
 }
 
@@ -621,6 +685,66 @@ static struct avc_node *avc_lookup(u32 ssid, u32 tsid, u16 tclass)
 	return NULL;
 }
 
+static inline unsigned int avc_pcpu_gen(void)
+{
+	unsigned int gen = atomic_read(&avc_cache.pcpu_gen);
+
+	/* pairs with the barrier in avc_pcpu_invalidate() */
+	smp_rmb();
+	return gen;
+}
+
+static inline void avc_pcpu_invalidate(void)
+{
+	smp_mb__before_atomic();
+	atomic_inc(&avc_cache.pcpu_gen);
+}
+
+static inline int avc_pcpu_lookup(u32 ssid, u32 tsid, u16 tclass,
+				  unsigned int gen, struct av_decision *avd)
+{
+	struct avc_pcpu_entry *e;
+	unsigned int seq;
+	int hit = 0;
+
+	e = &get_cpu_var(avc_pcpu_cache).entries[avc_pcpu_hash(ssid, tsid, tclass)];
+	seq = ACCESS_ONCE(e->seq);
+	barrier();
+	if (!(seq & 1) && e->gen == gen && e->ssid == ssid &&
+	    e->tsid == tsid && e->tclass == tclass) {
+		*avd = e->avd;
+		barrier();
+		hit = ACCESS_ONCE(e->seq) == seq;
+	}
+	put_cpu_var(avc_pcpu_cache);
+
+	if (hit) {
+		avc_cache_stats_incr(lookups);
+		avc_cache_stats_incr(pcpu_hits);
+	}
+	return hit;
+}
+
+static inline void avc_pcpu_store(u32 ssid, u32 tsid, u16 tclass,
+				  unsigned int gen, struct av_decision *avd)
+{
+	struct avc_pcpu_entry *e;
+
+	e = &get_cpu_var(avc_pcpu_cache).entries[avc_pcpu_hash(ssid, tsid, tclass)];
+	if (!(e->seq & 1)) {
+		e->seq++;
+		barrier();
+		e->gen = gen;
+		e->ssid = ssid;
+		e->tsid = tsid;
+		e->tclass = tclass;
+		e->avd = *avd;
+		barrier();
+		e->seq++;
+	}
+	put_cpu_var(avc_pcpu_cache);
+}
+
 static int avc_latest_notif_update(int seqno, int is_insert)
 {
 	int ret = 0;
@@ -909,6 +1033,7 @@ static int avc_update_node(u32 event, u32 perms, u8 driver, u8 xperm, u32 ssid,
 		break;
 	}
 	avc_node_replace(node, orig);
+	avc_pcpu_invalidate();
 out_unlock:
 	spin_unlock_irqrestore(lock, flag);
 out:
@@ -926,7 +1051,7 @@ static void avc_flush(void)
 	unsigned long flag;
 	int i;
 
-	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
+	for (i = 0; i < avc_cache_slots; i++) {
 		head = &avc_cache.slots[i];
 		lock = &avc_cache.slots_lock[i];
 
@@ -941,6 +1066,7 @@ static void avc_flush(void)
 		rcu_read_unlock();
 		spin_unlock_irqrestore(lock, flag);
 	}
+	avc_pcpu_invalidate();
 }
 
 /**
@@ -965,6 +1091,8 @@ int avc_ss_reset(u32 seqno)
 	}
 
 	avc_latest_notif_update(seqno, 0);
+	/* decisions made under the old policy may still have been cached */
+	avc_pcpu_invalidate();
 	return rc;
 }
 
@@ -981,11 +1109,16 @@ static noinline struct avc_node *avc_compute_av(u32 ssid, u32 tsid,
 			 u16 tclass, struct av_decision *avd,
 			 struct avc_xperms_node *xp_node)
 {
+	struct avc_node *node;
+	u64 start = avc_cache_stats_clock();
+
 	rcu_read_unlock();
 	INIT_LIST_HEAD(&xp_node->xpd_head);
 	security_compute_av(ssid, tsid, tclass, avd, &xp_node->xp);
 	rcu_read_lock();
-	return avc_insert(ssid, tsid, tclass, avd, xp_node);
+	node = avc_insert(ssid, tsid, tclass, avd, xp_node);
+	avc_cache_stats_add(miss_ns, avc_cache_stats_clock() - start);
+	return node;
 }
 
 static noinline int avc_denied(u32 ssid, u32 tsid,
@@ -1112,18 +1245,24 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 {
 	struct avc_node *node;
 	struct avc_xperms_node xp_node;
+	unsigned int gen;
 	int rc = 0;
 	u32 denied;
 
 	BUG_ON(!requested);
 
+	gen = avc_pcpu_gen();
+
 	rcu_read_lock();
 
-	node = avc_lookup(ssid, tsid, tclass);
-	if (unlikely(!node))
-		node = avc_compute_av(ssid, tsid, tclass, avd, &xp_node);
-	else
-		memcpy(avd, &node->ae.avd, sizeof(*avd));
+	if (!avc_pcpu_lookup(ssid, tsid, tclass, gen, avd)) {
+		node = avc_lookup(ssid, tsid, tclass);
+		if (unlikely(!node))
+			node = avc_compute_av(ssid, tsid, tclass, avd, &xp_node);
+		else
+			memcpy(avd, &node->ae.avd, sizeof(*avd));
+		avc_pcpu_store(ssid, tsid, tclass, gen, avd);
+	}
 
 	denied = requested & ~(avd->allowed);
 	if (unlikely(denied))
@@ -44,6 +44,9 @@ struct avc_cache_stats {
 	unsigned int allocations;
 	unsigned int reclaims;
 	unsigned int frees;
+	unsigned int pcpu_hits;	/* lookups answered by the per-cpu cache */
+	u64 miss_ns;		/* time spent computing missed decisions */
+	u64 reclaim_ns;		/* time spent reclaiming nodes */
 };
 
 /*
@@ -19,6 +19,8 @@
 
 #include <linux/kernel.h>
 #include <linux/slab.h>
+#include <linux/vmalloc.h>
+#include <linux/log2.h>
 #include <linux/errno.h>
 #include "avtab.h"
 #include "policydb.h"
@@ -26,10 +28,88 @@
 static struct kmem_cache *avtab_node_cachep;
 static struct kmem_cache *avtab_xperms_cachep;
 
-static inline int avtab_hash(struct avtab_key *keyp, u16 mask)
+/*
+ * MurmurHash3 mixing of the three key fields: the types and classes of
+ * a policy are small, dense numbers, so their bits need to be spread
+ * over the whole mask for a table with a slot per rule to pay off.
+ */
+static inline int avtab_hash(struct avtab_key *keyp, u32 mask)
 {
-	return ((keyp->target_class + (keyp->target_type << 2) +
-		 (keyp->source_type << 9)) & mask);
+	static const u32 c1 = 0xcc9e2d51;
+	static const u32 c2 = 0x1b873593;
+	static const u32 r1 = 15;
+	static const u32 r2 = 13;
+	static const u32 m  = 5;
+	static const u32 n  = 0xe6546b64;
+
+	u32 hash = 0;
+
+#define mix(input) { \
+	u32 v = input; \
+	v *= c1; \
+	v = (v << r1) | (v >> (32 - r1)); \
+	v *= c2; \
+	hash ^= v; \
+	hash = (hash << r2) | (hash >> (32 - r2)); \
+	hash = hash * m + n; \
+}
+
+	mix(keyp->target_class);
+	mix(keyp->target_type);
+	mix(keyp->source_type);
+
+#undef mix
+
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+
+	return hash & mask;
+}
+
+/* The slot and node arrays of a large policy are too big for kmalloc */
+static void *avtab_zalloc_array(size_t n, size_t size)
+{
+	void *p;
+
+	if (size && n > SIZE_MAX / size)
+		return NULL;
+	if (n * size <= (PAGE_SIZE << PAGE_ALLOC_COSTLY_ORDER)) {
+		p = kzalloc(n * size, GFP_KERNEL | __GFP_NOWARN);
+		if (p)
+			return p;
+	}
+	return vzalloc(n * size);
+}
+
+static void avtab_free_array(void *p)
+{
+	if (is_vmalloc_addr(p))
+		vfree(p);
+	else
+		kfree(p);
+}
+
+static inline bool avtab_node_in_pool(struct avtab *h, struct avtab_node *node)
+{
+	return node >= h->pool && node < h->pool + h->pool_size;
+}
+
+static struct avtab_node *avtab_alloc_node(struct avtab *h)
+{
+	if (h->pool_used < h->pool_size)
+		return &h->pool[h->pool_used++];
+	return kmem_cache_zalloc(avtab_node_cachep, GFP_KERNEL);
+}
+
+static void avtab_free_node(struct avtab *h, struct avtab_node *node)
+{
+	if (!avtab_node_in_pool(h, node))
+		kmem_cache_free(avtab_node_cachep, node);
+	else if (node == &h->pool[h->pool_used - 1])
+		h->pool_used--;
 }
 
 static struct avtab_node*
@@ -39,7 +119,7 @@ avtab_insert_node(struct avtab *h, int hvalue,
 {
 	struct avtab_node *newnode;
 	struct avtab_extended_perms *xperms;
-	newnode = kmem_cache_zalloc(avtab_node_cachep, GFP_KERNEL);
+	newnode = avtab_alloc_node(h);
 	if (newnode == NULL)
 		return NULL;
 	newnode->key = *key;
@@ -47,7 +127,7 @@ avtab_insert_node(struct avtab *h, int hvalue,
 	if (key->specified & AVTAB_XPERMS) {
 		xperms = kmem_cache_zalloc(avtab_xperms_cachep, GFP_KERNEL);
 		if (xperms == NULL) {
-			kmem_cache_free(avtab_node_cachep, newnode);
+			avtab_free_node(h, newnode);
 			return NULL;
 		}
 		*xperms = *(datum->u.xperms);
@@ -253,45 +333,46 @@ void avtab_destroy(struct avtab *h)
 			if (temp->key.specified & AVTAB_XPERMS)
 				kmem_cache_free(avtab_xperms_cachep,
 						temp->datum.u.xperms);
-			kmem_cache_free(avtab_node_cachep, temp);
+			if (!avtab_node_in_pool(h, temp))
+				kmem_cache_free(avtab_node_cachep, temp);
 		}
 		h->htable[i] = NULL;
 	}
-	kfree(h->htable);
+	avtab_free_array(h->htable);
 	h->htable = NULL;
 	h->nslot = 0;
 	h->mask = 0;
+	avtab_free_array(h->pool);
+	h->pool = NULL;
+	h->pool_size = 0;
+	h->pool_used = 0;
 }
 
 int avtab_init(struct avtab *h)
 {
 	h->htable = NULL;
+	h->pool = NULL;
+	h->pool_size = 0;
+	h->pool_used = 0;
 	h->nel = 0;
 	return 0;
 }
 
 int avtab_alloc(struct avtab *h, u32 nrules)
 {
-	u16 mask = 0;
-	u32 shift = 0;
-	u32 work = nrules;
+	u32 mask = 0;
 	u32 nslot = 0;
 
 	if (nrules == 0)
 		goto avtab_alloc_out;
 
-	while (work) {
-		work  = work >> 1;
-		shift++;
-	}
-	if (shift > 2)
-		shift = shift - 2;
-	nslot = 1 << shift;
+	/* between one and two rules per slot */
+	nslot = rounddown_pow_of_two(nrules);
 	if (nslot > MAX_AVTAB_HASH_BUCKETS)
 		nslot = MAX_AVTAB_HASH_BUCKETS;
 	mask = nslot - 1;
 
-	h->htable = kcalloc(nslot, sizeof(*(h->htable)), GFP_KERNEL);
+	h->htable = avtab_zalloc_array(nslot, sizeof(*(h->htable)));
 	if (!h->htable)
 		return -ENOMEM;
 
@@ -583,6 +664,18 @@ int avtab_read(struct avtab *a, void *fp, struct policydb *pol)
 	if (rc)
 		goto bad;
 
+	/*
+	 * Take the nodes of the rules from one allocation instead of one
+	 * at a time.  A rule takes at least 12 bytes of the policy image,
+	 * which keeps a corrupt count from asking for a huge pool; a pool
+	 * that cannot be had just leaves the nodes to the slab cache.
+	 */
+	if (nel <= ((struct policy_file *)fp)->len / 12) {
+		a->pool = avtab_zalloc_array(nel, sizeof(*a->pool));
+		if (a->pool)
+			a->pool_size = nel;
+	}
+
 	for (i = 0; i < nel; i++) {
 		rc = avtab_read_item(a, fp, pol, avtab_insertf, NULL);
 		if (rc) {
@@ -15,6 +15,7 @@
 #ifndef _SS_CONTEXT_H_
 #define _SS_CONTEXT_H_
 
+#include <linux/jhash.h>
 #include "ebitmap.h"
 #include "mls_types.h"
 #include "security.h"
@@ -102,6 +103,14 @@ static inline int mls_context_cmp(struct context *c1, struct context *c2)
 		ebitmap_cmp(&c1->range.level[1].cat, &c2->range.level[1].cat));
 }
 
+static inline u32 mls_context_hash(struct context *c, u32 hash)
+{
+	hash = jhash_1word(c->range.level[0].sens, hash);
+	hash = ebitmap_hash(&c->range.level[0].cat, hash);
+	hash = jhash_1word(c->range.level[1].sens, hash);
+	return ebitmap_hash(&c->range.level[1].cat, hash);
+}
+
 static inline void mls_context_destroy(struct context *c)
 {
 	ebitmap_destroy(&c->range.level[0].cat);
@@ -159,5 +168,17 @@ static inline int context_cmp(struct context *c1, struct context *c2)
 		mls_context_cmp(c1, c2));
 }
 
-#endif	/* _SS_CONTEXT_H_ */
+/*
+ * Contexts that context_cmp() finds equal hash to the same value.
+ */
+static inline u32 context_compute_hash(struct context *c)
+{
+	u32 hash;
 
+	if (c->len)
+		return jhash(c->str, strlen(c->str), 0);
+	hash = jhash_3words(c->user, c->role, c->type, 0);
+	return mls_context_hash(c, hash);
+}
+
+#endif	/* _SS_CONTEXT_H_ */
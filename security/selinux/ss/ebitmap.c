@@ -18,6 +18,7 @@
 #include <linux/kernel.h>
 #include <linux/slab.h>
 #include <linux/errno.h>
+#include <linux/jhash.h>
 #include <net/netlabel.h>
 #include "ebitmap.h"
 #include "policydb.h"
@@ -46,6 +47,22 @@ int ebitmap_cmp(struct ebitmap *e1, struct ebitmap *e2)
 	return 1;
 }
 
+/*
+ * Bitmaps that ebitmap_cmp() finds equal have the same highbit and the
+ * same nodes, so hashing those gives equal bitmaps equal hashes.
+ */
+u32 ebitmap_hash(struct ebitmap *e, u32 hash)
+{
+	struct ebitmap_node *n;
+
+	hash = jhash_1word(e->highbit, hash);
+	for (n = e->node; n; n = n->next) {
+		hash = jhash_1word(n->startbit, hash);
+		hash = jhash(n->maps, sizeof(n->maps), hash);
+	}
+	return hash;
+}
+
 int ebitmap_cpy(struct ebitmap *dst, struct ebitmap *src)
 {
 	struct ebitmap_node *n, *new, *prev;
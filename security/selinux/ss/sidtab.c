@@ -14,6 +14,9 @@
 #define SIDTAB_HASH(sid) \
 (sid & SIDTAB_HASH_MASK)
 
+#define SIDTAB_CONTEXT_HASH(hash) \
+(hash & SIDTAB_CONTEXT_HASH_MASK)
+
 int sidtab_init(struct sidtab *s)
 {
 	int i;
@@ -21,8 +24,17 @@ int sidtab_init(struct sidtab *s)
 	s->htable = kmalloc(sizeof(*(s->htable)) * SIDTAB_SIZE, GFP_ATOMIC);
 	if (!s->htable)
 		return -ENOMEM;
+	s->ctable = kmalloc(sizeof(*(s->ctable)) * SIDTAB_CONTEXT_HASH_BUCKETS,
+			    GFP_KERNEL);
+	if (!s->ctable) {
+		kfree(s->htable);
+		s->htable = NULL;
+		return -ENOMEM;
+	}
 	for (i = 0; i < SIDTAB_SIZE; i++)
 		s->htable[i] = NULL;
+	for (i = 0; i < SIDTAB_CONTEXT_HASH_BUCKETS; i++)
+		s->ctable[i] = NULL;
 	s->nel = 0;
 	s->next_sid = 1;
 	s->shutdown = 0;
@@ -30,6 +42,20 @@ int sidtab_init(struct sidtab *s)
 	return 0;
 }
 
+/*
+ * Like the SID index, the context index is searched without the sidtab
+ * lock, only under policy_rwlock, which keeps the nodes from being freed.
+ * So a new node is only linked in once it is fully set up.
+ */
+static void sidtab_context_link(struct sidtab *s, struct sidtab_node *node)
+{
+	int cvalue = SIDTAB_CONTEXT_HASH(node->hash);
+
+	node->context_next = s->ctable[cvalue];
+	wmb();
+	s->ctable[cvalue] = node;
+}
+
 int sidtab_insert(struct sidtab *s, u32 sid, struct context *context)
 {
 	int hvalue, rc = 0;
@@ -64,6 +90,7 @@ int sidtab_insert(struct sidtab *s, u32 sid, struct context *context)
 		rc = -ENOMEM;
 		goto out;
 	}
+	newnode->hash = context_compute_hash(context);
 
 	if (prev) {
 		newnode->next = prev->next;
@@ -74,6 +101,7 @@ int sidtab_insert(struct sidtab *s, u32 sid, struct context *context)
 		wmb();
 		s->htable[hvalue] = newnode;
 	}
+	sidtab_context_link(s, newnode);
 
 	s->nel++;
 	if (sid >= s->next_sid)
@@ -159,25 +187,25 @@ static void sidtab_update_cache(struct sidtab *s, struct sidtab_node *n, int loc
 }
 
 static inline u32 sidtab_search_context(struct sidtab *s,
-						  struct context *context)
+					struct context *context, u32 hash)
 {
-	int i;
 	struct sidtab_node *cur;
-
-	for (i = 0; i < SIDTAB_SIZE; i++) {
-		cur = s->htable[i];
-		while (cur) {
-			if (context_cmp(&cur->context, context)) {
-				sidtab_update_cache(s, cur, SIDTAB_CACHE_LEN - 1);
-				return cur->sid;
-			}
-			cur = cur->next;
+	u32 sid = 0;
+
+	cur = s->ctable[SIDTAB_CONTEXT_HASH(hash)];
+	while (cur) {
+		if (cur->hash == hash && context_cmp(&cur->context, context)) {
+			sidtab_update_cache(s, cur, SIDTAB_CACHE_LEN - 1);
+			sid = cur->sid;
+			break;
 		}
+		cur = cur->context_next;
 	}
-	return 0;
+	return sid;
 }
 
-static inline u32 sidtab_search_cache(struct sidtab *s, struct context *context)
+static inline u32 sidtab_search_cache(struct sidtab *s,
+				      struct context *context, u32 hash)
 {
 	int i;
 	struct sidtab_node *node;
@@ -186,7 +214,8 @@ static inline u32 sidtab_search_cache(struct sidtab *s, struct context *context)
 		node = s->cache[i];
 		if (unlikely(!node))
 			return 0;
-		if (context_cmp(&node->context, context)) {
+		if (node->hash == hash &&
+		    context_cmp(&node->context, context)) {
 			sidtab_update_cache(s, node, i);
 			return node->sid;
 		}
@@ -198,19 +227,20 @@ int sidtab_context_to_sid(struct sidtab *s,
 			  struct context *context,
 			  u32 *out_sid)
 {
-	u32 sid;
+	u32 sid, hash;
 	int ret = 0;
 	unsigned long flags;
 
 	*out_sid = SECSID_NULL;
 
-	sid  = sidtab_search_cache(s, context);
+	hash = context_compute_hash(context);
+	sid  = sidtab_search_cache(s, context, hash);
 	if (!sid)
-		sid = sidtab_search_context(s, context);
+		sid = sidtab_search_context(s, context, hash);
 	if (!sid) {
 		spin_lock_irqsave(&s->lock, flags);
 		/* Rescan now that we hold the lock. */
-		sid = sidtab_search_context(s, context);
+		sid = sidtab_search_context(s, context, hash);
 		if (sid)
 			goto unlock_out;
 		/* No SID exists for the context.  Allocate a new one. */
@@ -237,6 +267,27 @@ unlock_out:
 	return 0;
 }
 
+/*
+ * Rebuild the context index after the contexts were changed in place,
+ * as sidtab_map() with convert_context() does on a policy reload.  The
+ * sidtab must not be in use yet.
+ */
+void sidtab_rehash(struct sidtab *s)
+{
+	int i;
+	struct sidtab_node *cur;
+
+	for (i = 0; i < SIDTAB_CONTEXT_HASH_BUCKETS; i++)
+		s->ctable[i] = NULL;
+
+	for (i = 0; i < SIDTAB_SIZE; i++) {
+		for (cur = s->htable[i]; cur; cur = cur->next) {
+			cur->hash = context_compute_hash(&cur->context);
+			sidtab_context_link(s, cur);
+		}
+	}
+}
+
 void sidtab_hash_eval(struct sidtab *h, char *tag)
 {
 	int i, chain_len, slots_used, max_chain_len;
@@ -262,6 +313,27 @@ void sidtab_hash_eval(struct sidtab *h, char *tag)
 	printk(KERN_DEBUG "%s:  %d entries and %d/%d buckets used, longest "
 	       "chain length %d\n", tag, h->nel, slots_used, SIDTAB_SIZE,
 	       max_chain_len);
+
+	slots_used = 0;
+	max_chain_len = 0;
+	for (i = 0; i < SIDTAB_CONTEXT_HASH_BUCKETS; i++) {
+		cur = h->ctable[i];
+		if (cur) {
+			slots_used++;
+			chain_len = 0;
+			while (cur) {
+				chain_len++;
+				cur = cur->context_next;
+			}
+
+			if (chain_len > max_chain_len)
+				max_chain_len = chain_len;
+		}
+	}
+
+	printk(KERN_DEBUG "%s:  %d/%d context buckets used, longest "
+	       "chain length %d\n", tag, slots_used,
+	       SIDTAB_CONTEXT_HASH_BUCKETS, max_chain_len);
 }
 
 void sidtab_destroy(struct sidtab *s)
@@ -284,6 +356,8 @@ void sidtab_destroy(struct sidtab *s)
 	}
 	kfree(s->htable);
 	s->htable = NULL;
+	kfree(s->ctable);
+	s->ctable = NULL;
 	s->nel = 0;
 	s->next_sid = 1;
 }
@@ -295,6 +369,7 @@ void sidtab_set(struct sidtab *dst, struct sidtab *src)
 
 	spin_lock_irqsave(&src->lock, flags);
 	dst->htable = src->htable;
+	dst->ctable = src->ctable;
 	dst->nel = src->nel;
 	dst->next_sid = src->next_sid;
 	dst->shutdown = 0;
@@ -1,6 +1,7 @@
 /*
  * A security identifier table (sidtab) is a hash table
- * of security context structures indexed by SID value.
+ * of security context structures indexed by SID value,
+ * with a second hash index on the context contents.
  *
  * Author : Stephen Smalley, <sds@epoch.ncsc.mil>
  */
@@ -11,8 +12,10 @@
 
 struct sidtab_node {
 	u32 sid;		/* security identifier */
+	u32 hash;		/* hash of the context contents */
 	struct context context;	/* security context structure */
 	struct sidtab_node *next;
+	struct sidtab_node *context_next; /* next in the context index */
 };
 
 #define SIDTAB_HASH_BITS 7
@@ -21,8 +24,13 @@ struct sidtab_node {
 
 #define SIDTAB_SIZE SIDTAB_HASH_BUCKETS
 
+#define SIDTAB_CONTEXT_HASH_BITS 11
+#define SIDTAB_CONTEXT_HASH_BUCKETS (1 << SIDTAB_CONTEXT_HASH_BITS)
+#define SIDTAB_CONTEXT_HASH_MASK (SIDTAB_CONTEXT_HASH_BUCKETS-1)
+
 struct sidtab {
 	struct sidtab_node **htable;
+	struct sidtab_node **ctable;	/* indexed by context hash */
 	unsigned int nel;	/* number of elements */
 	unsigned int next_sid;	/* next SID to allocate */
 	unsigned char shutdown;
@@ -46,6 +54,7 @@ int sidtab_context_to_sid(struct sidtab *s,
 			  struct context *context,
 			  u32 *sid);
 
+void sidtab_rehash(struct sidtab *s);
 void sidtab_hash_eval(struct sidtab *h, char *tag);
 void sidtab_destroy(struct sidtab *s);
 void sidtab_set(struct sidtab *dst, struct sidtab *src);
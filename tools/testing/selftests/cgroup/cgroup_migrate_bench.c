@@ -0,0 +1,214 @@
+/*
+ * cgroup task migration latency.
+ *
+ * Creates two child cgroups below the given cgroup directory and moves a
+ * number of sleeping threads back and forth between them by writing their
+ * thread ids to the "tasks" files, the way the Android framework moves
+ * threads on app state changes. The latency of every write is measured
+ * and the average and worst case are reported, together with the cost of
+ * writing a thread to the cgroup it is already in.
+ *
+ * For cpuset hierarchies the cpus and mems of the parent are copied to
+ * the child cgroups.
+ *
+ * Usage: cgroup_migrate_bench [cgroup dir] [seconds] [threads]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+
+#define PATH_LEN	512
+
+static volatile int stop;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+
+struct sleeper {
+	pthread_t thread;
+	pid_t tid;
+};
+
+static void *sleeper_fn(void *arg)
+{
+	struct sleeper *s = arg;
+
+	s->tid = syscall(SYS_gettid);
+	pthread_mutex_lock(&lock);
+	while (!stop)
+		pthread_cond_wait(&cond, &lock);
+	pthread_mutex_unlock(&lock);
+	return NULL;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int write_file(const char *dir, const char *name, const char *val)
+{
+	char path[PATH_LEN + 16];
+	int fd, ret;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	fd = open(path, O_WRONLY);
+	if (fd < 0)
+		return -1;
+	ret = write(fd, val, strlen(val));
+	close(fd);
+	return ret < 0 ? -1 : 0;
+}
+
+static void copy_file(const char *from, const char *to, const char *name)
+{
+	char path[PATH_LEN + 16], buf[256];
+	ssize_t len;
+	int fd;
+
+	snprintf(path, sizeof(path), "%s/%s", from, name);
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return;
+	len = read(fd, buf, sizeof(buf) - 1);
+	close(fd);
+	if (len <= 0)
+		return;
+	buf[len] = '\0';
+	write_file(to, name, buf);
+}
+
+static int make_child(const char *parent, const char *name, char *path)
+{
+	snprintf(path, PATH_LEN, "%s/%s", parent, name);
+	if (mkdir(path, 0755) && errno != EEXIST) {
+		perror(path);
+		return -1;
+	}
+	/* cpusets need cpus and mems before tasks can be attached */
+	copy_file(parent, path, "cpuset.cpus");
+	copy_file(parent, path, "cpuset.mems");
+	copy_file(parent, path, "cpus");
+	copy_file(parent, path, "mems");
+	return 0;
+}
+
+/* Move a thread, return the latency in seconds or a negative value */
+static double move(int fd, pid_t tid)
+{
+	char buf[16];
+	double start;
+	int len;
+
+	len = snprintf(buf, sizeof(buf), "%d", tid);
+	start = now();
+	if (pwrite(fd, buf, len, 0) != len)
+		return -1;
+	return now() - start;
+}
+
+static int run(int fds[2], struct sleeper *s, int nr, int seconds,
+	       int same, const char *what)
+{
+	unsigned long long moves = 0;
+	double start, elapsed, lat, total = 0, max = 0;
+	int i, dst = 0;
+
+	start = now();
+	while ((elapsed = now() - start) < seconds) {
+		if (!same)
+			dst = !dst;
+		for (i = 0; i < nr; i++) {
+			lat = move(fds[dst], s[i].tid);
+			if (lat < 0) {
+				perror("write tasks");
+				return -1;
+			}
+			total += lat;
+			if (lat > max)
+				max = lat;
+			moves++;
+		}
+	}
+
+	printf("%-8s threads %3d: %10.0f moves/s avg %8.2f us max %8.2f us\n",
+	       what, nr, moves / elapsed, total * 1e6 / moves, max * 1e6);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	const char *root = "/dev/cpuset";
+	char path_a[PATH_LEN], path_b[PATH_LEN], tasks[PATH_LEN + 8];
+	struct sleeper *s;
+	int seconds = 2, nr = 16;
+	int fds[2], i, ret = 1;
+
+	if (argc > 1)
+		root = argv[1];
+	if (argc > 2)
+		seconds = atoi(argv[2]);
+	if (argc > 3)
+		nr = atoi(argv[3]);
+	if (seconds <= 0 || nr <= 0) {
+		fprintf(stderr, "usage: %s [cgroup dir] [seconds] [threads]\n",
+			argv[0]);
+		return 1;
+	}
+
+	if (make_child(root, "migrate_bench_a", path_a) ||
+	    make_child(root, "migrate_bench_b", path_b))
+		return 1;
+
+	snprintf(tasks, sizeof(tasks), "%s/tasks", path_a);
+	fds[0] = open(tasks, O_WRONLY);
+	snprintf(tasks, sizeof(tasks), "%s/tasks", path_b);
+	fds[1] = open(tasks, O_WRONLY);
+	s = calloc(nr, sizeof(*s));
+	if (fds[0] < 0 || fds[1] < 0 || !s) {
+		perror("setup");
+		goto out_rmdir;
+	}
+
+	for (i = 0; i < nr; i++)
+		pthread_create(&s[i].thread, NULL, sleeper_fn, &s[i]);
+	for (i = 0; i < nr; i++)
+		while (!((volatile struct sleeper *)&s[i])->tid)
+			usleep(1000);
+
+	if (!run(fds, s, nr, seconds, 0, "migrate") &&
+	    !run(fds, s, nr, seconds, 1, "noop"))
+		ret = 0;
+
+	/* move everybody back so that the children can be removed */
+	snprintf(tasks, sizeof(tasks), "%s/tasks", root);
+	close(fds[0]);
+	fds[0] = open(tasks, O_WRONLY);
+	for (i = 0; i < nr && fds[0] >= 0; i++)
+		move(fds[0], s[i].tid);
+
+	pthread_mutex_lock(&lock);
+	stop = 1;
+	pthread_cond_broadcast(&cond);
+	pthread_mutex_unlock(&lock);
+	for (i = 0; i < nr; i++)
+		pthread_join(s[i].thread, NULL);
+
+	close(fds[0]);
+	close(fds[1]);
+	free(s);
+out_rmdir:
+	rmdir(path_a);
+	rmdir(path_b);
+	return ret;
+}
@@ -0,0 +1,114 @@
+/*
+ * Check that a hole punched after the last full commit survives fast
+ * commit replay.
+ *
+ * "fc_punch prepare FILE" fills FILE, forces a full commit with syncfs()
+ * so that the blocks are mapped in the main journal, then punches a hole
+ * in the middle and fsync()s, which only writes a fast commit.  The
+ * caller snapshots the device at that point, as a crash would, and runs
+ * "fc_punch check FILE" on the replayed copy: the hole must read back as
+ * zeroes and its blocks must have been freed.
+ *
+ * Exits with 2 if the filesystem cannot punch holes.
+ *
+ * This is free and unencumbered software released into the public domain.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <err.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#ifndef FALLOC_FL_KEEP_SIZE
+#define FALLOC_FL_KEEP_SIZE	0x01
+#endif
+#ifndef FALLOC_FL_PUNCH_HOLE
+#define FALLOC_FL_PUNCH_HOLE	0x02
+#endif
+
+#define BLOCK_SIZE	4096
+#define FILE_SIZE	(256 * BLOCK_SIZE)
+#define HOLE_START	(64 * BLOCK_SIZE)
+#define HOLE_LEN	(64 * BLOCK_SIZE)
+#define PATTERN		0xa5
+
+static int prepare(const char *path)
+{
+	char buf[BLOCK_SIZE];
+	off_t off;
+	int fd;
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		err(1, "open %s", path);
+	memset(buf, PATTERN, sizeof(buf));
+	for (off = 0; off < FILE_SIZE; off += sizeof(buf))
+		if (write(fd, buf, sizeof(buf)) != sizeof(buf))
+			err(1, "write");
+	/* the file's extents must be in a full commit, not a fast one */
+	if (syscall(__NR_syncfs, fd))
+		err(1, "syncfs");
+
+	if (fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+		      HOLE_START, HOLE_LEN)) {
+		if (errno == EOPNOTSUPP) {
+			printf("punch hole not supported, skipping\n");
+			return 2;
+		}
+		err(1, "fallocate");
+	}
+	if (fsync(fd))
+		err(1, "fsync");
+	close(fd);
+	return 0;
+}
+
+static int check(const char *path)
+{
+	unsigned char buf[BLOCK_SIZE];
+	struct stat st;
+	off_t off;
+	int fd, i;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		err(1, "open %s", path);
+	if (fstat(fd, &st))
+		err(1, "fstat");
+	if (st.st_size != FILE_SIZE)
+		errx(1, "size %lld after replay, expected %d",
+		     (long long)st.st_size, FILE_SIZE);
+
+	for (off = 0; off < FILE_SIZE; off += sizeof(buf)) {
+		int in_hole = off >= HOLE_START && off < HOLE_START + HOLE_LEN;
+
+		if (pread(fd, buf, sizeof(buf), off) != sizeof(buf))
+			err(1, "read");
+		for (i = 0; i < BLOCK_SIZE; i++)
+			if (buf[i] != (in_hole ? 0 : PATTERN))
+				errx(1, "byte %lld is %#x after replay",
+				     (long long)off + i, buf[i]);
+	}
+	if ((long long)st.st_blocks * 512 > FILE_SIZE - HOLE_LEN)
+		errx(1, "%lld bytes allocated after replay, hole not freed",
+		     (long long)st.st_blocks * 512);
+	close(fd);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+		errx(1, "usage: %s prepare|check FILE", argv[0]);
+	if (!strcmp(argv[1], "prepare"))
+		return prepare(argv[2]);
+	if (!strcmp(argv[1], "check"))
+		return check(argv[2]);
+	errx(1, "unknown mode %s", argv[1]);
+}
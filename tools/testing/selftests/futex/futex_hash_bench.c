@@ -0,0 +1,178 @@
+/*
+ * Private futex wait/wake throughput with many processes.
+ *
+ * Each process runs pairs of threads which hand a token back and forth
+ * through a FUTEX_WAIT_PRIVATE/FUTEX_WAKE_PRIVATE ping-pong, so every round
+ * trip takes the hash bucket lock of the pair's futex four times. With a
+ * single global hash table the processes share buckets and their locks;
+ * with per process tables they do not. Round trips per second summed over
+ * all processes are reported for 1, 2, 4, ... processes up to the number
+ * of online CPUs. Bucket collisions are in /sys/kernel/debug/futex_hash_stats.
+ *
+ * Usage: futex_hash_bench [seconds per run] [pairs per process] [max processes]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/futex.h>
+
+static volatile int stop;
+
+struct pair {
+	pthread_t ping, pong;
+	int word;
+	unsigned long long rounds;
+} __attribute__((aligned(64)));
+
+static int futex(int *uaddr, int op, int val, const struct timespec *ts)
+{
+	return syscall(SYS_futex, uaddr, op, val, ts, NULL, 0);
+}
+
+/* Wait until *word == want, then hand the token over by storing next */
+static int handoff(int *word, int want, int next)
+{
+	static const struct timespec ts = { 0, 100000000 };
+	int cur;
+
+	while ((cur = __atomic_load_n(word, __ATOMIC_ACQUIRE)) != want) {
+		if (stop)
+			return -1;
+		futex(word, FUTEX_WAIT_PRIVATE, cur, &ts);
+	}
+	__atomic_store_n(word, next, __ATOMIC_RELEASE);
+	futex(word, FUTEX_WAKE_PRIVATE, 1, NULL);
+	return 0;
+}
+
+static void *ping_fn(void *arg)
+{
+	struct pair *p = arg;
+
+	while (!handoff(&p->word, 0, 1))
+		p->rounds++;
+	return NULL;
+}
+
+static void *pong_fn(void *arg)
+{
+	struct pair *p = arg;
+
+	while (!handoff(&p->word, 1, 0))
+		;
+	return NULL;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long long child(int npairs, int seconds)
+{
+	unsigned long long rounds = 0;
+	struct pair *pairs;
+	int i;
+
+	pairs = calloc(npairs, sizeof(*pairs));
+	if (!pairs)
+		return 0;
+
+	for (i = 0; i < npairs; i++) {
+		pthread_create(&pairs[i].ping, NULL, ping_fn, &pairs[i]);
+		pthread_create(&pairs[i].pong, NULL, pong_fn, &pairs[i]);
+	}
+	sleep(seconds);
+	stop = 1;
+	for (i = 0; i < npairs; i++) {
+		pthread_join(pairs[i].ping, NULL);
+		pthread_join(pairs[i].pong, NULL);
+		rounds += pairs[i].rounds;
+	}
+	free(pairs);
+	return rounds;
+}
+
+static int run(int nproc, int npairs, int seconds)
+{
+	unsigned long long rounds, total = 0;
+	double start, elapsed;
+	int fds[2], i, status;
+	pid_t pid;
+
+	if (pipe(fds)) {
+		perror("pipe");
+		return -1;
+	}
+
+	start = now();
+	for (i = 0; i < nproc; i++) {
+		pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			return -1;
+		}
+		if (pid == 0) {
+			close(fds[0]);
+			rounds = child(npairs, seconds);
+			if (write(fds[1], &rounds, sizeof(rounds)) != sizeof(rounds))
+				exit(1);
+			exit(0);
+		}
+	}
+	close(fds[1]);
+
+	for (i = 0; i < nproc; i++) {
+		if (read(fds[0], &rounds, sizeof(rounds)) != sizeof(rounds)) {
+			fprintf(stderr, "lost result of a child\n");
+			return -1;
+		}
+		total += rounds;
+	}
+	elapsed = now() - start;
+	close(fds[0]);
+	while (wait(&status) > 0)
+		;
+
+	printf("processes %3d x %2d pairs: %12.0f round trips/s\n",
+	       nproc, npairs, total / elapsed);
+	/* Keep the children from flushing our output again */
+	fflush(stdout);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int seconds = 2, npairs = 2, max = sysconf(_SC_NPROCESSORS_ONLN);
+	int n;
+
+	if (argc > 1)
+		seconds = atoi(argv[1]);
+	if (argc > 2)
+		npairs = atoi(argv[2]);
+	if (argc > 3)
+		max = atoi(argv[3]);
+	if (seconds <= 0 || npairs <= 0 || max <= 0) {
+		fprintf(stderr,
+			"usage: %s [seconds] [pairs per process] [max processes]\n",
+			argv[0]);
+		return 1;
+	}
+
+	for (n = 1; n <= max; n *= 2)
+		if (run(n, npairs, seconds))
+			return 1;
+	if (n / 2 != max && run(max, npairs, seconds))
+		return 1;
+
+	return 0;
+}
@@ -0,0 +1,414 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#ifndef SOL_UDP
+#define SOL_UDP		17
+#endif
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT	103
+#endif
+
+#ifndef UDP_GRO
+#define UDP_GRO		104
+#endif
+
+/* Datagrams sent over loopback with UDP_SEGMENT must arrive as
+ * individual datagrams of gso_size bytes, except for a shorter tail.
+ */
+struct udpgso_testcase {
+	const char	*name;
+	int		tlen;		/* total payload of one send */
+	int		gso_len;	/* UDP_SEGMENT size, 0 for none */
+	int		use_cmsg;	/* pass gso_len as cmsg, not sockopt */
+
+	/* 0    = number of segments as computed from tlen and gso_len
+	 * -foo = send fails with error foo
+	 */
+	int		expect;
+};
+
+static struct udpgso_testcase tests[] = {
+	{ "no gso",		1000,	0,	0,	0 },
+	{ "one segment",	1000,	1000,	0,	0 },
+	{ "two segments",	2000,	1000,	0,	0 },
+	{ "short tail",		2500,	1000,	0,	0 },
+	{ "tiny segments",	64,	1,	0,	0 },
+	{ "max segments",	64 * 500, 500,	0,	0 },
+	{ "too many segments",	65 * 500, 500,	0,	-EINVAL },
+	{ "segment over mtu",	2000,	65535,	0,	-EINVAL },
+	{ "cmsg segments",	3000,	1000,	1,	0 },
+};
+
+#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
+
+static char buf[1 << 16];
+
+static int send_one(int fd, struct sockaddr_in *addr,
+		    struct udpgso_testcase *t)
+{
+	char control[CMSG_SPACE(sizeof(uint16_t))];
+	struct iovec iov = { .iov_base = buf, .iov_len = t->tlen };
+	struct msghdr msg = { 0 };
+	struct cmsghdr *cm;
+	int val = t->use_cmsg ? 0 : t->gso_len;
+
+	if (setsockopt(fd, SOL_UDP, UDP_SEGMENT, &val, sizeof(val))) {
+		perror("setsockopt UDP_SEGMENT");
+		return -1;
+	}
+
+	msg.msg_name = addr;
+	msg.msg_namelen = sizeof(*addr);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+
+	if (t->use_cmsg) {
+		memset(control, 0, sizeof(control));
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		cm = CMSG_FIRSTHDR(&msg);
+		cm->cmsg_level = SOL_UDP;
+		cm->cmsg_type = UDP_SEGMENT;
+		cm->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+		*((uint16_t *)CMSG_DATA(cm)) = t->gso_len;
+	}
+
+	if (sendmsg(fd, &msg, 0) < 0)
+		return -errno;
+	return 0;
+}
+
+static int recv_all(int fd, struct udpgso_testcase *t)
+{
+	int gso = t->gso_len ? t->gso_len : t->tlen;
+	int left = t->tlen, ret;
+
+	while (left) {
+		int expect = left < gso ? left : gso;
+
+		ret = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+		if (ret < 0) {
+			fprintf(stderr, "%s: recv: %s (%d bytes missing)\n",
+				t->name, strerror(errno), left);
+			return -1;
+		}
+		if (ret != expect) {
+			fprintf(stderr, "%s: got %d bytes, expected %d\n",
+				t->name, ret, expect);
+			return -1;
+		}
+		left -= ret;
+	}
+
+	ret = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+	if (ret >= 0) {
+		fprintf(stderr, "%s: unexpected extra datagram\n", t->name);
+		return -1;
+	}
+	return 0;
+}
+
+static int run_tests(void)
+{
+	struct sockaddr_in addr = { 0 };
+	socklen_t alen = sizeof(addr);
+	int tx, rx, i, val, err = 0;
+
+	rx = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	tx = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (rx < 0 || tx < 0) {
+		perror("socket");
+		return -1;
+	}
+
+	val = 1 << 21;
+	setsockopt(rx, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val));
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(rx, (void *)&addr, sizeof(addr)) ||
+	    getsockname(rx, (void *)&addr, &alen)) {
+		perror("bind");
+		return -1;
+	}
+
+	alen = sizeof(val);
+	if (getsockopt(tx, SOL_UDP, UDP_SEGMENT, &val, &alen)) {
+		if (errno == ENOPROTOOPT) {
+			fprintf(stderr, "UDP_SEGMENT not supported, skipping\n");
+			return 0;
+		}
+		perror("getsockopt UDP_SEGMENT");
+		return -1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(tests); i++) {
+		struct udpgso_testcase *t = &tests[i];
+		int ret;
+
+		ret = send_one(tx, &addr, t);
+		if (t->expect < 0) {
+			if (ret != t->expect) {
+				fprintf(stderr, "%s: expected error %d, got %d\n",
+					t->name, t->expect, ret);
+				err = -1;
+			}
+			continue;
+		}
+		if (ret) {
+			fprintf(stderr, "%s: send: %s\n", t->name,
+				strerror(-ret));
+			err = -1;
+			continue;
+		}
+		if (recv_all(rx, t))
+			err = -1;
+	}
+
+	close(tx);
+	close(rx);
+	return err;
+}
+
+/* UDP_SEGMENT and UDP_GRO only work on the IPv4 paths: an IPv6-only
+ * socket must refuse them, a dual-stack one must accept them for its
+ * v4-mapped traffic.
+ */
+static int v6_setsockopt(int v6only, int optname, int expect)
+{
+	int fd, val = 1, ret = 0;
+
+	fd = socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	if (fd < 0) {
+		if (errno == EAFNOSUPPORT)
+			return 0;
+		perror("socket");
+		return -1;
+	}
+	if (setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only,
+		       sizeof(v6only))) {
+		perror("setsockopt IPV6_V6ONLY");
+		close(fd);
+		return -1;
+	}
+
+	if (setsockopt(fd, SOL_UDP, optname, &val, sizeof(val)))
+		ret = -errno;
+	if (ret == -ENOPROTOOPT) {
+		/* not supported at all, run_tests() already said so */
+		ret = 0;
+	} else if (ret != expect) {
+		fprintf(stderr, "%s %s: expected error %d, got %d\n",
+			v6only ? "v6only" : "dual-stack",
+			optname == UDP_GRO ? "UDP_GRO" : "UDP_SEGMENT",
+			expect, ret);
+		ret = -1;
+	} else {
+		ret = 0;
+	}
+	close(fd);
+	return ret;
+}
+
+static int run_v6_tests(void)
+{
+	int err = 0;
+
+	if (v6_setsockopt(1, UDP_SEGMENT, -EOPNOTSUPP))
+		err = -1;
+	if (v6_setsockopt(1, UDP_GRO, -EOPNOTSUPP))
+		err = -1;
+	if (v6_setsockopt(0, UDP_SEGMENT, 0))
+		err = -1;
+	if (v6_setsockopt(0, UDP_GRO, 0))
+		err = -1;
+	return err;
+}
+
+/* Receive side: loopback has no NAPI and never goes through GRO, so these
+ * run between two hosts over a GRO capable link:
+ *
+ *	receiver$ ./udpgso -r PORT
+ *	sender$   ./udpgso -t RECEIVER_IPV4 PORT
+ *
+ * The sender sends a burst of equal sized datagrams per case. The
+ * receiver, with UDP_GRO on, must get them back with their payload intact,
+ * either one by one or aggregated with a UDP_GRO segment size equal to
+ * the datagram size. Datagrams shorter than the minimum Ethernet frame
+ * are padded on the wire, and the padding must not be aggregated.
+ */
+struct udpgro_testcase {
+	const char	*name;
+	int		dlen;		/* payload of each datagram */
+	int		count;		/* datagrams in the burst */
+};
+
+static struct udpgro_testcase gro_tests[] = {
+	{ "gro full segments",	1000,	32 },
+	{ "gro padded segments", 1,	32 },
+	{ "gro short segments",	10,	32 },
+	{ "gro empty datagrams", 0,	32 },
+};
+
+static char gro_byte(int seq, int off)
+{
+	return 'a' + (seq + off) % 26;
+}
+
+static int gro_send(const char *host, int port)
+{
+	struct sockaddr_in addr = { 0 };
+	int fd, i, j, k;
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+		fprintf(stderr, "bad address %s\n", host);
+		return -1;
+	}
+	fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (fd < 0) {
+		perror("socket");
+		return -1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(gro_tests); i++) {
+		struct udpgro_testcase *t = &gro_tests[i];
+
+		for (j = 0; j < t->count; j++) {
+			for (k = 0; k < t->dlen; k++)
+				buf[k] = gro_byte(j, k);
+			if (sendto(fd, buf, t->dlen, 0, (void *)&addr,
+				   sizeof(addr)) != t->dlen) {
+				perror("sendto");
+				return -1;
+			}
+		}
+		/* let the receiver flush the burst before the next one */
+		usleep(200000);
+	}
+	close(fd);
+	return 0;
+}
+
+static int gro_recv_one(int fd, struct udpgro_testcase *t)
+{
+	char control[CMSG_SPACE(sizeof(int))];
+	struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+	struct msghdr msg = { 0 };
+	struct cmsghdr *cm;
+	int seq = 0, ret, gso, off;
+
+	while (seq < t->count) {
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control;
+		msg.msg_controllen = sizeof(control);
+		ret = recvmsg(fd, &msg, 0);
+		if (ret < 0) {
+			fprintf(stderr, "%s: recv: %s (%d of %d datagrams)\n",
+				t->name, strerror(errno), seq, t->count);
+			return -1;
+		}
+
+		gso = 0;
+		for (cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+			if (cm->cmsg_level == SOL_UDP &&
+			    cm->cmsg_type == UDP_GRO)
+				gso = *(int *)CMSG_DATA(cm);
+
+		if (!t->dlen) {
+			if (ret || gso) {
+				fprintf(stderr, "%s: got %d bytes, segment size %d\n",
+					t->name, ret, gso);
+				return -1;
+			}
+			seq++;
+			continue;
+		}
+		if ((gso && gso != t->dlen) || !ret || ret % t->dlen ||
+		    (!gso && ret != t->dlen)) {
+			fprintf(stderr, "%s: got %d bytes, segment size %d, expected %d\n",
+				t->name, ret, gso, t->dlen);
+			return -1;
+		}
+		for (off = 0; off < ret; off++) {
+			if (buf[off] != gro_byte(seq + off / t->dlen,
+						 off % t->dlen)) {
+				fprintf(stderr, "%s: corrupt payload at datagram %d\n",
+					t->name, seq + off / t->dlen);
+				return -1;
+			}
+		}
+		seq += ret / t->dlen;
+	}
+	return 0;
+}
+
+static int gro_recv(int port)
+{
+	struct sockaddr_in addr = { 0 };
+	struct timeval tv = { .tv_sec = 10 };
+	int fd, i, val, err = 0;
+
+	fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (fd < 0) {
+		perror("socket");
+		return -1;
+	}
+	val = 1;
+	if (setsockopt(fd, SOL_UDP, UDP_GRO, &val, sizeof(val))) {
+		if (errno == ENOPROTOOPT) {
+			fprintf(stderr, "UDP_GRO not supported, skipping\n");
+			return 0;
+		}
+		perror("setsockopt UDP_GRO");
+		return -1;
+	}
+	val = 1 << 21;
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val));
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+	if (bind(fd, (void *)&addr, sizeof(addr))) {
+		perror("bind");
+		return -1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(gro_tests); i++)
+		if (gro_recv_one(fd, &gro_tests[i]))
+			err = -1;
+	close(fd);
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	int err;
+
+	if (argc == 3 && !strcmp(argv[1], "-r"))
+		err = gro_recv(atoi(argv[2]));
+	else if (argc == 4 && !strcmp(argv[1], "-t"))
+		err = gro_send(argv[2], atoi(argv[3]));
+	else if (argc == 1)
+		err = run_tests() | run_v6_tests();
+	else {
+		fprintf(stderr, "usage: %s [-r port | -t addr port]\n",
+			argv[0]);
+		return 1;
+	}
+
+	if (err)
+		return 1;
+	return 0;
+}
@@ -0,0 +1,116 @@
+/*
+ * Round trip latency of small messages over a unix socketpair.
+ *
+ * A child process echoes every message back; the parent reports the
+ * average round trip time for SOCK_DGRAM and SOCK_SEQPACKET at a few
+ * message sizes around the ones used by input channels and logd.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+static int iterations = 100000;
+
+static char buf[4096];
+
+static unsigned long long now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void echo_loop(int fd)
+{
+	ssize_t ret;
+
+	for (;;) {
+		ret = recv(fd, buf, sizeof(buf), 0);
+		if (ret <= 0)
+			exit(0);
+		if (send(fd, buf, ret, 0) != ret)
+			exit(1);
+	}
+}
+
+static int run_one(int type, const char *name, int size)
+{
+	unsigned long long start, elapsed;
+	int fds[2], i, status;
+	pid_t pid;
+
+	if (socketpair(AF_UNIX, type, 0, fds)) {
+		perror("socketpair");
+		return -1;
+	}
+
+	pid = fork();
+	if (pid < 0) {
+		perror("fork");
+		return -1;
+	}
+	if (pid == 0) {
+		close(fds[0]);
+		echo_loop(fds[1]);
+	}
+	close(fds[1]);
+
+	memset(buf, 0xa5, size);
+	start = now_ns();
+	for (i = 0; i < iterations; i++) {
+		if (send(fds[0], buf, size, 0) != size) {
+			perror("send");
+			goto err;
+		}
+		if (recv(fds[0], buf, sizeof(buf), 0) != size) {
+			perror("recv");
+			goto err;
+		}
+	}
+	elapsed = now_ns() - start;
+
+	printf("%-10s %5d bytes: %8llu ns/round trip\n", name, size,
+	       elapsed / iterations);
+
+	/* An empty message stops the echo loop, dgram peers see no EOF */
+	send(fds[0], buf, 0, 0);
+	close(fds[0]);
+	waitpid(pid, &status, 0);
+	return 0;
+
+err:
+	close(fds[0]);
+	kill(pid, SIGKILL);
+	waitpid(pid, &status, 0);
+	return -1;
+}
+
+int main(int argc, char **argv)
+{
+	static const int sizes[] = { 32, 128, 512, 2048 };
+	int i, err = 0;
+
+	if (argc > 1)
+		iterations = atoi(argv[1]);
+	if (iterations <= 0) {
+		fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+		return 1;
+	}
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		if (run_one(SOCK_DGRAM, "dgram", sizes[i]))
+			err = 1;
+		if (run_one(SOCK_SEQPACKET, "seqpacket", sizes[i]))
+			err = 1;
+	}
+
+	return err;
+}
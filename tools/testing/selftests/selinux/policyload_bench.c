@@ -0,0 +1,105 @@
+/*
+ * Time to load a binary policy, as at boot or on a policy reload.
+ *
+ * The policy is read from the given file, by default the one that is
+ * loaded now (/sys/fs/selinux/policy), and written to
+ * /sys/fs/selinux/load the given number of times.  Reloading the policy
+ * that is already loaded changes nothing but flushes the AVC, so this
+ * is best run on an idle device with an Android policy.  Needs root and
+ * security:load_policy.
+ *
+ * Usage: policyload_bench [policy file] [loads]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define POLICY_FILE	"/sys/fs/selinux/policy"
+#define LOAD_FILE	"/sys/fs/selinux/load"
+
+static double now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+/* /sys/fs/selinux/policy has no size until it is read, so grow as we go */
+static char *read_policy(const char *path, size_t *lenp)
+{
+	size_t len = 0, size = 1 << 20;
+	char *buf = malloc(size);
+	ssize_t n;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || !buf)
+		return NULL;
+	while ((n = read(fd, buf + len, size - len)) > 0) {
+		len += n;
+		if (len == size) {
+			size *= 2;
+			buf = realloc(buf, size);
+			if (!buf)
+				return NULL;
+		}
+	}
+	close(fd);
+	if (n < 0 || !len)
+		return NULL;
+	*lenp = len;
+	return buf;
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = argc > 1 ? argv[1] : POLICY_FILE;
+	int loads = argc > 2 ? atoi(argv[2]) : 5;
+	double t, total = 0, min = 0, max = 0;
+	size_t len;
+	char *policy;
+	int i, fd;
+
+	if (loads <= 0) {
+		fprintf(stderr, "usage: %s [policy file] [loads]\n", argv[0]);
+		return 1;
+	}
+	policy = read_policy(path, &len);
+	if (!policy) {
+		printf("cannot read a policy from %s, skipping\n", path);
+		return 0;
+	}
+	printf("policy %s: %zu bytes\n", path, len);
+
+	for (i = 0; i < loads; i++) {
+		fd = open(LOAD_FILE, O_WRONLY);
+		if (fd < 0) {
+			printf("cannot open %s: %s, skipping\n", LOAD_FILE,
+			       strerror(errno));
+			return 0;
+		}
+		t = now_ms();
+		if (write(fd, policy, len) != (ssize_t)len) {
+			fprintf(stderr, "policy load failed: %s\n",
+				strerror(errno));
+			return 1;
+		}
+		t = now_ms() - t;
+		close(fd);
+
+		printf("load %d: %.2f ms\n", i, t);
+		total += t;
+		if (!i || t < min)
+			min = t;
+		if (t > max)
+			max = t;
+	}
+	printf("min %.2f ms avg %.2f ms max %.2f ms\n", min, total / loads, max);
+	return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * SID table lookup cost as the number of SIDs grows.
+ *
+ * Every context written to /sys/fs/selinux/context goes through
+ * sidtab_context_to_sid(), which allocates a new SID for a context it
+ * has not seen yet.  This writes contexts that differ only in their MLS
+ * category pair, like the per-app categories of Android, and reports
+ * for every batch the mean time to map a new context and to map again
+ * one that already has a SID, picked at random among all of them.
+ *
+ * The user, role and type are taken from the calling process, which
+ * needs to be allowed security:check_context (or SELinux permissive),
+ * and its user needs to be cleared for categories c0 to c1023.
+ *
+ * Usage: sidtab_bench [number of SIDs] [batch size]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#define CONTEXT_FILE	"/sys/fs/selinux/context"
+#define NCATS		1024
+
+static char prefix[256];
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Context number n, counting the category pairs c0,c1 c0,c2 ... c1,c2 ... */
+static int make_context(char *buf, size_t len, unsigned int n)
+{
+	unsigned int lo = 0, hi;
+
+	while (n >= NCATS - 1 - lo) {
+		n -= NCATS - 1 - lo;
+		lo++;
+	}
+	hi = lo + 1 + n;
+	return snprintf(buf, len, "%s:s0:c%u,c%u", prefix, lo, hi);
+}
+
+/* selinuxfs transaction files take one write per open */
+static int map_context(unsigned int n)
+{
+	char buf[512];
+	int fd, len, ret = 0;
+
+	len = make_context(buf, sizeof(buf), n);
+	fd = open(CONTEXT_FILE, O_RDWR);
+	if (fd < 0)
+		return -errno;
+	if (write(fd, buf, len + 1) < 0)
+		ret = -errno;
+	close(fd);
+	return ret;
+}
+
+static int read_prefix(void)
+{
+	char con[256], *p;
+	int fd, len, colons = 0;
+
+	fd = open("/proc/self/attr/current", O_RDONLY);
+	if (fd < 0)
+		return -1;
+	len = read(fd, con, sizeof(con) - 1);
+	close(fd);
+	if (len <= 0)
+		return -1;
+	con[len] = '\0';
+
+	/* keep user:role:type, drop the level */
+	for (p = con; *p && *p != '\n'; p++) {
+		if (*p == ':' && ++colons == 3)
+			break;
+	}
+	*p = '\0';
+	if (colons < 2)
+		return -1;
+	strcpy(prefix, con);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int nsids = argc > 1 ? atoi(argv[1]) : 10000;
+	unsigned int batch = argc > 2 ? atoi(argv[2]) : 1000;
+	unsigned int max = NCATS * (NCATS - 1) / 2;
+	unsigned int done, i;
+	int ret;
+
+	if (!nsids || !batch || nsids > max) {
+		fprintf(stderr, "usage: %s [number of SIDs <= %u] [batch size]\n",
+			argv[0], max);
+		return 1;
+	}
+	if (read_prefix()) {
+		printf("SELinux not enabled, skipping\n");
+		return 0;
+	}
+	ret = map_context(0);
+	if (ret) {
+		printf("cannot map %s:s0:c0,c1: %s, skipping\n", prefix,
+		       strerror(-ret));
+		return 0;
+	}
+
+	srand(1);
+	printf("%10s %14s %14s\n", "contexts", "new_ns", "existing_ns");
+	for (done = 0; done < nsids; ) {
+		double t0, t_new, t_old;
+		unsigned int n = batch;
+
+		if (n > nsids - done)
+			n = nsids - done;
+
+		t0 = now_ns();
+		for (i = 0; i < n; i++) {
+			ret = map_context(done + i);
+			if (ret) {
+				fprintf(stderr, "context %u: %s\n", done + i,
+					strerror(-ret));
+				return 1;
+			}
+		}
+		t_new = (now_ns() - t0) / n;
+		done += n;
+
+		t0 = now_ns();
+		for (i = 0; i < n; i++)
+			map_context(rand() % done);
+		t_old = (now_ns() - t0) / n;
+
+		printf("%10u %14.0f %14.0f\n", done, t_new, t_old);
+	}
+	return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Fork latency of a process with a growing anonymous resident set,
+ * with and without PR_SET_LAZY_FORK.
+ *
+ * Usage: fork_latency [max size in MB] [forks per size]
+ *
+ * For every size, the parent times fork() itself and the first write
+ * after fork (which has to copy the PTE table on a lazy fork), and the
+ * child checks that it still sees the memory as it was at fork time
+ * while the parent keeps writing to it.
+ *
+ * This is free and unencumbered software released into the public domain.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <err.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#ifndef PR_SET_LAZY_FORK
+#define PR_SET_LAZY_FORK	0x4c5a4653
+#endif
+
+#define PAGE_SIZE	4096
+#define MB		(1024 * 1024)
+
+static double now_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static void populate(char *buf, size_t len, char val)
+{
+	size_t off;
+
+	for (off = 0; off < len; off += PAGE_SIZE)
+		buf[off] = val;
+}
+
+static int check(const char *buf, size_t len, char val)
+{
+	size_t off;
+
+	for (off = 0; off < len; off += PAGE_SIZE)
+		if (buf[off] != val)
+			return -1;
+	return 0;
+}
+
+/* Returns the mean fork latency, and the first write latency in *write_us */
+static double measure(char *buf, size_t len, int forks, double *write_us)
+{
+	double fork_total = 0, write_total = 0;
+	int pipefd[2];
+	int i, status;
+
+	for (i = 0; i < forks; i++) {
+		char val = 'a' + i % 26;
+		double t0, t1;
+		pid_t pid;
+		char c;
+
+		populate(buf, len, val);
+		if (pipe(pipefd))
+			err(1, "pipe");
+
+		t0 = now_us();
+		pid = fork();
+		if (pid < 0)
+			err(1, "fork");
+		if (!pid) {
+			/* wait for the parent to scribble over its copy */
+			close(pipefd[1]);
+			if (read(pipefd[0], &c, 1) != 1)
+				_exit(2);
+			_exit(check(buf, len, val) ? 1 : 0);
+		}
+		t1 = now_us();
+		fork_total += t1 - t0;
+
+		close(pipefd[0]);
+		t0 = now_us();
+		buf[0] = val + 1;
+		write_total += now_us() - t0;
+		populate(buf, len, val + 1);
+		if (write(pipefd[1], "x", 1) != 1)
+			err(1, "write");
+		close(pipefd[1]);
+
+		if (waitpid(pid, &status, 0) != pid)
+			err(1, "waitpid");
+		if (!WIFEXITED(status) || WEXITSTATUS(status))
+			errx(1, "child saw the parent's writes after fork");
+	}
+	*write_us = write_total / forks;
+	return fork_total / forks;
+}
+
+int main(int argc, char **argv)
+{
+	size_t max_mb = argc > 1 ? atol(argv[1]) : 1024;
+	int forks = argc > 2 ? atoi(argv[2]) : 10;
+	double eager, lazy, eager_wr, lazy_wr;
+	size_t mb;
+	int has_lazy;
+
+	if (!max_mb || forks <= 0)
+		errx(1, "usage: %s [max size in MB] [forks per size]", argv[0]);
+
+	has_lazy = !prctl(PR_SET_LAZY_FORK, 0, 0, 0, 0);
+	if (!has_lazy)
+		printf("PR_SET_LAZY_FORK not supported, eager fork only\n");
+
+	printf("%8s %14s %14s %14s %14s\n", "size_mb", "fork_us",
+	       "lazy_fork_us", "1st_write_us", "lazy_1st_wr_us");
+
+	for (mb = 16; mb <= max_mb; mb *= 2) {
+		size_t len = mb * MB;
+		char *buf;
+
+		buf = mmap(NULL, len, PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (buf == MAP_FAILED)
+			err(1, "mmap %zu MB", mb);
+		/* THP would let fork copy a pmd per 2MB anyway */
+		madvise(buf, len, MADV_NOHUGEPAGE);
+
+		if (has_lazy && prctl(PR_SET_LAZY_FORK, 0, 0, 0, 0))
+			err(1, "prctl");
+		eager = measure(buf, len, forks, &eager_wr);
+
+		lazy = lazy_wr = 0;
+		if (has_lazy) {
+			if (prctl(PR_SET_LAZY_FORK, 1, 0, 0, 0))
+				err(1, "prctl");
+			lazy = measure(buf, len, forks, &lazy_wr);
+		}
+
+		printf("%8zu %14.1f %14.1f %14.1f %14.1f\n", mb, eager, lazy,
+		       eager_wr, lazy_wr);
+		munmap(buf, len);
+	}
+	return 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Check that a page mapped by a PTE table shared by lazy fork can still
+ * be migrated, so that compaction, CMA and reclaim are not held up by
+ * a child that never touches its inherited memory.
+ *
+ * The parent forks with PR_SET_LAZY_FORK set and, while the child still
+ * shares its PTE table, asks for one page of it to be soft offlined:
+ * that migrates the page through the same try_to_unmap() path as
+ * compaction.  The page must end up at a new pfn, and both processes
+ * must keep seeing its contents.
+ *
+ * Needs root and CONFIG_MEMORY_FAILURE; skipped otherwise.
+ *
+ * This is free and unencumbered software released into the public domain.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <err.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+
+#ifndef PR_SET_LAZY_FORK
+#define PR_SET_LAZY_FORK	0x4c5a4653
+#endif
+#ifndef MADV_SOFT_OFFLINE
+#define MADV_SOFT_OFFLINE	101
+#endif
+
+#define PAGE_SIZE	4096
+#define PMD_SIZE	(2UL * 1024 * 1024)
+#define PFN_MASK	((1ULL << 55) - 1)
+#define PM_PRESENT	(1ULL << 63)
+
+static uint64_t page_pfn(const void *addr)
+{
+	uint64_t entry;
+	int fd;
+
+	fd = open("/proc/self/pagemap", O_RDONLY);
+	if (fd < 0)
+		err(1, "open pagemap");
+	if (pread(fd, &entry, sizeof(entry),
+		  (uintptr_t)addr / PAGE_SIZE * sizeof(entry)) != sizeof(entry))
+		err(1, "read pagemap");
+	close(fd);
+	if (!(entry & PM_PRESENT))
+		errx(1, "page at %p not present", addr);
+	return entry & PFN_MASK;
+}
+
+static int check(const char *buf, size_t len)
+{
+	size_t off;
+
+	for (off = 0; off < len; off += PAGE_SIZE)
+		if (buf[off] != (char)(off / PAGE_SIZE))
+			return -1;
+	return 0;
+}
+
+int main(void)
+{
+	uint64_t before, after;
+	int pipefd[2], status;
+	char *map, *buf;
+	size_t off;
+	pid_t pid;
+
+	if (prctl(PR_SET_LAZY_FORK, 1, 0, 0, 0)) {
+		printf("PR_SET_LAZY_FORK not supported, skipping\n");
+		return 0;
+	}
+
+	/* only a PTE table lying entirely in the vma is shared */
+	map = mmap(NULL, 2 * PMD_SIZE, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (map == MAP_FAILED)
+		err(1, "mmap");
+	buf = (char *)(((uintptr_t)map + PMD_SIZE - 1) & ~(PMD_SIZE - 1));
+	madvise(buf, PMD_SIZE, MADV_NOHUGEPAGE);
+	for (off = 0; off < PMD_SIZE; off += PAGE_SIZE)
+		buf[off] = off / PAGE_SIZE;
+
+	if (pipe(pipefd))
+		err(1, "pipe");
+	pid = fork();
+	if (pid < 0)
+		err(1, "fork");
+	if (!pid) {
+		char c;
+
+		/* leave the table shared until the parent is done */
+		close(pipefd[1]);
+		if (read(pipefd[0], &c, 1) != 1)
+			_exit(2);
+		_exit(check(buf, PMD_SIZE) ? 1 : 0);
+	}
+	close(pipefd[0]);
+
+	before = page_pfn(buf + PAGE_SIZE);
+	if (madvise(buf + PAGE_SIZE, PAGE_SIZE, MADV_SOFT_OFFLINE)) {
+		if (errno == EINVAL || errno == EPERM) {
+			printf("MADV_SOFT_OFFLINE not available, skipping\n");
+			kill(pid, SIGKILL);
+			waitpid(pid, &status, 0);
+			return 0;
+		}
+		err(1, "page in a shared PTE table could not be migrated");
+	}
+	after = page_pfn(buf + PAGE_SIZE);
+
+	if (write(pipefd[1], "x", 1) != 1)
+		err(1, "write");
+	close(pipefd[1]);
+	if (waitpid(pid, &status, 0) != pid)
+		err(1, "waitpid");
+
+	if (before == after)
+		errx(1, "page in a shared PTE table was not migrated");
+	if (check(buf, PMD_SIZE))
+		errx(1, "parent lost its memory contents");
+	if (!WIFEXITED(status) || WEXITSTATUS(status))
+		errx(1, "child lost its memory contents");
+	printf("pfn %#llx migrated to %#llx\n", (unsigned long long)before,
+	       (unsigned long long)after);
+	return 0;
+}
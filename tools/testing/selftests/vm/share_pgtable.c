@@ -0,0 +1,146 @@
+/*
+ * Minor faults taken by a child reading a private file mapping that its
+ * parent already faulted in, with and without MADV_SHARE_PGTABLE.
+ *
+ * With sharing, it also checks that the Pss a child sees in smaps for
+ * the mapping is split with its parent rather than all its own.
+ *
+ * Usage: share_pgtable [size in MB]
+ *
+ * This is free and unencumbered software released into the public domain.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <err.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#ifndef MADV_SHARE_PGTABLE
+#define MADV_SHARE_PGTABLE	64
+#define MADV_NOSHARE_PGTABLE	65
+#endif
+
+#define PAGE_SIZE	4096
+#define MB		(1024 * 1024)
+
+static void child_minflt(const char *buf, size_t len)
+{
+	struct rusage ru;
+	int status;
+	pid_t pid;
+
+	pid = fork();
+	if (pid < 0)
+		err(1, "fork");
+	if (!pid) {
+		volatile char sum = 0;
+		long before;
+		size_t off;
+
+		getrusage(RUSAGE_SELF, &ru);
+		before = ru.ru_minflt;
+		for (off = 0; off < len; off += PAGE_SIZE)
+			sum += buf[off];
+		getrusage(RUSAGE_SELF, &ru);
+		/* the exit code is too small for the count: print it */
+		printf("%ld\n", ru.ru_minflt - before);
+		fflush(stdout);
+		_exit(0);
+	}
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+		errx(1, "child failed");
+}
+
+/* Rss and Pss in kB of the mapping at @buf, from /proc/self/smaps */
+static void smaps_rss_pss(const char *buf, unsigned long *rss,
+			  unsigned long *pss)
+{
+	char line[256];
+	int found = 0;
+	FILE *f;
+
+	f = fopen("/proc/self/smaps", "r");
+	if (!f)
+		err(1, "open smaps");
+	*rss = *pss = 0;
+	while (fgets(line, sizeof(line), f)) {
+		unsigned long start, end;
+
+		if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+			if (found)
+				break;
+			found = start == (unsigned long)buf;
+			continue;
+		}
+		if (!found)
+			continue;
+		sscanf(line, "Rss: %lu kB", rss);
+		sscanf(line, "Pss: %lu kB", pss);
+	}
+	fclose(f);
+	if (!found)
+		errx(1, "mapping not found in smaps");
+}
+
+/* The child shares the parent's tables, so it must own half their pages */
+static void child_pss(const char *buf)
+{
+	int status;
+	pid_t pid;
+
+	pid = fork();
+	if (pid < 0)
+		err(1, "fork");
+	if (!pid) {
+		unsigned long rss, pss;
+
+		smaps_rss_pss(buf, &rss, &pss);
+		printf("child rss %lu kB pss %lu kB\n", rss, pss);
+		fflush(stdout);
+		_exit(rss && pss * 4 > rss * 3);
+	}
+	if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+		errx(1, "child failed");
+	if (WEXITSTATUS(status))
+		errx(1, "pages of shared tables count as private in smaps");
+}
+
+int main(int argc, char **argv)
+{
+	size_t len = (argc > 1 ? atol(argv[1]) : 64) * MB;
+	char path[] = "/tmp/share_pgtable.XXXXXX";
+	volatile char sum = 0;
+	size_t off;
+	char *buf;
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0)
+		err(1, "mkstemp");
+	unlink(path);
+	if (ftruncate(fd, len))
+		err(1, "ftruncate");
+
+	buf = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (buf == MAP_FAILED)
+		err(1, "mmap");
+	for (off = 0; off < len; off += PAGE_SIZE)
+		sum += buf[off];
+
+	printf("child minor faults without sharing: ");
+	fflush(stdout);
+	child_minflt(buf, len);
+
+	if (madvise(buf, len, MADV_SHARE_PGTABLE)) {
+		printf("MADV_SHARE_PGTABLE not supported\n");
+		return 0;
+	}
+	printf("child minor faults with sharing: ");
+	fflush(stdout);
+	child_minflt(buf, len);
+	child_pss(buf);
+	return 0;
+}